@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Measures paretoRoutes latency and the number of labels it creates.
+
+Usage: pareto.py MAP... [--side SIDE] [--queries QUERIES]
+
+Generates a SIDE x SIDE grid of cities with road lengths 1..100 and years
+1960..2020, followed by QUERIES paretoRoutes lines between random cities.
+Each program is run on the grid alone and on the grid with the queries, and
+the difference is reported as the query time. All programs must print the
+same output.
+
+Label counts are printed only for programs built with PARETO_STATISTICS
+defined, for example:
+  cmake -S . -B stats -DCMAKE_C_FLAGS_RELEASE="-O3 -DNDEBUG -DPARETO_STATISTICS"
+Such a build prints the number of labels of the bound search and of the main
+search for every query to the standard diagnostic output.
+"""
+
+import argparse
+import random
+import sys
+
+import runner
+
+
+def grid(side):
+    lines = []
+    for row in range(side):
+        for column in range(side):
+            city = "c%d_%d" % (row, column)
+            if column + 1 < side:
+                lines.append("addRoad;%s;c%d_%d;%d;%d" % (
+                    city, row, column + 1, random.randint(1, 100),
+                    random.randint(1960, 2020)))
+            if row + 1 < side:
+                lines.append("addRoad;%s;c%d_%d;%d;%d" % (
+                    city, row + 1, column, random.randint(1, 100),
+                    random.randint(1960, 2020)))
+    return lines
+
+
+def queries(side, count):
+    lines = []
+    while len(lines) < count:
+        first = (random.randrange(side), random.randrange(side))
+        second = (random.randrange(side), random.randrange(side))
+        if first != second:
+            lines.append("paretoRoutes;c%d_%d;c%d_%d" % (first + second))
+    return lines
+
+
+def labels(errors, kind):
+    counts = []
+    for line in errors.splitlines():
+        words = line.split()
+        if words[:-1] == ["pareto"] + kind.split() + ["labels"]:
+            counts.append(int(words[-1]))
+    return counts
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument("programs", nargs="+")
+    parser.add_argument("--side", type=int, default=200)
+    parser.add_argument("--queries", type=int, default=20)
+    arguments = parser.parse_args()
+    random.seed(39)
+    roads = grid(arguments.side)
+    load = "\n".join(roads) + "\n"
+    search = "\n".join(roads + queries(arguments.side,
+                                        arguments.queries)) + "\n"
+
+    print("%d cities, %d roads, %d queries" % (
+        arguments.side * arguments.side, len(roads), arguments.queries))
+    output = None
+    for program in arguments.programs:
+        loaded = runner.best([program], load, 3)
+        seconds, memory, results, errors = runner.best([program], search, 3)
+        if output is not None and results != output:
+            sys.exit("%s prints different output" % program)
+        output = results
+        queried = seconds - loaded[0]
+        print("%s: %.3f s for queries, %.1f ms per query, %.1f MiB" % (
+            program, queried, 1000.0 * queried / arguments.queries, memory))
+        found = labels(errors, "")
+        bounds = labels(errors, "bound")
+        if found:
+            print("  labels %d (max %d per query), bound labels %d" % (
+                sum(found), max(found), sum(bounds)))
+
+
+if __name__ == "__main__":
+    main()
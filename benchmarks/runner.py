@@ -0,0 +1,42 @@
+"""Runs the map program on generated input and measures it.
+
+Every benchmark script in this directory imports this module. The input is
+written to a temporary file and given to the program as standard input, so
+reading it costs the same for every program compared. Wall time and the peak
+resident set size are taken for the child process alone, from wait4.
+"""
+
+import os
+import subprocess
+import tempfile
+import time
+
+
+def run(command, text):
+    """Runs command with text as standard input.
+
+    Returns a tuple (seconds, peak memory in MiB, standard output,
+    standard error).
+    """
+    with tempfile.TemporaryFile(mode="w+b") as source, \
+            tempfile.TemporaryFile(mode="w+b") as results, \
+            tempfile.TemporaryFile(mode="w+b") as errors:
+        source.write(text.encode())
+        source.seek(0)
+        start = time.perf_counter()
+        process = subprocess.Popen(command, stdin=source, stdout=results,
+                                   stderr=errors)
+        _, status, usage = os.wait4(process.pid, 0)
+        seconds = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+        results.seek(0)
+        errors.seek(0)
+        return (seconds, usage.ru_maxrss / 1024.0,
+                results.read().decode(errors="replace"),
+                errors.read().decode(errors="replace"))
+
+
+def best(command, text, repeats):
+    """Runs command repeats times and returns the run with the lowest time."""
+    runs = [run(command, text) for _ in range(repeats)]
+    return min(runs, key=lambda measured: measured[0])
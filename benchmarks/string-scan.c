@@ -0,0 +1,249 @@
+/** @file
+ * Mikrobenchmark funkcji przeszukujących napisy.
+ * Sprawdza, czy wersje znak po znaku, SSE2 i AVX2 funkcji z pliku
+ * string-scan.c dają te same wyniki, a następnie mierzy ich przepustowość
+ * na liniach długości 1 MB. Plik dołącza string-scan.c, żeby mieć dostęp do
+ * wszystkich wersji funkcji, więc kompiluje się go osobno:
+ *   cc -O2 -std=c11 -o string-scan benchmarks/string-scan.c
+ * Wersje AVX2 są sprawdzane i mierzone tylko wtedy, gdy obsługuje je procesor.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../src/string-scan.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef VECTOR_SCAN
+
+#define LINE_SIZE (1 << 20) ///< długość mierzonych linii
+#define REPEATS 200         ///< liczba przejść po linii w jednym pomiarze
+#define CHECKS 100000       ///< liczba losowych fragmentów do sprawdzenia
+#define MAX_CHECK_LENGTH 300 ///< największa długość sprawdzanego fragmentu
+
+/**
+ * Typ wskaźnika na wersję funkcji liczącej wystąpienia znaku.
+ */
+typedef size_t (*CountFunction)(const char *, size_t, char);
+
+/**
+ * Typ wskaźnika na wersję funkcji szukającej niedozwolonego znaku.
+ */
+typedef bool (*ForbiddenFunction)(const char *, size_t);
+
+/**
+ * @brief Struktura opisująca jedną wersję funkcji przeszukujących napisy.
+ */
+typedef struct Variant {
+    const char *name;            ///< nazwa wersji
+    CountFunction count;         ///< wersja funkcji countCharacter
+    ForbiddenFunction forbidden; ///< wersja funkcji hasForbiddenCharacter
+    bool supported;              ///< czy procesor obsługuje wersję
+} Variant;
+
+/**
+ * @brief Zwraca bieżący czas w sekundach.
+ * @return Czas zegara monotonicznego w sekundach.
+ */
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Wypełnia linię losowymi znakami dozwolonymi w nazwach miast
+ * i średnikami, które stanowią średnio co ósmy znak.
+ * @param[out] line          – tablica znaków linii;
+ * @param[in] length         – liczba znaków linii.
+ */
+static void fillLine(char *line, size_t length) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz"
+                                   "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -_";
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (rand() % 8 == 0) {
+            line[i] = ';';
+        }
+        else {
+            line[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+    }
+}
+
+/**
+ * @brief Porównuje wyniki wersji z wynikami wersji znak po znaku.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu;
+ * @param[in] variants       – tablica wersji funkcji, zaczynająca się od
+ *                             wersji znak po znaku;
+ * @param[in] numberOfVariants – liczba wersji funkcji.
+ * @return Liczba wersji, których wyniki są inne.
+ */
+static int compareVariants(const char *string, size_t length,
+                           Variant variants[], int numberOfVariants) {
+    size_t count = variants[0].count(string, length, ';');
+    bool forbidden = variants[0].forbidden(string, length);
+    int errors = 0;
+
+    for (int i = 1; i < numberOfVariants; i++) {
+        if (variants[i].supported
+            && ((variants[i].count(string, length, ';') != count)
+                || (variants[i].forbidden(string, length) != forbidden))) {
+            fprintf(stderr, "%s differs at length %zu\n", variants[i].name,
+                    length);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * @brief Sprawdza zgodność wersji na losowych fragmentach i na całej linii.
+ * Fragmenty zaczynają się pod dowolnym adresem i mają dowolną długość
+ * do @ref MAX_CHECK_LENGTH, więc obejmują końcówki krótsze niż blok
+ * wektorowy. W części fragmentów średniki są zastąpione innym znakiem,
+ * a w części jeden znak jest zastąpiony losowym bajtem. Cała linia jest
+ * sprawdzana bez niedozwolonych znaków oraz ze znakiem sterującym na końcu.
+ * @param[in,out] line       – tablica znaków linii o długości
+ *                             @ref LINE_SIZE;
+ * @param[in] variants       – tablica wersji funkcji;
+ * @param[in] numberOfVariants – liczba wersji funkcji.
+ * @return Liczba niezgodności.
+ */
+static int checkVariants(char *line, Variant variants[],
+                         int numberOfVariants) {
+    char *fragment;
+    size_t length;
+    int errors = 0;
+
+    for (int i = 0; i < CHECKS; i++) {
+        fillLine(line, MAX_CHECK_LENGTH + 64);
+        fragment = line + rand() % 64;
+        length = rand() % (MAX_CHECK_LENGTH + 1);
+        if (rand() % 2 == 0) {
+            for (size_t j = 0; j < length; j++) {
+                if (fragment[j] == ';') {
+                    fragment[j] = 'x';
+                }
+            }
+        }
+        if ((length > 0) && (rand() % 4 == 0)) {
+            fragment[rand() % length] = (char)(rand() % 256);
+        }
+
+        errors += compareVariants(fragment, length, variants,
+                                  numberOfVariants);
+    }
+
+    fillLine(line, LINE_SIZE);
+    for (size_t i = 0; i < LINE_SIZE; i++) {
+        if (line[i] == ';') {
+            line[i] = ',';
+        }
+    }
+    errors += compareVariants(line, LINE_SIZE, variants, numberOfVariants);
+    line[LINE_SIZE - 1] = '\n';
+    errors += compareVariants(line, LINE_SIZE, variants, numberOfVariants);
+
+    return errors;
+}
+
+/**
+ * @brief Mierzy przepustowość wersji na liniach długości @ref LINE_SIZE.
+ * Średniki są liczone w linii polecenia, a niedozwolone znaki są szukane
+ * w linii bez nich, więc przeszukiwana jest cała linia. Wypisuje też wyniki
+ * funkcji, żeby pomiar nie mógł zostać pominięty przez kompilator.
+ * @param[in] line           – linia ze średnikami;
+ * @param[in] clean          – linia bez niedozwolonych znaków;
+ * @param[in] variant        – wskaźnik na wersję funkcji.
+ */
+static void measureVariant(const char *line, const char *clean,
+                           Variant *variant) {
+    size_t count = 0, forbidden = 0;
+    double start, countSeconds, forbiddenSeconds;
+
+    start = now();
+    for (int i = 0; i < REPEATS; i++) {
+        count += variant->count(line, LINE_SIZE, ';');
+    }
+    countSeconds = now() - start;
+
+    start = now();
+    for (int i = 0; i < REPEATS; i++) {
+        forbidden += variant->forbidden(clean, LINE_SIZE);
+    }
+    forbiddenSeconds = now() - start;
+
+    printf("%-7s countCharacter %6.2f GB/s, hasForbiddenCharacter %6.2f GB/s,"
+           " semicolons %zu, forbidden %zu\n", variant->name,
+           (double)LINE_SIZE * REPEATS / countSeconds * 1e-9,
+           (double)LINE_SIZE * REPEATS / forbiddenSeconds * 1e-9,
+           count / REPEATS, forbidden);
+}
+
+int main(void) {
+    Variant variants[] = {
+        {"scalar", countCharacterScalar, hasForbiddenCharacterScalar, true},
+        {"SSE2", countCharacterSse2, hasForbiddenCharacterSse2,
+         __builtin_cpu_supports("sse2")},
+        {"AVX2", countCharacterAvx2, hasForbiddenCharacterAvx2,
+         __builtin_cpu_supports("avx2")}
+    };
+    int numberOfVariants = sizeof(variants) / sizeof(variants[0]);
+    char *line = (char *)malloc(LINE_SIZE);
+    char *clean = (char *)malloc(LINE_SIZE);
+    int errors = 1;
+
+    if ((line != NULL) && (clean != NULL)) {
+        srand(42);
+        errors = checkVariants(line, variants, numberOfVariants);
+        printf("%d fragments and two 1 MB lines checked, %d mismatches\n",
+               CHECKS, errors);
+
+        fillLine(line, LINE_SIZE);
+        for (size_t i = 0; i < LINE_SIZE; i++) {
+            if (line[i] == ';') {
+                clean[i] = ',';
+            }
+            else {
+                clean[i] = line[i];
+            }
+        }
+
+        for (int i = 0; i < numberOfVariants; i++) {
+            if (variants[i].supported) {
+                measureVariant(line, clean, &variants[i]);
+            }
+            else {
+                printf("%-7s not supported by this processor\n",
+                       variants[i].name);
+            }
+        }
+    }
+
+    free(line);
+    free(clean);
+
+    return errors != 0;
+}
+
+#else
+
+int main(void) {
+    printf("vector versions are not available on this processor\n");
+
+    return 0;
+}
+
+#endif
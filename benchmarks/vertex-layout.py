@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Compares the memory and search throughput of two map programs.
+
+Usage: vertex-layout.py OLD_MAP NEW_MAP [SIDE] [SEARCHES]
+
+Written for the change that moved vertex data from per-city objects into
+parallel arrays indexed by city id and made roads store 32-bit city ids.
+Build the program before and after that change and pass both binaries.
+
+Two inputs are generated from a SIDE x SIDE grid of cities:
+- load: only the addRoad lines of the grid, measuring memory per road;
+- search: the grid followed by SEARCHES pairs of newRoute and removeRoute
+  lines between random cities, measuring Dijkstra throughput.
+Both programs must print the same output.
+"""
+
+import random
+import sys
+
+import runner
+
+
+def grid(side):
+    lines = []
+    for row in range(side):
+        for column in range(side):
+            city = "c%d_%d" % (row, column)
+            if column + 1 < side:
+                lines.append("addRoad;%s;c%d_%d;%d;%d" % (
+                    city, row, column + 1, random.randint(1, 9),
+                    random.randint(1950, 2020)))
+            if row + 1 < side:
+                lines.append("addRoad;%s;c%d_%d;%d;%d" % (
+                    city, row + 1, column, random.randint(1, 9),
+                    random.randint(1950, 2020)))
+    return lines
+
+
+def searches(side, count):
+    lines = []
+    for _ in range(count):
+        lines.append("newRoute;1;c%d_%d;c%d_%d" % (
+            random.randrange(side), random.randrange(side),
+            random.randrange(side), random.randrange(side)))
+        lines.append("removeRoute;1")
+    return lines
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    old, new = sys.argv[1], sys.argv[2]
+    side = int(sys.argv[3]) if len(sys.argv) > 3 else 400
+    count = int(sys.argv[4]) if len(sys.argv) > 4 else 200
+    random.seed(31)
+    roads = grid(side)
+    inputs = [("load", roads), ("search", roads + searches(side, count))]
+
+    print("%d cities, %d roads, %d searches" % (side * side, len(roads),
+                                                  count))
+    for name, lines in inputs:
+        text = "\n".join(lines) + "\n"
+        measured = [runner.best([program], text, 3) for program in (old, new)]
+        if measured[0][2:] != measured[1][2:]:
+            sys.exit("%s: the programs print different output" % name)
+        for program, (seconds, memory, _, _) in zip(("old", "new"), measured):
+            print("%-6s %-3s %8.3f s %9.1f MiB" % (name, program, seconds,
+                                                   memory))
+        print("%-6s new/old time %.2f, memory %.2f" % (
+            name, measured[1][0] / measured[0][0],
+            measured[1][1] / measured[0][1]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,460 @@
+/** @file
+ * Plik zawierający funkcje do wyznaczania alternatywnych przebiegów dróg
+ * krajowych.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "alternatives.h"
+#include "help-functions.h"
+#include "dijkstra.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Struktura przechowująca tablicę ścieżek.
+ */
+typedef struct Paths Paths;
+
+/**
+ * @brief Struktura przechowująca tablicę ścieżek.
+ * Ścieżki są przechowywane w strukturach dróg krajowych, bez powiązań
+ * z odcinkami dróg i miastami mapy.
+ * Struktura zawiera:
+ * rozmiar tablicy i liczbę ścieżek;
+ * tablicę wskaźników na ścieżki.
+ */
+struct Paths {
+    int size;       ///< rozmiar tablicy wskaźników na ścieżki
+    int number;     ///< liczba ścieżek
+    Route **routes; ///< tablica wskaźników na ścieżki
+};
+
+/**
+ * @brief Dodaje ścieżkę na koniec tablicy ścieżek.
+ * @param[in,out] paths      – wskaźnik na tablicę ścieżek;
+ * @param[in] path           – wskaźnik na dodawaną ścieżkę.
+ * @return Wartość @p true, jeśli udało się dodać ścieżkę.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool addPath(Paths *paths, Route *path) {
+    Route **routes;
+    int newSize;
+    bool correct = true;
+
+    if (paths->number == paths->size) {
+        newSize = enlargeSize(paths->size);
+        routes = (Route **)realloc(paths->routes, newSize * sizeof(Route *));
+        if (routes == NULL) {
+            correct = false;
+        }
+        else {
+            paths->routes = routes;
+            paths->size = newSize;
+        }
+    }
+
+    if (correct) {
+        paths->routes[paths->number] = path;
+        paths->number++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Zwalnia ścieżki oraz tablicę ścieżek.
+ * @param[in,out] paths      – wskaźnik na tablicę ścieżek.
+ */
+static void freePaths(Paths *paths) {
+    for (int i = 0; i < paths->number; i++) {
+        freeRoute(paths->routes[i]);
+    }
+    free(paths->routes);
+}
+
+/**
+ * @brief Oblicza długość ścieżki.
+ * @param[in] path           – wskaźnik na ścieżkę.
+ * @return Suma długości odcinków dróg ścieżki.
+ */
+static uint64_t pathLength(Route *path) {
+    uint64_t length = 0;
+
+    for (int i = 0; i < path->numberOfRoads; i++) {
+        length += path->roads[path->first + i]->length;
+    }
+
+    return length;
+}
+
+/**
+ * @brief Wyznacza rok budowy lub ostatniego remontu najstarszego odcinka drogi
+ * ścieżki.
+ * @param[in] path           – wskaźnik na niepustą ścieżkę.
+ * @return Najmniejszy rok budowy lub ostatniego remontu odcinka drogi.
+ */
+static int pathOldestYear(Route *path) {
+    int oldest = path->roads[path->first]->year;
+
+    for (int i = 1; i < path->numberOfRoads; i++) {
+        if (path->roads[path->first + i]->year < oldest) {
+            oldest = path->roads[path->first + i]->year;
+        }
+    }
+
+    return oldest;
+}
+
+/**
+ * @brief Sprawdza, czy pierwsza ścieżka jest lepsza od drugiej.
+ * @param[in] path           – wskaźnik na ścieżkę;
+ * @param[in] other          – wskaźnik na ścieżkę.
+ * @return Wartość @p true, jeśli pierwsza ścieżka jest krótsza, lub jeśli
+ * jest tak samo długa, ale jej najstarszy odcinek drogi jest młodszy.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isBetterPath(Route *path, Route *other) {
+    uint64_t length = pathLength(path), otherLength = pathLength(other);
+    bool better = false;
+
+    if (length < otherLength) {
+        better = true;
+    }
+    else if ((length == otherLength)
+             && (pathOldestYear(path) > pathOldestYear(other))) {
+        better = true;
+    }
+
+    return better;
+}
+
+/**
+ * @brief Sprawdza, czy początkowe odcinki dróg dwóch ścieżek są takie same.
+ * @param[in] path           – wskaźnik na ścieżkę;
+ * @param[in] other          – wskaźnik na ścieżkę;
+ * @param[in] count          – liczba porównywanych odcinków dróg, nie większa
+ *                             niż liczba odcinków dróg w każdej ze ścieżek.
+ * @return Wartość @p true, jeśli początkowe odcinki dróg są takie same.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool haveSameBeginning(Route *path, Route *other, int count) {
+    if (memcmp(path->roads + path->first, other->roads + other->first,
+               count * sizeof(Road *)) == 0) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Sprawdza, czy ścieżka znajduje się w tablicy ścieżek.
+ * @param[in] paths          – wskaźnik na tablicę ścieżek;
+ * @param[in] path           – wskaźnik na ścieżkę.
+ * @return Wartość @p true, jeśli w tablicy jest ścieżka o tych samych odcinkach
+ * dróg. Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isPathKnown(Paths *paths, Route *path) {
+    bool known = false;
+    int i = 0;
+
+    while ((i < paths->number) && !known) {
+        if ((paths->routes[i]->numberOfRoads == path->numberOfRoads)
+            && haveSameBeginning(paths->routes[i], path, path->numberOfRoads)) {
+            known = true;
+        }
+        i++;
+    }
+
+    return known;
+}
+
+/**
+ * @brief Tworzy ścieżkę złożoną z początku danej ścieżki i ścieżki wyznaczonej
+ * przez tablicę poprzedników.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] root           – wskaźnik na ścieżkę, której początek jest
+ *                             kopiowany, lub NULL;
+ * @param[in] rootRoads      – liczba kopiowanych odcinków dróg;
+ * @param[in] to             – identyfikator miasta, na którym kończy się
+ *                             ścieżka wyznaczona przez tablicę poprzedników;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Wskaźnik na utworzoną ścieżkę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static Route* buildPath(Map *map, Route *root, int rootRoads, int to,
+                        Road *previous[]) {
+    Route *path = (Route *)malloc(sizeof(Route));
+    int id = to, length = 0, position;
+
+    while (previous[id] != NULL) {
+        id = otherCityId(previous[id], id);
+        length++;
+    }
+
+    if (path != NULL) {
+        setRouteValues(path, 0);
+        if (!reserveRouteSpace(path, 0, rootRoads + length)) {
+            freeRoute(path);
+            path = NULL;
+        }
+    }
+
+    if (path != NULL) {
+        position = path->first;
+        for (int i = 0; i < rootRoads; i++) {
+            path->roads[position] = root->roads[root->first + i];
+            path->cities[position] = root->cities[root->first + i];
+            position++;
+        }
+
+        position += length;
+        id = to;
+        path->cities[position] = map->cities[id];
+        while (previous[id] != NULL) {
+            position--;
+            path->roads[position] = previous[id];
+            id = otherCityId(previous[id], id);
+            path->cities[position] = map->cities[id];
+        }
+        path->numberOfRoads = rootRoads + length;
+    }
+
+    return path;
+}
+
+/**
+ * @brief Ustawia informację o przeznaczeniu do usunięcia odcinków dróg, którymi
+ * znalezione ścieżki o podanym początku wychodzą z miasta odgałęzienia.
+ * @param[in] found          – wskaźnik na tablicę znalezionych ścieżek;
+ * @param[in] last           – wskaźnik na ostatnio znalezioną ścieżkę;
+ * @param[in] rootRoads      – liczba odcinków dróg przed miastem
+ *                             odgałęzienia;
+ * @param[in] value          – ustawiana wartość.
+ */
+static void excludeNextRoads(Paths *found, Route *last, int rootRoads,
+                             bool value) {
+    Route *path;
+
+    for (int i = 0; i < found->number; i++) {
+        path = found->routes[i];
+        if ((path->numberOfRoads > rootRoads)
+            && haveSameBeginning(path, last, rootRoads)) {
+            path->roads[path->first + rootRoads]->toRemove = value;
+        }
+    }
+}
+
+/**
+ * @brief Wyznacza kandydatów na kolejną ścieżkę.
+ * Dla każdego miasta ostatnio znalezionej ścieżki, z wyjątkiem końcowego,
+ * szuka najkrótszej ścieżki z tego miasta do miasta końcowego, omijającej
+ * wcześniejsze miasta ścieżki oraz odcinki dróg, którymi wychodzą z tego
+ * miasta znalezione już ścieżki o tym samym początku.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze;
+ * @param[in] found          – wskaźnik na tablicę znalezionych ścieżek;
+ * @param[in,out] candidates – wskaźnik na tablicę kandydatów;
+ * @param[in] to             – identyfikator miasta końcowego;
+ * @param[in] bound          – tablica odległości miast od miasta końcowego.
+ * @return Wartość @p true, jeśli udało się wyznaczyć kandydatów.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool findCandidates(Map *map, Workspace *workspace, Paths *found,
+                           Paths *candidates, int to, const uint64_t bound[]) {
+    Route *last = found->routes[found->number - 1];
+    Route *path;
+    int spur;
+    bool correct = true, exists;
+    int i = 0;
+
+    while ((i < last->numberOfRoads) && correct) {
+        spur = last->cities[last->first + i]->id;
+        newMark(map);
+        for (int j = 0; j < i; j++) {
+            markVertex(map, last->cities[last->first + j]->id);
+        }
+        excludeNextRoads(found, last, i, true);
+        exists = shortestPath(map, workspace, spur, to, bound);
+        excludeNextRoads(found, last, i, false);
+        newMark(map);
+
+        if (exists) {
+            path = buildPath(map, last, i, to, workspace->previous);
+            if (path == NULL) {
+                correct = false;
+            }
+            else if (isPathKnown(candidates, path)) {
+                freeRoute(path);
+            }
+            else if (!addPath(candidates, path)) {
+                freeRoute(path);
+                correct = false;
+            }
+        }
+        i++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Przenosi najlepszego kandydata do tablicy znalezionych ścieżek.
+ * @param[in,out] found      – wskaźnik na tablicę znalezionych ścieżek;
+ * @param[in,out] candidates – wskaźnik na niepustą tablicę kandydatów.
+ * @return Wartość @p true, jeśli udało się przenieść kandydata.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool chooseBestCandidate(Paths *found, Paths *candidates) {
+    int best = 0;
+    Route *path;
+
+    for (int i = 1; i < candidates->number; i++) {
+        if (isBetterPath(candidates->routes[i], candidates->routes[best])) {
+            best = i;
+        }
+    }
+
+    path = candidates->routes[best];
+    candidates->number--;
+    candidates->routes[best] = candidates->routes[candidates->number];
+
+    if (!addPath(found, path)) {
+        freeRoute(path);
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+/**
+ * @brief Porządkuje ścieżki od najlepszej, zachowując kolejność ścieżek
+ * równie dobrych.
+ * Ścieżki znajdowane są w kolejności niemalejących długości, ale pierwsza
+ * z nich nie musi być najlepsza spośród ścieżek o tej samej długości.
+ * @param[in,out] paths      – wskaźnik na tablicę ścieżek.
+ */
+static void sortPaths(Paths *paths) {
+    Route *path;
+    int j;
+
+    for (int i = 1; i < paths->number; i++) {
+        path = paths->routes[i];
+        j = i;
+        while ((j > 0) && isBetterPath(path, paths->routes[j - 1])) {
+            paths->routes[j] = paths->routes[j - 1];
+            j--;
+        }
+        paths->routes[j] = path;
+    }
+}
+
+/**
+ * @brief Tworzy opis znalezionych ścieżek.
+ * Porządkuje ścieżki i nadaje im pozycje.
+ * @param[in,out] found      – wskaźnik na tablicę znalezionych ścieżek.
+ * @return Wskaźnik na zaalokowany napis lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static char const* pathsDescription(Paths *found) {
+    char *description = (char *)malloc(1);
+    const char *line;
+    size_t size = 0, lineSize;
+    Route *path;
+
+    sortPaths(found);
+    if (description != NULL) {
+        description[0] = '\0';
+    }
+
+    for (int i = 0; (i < found->number) && (description != NULL); i++) {
+        path = found->routes[i];
+        if ((i > 0) && !isBetterPath(found->routes[i - 1], path)) {
+            path->id = found->routes[i - 1]->id;
+        }
+        else {
+            path->id = i + 1;
+        }
+
+        line = routeDescription(path);
+        if (line == NULL) {
+            free(description);
+            description = NULL;
+        }
+        else {
+            lineSize = strlen(line);
+            description = (char *)realloc(description, size + lineSize + 2);
+            if (description != NULL) {
+                if (i > 0) {
+                    description[size] = '\n';
+                    size++;
+                }
+                memcpy(description + size, line, lineSize + 1);
+                size += lineSize;
+            }
+            free((void *)line);
+        }
+    }
+
+    return description;
+}
+
+char const* alternativesDescription(Map *map, City *from, City *to, unsigned k) {
+    Paths found = {0, 0, NULL}, candidates = {0, 0, NULL};
+    Workspace *workspace = newWorkspace(map->numberOfCities);
+    uint64_t *bound = (uint64_t *)malloc(map->numberOfCities
+                                         * sizeof(uint64_t));
+    const char *description = NULL;
+    Route *path;
+    bool correct = true;
+
+    if ((workspace == NULL) || (bound == NULL)) {
+        correct = false;
+    }
+    else {
+        newMark(map);
+        shortestPath(map, workspace, to->id, -1, NULL);
+        memcpy(bound, workspace->vertices.distance,
+               map->numberOfCities * sizeof(uint64_t));
+
+        if (shortestPath(map, workspace, from->id, to->id, bound)) {
+            path = buildPath(map, NULL, 0, to->id, workspace->previous);
+            if (path == NULL) {
+                correct = false;
+            }
+            else if (!addPath(&found, path)) {
+                freeRoute(path);
+                correct = false;
+            }
+        }
+    }
+
+    while (correct && (found.number > 0) && ((unsigned)found.number < k)) {
+        if (!findCandidates(map, workspace, &found, &candidates, to->id,
+                            bound)) {
+            correct = false;
+        }
+        else if (candidates.number == 0) {
+            k = found.number;
+        }
+        else if (!chooseBestCandidate(&found, &candidates)) {
+            correct = false;
+        }
+    }
+
+    if (correct) {
+        description = pathsDescription(&found);
+    }
+
+    freePaths(&found);
+    freePaths(&candidates);
+    freeWorkspace(workspace);
+    free(bound);
+
+    return description;
+}
@@ -0,0 +1,35 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje do wyznaczania alternatywnych
+ * przebiegów dróg krajowych.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __ALTERNATIVES_H__
+#define __ALTERNATIVES_H__
+
+#include "structures-functions.h"
+
+/**
+ * @brief Wyznacza najkrótsze ścieżki bez cykli między dwoma miastami
+ * i tworzy ich opis.
+ * Wyznacza co najwyżej @p k najkrótszych ścieżek algorytmem Yena. Ścieżki
+ * o równej długości porządkuje tak, jak przy wyborze przebiegu drogi krajowej:
+ * wcześniej jest ta, której najstarszy odcinek drogi jest najmłodszy. Każdą
+ * ścieżkę opisuje w formacie opisu drogi krajowej, w którym zamiast numeru
+ * drogi krajowej występuje pozycja ścieżki. Ścieżki o równej długości i równym
+ * roku najstarszego odcinka drogi mają tę samą pozycję. Opisy ścieżek są
+ * oddzielone znakami nowej linii.
+ * @param[in,out] map        – wskaźnik na strukturę mapy, która po wykonaniu
+ *                             funkcji jest taka sama jak przed nim;
+ * @param[in] from           – wskaźnik na miasto początkowe;
+ * @param[in] to             – wskaźnik na miasto końcowe, różne od
+ *                             początkowego;
+ * @param[in] k              – największa liczba wyznaczanych ścieżek.
+ * @return Wskaźnik na zaalokowany napis, pusty, gdy miasta nie są połączone,
+ * lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+char const* alternativesDescription(Map *map, City *from, City *to, unsigned k);
+
+#endif /* __ALTERNATIVES_H__ */
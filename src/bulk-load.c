@@ -0,0 +1,691 @@
+/** @file
+ * Plik zawierający funkcje wczytywania mapy w trybie zbiorczym.
+ *
+ * Indeks nazw, listy sąsiedztwa i dowiązania dróg krajowych nie są budowane
+ * od nowa jednym przebiegiem. Odłożone polecenia są wykonywane po kolei, tak
+ * jak bez trybu zbiorczego, ale nazwy miast i pary miast są wcześniej
+ * posortowane i wyszukane w mapie tylko raz. Dzięki temu każde polecenie
+ * nadal ma własny punkt wycofania w dzienniku zmian, a błędne polecenia są
+ * zgłaszane tak samo jak bez trybu zbiorczego.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "bulk-load.h"
+#include "help-functions.h"
+#include "route-search.h"
+#include "undo-log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Struktura przechowująca nazwę miasta przy sortowaniu nazw.
+ */
+typedef struct NameEntry NameEntry;
+
+/**
+ * Struktura przechowująca parę miast przy sortowaniu odcinków dróg.
+ */
+typedef struct EdgeEntry EdgeEntry;
+
+/**
+ * Struktura przechowująca tablice pomocnicze trybu zbiorczego.
+ */
+typedef struct BulkPlan BulkPlan;
+
+/**
+ * @brief Struktura przechowująca nazwę miasta przy sortowaniu nazw.
+ */
+struct NameEntry {
+    const char *name; ///< nazwa miasta
+    int index;        ///< indeks nazwy w tablicy nazw trybu zbiorczego
+};
+
+/**
+ * @brief Struktura przechowująca parę miast przy sortowaniu odcinków dróg.
+ * Miasta są zapisane jako numery nazw, mniejszy numer jako pierwszy.
+ */
+struct EdgeEntry {
+    int cityA; ///< mniejszy numer nazwy miasta
+    int cityB; ///< większy numer nazwy miasta
+    int index; ///< indeks nazwy, od której zaczyna się odcinek drogi
+};
+
+/**
+ * @brief Struktura przechowująca tablice pomocnicze trybu zbiorczego.
+ * Różne nazwy miast i różne pary miast połączonych odcinkami dróg mają
+ * kolejne numery. Struktura zawiera:
+ * numery nazw kolejnych miast poleceń;
+ * identyfikatory miast o kolejnych numerach nazw;
+ * numery ostatnich poleceń, w których wystąpiły miasta;
+ * numery par miast kolejnych odcinków dróg poleceń;
+ * odcinki dróg łączące pary miast o kolejnych numerach;
+ * tablice miast i odcinków dróg wykonywanego polecenia.
+ */
+struct BulkPlan {
+    int *keys;        ///< numery nazw kolejnych miast poleceń
+    int *cityIds;     ///< identyfikatory miast lub -1, jeśli ich nie ma
+    int *seen;        ///< numery poleceń, w których ostatnio były miasta
+    int *slots;       ///< numery par miast kolejnych odcinków dróg
+    Road **roads;     ///< odcinki dróg łączące pary miast lub NULL
+    City **cities;    ///< tablica miast wykonywanego polecenia
+    Road **newRoads;  ///< tablica odcinków dróg wykonywanego polecenia
+};
+
+void setBulkLoadValues(BulkLoad *bulk) {
+    bulk->active = false;
+    bulk->parallel = false;
+    bulk->records = NULL;
+    bulk->numberOfRecords = 0;
+    bulk->recordsSize = 0;
+    bulk->names = NULL;
+    bulk->numberOfNames = 0;
+    bulk->namesSize = 0;
+    bulk->text = NULL;
+    bulk->textLength = 0;
+    bulk->textSize = 0;
+}
+
+void freeBulkLoad(BulkLoad *bulk) {
+    free(bulk->records);
+    free(bulk->names);
+    free(bulk->text);
+    setBulkLoadValues(bulk);
+}
+
+void clearBulkLoad(BulkLoad *bulk) {
+    bulk->numberOfRecords = 0;
+    bulk->numberOfNames = 0;
+    bulk->textLength = 0;
+}
+
+char* bulkName(BulkLoad *bulk, int index) {
+    return bulk->text + bulk->names[index].offset;
+}
+
+/**
+ * @brief Zapewnia w tablicach trybu zbiorczego miejsce na kolejne polecenie.
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] numberOfNames  – liczba miast polecenia;
+ * @param[in] textLength     – łączna długość nazw miast polecenia wraz ze
+ *                             znakami końca napisu.
+ * @return Wartość @p true, jeśli w tablicach jest miejsce na polecenie.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveBulkSpace(BulkLoad *bulk, int numberOfNames,
+                             size_t textLength) {
+    BulkRecord *records;
+    BulkName *names;
+    char *text;
+    int newSize;
+    size_t newTextSize;
+    bool correct = true;
+
+    if (bulk->numberOfRecords == bulk->recordsSize) {
+        newSize = enlargeSize(bulk->recordsSize);
+        records = (BulkRecord *)realloc(bulk->records,
+                                        newSize * sizeof(BulkRecord));
+        if (records == NULL) {
+            correct = false;
+        }
+        else {
+            bulk->records = records;
+            bulk->recordsSize = newSize;
+        }
+    }
+
+    if (correct && (bulk->numberOfNames + numberOfNames > bulk->namesSize)) {
+        newSize = enlargeSize(bulk->numberOfNames + numberOfNames);
+        names = (BulkName *)realloc(bulk->names, newSize * sizeof(BulkName));
+        if (names == NULL) {
+            correct = false;
+        }
+        else {
+            bulk->names = names;
+            bulk->namesSize = newSize;
+        }
+    }
+
+    if (correct && (bulk->textLength + textLength > bulk->textSize)) {
+        newTextSize = 2 * (bulk->textLength + textLength);
+        text = (char *)realloc(bulk->text, newTextSize);
+        if (text == NULL) {
+            correct = false;
+        }
+        else {
+            bulk->text = text;
+            bulk->textSize = newTextSize;
+        }
+    }
+
+    return correct;
+}
+
+bool addBulkRecord(BulkLoad *bulk, int lineNumber, unsigned routeId,
+                   int numberOfNames, char *names[], unsigned lengths[],
+                   int years[]) {
+    BulkRecord *record;
+    BulkName *name;
+    size_t textLength = 0, nameLength;
+    bool correct = true;
+
+    for (int i = 0; i < numberOfNames; i++) {
+        textLength += strlen(names[i]) + 1;
+    }
+
+    if (!reserveBulkSpace(bulk, numberOfNames, textLength)) {
+        correct = false;
+    }
+    else {
+        record = &bulk->records[bulk->numberOfRecords];
+        record->lineNumber = lineNumber;
+        record->routeId = routeId;
+        record->firstName = bulk->numberOfNames;
+        record->numberOfNames = numberOfNames;
+        record->search = false;
+        record->failed = false;
+        bulk->numberOfRecords++;
+
+        for (int i = 0; i < numberOfNames; i++) {
+            name = &bulk->names[bulk->numberOfNames];
+            nameLength = strlen(names[i]) + 1;
+            name->offset = bulk->textLength;
+            memcpy(bulk->text + bulk->textLength, names[i], nameLength);
+            bulk->textLength += nameLength;
+            if (i < numberOfNames - 1) {
+                name->length = lengths[i];
+                name->year = years[i];
+            }
+            bulk->numberOfNames++;
+        }
+    }
+
+    return correct;
+}
+
+bool addBulkSearch(BulkLoad *bulk, int lineNumber, unsigned routeId,
+                   int numberOfNames, char *names[]) {
+    unsigned lengths[1] = {0};
+    int years[1] = {0};
+    bool correct = addBulkRecord(bulk, lineNumber, routeId, numberOfNames,
+                                 names, lengths, years);
+
+    if (correct) {
+        bulk->records[bulk->numberOfRecords - 1].search = true;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Porównuje nazwy miast przy sortowaniu.
+ * @param[in] a              – wskaźnik na pierwszą nazwę;
+ * @param[in] b              – wskaźnik na drugą nazwę.
+ * @return Liczba ujemna, zero lub dodatnia, gdy pierwsza nazwa jest
+ * odpowiednio mniejsza, równa lub większa od drugiej.
+ */
+static int compareNames(const void *a, const void *b) {
+    return strcmp(((const NameEntry *)a)->name, ((const NameEntry *)b)->name);
+}
+
+/**
+ * @brief Porównuje pary miast przy sortowaniu.
+ * @param[in] a              – wskaźnik na pierwszą parę;
+ * @param[in] b              – wskaźnik na drugą parę.
+ * @return Liczba ujemna, zero lub dodatnia, gdy pierwsza para jest
+ * odpowiednio mniejsza, równa lub większa od drugiej.
+ */
+static int compareEdges(const void *a, const void *b) {
+    const EdgeEntry *edgeA = (const EdgeEntry *)a;
+    const EdgeEntry *edgeB = (const EdgeEntry *)b;
+
+    if (edgeA->cityA != edgeB->cityA) {
+        return (edgeA->cityA > edgeB->cityA) - (edgeA->cityA < edgeB->cityA);
+    }
+    else {
+        return (edgeA->cityB > edgeB->cityB) - (edgeA->cityB < edgeB->cityB);
+    }
+}
+
+/**
+ * @brief Zwalnia tablice pomocnicze trybu zbiorczego.
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze.
+ */
+static void freeBulkPlan(BulkPlan *plan) {
+    free(plan->keys);
+    free(plan->cityIds);
+    free(plan->seen);
+    free(plan->slots);
+    free(plan->roads);
+    free(plan->cities);
+    free(plan->newRoads);
+}
+
+/**
+ * @brief Alokuje tablice pomocnicze trybu zbiorczego.
+ * @param[out] plan          – wskaźnik na tablice pomocnicze;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego.
+ * @return Wartość @p true, jeśli udało się zaalokować tablice.
+ * Wartość @p false, w przeciwnym przypadku; tablice są wtedy zwolnione.
+ */
+static bool newBulkPlan(BulkPlan *plan, BulkLoad *bulk) {
+    int size = bulk->numberOfNames;
+    int longest = 0;
+
+    for (int i = 0; i < bulk->numberOfRecords; i++) {
+        if (bulk->records[i].numberOfNames > longest) {
+            longest = bulk->records[i].numberOfNames;
+        }
+    }
+
+    plan->keys = (int *)malloc(size * sizeof(int));
+    plan->cityIds = (int *)malloc(size * sizeof(int));
+    plan->seen = (int *)malloc(size * sizeof(int));
+    plan->slots = (int *)malloc(size * sizeof(int));
+    plan->roads = (Road **)malloc(size * sizeof(Road *));
+    plan->cities = (City **)malloc(longest * sizeof(City *));
+    plan->newRoads = (Road **)malloc(longest * sizeof(Road *));
+
+    if ((plan->keys == NULL) || (plan->cityIds == NULL) || (plan->seen == NULL)
+        || (plan->slots == NULL) || (plan->roads == NULL)
+        || (plan->cities == NULL) || (plan->newRoads == NULL)) {
+        freeBulkPlan(plan);
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+/**
+ * @brief Nadaje numery różnym nazwom miast.
+ * Sortuje nazwy i każdą różną nazwę raz szuka w mapie.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze.
+ * @return Wartość @p true, jeśli udało się nadać numery.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool numberNames(Map *map, BulkLoad *bulk, BulkPlan *plan) {
+    NameEntry *entries = (NameEntry *)malloc(bulk->numberOfNames
+                                             * sizeof(NameEntry));
+    City *city;
+    int key = -1;
+
+    if (entries == NULL) {
+        return false;
+    }
+    else {
+        for (int i = 0; i < bulk->numberOfNames; i++) {
+            entries[i].name = bulkName(bulk, i);
+            entries[i].index = i;
+        }
+        qsort(entries, bulk->numberOfNames, sizeof(NameEntry), compareNames);
+
+        for (int i = 0; i < bulk->numberOfNames; i++) {
+            if ((i == 0) || (strcmp(entries[i].name, entries[i - 1].name) != 0)) {
+                key++;
+                city = findCity(map, entries[i].name);
+                if (city == NULL) {
+                    plan->cityIds[key] = -1;
+                }
+                else {
+                    plan->cityIds[key] = city->id;
+                }
+                plan->seen[key] = -1;
+            }
+            plan->keys[entries[i].index] = key;
+        }
+
+        free(entries);
+        return true;
+    }
+}
+
+/**
+ * @brief Nadaje numery różnym parom miast połączonych odcinkami dróg.
+ * Sortuje pary i dla każdej różnej pary istniejących już miast raz szuka
+ * łączącego je odcinka drogi.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze.
+ * @return Wartość @p true, jeśli udało się nadać numery.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool numberEdges(Map *map, BulkLoad *bulk, BulkPlan *plan) {
+    EdgeEntry *entries = (EdgeEntry *)malloc(bulk->numberOfNames
+                                             * sizeof(EdgeEntry));
+    BulkRecord *record;
+    EdgeEntry *entry;
+    int numberOfEdges = 0, slot = -1;
+    int keyA, keyB;
+
+    if (entries == NULL) {
+        return false;
+    }
+    else {
+        for (int i = 0; i < bulk->numberOfRecords; i++) {
+            record = &bulk->records[i];
+            for (int j = record->firstName;
+                 j < record->firstName + record->numberOfNames - 1; j++) {
+                entry = &entries[numberOfEdges++];
+                keyA = plan->keys[j];
+                keyB = plan->keys[j + 1];
+                if (keyA < keyB) {
+                    entry->cityA = keyA;
+                    entry->cityB = keyB;
+                }
+                else {
+                    entry->cityA = keyB;
+                    entry->cityB = keyA;
+                }
+                entry->index = j;
+            }
+        }
+        qsort(entries, numberOfEdges, sizeof(EdgeEntry), compareEdges);
+
+        for (int i = 0; i < numberOfEdges; i++) {
+            entry = &entries[i];
+            if ((i == 0) || (compareEdges(entry, &entries[i - 1]) != 0)) {
+                slot++;
+                plan->roads[slot] = NULL;
+                keyA = plan->cityIds[entry->cityA];
+                keyB = plan->cityIds[entry->cityB];
+                if ((keyA >= 0) && (keyB >= 0)) {
+                    plan->roads[slot] = findRoad(map->cities[keyA],
+                                                 map->cities[keyB]);
+                }
+            }
+            plan->slots[entry->index] = slot;
+        }
+
+        free(entries);
+        return true;
+    }
+}
+
+/**
+ * @brief Szuka miasta o podanym indeksie nazwy lub je dodaje.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] plan           – wskaźnik na tablice pomocnicze;
+ * @param[in] index          – indeks nazwy miasta.
+ * @return Wskaźnik na miasto lub NULL, gdy nie udało się go dodać.
+ */
+static City* findOrAddBulkCity(Map *map, BulkLoad *bulk, BulkPlan *plan,
+                               int index) {
+    int id = plan->cityIds[plan->keys[index]];
+
+    if (id >= 0) {
+        return map->cities[id];
+    }
+    else {
+        return addCity(map, bulkName(bulk, index));
+    }
+}
+
+/**
+ * @brief Zapisuje w tablicach pomocniczych miasta i odcinki dróg dodane przez
+ * polecenie, które się powiodło.
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze;
+ * @param[in] record         – wskaźnik na polecenie.
+ */
+static void publishRecord(BulkPlan *plan, BulkRecord *record) {
+    for (int i = 0; i < record->numberOfNames; i++) {
+        plan->cityIds[plan->keys[record->firstName + i]] = plan->cities[i]->id;
+        if (i < record->numberOfNames - 1) {
+            plan->roads[plan->slots[record->firstName + i]] = plan->newRoads[i];
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje odłożone polecenie dodania odcinka drogi.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze;
+ * @param[in] record         – wskaźnik na polecenie.
+ * @return Wartość @p true, jeśli udało się dodać odcinek drogi.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool loadRoad(Map *map, BulkLoad *bulk, BulkPlan *plan,
+                     BulkRecord *record) {
+    BulkName *name = &bulk->names[record->firstName];
+    bool correct = true;
+
+    if (plan->roads[plan->slots[record->firstName]] != NULL) {
+        correct = false;
+    }
+    else {
+        plan->cities[0] = findOrAddBulkCity(map, bulk, plan, record->firstName);
+        if (plan->cities[0] != NULL) {
+            plan->cities[1] = findOrAddBulkCity(map, bulk, plan,
+                                                record->firstName + 1);
+        }
+
+        if ((plan->cities[0] == NULL) || (plan->cities[1] == NULL)) {
+            correct = false;
+        }
+        else {
+            plan->newRoads[0] = newRoad(map, plan->cities[0], plan->cities[1],
+                                        name->length, name->year);
+            if (plan->newRoads[0] == NULL) {
+                correct = false;
+            }
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Sprawdza, czy odłożone polecenie utworzenia drogi krajowej nie
+ * przechodzi dwa razy przez to samo miasto ani nie jest sprzeczne
+ * z istniejącymi odcinkami dróg.
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze;
+ * @param[in] record         – wskaźnik na polecenie;
+ * @param[in] number         – numer polecenia.
+ * @return Wartość @p true, jeśli można utworzyć drogę krajową.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool canBulkRouteBeMade(BulkLoad *bulk, BulkPlan *plan,
+                               BulkRecord *record, int number) {
+    BulkName *name;
+    Road *road;
+    int key, i = 0;
+    bool correct = true;
+
+    while ((i < record->numberOfNames) && correct) {
+        key = plan->keys[record->firstName + i];
+        if (plan->seen[key] == number) {
+            correct = false;
+        }
+        plan->seen[key] = number;
+
+        if (i < record->numberOfNames - 1) {
+            name = &bulk->names[record->firstName + i];
+            road = plan->roads[plan->slots[record->firstName + i]];
+            if ((road != NULL) && ((road->length != name->length)
+                                   || (road->year > name->year))) {
+                correct = false;
+            }
+        }
+        i++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wykonuje odłożone polecenie utworzenia drogi krajowej.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] plan       – wskaźnik na tablice pomocnicze;
+ * @param[in] record         – wskaźnik na polecenie;
+ * @param[in] number         – numer polecenia.
+ * @return Wartość @p true, jeśli udało się utworzyć drogę krajową.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool loadRoute(Map *map, BulkLoad *bulk, BulkPlan *plan,
+                      BulkRecord *record, int number) {
+    BulkName *name;
+    Road *road;
+    int i = 0, last = record->numberOfNames - 1;
+    bool correct = true;
+
+    if ((findRoute(map, record->routeId) != NULL)
+        || !canBulkRouteBeMade(bulk, plan, record, number)) {
+        correct = false;
+    }
+
+    while ((i <= last) && correct) {
+        plan->cities[i] = findOrAddBulkCity(map, bulk, plan,
+                                            record->firstName + i);
+        if (plan->cities[i] == NULL) {
+            correct = false;
+        }
+        i++;
+    }
+
+    i = 0;
+    while ((i < last) && correct) {
+        name = &bulk->names[record->firstName + i];
+        road = plan->roads[plan->slots[record->firstName + i]];
+        if (road == NULL) {
+            road = newRoad(map, plan->cities[i], plan->cities[i + 1],
+                           name->length, name->year);
+            if (road == NULL) {
+                correct = false;
+            }
+        }
+        else if ((road->year < name->year)
+                 && !updateRoadYear(map, road, name->year)) {
+            correct = false;
+        }
+        plan->newRoads[i] = road;
+        i++;
+    }
+
+    if (correct && !addRouteAlongToMap(map, record->routeId, plan->cities,
+                                       plan->newRoads, last)) {
+        correct = false;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Przygotowuje wyszukiwanie przebiegu dla odłożonego polecenia newRoute.
+ * Pomija wyszukiwanie, jeśli już teraz wiadomo, że polecenie się nie powiedzie.
+ * Wcześniejsze polecenia newRoute nie dodają miast ani nie usuwają dróg
+ * krajowych, więc to się nie zmieni.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] record         – wskaźnik na polecenie;
+ * @param[out] search        – wskaźnik na wyszukiwanie.
+ */
+static void planSearch(Map *map, BulkLoad *bulk, BulkRecord *record,
+                       RouteSearch *search) {
+    if (record->numberOfNames == 2) {
+        planRouteSearch(map, record->routeId,
+                        bulkName(bulk, record->firstName),
+                        bulkName(bulk, record->firstName + 1), search);
+    }
+    else {
+        search->start = -1;
+        search->stop = -1;
+    }
+}
+
+/**
+ * @brief Wykonuje odłożone polecenia newRoute.
+ * Wyznacza równolegle przebiegi wszystkich dróg krajowych, a potem tworzy je
+ * po kolei. Polecenie, dla którego nie udało się zaalokować pamięci na
+ * ścieżkę, jest wykonywane zwykłą ścieżką.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego.
+ * @return Wartość @p true, jeśli polecenia zostały wykonane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci lub utworzyć
+ * wątku.
+ */
+static bool finishBulkSearches(Map *map, BulkLoad *bulk) {
+    RouteSearch *searches = (RouteSearch *)malloc(bulk->numberOfRecords
+                                                  * sizeof(RouteSearch));
+    RouteSearch *search;
+    BulkRecord *record;
+    const char *city1, *city2;
+    bool correct = true;
+
+    if (searches == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < bulk->numberOfRecords; i++) {
+        planSearch(map, bulk, &bulk->records[i], &searches[i]);
+    }
+    correct = searchRoutes(map, searches, bulk->numberOfRecords);
+
+    for (int i = 0; (i < bulk->numberOfRecords) && correct; i++) {
+        record = &bulk->records[i];
+        search = &searches[i];
+        if (record->numberOfNames == 0) {
+            record->failed = true;
+        }
+        else {
+            city1 = bulkName(bulk, record->firstName);
+            city2 = bulkName(bulk, record->firstName + 1);
+            record->failed = !createSearchedRoute(map, record->routeId, city1,
+                                                  city2, search);
+        }
+    }
+
+    freeRouteSearches(searches, bulk->numberOfRecords);
+    free(searches);
+
+    return correct;
+}
+
+bool finishBulkLoad(Map *map, BulkLoad *bulk) {
+    BulkPlan plan;
+    BulkRecord *record;
+    int savepoint;
+    bool correct = true;
+
+    if (bulk->records[0].search) {
+        return finishBulkSearches(map, bulk);
+    }
+    else if (!newBulkPlan(&plan, bulk)) {
+        return false;
+    }
+    else if (!numberNames(map, bulk, &plan)
+             || !numberEdges(map, bulk, &plan)) {
+        correct = false;
+    }
+
+    for (int i = 0; (i < bulk->numberOfRecords) && correct; i++) {
+        record = &bulk->records[i];
+        if (record->numberOfNames == 0) {
+            record->failed = true;
+        }
+        else {
+            savepoint = startChanges(map);
+            if (record->routeId == 0) {
+                record->failed = !loadRoad(map, bulk, &plan, record);
+            }
+            else {
+                record->failed = !loadRoute(map, bulk, &plan, record, i);
+            }
+            finishChanges(map, savepoint, !record->failed);
+            if (!record->failed) {
+                publishRecord(&plan, record);
+            }
+        }
+    }
+
+    freeBulkPlan(&plan);
+
+    return correct;
+}
@@ -0,0 +1,162 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje wczytywania mapy w trybie zbiorczym.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __BULK_LOAD_H__
+#define __BULK_LOAD_H__
+
+#include "structures-functions.h"
+
+/**
+ * Struktura przechowująca polecenie odłożone w trybie zbiorczym.
+ */
+typedef struct BulkRecord BulkRecord;
+
+/**
+ * Struktura przechowująca nazwę miasta odłożonego polecenia.
+ */
+typedef struct BulkName BulkName;
+
+/**
+ * Struktura przechowująca polecenia odłożone w trybie zbiorczym.
+ */
+typedef struct BulkLoad BulkLoad;
+
+/**
+ * @brief Struktura przechowująca polecenie odłożone w trybie zbiorczym.
+ * Polecenie dodania odcinka drogi ma numer drogi krajowej 0 i dwa miasta,
+ * polecenie newRoute ma dwa miasta, a błędne polecenie nie ma miast.
+ */
+struct BulkRecord {
+    int lineNumber;    ///< numer linii polecenia
+    unsigned routeId;  ///< numer drogi krajowej lub 0
+    int firstName;     ///< indeks pierwszej nazwy miasta polecenia
+    int numberOfNames; ///< liczba miast polecenia
+    bool search;       ///< informacja o tym, czy to polecenie newRoute
+    bool failed;       ///< informacja o tym, czy polecenie się nie powiodło
+};
+
+/**
+ * @brief Struktura przechowująca nazwę miasta odłożonego polecenia wraz
+ * z odcinkiem drogi prowadzącym do następnego miasta polecenia.
+ */
+struct BulkName {
+    size_t offset;   ///< położenie nazwy w buforze nazw
+    unsigned length; ///< długość odcinka drogi do następnego miasta
+    int year;        ///< rok budowy lub ostatniego remontu odcinka drogi
+};
+
+/**
+ * @brief Struktura przechowująca polecenia odłożone w trybie zbiorczym.
+ * W trybie zbiorczym polecenia dodania odcinka drogi i utworzenia drogi
+ * krajowej są tylko zapisywane w płaskich tablicach, a wykonywane dopiero
+ * wszystkie naraz. W trybie równoległego tworzenia dróg krajowych tak samo
+ * odkładane są kolejne polecenia newRoute. Odłożone polecenia są zawsze
+ * tego samego rodzaju. Struktura zawiera:
+ * informacje o tym, czy tryb zbiorczy i tryb równoległego tworzenia dróg
+ * krajowych są włączone;
+ * tablicę poleceń wraz z ich liczbą i rozmiarem tablicy;
+ * tablicę nazw miast wraz z ich liczbą i rozmiarem tablicy;
+ * bufor z kopiami nazw miast wraz z zajętą częścią i rozmiarem bufora.
+ */
+struct BulkLoad {
+    bool active;          ///< informacja o włączeniu trybu zbiorczego
+    bool parallel;        ///< informacja o włączeniu trybu równoległego
+    BulkRecord *records;  ///< tablica poleceń
+    int numberOfRecords;  ///< liczba poleceń
+    int recordsSize;      ///< rozmiar tablicy poleceń
+    BulkName *names;      ///< tablica nazw miast
+    int numberOfNames;    ///< liczba nazw miast
+    int namesSize;        ///< rozmiar tablicy nazw miast
+    char *text;           ///< bufor z kopiami nazw miast
+    size_t textLength;    ///< zajęta część bufora
+    size_t textSize;      ///< rozmiar bufora
+};
+
+/**
+ * @brief Ustawia wartości początkowe struktury trybu zbiorczego.
+ * @param[out] bulk          – wskaźnik na strukturę trybu zbiorczego.
+ */
+void setBulkLoadValues(BulkLoad *bulk);
+
+/**
+ * @brief Zwalnia pamięć zajmowaną przez tablice struktury trybu zbiorczego.
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego.
+ */
+void freeBulkLoad(BulkLoad *bulk);
+
+/**
+ * @brief Odkłada polecenie w trybie zbiorczym.
+ * Kopiuje nazwy miast, więc podane napisy mogą zostać później zmienione.
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in] routeId        – numer drogi krajowej lub 0 dla polecenia
+ *                             dodania odcinka drogi;
+ * @param[in] numberOfNames  – liczba miast polecenia lub 0 dla błędnego
+ *                             polecenia;
+ * @param[in] names          – tablica poprawnych nazw miast;
+ * @param[in] lengths        – tablica długości kolejnych odcinków dróg;
+ * @param[in] years          – tablica lat budowy lub ostatniego remontu
+ *                             kolejnych odcinków dróg.
+ * @return Wartość @p true, jeśli udało się odłożyć polecenie.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool addBulkRecord(BulkLoad *bulk, int lineNumber, unsigned routeId,
+                   int numberOfNames, char *names[], unsigned lengths[],
+                   int years[]);
+
+/**
+ * @brief Odkłada polecenie newRoute.
+ * Kopiuje nazwy miast, więc podane napisy mogą zostać później zmienione.
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in] routeId        – numer drogi krajowej;
+ * @param[in] numberOfNames  – liczba miast polecenia, czyli 2, lub 0 dla
+ *                             błędnego polecenia;
+ * @param[in] names          – tablica nazw miast.
+ * @return Wartość @p true, jeśli udało się odłożyć polecenie.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool addBulkSearch(BulkLoad *bulk, int lineNumber, unsigned routeId,
+                   int numberOfNames, char *names[]);
+
+/**
+ * @brief Wykonuje polecenia odłożone w trybie zbiorczym.
+ * Polecenia dodania odcinka drogi i utworzenia drogi krajowej wykonuje tak:
+ * najpierw sortuje wszystkie nazwy miast i wszystkie pary miast połączonych
+ * odcinkami dróg, nadając im numery, i raz szuka ich w mapie. Następnie
+ * wykonuje polecenia po kolei, sprawdzając istnienie miast i odcinków dróg
+ * w tablicach indeksowanych tymi numerami, zamiast przeglądać listy odcinków
+ * dróg miast. Dla poleceń newRoute najpierw wyznacza równolegle przebiegi
+ * wszystkich dróg krajowych, a potem tworzy je po kolei. Polecenia newRoute
+ * nie zmieniają odcinków dróg, więc przebiegi wyznaczone przed utworzeniem
+ * wcześniejszych dróg krajowych pozostają aktualne i żadnego wyszukiwania
+ * nie trzeba powtarzać. Każde polecenie daje taki sam wynik, jak wykonane
+ * osobno, a to, czy się nie powiodło, jest zapisywane w strukturze
+ * polecenia. Jeśli nie udało się zaalokować pamięci na tablice pomocnicze
+ * lub utworzyć wątku, nie wykonuje żadnego polecenia.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego.
+ * @return Wartość @p true, jeśli polecenia zostały wykonane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool finishBulkLoad(Map *map, BulkLoad *bulk);
+
+/**
+ * @brief Daje w wyniku nazwę miasta odłożonego polecenia.
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] index          – indeks nazwy miasta.
+ * @return Wskaźnik na nazwę miasta.
+ */
+char* bulkName(BulkLoad *bulk, int index);
+
+/**
+ * @brief Usuwa odłożone polecenia, zachowując zaalokowane tablice.
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego.
+ */
+void clearBulkLoad(BulkLoad *bulk);
+
+#endif /* __BULK_LOAD_H__ */
@@ -0,0 +1,460 @@
+/** @file
+ * Plik zawierający funkcje podziału poleceń na składowe spójności mapy.
+ *
+ * Podział jest strukturą zbiorów rozłącznych, której węzłami są numery dróg
+ * krajowych i, po nich, identyfikatory miast. Polecenia okna są łączone
+ * w osobnej, małej strukturze, której węzłami są korzenie podziału oraz nazwy
+ * miast, które jeszcze nie istnieją.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "components.h"
+#include "help-functions.h"
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_WINDOW_NAMES 64 ///< najmniejszy rozmiar tablicy nazw okna
+
+/**
+ * Struktura przechowująca nazwę miasta, które nie istniało na początku okna.
+ */
+typedef struct WindowName WindowName;
+
+/**
+ * @brief Struktura przechowująca nazwę miasta, które nie istniało na początku
+ * okna.
+ * Struktura zawiera:
+ * wskaźnik na nazwę, jej długość i skrót;
+ * numer okna, w którym nazwę dodano, i jej węzeł okna.
+ */
+struct WindowName {
+    const char *name; ///< wskaźnik na nazwę miasta
+    size_t length;    ///< długość nazwy miasta
+    unsigned hash;    ///< skrót nazwy miasta
+    unsigned window;  ///< numer okna, w którym dodano nazwę, lub 0
+    int node;         ///< numer węzła okna
+};
+
+/**
+ * @brief Struktura przechowująca podział miast i dróg krajowych na składowe.
+ * Struktura zawiera:
+ * rodziców węzłów podziału wraz z ich liczbą;
+ * numer bieżącego okna oraz, dla każdego węzła podziału, numer okna,
+ * w którym dostał węzeł okna, i ten węzeł;
+ * rodziców węzłów okna i numery składowych ich korzeni;
+ * tablicę mieszającą nazw miast okna;
+ * informację o tym, czy podział jest poprawny.
+ */
+struct Components {
+    int size;               ///< liczba węzłów podziału
+    int *parent;            ///< tablica rodziców węzłów podziału
+    unsigned window;        ///< numer bieżącego okna
+    unsigned *windowStamp;  ///< tablica numerów okien węzłów podziału
+    int *windowNode;        ///< tablica węzłów okna węzłów podziału
+    int numberOfNodes;      ///< liczba węzłów okna
+    int sizeOfNodes;        ///< rozmiar tablic węzłów okna
+    int *nodeParent;        ///< tablica rodziców węzłów okna
+    int *nodeComponent;     ///< tablica numerów składowych korzeni lub -1
+    int numberOfComponents; ///< liczba ponumerowanych składowych okna
+    int numberOfNames;      ///< liczba nazw miast okna
+    int sizeOfNames;        ///< rozmiar tablicy mieszającej nazw
+    WindowName *names;      ///< tablica mieszająca nazw miast okna
+    bool correct;           ///< informacja o tym, czy podział jest poprawny
+};
+
+/**
+ * @brief Znajduje korzeń zbioru węzła, skracając po drodze ścieżkę.
+ * @param[in,out] parent     – tablica rodziców węzłów;
+ * @param[in] node           – numer węzła.
+ * @return Numer korzenia.
+ */
+static int findNode(int parent[], int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+
+    return node;
+}
+
+/**
+ * @brief Łączy zbiory dwóch węzłów.
+ * Korzeniem połączonego zbioru zostaje korzeń o mniejszym numerze.
+ * @param[in,out] parent     – tablica rodziców węzłów;
+ * @param[in] a              – numer węzła;
+ * @param[in] b              – numer węzła.
+ */
+static void uniteNodes(int parent[], int a, int b) {
+    a = findNode(parent, a);
+    b = findNode(parent, b);
+
+    if (a < b) {
+        parent[b] = a;
+    }
+    else {
+        parent[a] = b;
+    }
+}
+
+/**
+ * @brief Zapewnia w podziale co najmniej podaną liczbę węzłów.
+ * Nowe węzły są w osobnych zbiorach. Tablice, które udało się powiększyć,
+ * pozostają w strukturze nawet wtedy, gdy powiększenie innej się nie
+ * powiodło.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] size           – liczba węzłów.
+ * @return Wartość @p true, jeśli podział ma tyle węzłów.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveNodes(Components *components, int size) {
+    int newSize = enlargeSize(components->size);
+    int *parent, *windowNode;
+    unsigned *windowStamp;
+    bool correct = true;
+
+    if (size > components->size) {
+        if (newSize < size) {
+            newSize = size;
+        }
+
+        parent = (int *)realloc(components->parent, newSize * sizeof(int));
+        if (parent != NULL) {
+            components->parent = parent;
+        }
+        windowStamp = (unsigned *)realloc(components->windowStamp,
+                                          newSize * sizeof(unsigned));
+        if (windowStamp != NULL) {
+            components->windowStamp = windowStamp;
+        }
+        windowNode = (int *)realloc(components->windowNode,
+                                    newSize * sizeof(int));
+        if (windowNode != NULL) {
+            components->windowNode = windowNode;
+        }
+
+        if ((parent == NULL) || (windowStamp == NULL)
+            || (windowNode == NULL)) {
+            correct = false;
+        }
+        else {
+            for (int i = components->size; i < newSize; i++) {
+                parent[i] = i;
+                windowStamp[i] = 0;
+            }
+            components->size = newSize;
+        }
+    }
+
+    return correct;
+}
+
+Components* newComponents(void) {
+    Components *components = (Components *)calloc(1, sizeof(Components));
+
+    if ((components != NULL) && !reserveNodes(components, ROUTE_SLOTS)) {
+        deleteComponents(components);
+        components = NULL;
+    }
+    else if (components != NULL) {
+        components->correct = true;
+    }
+
+    return components;
+}
+
+void deleteComponents(Components *components) {
+    if (components != NULL) {
+        free(components->parent);
+        free(components->windowStamp);
+        free(components->windowNode);
+        free(components->nodeParent);
+        free(components->nodeComponent);
+        free(components->names);
+        free(components);
+    }
+}
+
+bool rebuildComponents(Components *components, Map *map) {
+    ListOfRoads *road = map->firstRoad;
+    ListOfRoutes *route = map->firstRoute;
+    int *parent;
+
+    components->correct = reserveNodes(components,
+                                       ROUTE_SLOTS + map->numberOfCities);
+
+    if (components->correct) {
+        parent = components->parent;
+        for (int i = 0; i < components->size; i++) {
+            parent[i] = i;
+        }
+        while (road != NULL) {
+            uniteNodes(parent, ROUTE_SLOTS + road->road->cityA,
+                       ROUTE_SLOTS + road->road->cityB);
+            road = road->next;
+        }
+        while (route != NULL) {
+            uniteNodes(parent, route->route->id,
+                       ROUTE_SLOTS
+                       + route->route->cities[route->route->first]->id);
+            route = route->next;
+        }
+    }
+
+    return components->correct;
+}
+
+bool joinComponents(Components *components, Map *map, const char *names[],
+                    int numberOfNames, unsigned routeId) {
+    City *city;
+    int node = -1;
+
+    if (components->correct
+        && !reserveNodes(components, ROUTE_SLOTS + map->numberOfCities)) {
+        components->correct = false;
+    }
+
+    if (components->correct) {
+        if (isRouteIdCorrect(routeId)) {
+            node = routeId;
+        }
+        for (int i = 0; i < numberOfNames; i++) {
+            city = findCity(map, names[i]);
+            if ((city != NULL) && (node < 0)) {
+                node = ROUTE_SLOTS + city->id;
+            }
+            else if (city != NULL) {
+                uniteNodes(components->parent, node, ROUTE_SLOTS + city->id);
+            }
+        }
+    }
+
+    return components->correct;
+}
+
+bool startWindow(Components *components, Map *map) {
+    components->window++;
+    if (components->window == 0) {
+        memset(components->windowStamp, 0,
+               components->size * sizeof(unsigned));
+        for (int i = 0; i < components->sizeOfNames; i++) {
+            components->names[i].window = 0;
+        }
+        components->window = 1;
+    }
+
+    components->numberOfNodes = 0;
+    components->numberOfComponents = 0;
+    components->numberOfNames = 0;
+
+    return components->correct
+           && reserveNodes(components, ROUTE_SLOTS + map->numberOfCities);
+}
+
+/**
+ * @brief Tworzy nowy węzeł okna w osobnym zbiorze.
+ * @param[in,out] components – wskaźnik na podział na składowe.
+ * @return Numer węzła lub -1, gdy nie udało się zaalokować pamięci.
+ */
+static int newWindowNode(Components *components) {
+    int size = enlargeSize(components->sizeOfNodes);
+    int node = components->numberOfNodes;
+    int *nodeParent, *nodeComponent;
+
+    if (node == components->sizeOfNodes) {
+        nodeParent = (int *)realloc(components->nodeParent,
+                                    size * sizeof(int));
+        if (nodeParent != NULL) {
+            components->nodeParent = nodeParent;
+        }
+        nodeComponent = (int *)realloc(components->nodeComponent,
+                                       size * sizeof(int));
+        if (nodeComponent != NULL) {
+            components->nodeComponent = nodeComponent;
+        }
+
+        if ((nodeParent == NULL) || (nodeComponent == NULL)) {
+            node = -1;
+        }
+        else {
+            components->sizeOfNodes = size;
+        }
+    }
+
+    if (node >= 0) {
+        components->nodeParent[node] = node;
+        components->nodeComponent[node] = -1;
+        components->numberOfNodes++;
+    }
+
+    return node;
+}
+
+/**
+ * @brief Daje w wyniku węzeł okna odpowiadający zbiorowi węzła podziału.
+ * Tworzy go przy pierwszym zapytaniu o zbiór w bieżącym oknie.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] node           – numer węzła podziału.
+ * @return Numer węzła okna lub -1, gdy nie udało się zaalokować pamięci.
+ */
+static int rootWindowNode(Components *components, int node) {
+    int root = findNode(components->parent, node);
+
+    if (components->windowStamp[root] != components->window) {
+        node = newWindowNode(components);
+        if (node >= 0) {
+            components->windowStamp[root] = components->window;
+            components->windowNode[root] = node;
+        }
+    }
+    else {
+        node = components->windowNode[root];
+    }
+
+    return node;
+}
+
+/**
+ * @brief Zapewnia w tablicy mieszającej miejsce na kolejną nazwę.
+ * Tablica jest zapełniona co najwyżej w połowie.
+ * @param[in,out] components – wskaźnik na podział na składowe.
+ * @return Wartość @p true, jeśli w tablicy jest miejsce.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveWindowNames(Components *components) {
+    int size = 2 * components->sizeOfNames;
+    WindowName *names, *old = components->names;
+    int mask = size - 1, j;
+    bool correct = true;
+
+    if (2 * (components->numberOfNames + 1) > components->sizeOfNames) {
+        if (size < MIN_WINDOW_NAMES) {
+            size = MIN_WINDOW_NAMES;
+            mask = size - 1;
+        }
+
+        names = (WindowName *)calloc(size, sizeof(WindowName));
+        if (names == NULL) {
+            correct = false;
+        }
+        else {
+            for (int i = 0; i < components->sizeOfNames; i++) {
+                if (old[i].window == components->window) {
+                    j = old[i].hash & mask;
+                    while (names[j].window == components->window) {
+                        j = (j + 1) & mask;
+                    }
+                    names[j] = old[i];
+                }
+            }
+            free(old);
+            components->names = names;
+            components->sizeOfNames = size;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Daje w wyniku węzeł okna odpowiadający nazwie miasta.
+ * Tworzy go przy pierwszym zapytaniu o nazwę w bieżącym oknie.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] name           – wskaźnik na nazwę miasta, która nie zmienia
+ *                             się do końca okna.
+ * @return Numer węzła okna lub -1, gdy nie udało się zaalokować pamięci.
+ */
+static int nameWindowNode(Components *components, const char *name) {
+    WindowName *entry = NULL;
+    size_t length;
+    unsigned hash = hashCityName(name, &length);
+    int mask, i, node = -1;
+
+    if (reserveWindowNames(components)) {
+        mask = components->sizeOfNames - 1;
+        i = hash & mask;
+        while ((components->names[i].window == components->window)
+               && (entry == NULL)) {
+            if ((components->names[i].hash == hash)
+                && (components->names[i].length == length)
+                && (memcmp(components->names[i].name, name, length) == 0)) {
+                entry = &components->names[i];
+            }
+            else {
+                i = (i + 1) & mask;
+            }
+        }
+
+        if (entry != NULL) {
+            node = entry->node;
+        }
+        else {
+            node = newWindowNode(components);
+            if (node >= 0) {
+                entry = &components->names[i];
+                entry->name = name;
+                entry->length = length;
+                entry->hash = hash;
+                entry->window = components->window;
+                entry->node = node;
+                components->numberOfNames++;
+            }
+        }
+    }
+
+    return node;
+}
+
+int addWindowCommand(Components *components, Map *map, const char *names[],
+                     int numberOfNames, unsigned routeId) {
+    City *city;
+    int node = -1, entity;
+    bool correct = true;
+
+    if (isRouteIdCorrect(routeId)) {
+        node = rootWindowNode(components, routeId);
+        correct = (node >= 0);
+    }
+    for (int i = 0; (i < numberOfNames) && correct; i++) {
+        city = findCity(map, names[i]);
+        if (city != NULL) {
+            entity = rootWindowNode(components, ROUTE_SLOTS + city->id);
+        }
+        else {
+            entity = nameWindowNode(components, names[i]);
+        }
+
+        if (entity < 0) {
+            correct = false;
+        }
+        else if (node < 0) {
+            node = entity;
+        }
+        else {
+            uniteNodes(components->nodeParent, node, entity);
+        }
+    }
+
+    if (!correct) {
+        node = -1;
+    }
+    else if (node < 0) {
+        node = newWindowNode(components);
+    }
+
+    return node;
+}
+
+int windowComponent(Components *components, int node) {
+    int root = findNode(components->nodeParent, node);
+
+    if (components->nodeComponent[root] < 0) {
+        components->nodeComponent[root] = components->numberOfComponents;
+        components->numberOfComponents++;
+    }
+
+    return components->nodeComponent[root];
+}
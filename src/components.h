@@ -0,0 +1,103 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje podziału poleceń na składowe
+ * spójności mapy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __COMPONENTS_H__
+#define __COMPONENTS_H__
+
+#include "structures-functions.h"
+
+/**
+ * Struktura przechowująca podział miast i dróg krajowych na składowe.
+ */
+typedef struct Components Components;
+
+/**
+ * @brief Tworzy nowy podział na składowe.
+ * Każda droga krajowa jest w osobnej składowej.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+Components* newComponents(void);
+
+/**
+ * @brief Usuwa podział na składowe.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] components     – wskaźnik na usuwaną strukturę.
+ */
+void deleteComponents(Components *components);
+
+/**
+ * @brief Wyznacza podział na składowe od nowa na podstawie mapy.
+ * Miasta połączone odcinkiem drogi oraz droga krajowa i jej miasta trafiają
+ * do tej samej składowej.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] map            – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli podział jest poprawny.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool rebuildComponents(Components *components, Map *map);
+
+/**
+ * @brief Łączy składowe miast i drogi krajowej zmienionych przez polecenie.
+ * Wywoływana po wykonaniu polecenia, które mogło zmienić mapę. Pomija
+ * nieistniejące miasta i niepoprawny numer drogi krajowej. Dzięki temu każda
+ * składowa mapy jest zawarta w jednej składowej podziału. Składowe nigdy nie
+ * są dzielone, nawet gdy polecenie się nie powiodło lub usunęło odcinek
+ * drogi. Jeśli nie udało się zaalokować pamięci, podział przestaje być
+ * poprawny aż do wyznaczenia go od nowa.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] names          – tablica nazw miast;
+ * @param[in] numberOfNames  – liczba nazw miast;
+ * @param[in] routeId        – numer drogi krajowej lub 0.
+ * @return Wartość @p true, jeśli podział jest poprawny.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+bool joinComponents(Components *components, Map *map, const char *names[],
+                    int numberOfNames, unsigned routeId);
+
+/**
+ * @brief Rozpoczyna przydzielanie składowych poleceniom okna.
+ * Polecenia okna dostają składowe wyznaczone dla mapy z chwili wywołania,
+ * a miasta, które jeszcze nie istnieją, są rozpoznawane po nazwach.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] map            – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli można przydzielać składowe.
+ * Wartość @p false, gdy podział nie jest poprawny lub nie udało się
+ * zaalokować pamięci.
+ */
+bool startWindow(Components *components, Map *map);
+
+/**
+ * @brief Dodaje polecenie okna.
+ * Łączy w oknie składowe wszystkich podanych miast i drogi krajowej,
+ * a polecenie bez miast i poprawnego numeru drogi krajowej dostaje osobną
+ * składową.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] names          – tablica nazw miast;
+ * @param[in] numberOfNames  – liczba nazw miast;
+ * @param[in] routeId        – numer drogi krajowej lub 0.
+ * @return Numer węzła polecenia lub -1, gdy nie udało się zaalokować
+ * pamięci.
+ */
+int addWindowCommand(Components *components, Map *map, const char *names[],
+                     int numberOfNames, unsigned routeId);
+
+/**
+ * @brief Daje w wyniku składową polecenia okna.
+ * Wywoływana po dodaniu wszystkich poleceń okna. Polecenia mają tę samą
+ * składową wtedy i tylko wtedy, gdy są połączone w oknie, a składowe są
+ * numerowane od zera w kolejności pierwszych zapytań.
+ * @param[in,out] components – wskaźnik na podział na składowe;
+ * @param[in] node           – numer węzła polecenia.
+ * @return Numer składowej polecenia.
+ */
+int windowComponent(Components *components, int node);
+
+#endif /* __COMPONENTS_H__ */
@@ -6,9 +6,21 @@
  */
 
 #include "dijkstra.h"
+#include "structures-functions.h"
 
 #include <stdlib.h>
 #include <limits.h>
+#include <pthread.h>
+
+/**
+ * Klucz tablic pomocniczych wyszukiwań wykonywanych przez wątek.
+ */
+static pthread_key_t workspaceKey;
+
+/**
+ * Informacja o tym, czy klucz tablic pomocniczych wątku został utworzony.
+ */
+static pthread_once_t workspaceKeyOnce = PTHREAD_ONCE_INIT;
 
 /**
  * @brief Zwalnia pamięć zaalokowaną na kopiec.
@@ -22,17 +34,21 @@ static void removeBinaryHeap(BinaryHeap *heap) {
 
 /** 
  * @brief Tworzy binarny kopiec.
- * @param[in] numberOfCities – liczba miast w mapie.
+ * Klucze są początkowo odległościami wierzchołków od źródła.
+ * @param[in] numberOfCities – liczba miast w mapie;
+ * @param[in] key            – tablica odległości wierzchołków od źródła.
  * @return Wskaźnik na utworzony kopiec lub NULL, gdy nie udało się
  * zaalokować pamięci.
  */
-static BinaryHeap* newBinaryHeap(int numberOfCities) {
+static BinaryHeap* newBinaryHeap(int numberOfCities, uint64_t key[]) {
     BinaryHeap *heap = (BinaryHeap *)malloc(sizeof(BinaryHeap));
     
     if (heap != NULL) {
         heap->size = 0;
+        heap->key = key;
+        heap->distance = key;
         heap->verticesPositions = (int *)malloc(numberOfCities * sizeof(int));
-        heap->vertices = (Vertex **)malloc(numberOfCities * sizeof(Vertex *));
+        heap->vertices = (int *)malloc(numberOfCities * sizeof(int));
         if ((heap->verticesPositions == NULL) || (heap->vertices == NULL)) {
             removeBinaryHeap(heap);
             heap = NULL;
@@ -43,20 +59,40 @@ static BinaryHeap* newBinaryHeap(int numberOfCities) {
 }
 
 /**
- * @brief Sprawdza, który z danych wierzchołków jest w mniejeszej odległości
- * od źródła.
+ * @brief Sprawdza, czy wierzchołek powinien opuścić kopiec przed innym.
+ * Z wierzchołków o równych kluczach pierwszy jest ten, który jest bliżej
+ * źródła. Przy wyszukiwaniu kierowanym oszacowaniami odległości każdy
+ * poprzednik wierzchołka na najkrótszej ścieżce ma klucz nie większy niż
+ * wierzchołek i jest bliżej źródła, bo odcinki dróg mają dodatnie długości,
+ * więc jest przetwarzany wcześniej. Dzięki temu wybór między ścieżkami
+ * o równej długości uwzględnia wszystkie te ścieżki, tak jak bez oszacowań.
  * @param[in] heap           – wskaźnik na strukturę kopca;
- * @param[in] min            – identyfikator wierzchołka;
- * @param[in] son            – identyfikator wierzchołka.
- * @return Identyfikator wierzchołka o mniejszej odległości od źródła.
+ * @param[in] v1             – identyfikator wierzchołka;
+ * @param[in] v2             – identyfikator wierzchołka.
+ * @return Wartość @p true, jeśli wierzchołek @p v1 powinien opuścić kopiec
+ * przed wierzchołkiem @p v2.
+ * Wartość @p false, w przeciwnym przypadku.
  */
-static int minimalVertexIndex(BinaryHeap *heap, int min, int son) {
-    Vertex *minVertex, *helpVertex;
+static inline bool isBefore(BinaryHeap *heap, int v1, int v2) {
+    if (heap->key[v1] != heap->key[v2]) {
+        return heap->key[v1] < heap->key[v2];
+    }
+    else {
+        return heap->distance[v1] < heap->distance[v2];
+    }
+}
 
+/**
+ * @brief Sprawdza, który z danych wierzchołków powinien wcześniej opuścić
+ * kopiec.
+ * @param[in] heap           – wskaźnik na strukturę kopca;
+ * @param[in] min            – pozycja wierzchołka w kopcu;
+ * @param[in] son            – pozycja wierzchołka w kopcu.
+ * @return Pozycja wierzchołka, który powinien wcześniej opuścić kopiec.
+ */
+static int minimalVertexIndex(BinaryHeap *heap, int min, int son) {
     if (son < heap->size) {
-        minVertex = heap->vertices[min];
-        helpVertex = heap->vertices[son];
-        if (helpVertex->distanceFromSource < minVertex->distanceFromSource) {
+        if (isBefore(heap, heap->vertices[son], heap->vertices[min])) {
             min = son;
         }
     }
@@ -65,12 +101,12 @@ static int minimalVertexIndex(BinaryHeap *heap, int min, int son) {
 }
 
 /**
- * @brief Zamienia ze sobą wskaźniki na dwa wierzchołki.
- * @param[in] v1             – wskaźnik na wskaźnik na strukturę wierzchołka;
- * @param[in] v2             – wskaźnik na wskaźnik na strukturę wierzchołka.
+ * @brief Zamienia ze sobą identyfikatory dwóch wierzchołków.
+ * @param[in] v1             – wskaźnik na identyfikator wierzchołka;
+ * @param[in] v2             – wskaźnik na identyfikator wierzchołka.
  */
-static void swapVertices(Vertex **v1, Vertex **v2) {
-    Vertex *temp = *v1;
+static void swapVertices(int *v1, int *v2) {
+    int temp = *v1;
     *v1 = *v2;
     *v2 = temp;
 }
@@ -78,15 +114,15 @@ static void swapVertices(Vertex **v1, Vertex **v2) {
 /**
  * @brief Zamienia ze sobą pozycję dwóch wierzchołków.
  * @param[in,out] heap       – wskaźnik na strukturę kopca;
- * @param[in] v1             – wskaźnik na strukturę wierzchołka;
- * @param[in] v2             – wskaźnik na strukturę wierzchołka;
+ * @param[in] v1             – identyfikator wierzchołka;
+ * @param[in] v2             – identyfikator wierzchołka;
  * @param[in] position1      – pozycja pierwszego wierzchołka;
  * @param[in] position2      – pozycja drugiego wierzchołka.
  */
-static void swapVerticesPositions(BinaryHeap *heap, Vertex *v1, Vertex *v2,
+static void swapVerticesPositions(BinaryHeap *heap, int v1, int v2,
                                   int position1, int position2) {
-    heap->verticesPositions[v1->id] = position2;
-    heap->verticesPositions[v2->id] = position1;
+    heap->verticesPositions[v1] = position2;
+    heap->verticesPositions[v2] = position1;
 }
 
 /**
@@ -128,11 +164,11 @@ static bool isEmpty(BinaryHeap *heap) {
 /** 
  * @brief Daje w wyniku wierzchołek o najmiejszej odległośći od źródła.
  * @param[in,out] heap       – wskaźnik na strukturę kopca.
- * @return Wskaźnik na wierzchołek o najmniejszej odległości od źródła lub
- * NULL, gdy kopiec jest pusty.
+ * @return Identyfikator wierzchołka o najmniejszej odległości od źródła lub
+ * -1, gdy kopiec jest pusty.
  */
-static Vertex* extractMin(BinaryHeap *heap) {
-    Vertex *min = NULL, *last;
+static int extractMin(BinaryHeap *heap) {
+    int min = -1, last;
     int firstIndex = 0, lastIndex = heap->size - 1;
 
     if (!isEmpty(heap)) {
@@ -141,6 +177,7 @@ static Vertex* extractMin(BinaryHeap *heap) {
         heap->vertices[firstIndex] = last;
         swapVerticesPositions(heap, min, last, firstIndex, lastIndex);
         heap->size -= 1;
+        heap->verticesPositions[min] = -1;
         makeMinHeap(heap, firstIndex);
     }
 
@@ -160,19 +197,19 @@ static int parentIndex(int sonIndex) {
  * @brief Wykonuje operację zmniejszenia klucza w kopcu.
  * @param[in,out] heap       – wskaźnik na strukturę kopca;
  * @param[in] id             – identyfikator wierzchołka;
- * @param[in] distance       – odległość wierzchołka od źródła.
+ * @param[in] key            – nowy klucz wierzchołka.
  */
-static void decreasePriority(BinaryHeap *heap, int id, int distance) {
-    Vertex *son, *father;
+static void decreasePriority(BinaryHeap *heap, int id, uint64_t key) {
+    int son, father;
     int sonIndex = heap->verticesPositions[id];
     int fatherIndex = parentIndex(sonIndex);
     bool end = false;
 
-    heap->vertices[sonIndex]->distanceFromSource = distance;
+    heap->key[id] = key;
     while ((fatherIndex >= 0) && !end) {
         son = heap->vertices[sonIndex];
         father = heap->vertices[fatherIndex];
-        if (son->distanceFromSource < father->distanceFromSource) {
+        if (isBefore(heap, son, father)) {
             swapVerticesPositions(heap, son, father, sonIndex, fatherIndex);
             swapVertices(&(heap->vertices[sonIndex]),
                          &(heap->vertices[fatherIndex]));
@@ -186,14 +223,50 @@ static void decreasePriority(BinaryHeap *heap, int id, int distance) {
 }
 
 /**
- * @brief Sprawdza, czy podany wierzchołek jest w kopcu.
+ * @brief Sprawdza, czy podany wierzchołek osiągnięty w bieżącym wyszukiwaniu
+ * jest w kopcu.
  * @param[in] heap           – wskaźnik na strukturę kopca;
- * @param[in] vertex         – wskaźnik na strukturę wierzchołka.
+ * @param[in] id             – identyfikator wierzchołka.
  * @return Wartość @p true, jeśli dany wierzchołek jest w kopcu.
+ * Wartość @p false, jeśli został już z niego usunięty.
+ */
+static bool inHeap(BinaryHeap *heap, int id) {
+    if (heap->verticesPositions[id] >= 0) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Rozpoczyna nowe wyszukiwanie.
+ * Zmienia numer bieżącego wyszukiwania, przez co żaden wierzchołek nie jest
+ * osiągnięty. Dopiero gdy licznik wyszukiwań się przepełni, zeruje numery
+ * wyszukiwań wszystkich wierzchołków.
+ * @param[in,out] vertices   – wskaźnik na tablice danych wierzchołków;
+ * @param[in] numberOfCities – liczba miast w mapie.
+ */
+static void newSearch(Vertices *vertices, int numberOfCities) {
+    vertices->search++;
+
+    if (vertices->search == 0) {
+        for (int i = 0; i < numberOfCities; i++) {
+            vertices->reached[i] = 0;
+        }
+        vertices->search = 1;
+    }
+}
+
+/**
+ * @brief Sprawdza, czy wierzchołek został osiągnięty w bieżącym wyszukiwaniu.
+ * @param[in] vertices       – wskaźnik na tablice danych wierzchołków;
+ * @param[in] id             – identyfikator wierzchołka.
+ * @return Wartość @p true, jeśli wierzchołek został osiągnięty.
  * Wartość @p false, w przeciwnym przypadku.
  */
-static bool inHeap(BinaryHeap *heap, Vertex *vertex) {
-    if (heap->verticesPositions[vertex->id] < heap->size) {
+static bool isReached(Vertices *vertices, int id) {
+    if (vertices->reached[id] == vertices->search) {
         return true;
     }
     else {
@@ -202,121 +275,455 @@ static bool inHeap(BinaryHeap *heap, Vertex *vertex) {
 }
 
 /**
- * @brief Znajduje wierzchołek o podanym identyfikatorze i ustawia jego
- * odległość od źródła.
- * @param[in] map            – wskaźnik na strukturę mapy;
+ * @brief Oznacza wierzchołek jako osiągnięty w bieżącym wyszukiwaniu.
+ * Ustawia początkowe wartości wierzchołka i dodaje go na koniec kopca
+ * z nieskończonym kluczem.
+ * @param[in,out] heap       – wskaźnik na strukturę kopca;
+ * @param[in,out] vertices   – wskaźnik na tablice danych wierzchołków;
  * @param[in] id             – identyfikator wierzchołka;
- * @param[in] distance       – odległość wierzchołka od źródła.
- * @return Wskaźnik na znaleziony wierzchołek.
+ * @param[in,out] prev       – tablica odcinków dróg prowadzących do poprzedników
+ *                             miast.
  */
-static Vertex* findVertex(Map *map, int id, int distance) {
-    Vertex *vertex = map->cities[id]->vertex;
+static void reachVertex(BinaryHeap *heap, Vertices *vertices, int id,
+                        Road *prev[]) {
+    vertices->reached[id] = vertices->search;
+    vertices->distance[id] = INFINITE_DISTANCE;
+    vertices->oldestYear[id] = INT_MAX;
+    vertices->error[id] = false;
+    prev[id] = NULL;
+    heap->key[id] = INFINITE_DISTANCE;
+    heap->vertices[heap->size] = id;
+    heap->verticesPositions[id] = heap->size;
+    heap->size++;
+}
 
-    vertex->distanceFromSource = distance;
+/**
+ * @brief Oblicza klucz wierzchołka w kopcu.
+ * @param[in] heuristic      – tablica dolnych oszacowań odległości wierzchołków
+ *                             od miasta końcowego lub NULL;
+ * @param[in] id             – identyfikator wierzchołka;
+ * @param[in] distance       – odległość wierzchołka od źródła.
+ * @return Odległość wierzchołka od źródła, powiększona o oszacowanie, jeśli
+ * tablica oszacowań jest podana, lub @ref INFINITE_DISTANCE, gdy z wierzchołka
+ * nie da się dojść do miasta końcowego.
+ */
+static uint64_t vertexKey(const uint64_t heuristic[], int id,
+                          uint64_t distance) {
+    if (heuristic == NULL) {
+        return distance;
+    }
+    else if (heuristic[id] == INFINITE_DISTANCE) {
+        return INFINITE_DISTANCE;
+    }
+    else {
+        return distance + heuristic[id];
+    }
+}
 
-    return vertex;
+/**
+ * @brief Sprawdza, czy ścieżka może prowadzić przez odcinek drogi.
+ * Funkcja jest rozwijana w miejscu wywołania, więc gdy filtr jest stałą
+ * NULL, kompilator pomija jego sprawdzanie.
+ * @param[in] filter         – wskaźnik na filtr ścieżek lub NULL;
+ * @param[in] road           – wskaźnik na odcinek drogi.
+ * @return Wartość @p true, jeśli odcinek drogi nie jest przeznaczony do
+ * usunięcia i spełnia warunki filtra.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static inline bool isRoadAllowed(const PathFilter *filter, Road *road) {
+    if (road->toRemove == true) {
+        return false;
+    }
+    else if ((filter != NULL) && (road->year < filter->minYear)) {
+        return false;
+    }
+    else {
+        return true;
+    }
 }
 
 /**
- * @brief Wypełnia kopiec oraz pomocnicze tablice.
+ * @brief Relaksuje odcinki dróg wychodzące z danego wierzchołka.
+ * Przy równych odległościach wybiera ścieżkę, której najstarszy odcinek drogi
+ * jest najmłodszy, a gdy i to nie rozstrzyga, zaznacza błąd w wierzchołku.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] vertices   – wskaźnik na tablice danych wierzchołków;
  * @param[in,out] heap       – wskaźnik na strukturę kopca;
+ * @param[in] min            – identyfikator przetwarzanego wierzchołka;
+ * @param[in,out] previous   – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast;
+ * @param[in] heuristic      – tablica dolnych oszacowań odległości wierzchołków
+ *                             od miasta końcowego lub NULL;
+ * @param[in] filter         – wskaźnik na filtr ścieżek lub NULL.
+ */
+static inline void relaxRoads(Map *map, Vertices *vertices, BinaryHeap *heap,
+                              int min, Road *previous[],
+                              const uint64_t heuristic[],
+                              const PathFilter *filter) {
+    Road *road;
+    uint64_t *distance = vertices->distance;
+    int *oldestYear = vertices->oldestYear;
+    bool *error = vertices->error;
+    int vertex, oldest;
+    uint64_t length;
+    ListOfRoads *list = map->cities[min]->firstRoad;
+
+    while (list != NULL) {
+        road = list->road;
+        if (isRoadAllowed(filter, road)) {
+            vertex = otherCityId(road, min);
+            if (!isReached(vertices, vertex)) {
+                reachVertex(heap, vertices, vertex, previous);
+            }
+            if (inHeap(heap, vertex)) {
+                length = road->length;
+                if (road->year > oldestYear[min]) {
+                    oldest = oldestYear[min];
+                }
+                else {
+                    oldest = road->year;
+                }
+
+                if (distance[min] + length < distance[vertex]) {
+                    previous[vertex] = road;
+                    oldestYear[vertex] = oldest;
+                    error[vertex] = error[min];
+                    distance[vertex] = distance[min] + length;
+                    decreasePriority(heap, vertex,
+                                     vertexKey(heuristic, vertex,
+                                               distance[vertex]));
+                }
+                else if (distance[min] + length == distance[vertex]) {
+                    if (oldestYear[vertex] == oldest) {
+                        error[vertex] = true;
+                    }
+                    else if (oldestYear[vertex] < oldest) {
+                        previous[vertex] = road;
+                        oldestYear[vertex] = oldest;
+                        error[vertex] = error[min];
+                    }
+                }
+            }
+        }
+        list = list->next;
+    }
+}
+
+/**
+ * @brief Wyszukuje najkrótsze ścieżki od miasta początkowego.
+ * Przerywa wyszukiwanie, gdy dotrze do miasta końcowego, gdy pozostałe
+ * wierzchołki są nieosiągalne lub gdy przekroczy podane ograniczenia.
+ * Wartości w tablicach danych wierzchołków oraz w tablicy poprzedników są
+ * ostateczne dla wierzchołków przetworzonych przed przerwaniem wyszukiwania.
  * @param[in] map            – wskaźnik na strukturę mapy;
- * @param[in,out] dist       – tablica odległości od źródła;
- * @param[in,out] prev       – tablica identyfikatorów poprzedników miast.
+ * @param[in,out] vertices   – wskaźnik na tablice danych wierzchołków;
+ * @param[in,out] heap       – wskaźnik na strukturę kopca, którego tablice
+ *                             mają rozmiar równy liczbie miast;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] stop           – identyfikator miasta końcowego lub -1, gdy
+ *                             wyszukiwanie ma objąć cały graf;
+ * @param[in,out] previous   – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast;
+ * @param[in] maxDistance    – największa dopuszczalna długość ścieżki, używana
+ *                             tylko bez tablicy oszacowań;
+ * @param[in] maxSettled     – największa liczba przetworzonych wierzchołków;
+ * @param[in] heuristic      – tablica dolnych oszacowań odległości wierzchołków
+ *                             od miasta końcowego, spełniających nierówność
+ *                             trójkąta, lub NULL; gdy jest podana, kopiec musi
+ *                             być uporządkowany według osobnej tablicy kluczy;
+ * @param[in] filter         – wskaźnik na filtr ścieżek lub NULL; funkcja
+ *                             jest rozwijana w miejscu wywołania, więc
+ *                             wyszukiwanie bez filtra nie sprawdza go.
+ * @return Wartość @p true, jeśli dotarto do miasta końcowego.
+ * Wartość @p false, w przeciwnym przypadku.
  */
-static void fillHeapAndArrays(BinaryHeap *heap, Map *map, int dist[], int prev[]) {
-    for (int i = 0; i < heap->size; i++) {
-        heap->vertices[i] = findVertex(map, i, INT_MAX);
-        heap->verticesPositions[i] = i;
-        heap->vertices[i]->road = NULL;
-        heap->vertices[i]->oldestYear = INT_MAX;
-        heap->vertices[i]->error = false;
-        dist[i] = INT_MAX;
-        prev[i] = -1;
+static inline bool search(Map *map, Vertices *vertices, BinaryHeap *heap,
+                          int start, int stop, Road *previous[],
+                          uint64_t maxDistance, int maxSettled,
+                          const uint64_t heuristic[],
+                          const PathFilter *filter) {
+    uint64_t *distance = vertices->distance;
+    int min, settled = 0;
+    bool found = false, exceeded = false;
+
+    heap->size = 0;
+    newSearch(vertices, map->numberOfCities);
+    reachVertex(heap, vertices, start, previous);
+    distance[start] = 0;
+    decreasePriority(heap, start, vertexKey(heuristic, start, 0));
+
+    while (!isEmpty(heap) && !found && !exceeded) {
+        min = extractMin(heap);
+        if ((heap->key[min] == INFINITE_DISTANCE)
+            || (distance[min] > maxDistance)) {
+            exceeded = true;
+        }
+        else if (min == stop) {
+            found = true;
+        }
+        else if ((min == start) || !isVertexMarked(map, min)) {
+            if (settled == maxSettled) {
+                exceeded = true;
+            }
+            else {
+                relaxRoads(map, vertices, heap, min, previous, heuristic,
+                           filter);
+                settled++;
+            }
+        }
     }
+
+    return found;
 }
 
-int dijkstra(Map *map, int start, int stop, int previous[]) {
-    City *city;
-    Vertex *min, *vertex;
-    int length;
-    int distance[map->numberOfCities];
-    bool found = false;
-    BinaryHeap *heap = newBinaryHeap(map->numberOfCities);
+uint64_t boundedDijkstra(Map *map, int start, int stop, Road *previous[],
+                         uint64_t maxDistance, int maxSettled) {
+    Vertices *vertices = &(map->vertices);
+    bool found;
+    BinaryHeap *heap = newBinaryHeap(map->numberOfCities, vertices->distance);
 
     if (heap != NULL) {
-        heap->size = map->numberOfCities;
-        fillHeapAndArrays(heap, map, distance, previous);
-        distance[start] = 0;
+        found = search(map, vertices, heap, start, stop, previous, maxDistance,
+                       maxSettled, NULL, NULL);
+        removeBinaryHeap(heap);
+
+        if (!found || (vertices->error[stop] == true)) {
+            previous[stop] = NULL;
+            vertices->distance[stop] = INFINITE_DISTANCE;
+        }
+        return vertices->distance[stop];
+    }
+    else {
+        previous[stop] = NULL;
+        return INFINITE_DISTANCE;
+    }
+}
+
+uint64_t filteredDijkstra(Map *map, Workspace *workspace, int start, int stop,
+                          const PathFilter *filter) {
+    Vertices *vertices = &(workspace->vertices);
+    Road **previous = workspace->previous;
+    bool found;
+
+    workspace->heap->key = vertices->distance;
+    found = search(map, vertices, workspace->heap, start, stop, previous,
+                   INFINITE_DISTANCE, map->numberOfCities, NULL, filter);
+
+    if (!found || (vertices->error[stop] == true)) {
+        previous[stop] = NULL;
+        vertices->distance[stop] = INFINITE_DISTANCE;
+    }
+
+    return vertices->distance[stop];
+}
+
+uint64_t dijkstra(Map *map, int start, int stop, Road *previous[]) {
+    return boundedDijkstra(map, start, stop, previous, INFINITE_DISTANCE,
+                           map->numberOfCities);
+}
+
+Workspace* newWorkspace(int numberOfCities) {
+    Workspace *workspace = (Workspace *)malloc(sizeof(Workspace));
+    Vertices *vertices;
+
+    if (workspace != NULL) {
+        vertices = &(workspace->vertices);
+        vertices->distance = (uint64_t *)malloc(numberOfCities
+                                                * sizeof(uint64_t));
+        vertices->oldestYear = (int *)malloc(numberOfCities * sizeof(int));
+        vertices->mark = NULL;
+        vertices->error = (bool *)malloc(numberOfCities * sizeof(bool));
+        vertices->reached = (unsigned *)calloc(numberOfCities,
+                                               sizeof(unsigned));
+        vertices->search = 0;
+        workspace->estimate = (uint64_t *)malloc(numberOfCities
+                                                 * sizeof(uint64_t));
+        workspace->previous = (Road **)malloc(numberOfCities * sizeof(Road *));
+        workspace->heap = newBinaryHeap(numberOfCities, vertices->distance);
+        workspace->size = numberOfCities;
+        if ((vertices->distance == NULL) || (vertices->oldestYear == NULL)
+            || (vertices->error == NULL) || (vertices->reached == NULL)
+            || (workspace->estimate == NULL)
+            || (workspace->previous == NULL)
+            || (workspace->heap == NULL)) {
+            freeWorkspace(workspace);
+            workspace = NULL;
+        }
+    }
+
+    return workspace;
+}
+
+void freeWorkspace(Workspace *workspace) {
+    if (workspace != NULL) {
+        free(workspace->vertices.distance);
+        free(workspace->vertices.oldestYear);
+        free(workspace->vertices.error);
+        free(workspace->vertices.reached);
+        free(workspace->estimate);
+        free(workspace->previous);
+        if (workspace->heap != NULL) {
+            removeBinaryHeap(workspace->heap);
+        }
+        free(workspace);
+    }
+}
+
+void shortestDistances(Map *map, Workspace *workspace, int start) {
+    Vertices *vertices = &(workspace->vertices);
+
+    workspace->heap->key = vertices->distance;
+    search(map, vertices, workspace->heap, start, -1, workspace->previous,
+           INFINITE_DISTANCE, map->numberOfCities, NULL, NULL);
+
+    for (int i = 0; i < map->numberOfCities; i++) {
+        if (!isReached(vertices, i) || (vertices->error[i] == true)) {
+            vertices->distance[i] = INFINITE_DISTANCE;
+        }
+    }
+}
+
+bool shortestPath(Map *map, Workspace *workspace, int start, int stop,
+                  const uint64_t heuristic[]) {
+    Vertices *vertices = &(workspace->vertices);
+    bool found;
+
+    if (heuristic == NULL) {
+        workspace->heap->key = vertices->distance;
+    }
+    else {
+        workspace->heap->key = workspace->estimate;
+    }
+
+    found = search(map, vertices, workspace->heap, start, stop,
+                   workspace->previous, INFINITE_DISTANCE, map->numberOfCities,
+                   heuristic, NULL);
+
+    if (stop == -1) {
+        for (int i = 0; i < map->numberOfCities; i++) {
+            if (!isReached(vertices, i)) {
+                vertices->distance[i] = INFINITE_DISTANCE;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief Zwalnia tablice pomocnicze kończącego się wątku.
+ * @param[in] workspace      – wskaźnik na tablice pomocnicze wątku.
+ */
+static void freeThreadWorkspace(void *workspace) {
+    freeWorkspace((Workspace *)workspace);
+}
+
+/**
+ * @brief Tworzy klucz tablic pomocniczych wątku.
+ */
+static void createWorkspaceKey(void) {
+    pthread_key_create(&workspaceKey, freeThreadWorkspace);
+}
+
+/**
+ * @brief Daje tablice pomocnicze wątku wystarczające dla podanej liczby miast.
+ * Tablice są zachowywane między wyszukiwaniami, więc wyszukiwanie nie alokuje
+ * pamięci, a jego koszt nie zależy od liczby miast w mapie. Gdy mapa urosła,
+ * alokuje tablice co najmniej dwa razy większe od dotychczasowych, więc łączny
+ * koszt ich powiększania jest proporcjonalny do liczby miast.
+ * @param[in] numberOfCities – liczba miast w mapie.
+ * @return Wskaźnik na tablice pomocnicze wątku lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static Workspace* threadWorkspace(int numberOfCities) {
+    Workspace *workspace;
+    int size = numberOfCities;
+
+    pthread_once(&workspaceKeyOnce, createWorkspaceKey);
+    workspace = (Workspace *)pthread_getspecific(workspaceKey);
+
+    if ((workspace == NULL) || (workspace->size < numberOfCities)) {
+        if ((workspace != NULL) && (workspace->size <= INT_MAX / 2)
+            && (2 * workspace->size > size)) {
+            size = 2 * workspace->size;
+        }
+        freeWorkspace(workspace);
+        workspace = newWorkspace(size);
+        pthread_setspecific(workspaceKey, workspace);
+    }
+
+    return workspace;
+}
+
+bool isochrone(Map *map, int start, uint64_t maxDistance,
+               IsochroneHandler handler, void *data) {
+    Workspace *workspace = threadWorkspace(map->numberOfCities);
+    Vertices *vertices;
+    BinaryHeap *heap;
+    int min;
+    bool correct = true, exceeded = false;
+
+    if (workspace == NULL) {
+        correct = false;
+    }
+    else {
+        vertices = &(workspace->vertices);
+        heap = workspace->heap;
+        heap->size = 0;
+        newSearch(vertices, map->numberOfCities);
+        reachVertex(heap, vertices, start, workspace->previous);
         decreasePriority(heap, start, 0);
 
-        while (!isEmpty(heap) && !found) {
+        while (!isEmpty(heap) && !exceeded) {
             min = extractMin(heap);
-            if ((min->id == start) || (min->usedInRoute == false)) {
-                city = map->cities[min->id];
-                ListOfRoads *list = city->firstRoad;
-                while (list != NULL) {
-                    if (list->road->cityA == city) {
-                        vertex = list->road->cityB->vertex;
-                    }
-                    else {
-                        vertex = list->road->cityA->vertex;
-                    }
-                    if (inHeap(heap, vertex) && (distance[min->id] != INT_MAX)
-                        && (list->road->toRemove == false)) {
-                        length = list->road->length;
-                        if (distance[min->id] + length < distance[vertex->id]) {
-                            vertex->road = list->road;
-                            previous[vertex->id] = min->id;
-                            distance[vertex->id] = distance[min->id] + length;
-                            if (vertex->oldestYear > min->oldestYear) {
-                                vertex->oldestYear = min->oldestYear;
-                            }
-                            if (vertex->oldestYear > list->road->year) {
-                                vertex->oldestYear = list->road->year;
-                            }
-                            vertex->error = min->error;
-                            decreasePriority(heap, vertex->id, distance[vertex->id]);
-                        }
-                        else if (distance[min->id] + length == distance[vertex->id]) {
-                            int oldest;
-                            if (list->road->year > min->oldestYear) {
-                                oldest = min->oldestYear;
-                            }
-                            else {
-                                oldest = list->road->year;
-                            }
-
-                            if (vertex->oldestYear == oldest) {
-                                vertex->error = true;
-                            }
-                            else if (vertex->oldestYear < oldest) {
-                                vertex->road = list->road;
-                                previous[vertex->id] = min->id;
-                                distance[vertex->id] = distance[min->id] + length;
-                                vertex->oldestYear = oldest;
-                                vertex->error = min->error;
-                                decreasePriority(heap, vertex->id, distance[vertex->id]);
-                            }
-                        }
-                    }
-                    list = list->next;
-                }
-                if (min->id == stop) {
-                    found = true;
-                }
+            if (vertices->distance[min] > maxDistance) {
+                exceeded = true;
+            }
+            else {
+                handler(map->cities[min]->name, vertices->distance[min], data);
+                relaxRoads(map, vertices, heap, min, workspace->previous, NULL,
+                           NULL);
             }
         }
-        removeBinaryHeap(heap);
+    }
 
-        if (map->cities[stop]->vertex->error == true) {
-            previous[stop] = -1;
-            distance[stop] = INT_MAX;
-        }
-        return distance[stop];
+    return correct;
+}
+
+bool nearestOnRoute(Map *map, int start, Route *route, int *nearest,
+                    uint64_t *distance) {
+    Workspace *workspace = threadWorkspace(map->numberOfCities);
+    Vertices *vertices;
+    BinaryHeap *heap;
+    int min;
+    bool correct = true;
+
+    *nearest = -1;
+    *distance = INFINITE_DISTANCE;
+
+    if (workspace == NULL) {
+        correct = false;
     }
     else {
-        previous[stop] = -1;
-        return INT_MAX;
+        vertices = &(workspace->vertices);
+        heap = workspace->heap;
+        heap->size = 0;
+        newSearch(vertices, map->numberOfCities);
+        reachVertex(heap, vertices, start, workspace->previous);
+        decreasePriority(heap, start, 0);
+
+        while (!isEmpty(heap) && (*nearest == -1)) {
+            min = extractMin(heap);
+            if (isCityInRoute(route, map->cities[min])) {
+                *nearest = min;
+                *distance = vertices->distance[min];
+            }
+            else {
+                relaxRoads(map, vertices, heap, min, workspace->previous, NULL,
+                           NULL);
+            }
+        }
     }
+
+    return correct;
 }
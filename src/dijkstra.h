@@ -24,22 +24,217 @@ typedef struct BinaryHeap BinaryHeap;
  * Struktura binarnego kopca zawiera:
  * rozmiar kopca, czyli liczbę wierzchołków;
  * tablicę pozycji wierzchołków w tablicy;
- * tablicę wskaźników na wierzchołki jednoznacznie powiązane z miastami.
+ * tablicę identyfikatorów wierzchołków jednoznacznie powiązanych z miastami;
+ * wskaźnik na tablicę kluczy wierzchołków, według których uporządkowany jest
+ * kopiec; zwykle jest to tablica odległości wierzchołków od źródła;
+ * wskaźnik na tablicę odległości wierzchołków od źródła, która rozstrzyga
+ * o kolejności wierzchołków o równych kluczach.
  */
 struct BinaryHeap {
     int size;               ///< rozmiar kopca
     int *verticesPositions; ///< tablica pozycji wierzchołków w kopcu
-    Vertex **vertices;      ///< tablica wskaźników na wierzchołki
+    int *vertices;          ///< tablica identyfikatorów wierzchołków
+    uint64_t *key;          ///< tablica kluczy wierzchołków
+    uint64_t *distance;     ///< tablica odległości wierzchołków od źródła
+};
+
+/**
+ * Struktura przechowująca warunki, które muszą spełniać odcinki dróg ścieżki.
+ */
+typedef struct PathFilter PathFilter;
+
+/**
+ * @brief Struktura przechowująca warunki, które muszą spełniać odcinki dróg
+ * ścieżki.
+ * Miasta, przez które ścieżka nie może przechodzić, wskazuje się, oznaczając
+ * je znacznikiem mapy, tak jak przy wyszukiwaniu objazdów.
+ * Struktura zawiera:
+ * najmniejszy dopuszczalny rok budowy lub ostatniego remontu odcinka drogi.
+ */
+struct PathFilter {
+    int minYear; ///< najmniejszy dopuszczalny rok budowy odcinka drogi
+};
+
+/**
+ * Struktura przechowująca tablice pomocnicze do wyszukiwania najkrótszych
+ * ścieżek, niezależne od tablic mapy.
+ */
+typedef struct Workspace Workspace;
+
+/**
+ * @brief Struktura przechowująca tablice pomocnicze do wyszukiwania
+ * najkrótszych ścieżek.
+ * Dzięki niej wiele wyszukiwań może odbywać się jednocześnie na tej samej,
+ * niezmienianej w tym czasie mapie, a kolejne wyszukiwania nie alokują
+ * pamięci.
+ * Struktura zawiera:
+ * tablice danych wierzchołków (bez tablicy znaczników, która należy do mapy);
+ * kopiec;
+ * tablicę kluczy wierzchołków używaną przy wyszukiwaniu kierowanym
+ * oszacowaniami odległości;
+ * tablicę odcinków dróg prowadzących do poprzedników miast;
+ * liczbę miast, dla której zaalokowano tablice.
+ */
+struct Workspace {
+    Vertices vertices;  ///< tablice danych wierzchołków
+    BinaryHeap *heap;   ///< wskaźnik na kopiec
+    uint64_t *estimate; ///< tablica kluczy wierzchołków
+    Road **previous;    ///< tablica odcinków dróg prowadzących do poprzedników
+    int size;           ///< liczba miast, dla której zaalokowano tablice
 };
 
 /** @brief Znajduje najkrótszą ścieżkę w grafie.
  * @param[in] map            – wskaźnik na strukturę mapy;
  * @param[in] start          – identyfikator miasta początkowego;
  * @param[in] stop           – identyfikator miasta końcowego;
- * @param[in,out] previous   – tablica identyfikatorów poprzedników miast.
+ * @param[in,out] previous   – tablica odcinków dróg, którymi na najkrótszej
+ *                             ścieżce dochodzi się do miast; wartość NULL
+ *                             oznacza brak poprzednika.
  * @return Długość najkrótszej ścieżki w grafie od miasta początkowego
- * do miasta końcowego.
+ * do miasta końcowego lub @ref INFINITE_DISTANCE, gdy nie istnieje jednoznaczna
+ * najkrótsza ścieżka.
+ */
+uint64_t dijkstra(Map *map, int start, int stop, Road *previous[]);
+
+/** @brief Znajduje najkrótszą ścieżkę w grafie, ograniczając przeszukiwanie.
+ * Przerywa wyszukiwanie, gdy najbliższy nieprzetworzony wierzchołek jest
+ * dalej od źródła niż podana odległość lub gdy przetworzono już podaną
+ * liczbę wierzchołków, a miasto końcowe nie zostało osiągnięte. Przerywa je
+ * także, gdy pozostałe wierzchołki są nieosiągalne, dzięki czemu nie
+ * przegląda reszty grafu. Ścieżkę uznaje się wtedy za nieistniejącą.
+ * Ścieżka nie przechodzi przez wierzchołki oznaczone, z wyjątkiem miasta
+ * początkowego.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] stop           – identyfikator miasta końcowego;
+ * @param[in,out] previous   – tablica odcinków dróg, którymi na najkrótszej
+ *                             ścieżce dochodzi się do miast; wartość NULL
+ *                             oznacza brak poprzednika;
+ * @param[in] maxDistance    – największa dopuszczalna długość ścieżki;
+ * @param[in] maxSettled     – największa liczba przetworzonych wierzchołków.
+ * @return Długość najkrótszej ścieżki w grafie od miasta początkowego
+ * do miasta końcowego lub @ref INFINITE_DISTANCE, gdy nie istnieje jednoznaczna
+ * najkrótsza ścieżka mieszcząca się w podanych ograniczeniach.
+ */
+uint64_t boundedDijkstra(Map *map, int start, int stop, Road *previous[],
+                         uint64_t maxDistance, int maxSettled);
+
+/** @brief Znajduje najkrótszą ścieżkę w grafie złożoną z odcinków dróg
+ * spełniających warunki filtra.
+ * Działa jak funkcja @ref dijkstra, ale pomija odcinki dróg niespełniające
+ * warunków filtra. Wyszukiwanie bez filtra jest osobno kompilowanym
+ * wariantem tego samego kodu, więc nie ponosi kosztu sprawdzania filtra.
+ * Używa własnych tablic pomocniczych, więc może być wywoływana jednocześnie
+ * z wielu wątków na niezmienianej w tym czasie mapie.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze o rozmiarze
+ *                             równym liczbie miast w mapie; po wywołaniu
+ *                             tablica poprzedników zawiera odcinki dróg,
+ *                             którymi na najkrótszej ścieżce dochodzi się
+ *                             do miast, a wartość NULL oznacza brak
+ *                             poprzednika;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] stop           – identyfikator miasta końcowego;
+ * @param[in] filter         – wskaźnik na filtr ścieżek lub NULL.
+ * @return Długość najkrótszej ścieżki w grafie od miasta początkowego
+ * do miasta końcowego lub @ref INFINITE_DISTANCE, gdy nie istnieje jednoznaczna
+ * najkrótsza ścieżka spełniająca warunki filtra.
+ */
+uint64_t filteredDijkstra(Map *map, Workspace *workspace, int start, int stop,
+                          const PathFilter *filter);
+
+/** @brief Tworzy tablice pomocnicze do wyszukiwania najkrótszych ścieżek.
+ * @param[in] numberOfCities – liczba miast w mapie.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+Workspace* newWorkspace(int numberOfCities);
+
+/** @brief Zwalnia tablice pomocnicze do wyszukiwania najkrótszych ścieżek.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] workspace      – wskaźnik na usuwaną strukturę.
+ */
+void freeWorkspace(Workspace *workspace);
+
+/** @brief Wyznacza odległości od miasta do wszystkich miast.
+ * Nie zmienia mapy, więc może być wywoływana jednocześnie z wielu wątków,
+ * o ile każdy z nich używa własnych tablic pomocniczych. Po wywołaniu
+ * tablica odległości w @p workspace zawiera dla każdego miasta tę samą
+ * wartość, którą dla niego dałaby w wyniku funkcja @ref dijkstra, czyli
+ * @ref INFINITE_DISTANCE, gdy najkrótsza ścieżka nie istnieje lub nie jest
+ * jednoznaczna.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze o rozmiarze
+ *                             równym liczbie miast w mapie;
+ * @param[in] start          – identyfikator miasta początkowego.
+ */
+void shortestDistances(Map *map, Workspace *workspace, int start);
+
+/** @brief Znajduje jedną z najkrótszych ścieżek między miastami.
+ * W przeciwieństwie do funkcji @ref dijkstra nie odrzuca ścieżki, gdy
+ * najkrótsza ścieżka nie jest jednoznaczna; zapisuje wtedy jedną z nich.
+ * Ścieżka nie przechodzi przez wierzchołki oznaczone, z wyjątkiem miasta
+ * początkowego, ani przez odcinki dróg przeznaczone do usunięcia. Gdy podane
+ * są dolne oszacowania odległości od miasta końcowego, najpierw przetwarza
+ * wierzchołki, przez które ścieżka może być najkrótsza, więc zwykle
+ * przegląda tylko niewielką część grafu. Gdy miasto końcowe ma identyfikator
+ * -1, wyznacza odległości do wszystkich miast. Nie zmienia mapy.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze o rozmiarze
+ *                             równym liczbie miast w mapie; po wywołaniu
+ *                             tablica poprzedników wyznacza ścieżkę od miasta
+ *                             końcowego do miasta początkowego;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] stop           – identyfikator miasta końcowego lub -1;
+ * @param[in] heuristic      – tablica dolnych oszacowań odległości miast
+ *                             od miasta końcowego, spełniających nierówność
+ *                             trójkąta, na przykład odległości wyznaczonych
+ *                             w całym grafie, lub NULL.
+ * @return Wartość @p true, jeśli ścieżka istnieje.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+bool shortestPath(Map *map, Workspace *workspace, int start, int stop,
+                  const uint64_t heuristic[]);
+
+/** @brief Wyznacza miasta położone nie dalej niż podana odległość od miasta.
+ * Wywołuje funkcję @p handler dla kolejnych miast w kolejności niemalejących
+ * odległości, gdy tylko ich odległość jest ostateczna, i kończy wyszukiwanie,
+ * gdy najbliższe nieprzetworzone miasto jest dalej niż @p maxDistance. Czas
+ * działania zależy tylko od liczby znalezionych miast i wychodzących z nich
+ * odcinków dróg, a nie od liczby wszystkich miast w mapie. Nie zmienia mapy.
+ * Używa tablic pomocniczych wątku, które są alokowane przy pierwszym
+ * wyszukiwaniu w wątku lub gdy mapa urosła, i zwalniane po zakończeniu
+ * wątku.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] maxDistance    – największa odległość od miasta początkowego;
+ * @param[in] handler        – funkcja wywoływana dla kolejnych miast;
+ * @param[in] data           – wskaźnik przekazywany funkcji @p handler.
+ * @return Wartość @p true, jeśli wyszukiwanie zostało wykonane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci; funkcja @p handler
+ * nie jest wtedy wywoływana.
+ */
+bool isochrone(Map *map, int start, uint64_t maxDistance,
+               IsochroneHandler handler, void *data);
+
+/** @brief Znajduje miasto drogi krajowej położone najbliżej danego miasta.
+ * Wykonuje jedno wyszukiwanie od miasta początkowego i kończy je na pierwszym
+ * przetworzonym mieście, przez które przechodzi droga krajowa, więc jego koszt
+ * nie zależy od długości drogi krajowej. Spośród miast w tej samej odległości
+ * wybiera to, które zostało przetworzone jako pierwsze. Nie zmienia mapy
+ * i używa tablic pomocniczych wątku, tak jak @ref isochrone.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] route          – wskaźnik na drogę krajową;
+ * @param[out] nearest       – identyfikator znalezionego miasta lub -1, gdy
+ *                             z miasta początkowego nie da się dojechać do
+ *                             drogi krajowej;
+ * @param[out] distance      – odległość znalezionego miasta od miasta
+ *                             początkowego lub @ref INFINITE_DISTANCE.
+ * @return Wartość @p true, jeśli wyszukiwanie zostało wykonane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
  */
-int dijkstra(Map *map, int start, int stop, int previous[]);
+bool nearestOnRoute(Map *map, int start, Route *route, int *nearest,
+                    uint64_t *distance);
 
 #endif /* __DIJKSTRA_H__ */
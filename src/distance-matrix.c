@@ -0,0 +1,244 @@
+/** @file
+ * Plik zawierający funkcje do obliczania macierzy odległości między miastami.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "distance-matrix.h"
+#include "dijkstra.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64   ///< największa liczba wątków obliczających wiersze
+#define ROWS_PER_THREAD 2 ///< liczba buforowanych wierszy na jeden wątek
+
+/**
+ * Struktura przechowująca stan obliczania macierzy odległości.
+ */
+typedef struct DistancesJob DistancesJob;
+
+/**
+ * Struktura przechowująca dane jednego wątku obliczającego wiersze.
+ */
+typedef struct DistancesWorker DistancesWorker;
+
+/**
+ * @brief Struktura przechowująca stan obliczania macierzy odległości.
+ * Wiersze są obliczane w buforze cyklicznym o rozmiarze @p window, więc wątek
+ * może zacząć obliczać wiersz dopiero wtedy, gdy wiersz o @p window wcześniejszy
+ * został przekazany dalej.
+ * Struktura zawiera:
+ * wskaźnik na mapę oraz tablice miast początkowych i docelowych wraz z ich
+ * liczbą;
+ * bufor wierszy wraz z informacją, które z nich są już obliczone;
+ * numer następnego wiersza do obliczenia i liczbę wierszy przekazanych dalej;
+ * muteks oraz zmienne warunkowe chroniące powyższe dane.
+ */
+struct DistancesJob {
+    Map *map;                 ///< wskaźnik na strukturę mapy
+    const int *sources;       ///< tablica identyfikatorów miast początkowych
+    int numberOfSources;      ///< liczba miast początkowych
+    const int *targets;       ///< tablica identyfikatorów miast docelowych
+    int numberOfTargets;      ///< liczba miast docelowych
+    int window;               ///< liczba wierszy w buforze
+    uint64_t *rows;           ///< bufor wierszy
+    bool *ready;              ///< informacje o tym, czy wiersze są obliczone
+    int nextSource;           ///< numer następnego wiersza do obliczenia
+    int emitted;              ///< liczba wierszy przekazanych dalej
+    pthread_mutex_t mutex;    ///< muteks chroniący stan obliczeń
+    pthread_cond_t rowReady;  ///< zmienna warunkowa obliczenia wiersza
+    pthread_cond_t slotFree;  ///< zmienna warunkowa zwolnienia miejsca w buforze
+};
+
+/**
+ * @brief Struktura przechowująca dane jednego wątku obliczającego wiersze.
+ * Struktura zawiera:
+ * wskaźnik na wspólny stan obliczeń;
+ * tablice pomocnicze do wyszukiwania najkrótszych ścieżek, używane tylko
+ * przez ten wątek;
+ * identyfikator wątku.
+ */
+struct DistancesWorker {
+    DistancesJob *job;    ///< wskaźnik na wspólny stan obliczeń
+    Workspace *workspace; ///< tablice pomocnicze wątku
+    pthread_t thread;     ///< identyfikator wątku
+};
+
+/**
+ * @brief Oblicza liczbę wątków.
+ * @param[in] numberOfSources – liczba miast początkowych.
+ * @return Liczba dostępnych procesorów, ograniczona przez liczbę miast
+ * początkowych i @ref MAX_THREADS.
+ */
+static int numberOfThreads(int numberOfSources) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = MAX_THREADS;
+
+    if ((processors > 0) && (processors < threads)) {
+        threads = processors;
+    }
+    if (numberOfSources < threads) {
+        threads = numberOfSources;
+    }
+
+    return threads;
+}
+
+/**
+ * @brief Funkcja wykonywana przez wątek obliczający wiersze.
+ * Pobiera numery kolejnych wierszy do obliczenia, czekając, jeśli w buforze
+ * nie ma dla nich miejsca, i zapisuje obliczone wiersze w buforze.
+ * @param[in,out] argument   – wskaźnik na strukturę danych wątku.
+ * @return Wartość NULL.
+ */
+static void* computeRows(void *argument) {
+    DistancesWorker *worker = (DistancesWorker *)argument;
+    DistancesJob *job = worker->job;
+    uint64_t *distance = worker->workspace->vertices.distance;
+    uint64_t *row;
+    int source;
+    bool end = false;
+
+    pthread_mutex_lock(&job->mutex);
+    while (!end) {
+        if (job->nextSource == job->numberOfSources) {
+            end = true;
+        }
+        else if (job->nextSource == job->emitted + job->window) {
+            pthread_cond_wait(&job->slotFree, &job->mutex);
+        }
+        else {
+            source = job->nextSource;
+            job->nextSource++;
+            pthread_mutex_unlock(&job->mutex);
+
+            shortestDistances(job->map, worker->workspace, job->sources[source]);
+            row = job->rows + (size_t)(source % job->window)
+                  * job->numberOfTargets;
+            for (int i = 0; i < job->numberOfTargets; i++) {
+                row[i] = distance[job->targets[i]];
+            }
+
+            pthread_mutex_lock(&job->mutex);
+            job->ready[source % job->window] = true;
+            pthread_cond_broadcast(&job->rowReady);
+        }
+    }
+    pthread_mutex_unlock(&job->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Przekazuje obliczone wiersze funkcji @p handler w kolejności miast
+ * początkowych.
+ * @param[in,out] job        – wskaźnik na stan obliczeń;
+ * @param[in] handler        – funkcja wywoływana dla kolejnych wierszy;
+ * @param[in] data           – wskaźnik przekazywany funkcji @p handler.
+ */
+static void emitRows(DistancesJob *job, DistancesHandler handler, void *data) {
+    int slot;
+
+    for (int i = 0; i < job->numberOfSources; i++) {
+        slot = i % job->window;
+        pthread_mutex_lock(&job->mutex);
+        while (!job->ready[slot]) {
+            pthread_cond_wait(&job->rowReady, &job->mutex);
+        }
+        pthread_mutex_unlock(&job->mutex);
+
+        handler(job->rows + (size_t)slot * job->numberOfTargets,
+                job->numberOfTargets, data);
+
+        pthread_mutex_lock(&job->mutex);
+        job->ready[slot] = false;
+        job->emitted++;
+        pthread_cond_broadcast(&job->slotFree);
+        pthread_mutex_unlock(&job->mutex);
+    }
+}
+
+/**
+ * @brief Zwalnia tablice pomocnicze wątków.
+ * @param[in,out] workers    – tablica danych wątków;
+ * @param[in] threads        – liczba wątków.
+ */
+static void freeWorkers(DistancesWorker workers[], int threads) {
+    for (int i = 0; i < threads; i++) {
+        freeWorkspace(workers[i].workspace);
+    }
+}
+
+bool distanceMatrix(Map *map, const int sources[], int numberOfSources,
+                    const int targets[], int numberOfTargets,
+                    DistancesHandler handler, void *data) {
+    DistancesJob job;
+    int threads = numberOfThreads(numberOfSources);
+    int started = 0;
+    DistancesWorker workers[MAX_THREADS];
+    bool correct = true;
+
+    job.map = map;
+    job.sources = sources;
+    job.numberOfSources = numberOfSources;
+    job.targets = targets;
+    job.numberOfTargets = numberOfTargets;
+    job.window = threads * ROWS_PER_THREAD;
+    job.nextSource = 0;
+    job.emitted = 0;
+    job.rows = (uint64_t *)malloc((size_t)job.window * numberOfTargets
+                                  * sizeof(uint64_t));
+    job.ready = (bool *)calloc(job.window, sizeof(bool));
+    if ((job.rows == NULL) || (job.ready == NULL)) {
+        correct = false;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = &job;
+        workers[i].workspace = NULL;
+        if (correct) {
+            workers[i].workspace = newWorkspace(map->numberOfCities);
+            if (workers[i].workspace == NULL) {
+                correct = false;
+            }
+        }
+    }
+
+    if (correct) {
+        pthread_mutex_init(&job.mutex, NULL);
+        pthread_cond_init(&job.rowReady, NULL);
+        pthread_cond_init(&job.slotFree, NULL);
+
+        while ((started < threads)
+               && (pthread_create(&workers[started].thread, NULL, computeRows,
+                                  &workers[started]) == 0)) {
+            started++;
+        }
+
+        if (started == 0) {
+            correct = false;
+        }
+        else {
+            emitRows(&job, handler, data);
+        }
+
+        for (int i = 0; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+
+        pthread_cond_destroy(&job.slotFree);
+        pthread_cond_destroy(&job.rowReady);
+        pthread_mutex_destroy(&job.mutex);
+    }
+
+    freeWorkers(workers, threads);
+    free(job.ready);
+    free(job.rows);
+
+    return correct;
+}
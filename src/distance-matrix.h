@@ -0,0 +1,39 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje do obliczania macierzy odległości
+ * między miastami.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __DISTANCE_MATRIX_H__
+#define __DISTANCE_MATRIX_H__
+
+#include "map.h"
+#include "help-structures.h"
+
+/**
+ * @brief Oblicza odległości od każdego z miast początkowych do każdego
+ * z miast docelowych.
+ * Dla każdego miasta początkowego wykonuje jedno wyszukiwanie, a wyszukiwania
+ * dla różnych miast początkowych rozdziela między wątki. Wiersze macierzy
+ * przekazuje funkcji @p handler w kolejności miast początkowych, w wątku,
+ * który wywołał tę funkcję, gdy tylko zostaną obliczone, więc w pamięci
+ * przechowywana jest jednocześnie tylko niewielka liczba wierszy. Mapa nie
+ * może być zmieniana w trakcie działania funkcji.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] sources        – tablica identyfikatorów miast początkowych;
+ * @param[in] numberOfSources – liczba miast początkowych;
+ * @param[in] targets        – tablica identyfikatorów miast docelowych;
+ * @param[in] numberOfTargets – liczba miast docelowych;
+ * @param[in] handler        – funkcja wywoływana dla kolejnych wierszy;
+ * @param[in] data           – wskaźnik przekazywany funkcji @p handler.
+ * @return Wartość @p true, jeśli udało się obliczyć wszystkie wiersze.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci lub utworzyć
+ * żadnego wątku; funkcja @p handler nie jest wtedy wywoływana.
+ */
+bool distanceMatrix(Map *map, const int sources[], int numberOfSources,
+                    const int targets[], int numberOfTargets,
+                    DistancesHandler handler, void *data);
+
+#endif /* __DISTANCE_MATRIX_H__ */
@@ -7,6 +7,8 @@
 
 #include "help-functions.h"
 #include "dijkstra.h"
+#include "string-scan.h"
+#include "undo-log.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,56 +17,52 @@
 
 #define MIN_ROUTE_ID 1   ///< najmniejszy numer drogi krajowej
 #define MAX_ROUTE_ID 999 ///< największy numer drogi krajowej
+#define MAX_ROUTE_ID_LENGTH 3 ///< maksymalna liczba cyfr numeru drogi krajowej
 
 bool isCityNameCorrect(const char *name) {
-    int i = 0;
-    bool correct = true;
+    size_t length = strlen(name);
 
-    while ((name[i] != '\0') && correct) {
-        if (((name[i] >= 0) && (name[i] <= 31)) || (name[i] == ';')) {
-            correct = false;
-        }
-        i++;
+    if ((length > 0) && !hasForbiddenCharacter(name, length)) {
+        return true;
     }
-
-    if (i == 0) {
-        correct = false;
+    else {
+        return false;
     }
-
-    return correct;
 }
 
 City* addCity(Map *map, const char *name) {
     City *city = NULL;
-    Vertex *vertex = NULL;
     bool correct = true;
 
-    if (map->numberOfCities == map->sizeOfCitiesArray) {
+    if (!reserveChange(map)) {
+        correct = false;
+    }
+
+    if (correct && (map->numberOfCities == map->sizeOfCitiesArray)) {
         if (!enlargeCitiesArray(map)) {
             correct = false;
         }
     }
 
+    if (correct && !enlargeCitiesIndex(map)) {
+        correct = false;
+    }
+
     if (correct) {
         city = (City *)malloc(sizeof(City));
         if (city != NULL) {
-            setCityValues(city, name);
+            setCityValues(map, city, name);
             if (city->name == NULL) {
                 free(city);
                 city = NULL;
             }
             else {
-                vertex = (Vertex *)malloc(sizeof(Vertex));
-                if (vertex == NULL) {
-                    freeCity(city);
-                    city = NULL;
-                }
-                else {
-                    setVertexValues(vertex, map->numberOfCities);
-                    city->vertex = vertex;
-                    map->cities[map->numberOfCities] = city;
-                    map->numberOfCities += 1;
-                }
+                city->id = map->numberOfCities;
+                setVertexValues(map, city->id);
+                map->cities[city->id] = city;
+                addCityToIndex(map, city, city->id);
+                map->numberOfCities += 1;
+                logAddedCity(map);
             }
         }
     }
@@ -73,25 +71,40 @@ City* addCity(Map *map, const char *name) {
 }
 
 Road* newRoad(Map *map, City *cityA, City *cityB, unsigned length, int year) {
-    bool error = false;
-    Road *road = (Road *)malloc(sizeof(Road));
+    Road *road = NULL;
+    ListOfRoads *tails[ROAD_LISTS];
+
+    if (reserveChange(map)) {
+        road = (Road *)malloc(sizeof(Road));
+    }
 
     if (road != NULL) {
         setRoadValues(road, cityA, cityB, length, year);
+        tails[MAP_ROADS] = map->lastRoad;
+        tails[CITY_A_ROADS] = cityA->lastRoad;
+        tails[CITY_B_ROADS] = cityB->lastRoad;
+        logAddedRoad(map, road, tails);
         if (!addRoadToMap(map, road) || !addRoadToCity(cityA, road)
             || !addRoadToCity(cityB, road)) {
-            error = true;
+            undoChanges(map, map->undoLog.numberOfChanges - 1);
+            road = NULL;
         }
     }
 
-    if (error) {
-        free(road);
-        road = NULL;
-    }
-
     return road;
 }
 
+bool updateRoadYear(Map *map, Road *road, int year) {
+    if (!reserveChange(map)) {
+        return false;
+    }
+    else {
+        logRepairedRoad(map, road, road->year);
+        road->year = year;
+        return true;
+    }
+}
+
 bool isLengthCorrect(unsigned length) {
     if (length > 0) {
         return true;
@@ -119,386 +132,524 @@ bool isRouteIdCorrect(unsigned routeId) {
     }
 }
 
-Route* addRoute(Map *map, unsigned id, int start, int stop, int previous[]) {
-    Route *route = NULL;
+/**
+ * @brief Oblicza liczbę odcinków dróg na ścieżce wyznaczonej przez tablicę
+ * poprzedników.
+ * @param[in] city           – wskaźnik na miasto początkowe;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Liczba odcinków dróg na ścieżce.
+ */
+static int pathLength(City *city, Road *previous[]) {
+    int id = city->id;
+    int length = 0;
 
-    route = (Route *)malloc(sizeof(Route));
-    if (route != NULL) {
-        setRouteValues(route, id, map->cities[start], map->cities[stop]);
-        while ((previous[start] != -1) && (route != NULL)) {
-            if (!addRoadToRoute(route, map->cities[start]->vertex->road)
-                || !addRouteToRoad(map->cities[start]->vertex->road, route)) {
-                route = NULL;
-            }
-            start = previous[start];
-        }
+    while (previous[id] != NULL) {
+        id = otherCityId(previous[id], id);
+        length++;
     }
 
-    return route;
+    return length;
 }
 
-bool extendFromFirstCity(Map *map, Route *route, int start, int previous[]) {
-    ListOfRoads *first, *last;
-    City *firstCity;
+/**
+ * @brief Zapisuje odcinek drogi i jego początkowe miasto w tablicach drogi
+ * krajowej.
+ * Dodaje drogę krajową do odcinka drogi, zapamiętując w węźle listy dróg
+ * krajowych odcinka jego pozycję i kierunek, oraz do miasta, jeśli wcześniej
+ * przez nie nie przechodziła.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] position       – pozycja w tablicach drogi krajowej;
+ * @param[in] city           – wskaźnik na miasto, z którego wychodzi odcinek
+ *                             drogi;
+ * @param[in] road           – wskaźnik na odcinek drogi.
+ * @return Wartość @p true, jeśli udało się zapisać odcinek drogi.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool writeRoad(Route *route, int position, City *city, Road *road) {
+    ListOfRoutes *link = addRouteToRoad(road, route);
     bool correct = true;
 
-    firstCity = map->cities[start];
-    start = previous[start];
-    first = route->firstRoad;
-    last = route->lastRoad;
-
-    while ((start != -1) && correct) {
-        if (!addRoadToRoute(route, map->cities[start]->vertex->road)
-            || !addRouteToRoad(map->cities[start]->vertex->road, route)) {
-            correct = false;
-        }
-        start = previous[start];
+    if (link == NULL) {
+        correct = false;
     }
-
-    if (correct) {
-        route->firstCity = firstCity;
-        route->firstRoad = last->next;
-        last->next = NULL;
-        route->lastRoad->next = first;
-        route->lastRoad = last;
+    else if (!isCityInRoute(route, city) && !addRouteToCity(city, route)) {
+        removeRouteFromRoad(road, link);
+        correct = false;
+    }
+    else {
+        link->position = position;
+        link->forward = (road->cityA == city->id);
+        route->roads[position] = road;
+        route->cities[position] = city;
+        route->links[position] = link;
     }
 
     return correct;
 }
 
-bool extendFromLastCity(Map *map, Route *route, int start, int previous[]) {
+/**
+ * @brief Zapisuje ostatnie miasto drogi krajowej w jej tablicach.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] position       – pozycja w tablicach drogi krajowej;
+ * @param[in] city           – wskaźnik na miasto.
+ * @return Wartość @p true, jeśli udało się zapisać miasto.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool writeLastCity(Route *route, int position, City *city) {
+    route->cities[position] = city;
+
+    if (!isCityInRoute(route, city) && !addRouteToCity(city, route)) {
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+/**
+ * @brief Zapisuje ścieżkę wyznaczoną przez tablicę poprzedników w tablicach
+ * drogi krajowej.
+ * Zapisuje kolejne odcinki dróg i miasta, począwszy od podanej pozycji.
+ * Zakłada, że w tablicach drogi krajowej jest miejsce na całą ścieżkę.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] position       – pozycja w tablicach drogi krajowej;
+ * @param[in] city           – wskaźnik na miasto początkowe;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Wartość @p true, jeśli udało się zapisać ścieżkę.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool writePath(Map *map, Route *route, int position, City *city,
+                      Road *previous[]) {
+    Road *road;
     bool correct = true;
 
-    while ((previous[start] != -1) && correct) {
-        if (!addRoadToRoute(route, map->cities[start]->vertex->road)
-            || !addRouteToRoad(map->cities[start]->vertex->road, route)) {
+    while ((previous[city->id] != NULL) && correct) {
+        road = previous[city->id];
+        if (!writeRoad(route, position, city, road)) {
             correct = false;
         }
-        start = previous[start];
+        else {
+            city = otherCity(map, road, city);
+            position++;
+        }
     }
 
-    if (correct) {
-        route->lastCity = map->cities[start];
+    if (correct && !writeLastCity(route, position, city)) {
+        correct = false;
     }
 
     return correct;
 }
 
-bool canRoadBeRemoved(Map *map, Road *road) {
-    bool error = false;
-    int previous[map->numberOfCities];
-    ListOfRoutes *node = road->firstRoute;
-
-    while ((node != NULL) && !error) {
-        markVerticies(node->route, true);
-        dijkstra(map, road->cityA->vertex->id, road->cityB->vertex->id, previous);
-        markVerticies(node->route, false);
-        if (previous[road->cityB->vertex->id] == -1) {
-            error = true;
-        }
-        node = node->next;
+/**
+ * @brief Czyści fragment tablic drogi krajowej przed zapisaniem w nim ścieżki.
+ * Dzięki temu po nieudanym zapisie wiadomo, które odcinki drogi i miasta
+ * zostały już zapisane.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] roadsFrom      – pierwsza czyszczona pozycja odcinków dróg;
+ * @param[in] roadsTo        – pozycja za ostatnią czyszczoną pozycją odcinków
+ *                             dróg;
+ * @param[in] citiesFrom     – pierwsza czyszczona pozycja miast;
+ * @param[in] citiesTo       – pozycja za ostatnią czyszczoną pozycją miast.
+ */
+static void clearRoutePart(Route *route, int roadsFrom, int roadsTo,
+                           int citiesFrom, int citiesTo) {
+    for (int i = roadsFrom; i < roadsTo; i++) {
+        route->roads[i] = NULL;
+        route->links[i] = NULL;
     }
+    for (int i = citiesFrom; i < citiesTo; i++) {
+        route->cities[i] = NULL;
+    }
+}
 
-    if (error) {
-        return false;
+void detachRoutePart(Route *route, int roadsFrom, int roadsTo, int citiesFrom,
+                     int citiesTo) {
+    for (int i = roadsFrom; i < roadsTo; i++) {
+        if (route->links[i] != NULL) {
+            removeRouteFromRoad(route->roads[i], route->links[i]);
+        }
     }
-    else {
-        return true;
+    for (int i = citiesFrom; i < citiesTo; i++) {
+        if (route->cities[i] != NULL) {
+            removeRouteFromCity(route->cities[i], route);
+        }
     }
 }
 
-void removeListOfRoadsNodeFromCity(City *city, Road *road) {
-    ListOfRoads *node = city->firstRoad;
-    ListOfRoads *nodeToRemove = NULL;
-    bool found = false;
+/**
+ * @brief Usuwa drogę krajową, której nie udało się zapisać w całości.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej.
+ */
+static void freePartialRoute(Route *route) {
+    int last = route->first + route->numberOfRoads;
 
-    if (node != NULL) {
-        if (city->firstRoad == city->lastRoad) {
-            nodeToRemove = city->firstRoad;
-            city->firstRoad = NULL;
-            city->lastRoad = NULL;
-        }
-        else if (city->firstRoad->road == road) {
-            nodeToRemove = city->firstRoad;
-            city->firstRoad = nodeToRemove->next;
+    detachRoutePart(route, route->first, last, route->first, last + 1);
+    freeRoute(route);
+}
+
+Route* addRoute(Map *map, unsigned id, int start, Road *previous[]) {
+    Route *route = NULL;
+    City *city = map->cities[start];
+    int length = pathLength(city, previous);
+
+    route = (Route *)malloc(sizeof(Route));
+    if (route != NULL) {
+        setRouteValues(route, id);
+        if (!reserveRouteSpace(route, 0, length)) {
+            freeRoute(route);
+            route = NULL;
         }
         else {
-            while ((node != NULL) && (node->next != NULL) && !found) {
-                if (node->next->road == road) {
-                    nodeToRemove = node->next;
-                    node->next = nodeToRemove->next;
-                    if (nodeToRemove == city->lastRoad) {
-                        city->lastRoad = node;
-                        city->lastRoad->next = NULL;
-                    }
-                    found = true;
-                }
-                node = node->next;
+            route->numberOfRoads = length;
+            clearRoutePart(route, route->first, route->first + length,
+                           route->first, route->first + length + 1);
+            if (!writePath(map, route, route->first, city, previous)) {
+                freePartialRoute(route);
+                route = NULL;
             }
         }
-        free(nodeToRemove);
     }
+
+    return route;
 }
 
-void removeRoadFromMap(Map *map, Road *road) {
-    ListOfRoads *node = map->firstRoad;
-    ListOfRoads *nodeToRemove = NULL;
-    bool found = false;
+Route* addRouteAlong(unsigned id, City *cities[], Road *roads[],
+                     int numberOfRoads) {
+    Route *route = (Route *)malloc(sizeof(Route));
+    int i = 0;
+    bool correct = true;
 
-    if (node != NULL) {
-        if (map->firstRoad == map->lastRoad) {
-            nodeToRemove = map->firstRoad;
-            map->firstRoad = NULL;
-            map->lastRoad = NULL;
-        }
-        else if (map->firstRoad->road == road) {
-            nodeToRemove = map->firstRoad;
-            map->firstRoad = nodeToRemove->next;
+    if (route != NULL) {
+        setRouteValues(route, id);
+        if (!reserveRouteSpace(route, 0, numberOfRoads)) {
+            freeRoute(route);
+            route = NULL;
         }
         else {
-            while ((node != NULL) && (node->next != NULL) && !found) {
-                if (node->next->road == road) {
-                    nodeToRemove = node->next;
-                    node->next = nodeToRemove->next;
-                    if (nodeToRemove == map->lastRoad) {
-                        map->lastRoad = node;
-                        map->lastRoad->next = NULL;
-                    }
-                    found = true;
-                }
-                node = node->next;
+            route->numberOfRoads = numberOfRoads;
+            clearRoutePart(route, route->first, route->first + numberOfRoads,
+                           route->first, route->first + numberOfRoads + 1);
+            while ((i < numberOfRoads) && correct) {
+                correct = writeRoad(route, route->first + i, cities[i],
+                                    roads[i]);
+                i++;
+            }
+
+            if (!correct || !writeLastCity(route, route->first + numberOfRoads,
+                                           cities[numberOfRoads])) {
+                freePartialRoute(route);
+                route = NULL;
             }
         }
-        free(nodeToRemove);
-        freeListOfRoutes(road->firstRoute);
-        free(road);
     }
+
+    return route;
 }
 
-/**
- * @brief Znajduje poprawną kolejność miast do wywołania funkcji znajdującej
- * najkrótszą ścieżkę w grafie.
- * Szuka w drodze krajowej danego odcinka drogi, następnie sprawdza, od którego,
- * do którego miasta powinna zostać wywołana funkcja znajdująca najkrótszą
- * ścieżkę w grafie, aby można było utworzyć objazd.
- * @param[in] start          – wskaźnik na identyfikator miasta początkowego;
- * @param[in] stop           – wskaźnik na identyfikator miasta końcowego;
- * @param[in] route          – wskaźnik na strukturę drogi krajowej;
- * @param[in] road           – wskaźnik na strukturę odcinka drogi.
- * @return Wskaźnik na węzeł poprzedzający węzeł, w którym znajduje się dany
- * odcinek drogi.
- */
-static ListOfRoads* findCorrectCitiesForDijkstra(int *start, int *stop,
-                                                 Route *route, Road *road) {
-    ListOfRoads *node = route->firstRoad;
-    ListOfRoads *previousNode = NULL;
-    City *cityA, *cityB;
-
-    cityA = road->cityA;
-    cityB = road->cityB;
-
-    if (route->firstRoad->road == road) {
-        if (route->firstCity == cityA) {
-            *start = cityA->vertex->id;
-            *stop = cityB->vertex->id;
-        }
-        else {
-            *start = cityB->vertex->id;
-            *stop = cityA->vertex->id;
-        }
+bool addRouteAlongToMap(Map *map, unsigned id, City *cities[], Road *roads[],
+                        int numberOfRoads) {
+    Route *route = addRouteAlong(id, cities, roads, numberOfRoads);
+    bool correct = true;
+
+    if (route == NULL) {
+        correct = false;
+    }
+    else if (!reserveChange(map) || !addRouteToMap(map, route)) {
+        discardRoute(route);
+        correct = false;
     }
     else {
-        while ((node != NULL) && (node->road != road)) {
-            previousNode = node;
-            node = node->next;
-        }
+        logAddedRoute(map, route);
+    }
 
-        if (node == route->lastRoad) {
-            if (route->lastCity == cityA) {
-                *start = cityB->vertex->id;
-                *stop = cityA->vertex->id;
-            }
-            else {
-                *start = cityA->vertex->id;
-                *stop = cityB->vertex->id;
-            }
-        }
-        else {
-            if (previousNode->road->cityA == cityA
-                || previousNode->road->cityB == cityA) {
-                *start = cityA->vertex->id;
-                *stop = cityB->vertex->id;
-            }
-            else {
-                *start = cityB->vertex->id;
-                *stop = cityA->vertex->id;
-            }
-        }
+    return correct;
+}
+
+bool extendFromFirstCity(Map *map, Route *route, int start,
+                         Road *previous[]) {
+    City *city = map->cities[start];
+    int length = pathLength(city, previous);
+    bool correct = true;
+
+    if (!reserveChange(map) || !reserveRouteSpace(route, length, 0)) {
+        correct = false;
+    }
+    else {
+        route->first -= length;
+        route->numberOfRoads += length;
+        clearRoutePart(route, route->first, route->first + length,
+                       route->first, route->first + length);
+        logExtendedRoute(map, route, length, 0);
+        correct = writePath(map, route, route->first, city, previous);
+    }
+
+    return correct;
+}
+
+bool extendFromLastCity(Map *map, Route *route, int start, Road *previous[]) {
+    City *city = map->cities[start];
+    int length = pathLength(city, previous);
+    int position;
+    bool correct = true;
+
+    if (!reserveChange(map) || !reserveRouteSpace(route, 0, length)) {
+        correct = false;
+    }
+    else {
+        position = route->first + route->numberOfRoads;
+        route->numberOfRoads += length;
+        clearRoutePart(route, position, position + length, position + 1,
+                       position + length + 1);
+        logExtendedRoute(map, route, 0, length);
+        correct = writePath(map, route, position, city, previous);
     }
 
-    return previousNode;
+    return correct;
 }
 
 /**
- * @brief Tworzy nowe węzły listy odcinków dróg w drodze krajowej.
- * @param[in] map            – wskaźnik na strukturę mapy;
- * @param[in,out] route      – wskaźnik na strukturę wydłużanej drogi krajowej;
- * @param[in] start          – identyfikator miasta, od którego wydłużamy drogę;
- * @param[in] previous       – tablica identyfikatorów poprzedników miast.
- * @return Wartość @p true, jeśli udało się utworzyć nowe węzły listy.
+ * @brief Wyznacza miasta, między którymi trzeba utworzyć objazd.
+ * Korzysta z kierunku przejścia drogi krajowej przez odcinek zapisanego
+ * w węźle listy dróg krajowych odcinka drogi.
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] link           – wskaźnik na węzeł listy dróg krajowych odcinka;
+ * @param[out] start         – wskaźnik na identyfikator miasta, od którego
+ *                             droga krajowa wchodzi na odcinek;
+ * @param[out] stop          – wskaźnik na identyfikator miasta, w którym
+ *                             droga krajowa opuszcza odcinek.
+ */
+static void findDetourEnds(Road *road, ListOfRoutes *link, int *start,
+                           int *stop) {
+    if (link->forward) {
+        *start = road->cityA;
+        *stop = road->cityB;
+    }
+    else {
+        *start = road->cityB;
+        *stop = road->cityA;
+    }
+}
+
+/**
+ * @brief Sprawdza, czy da się jednoznacznie wyznaczyć objazd.
+ * Objazd nie może przekraczać ograniczeń długości i liczby przeglądanych
+ * miast zapisanych w mapie.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] stop           – identyfikator miasta końcowego;
+ * @param[in,out] previous   – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Wartość @p true, jeśli istnieje jednoznaczny objazd od miasta
+ * końcowego do miasta początkowego.
  * Wartość @p false, w przeciwnym przypadku.
  */
-static bool fillListOfRoads(Map *map, Route *route, int start, int previous[]) {
-    bool correct = true;
+static bool isDetourFound(Map *map, Route *route, int start, int stop,
+                          Road *previous[]) {
+    markVerticies(map, route);
+    boundedDijkstra(map, stop, start, previous, map->maxDetourLength,
+                    map->maxDetourCities);
+    newMark(map);
+
+    if (previous[start] == NULL) {
+        return false;
+    }
+    else {
+        return true;
+    }
+}
 
-    while ((previous[start] != -1) && correct) {
-        if (!addRoadToRoute(route, map->cities[start]->vertex->road)
-            || !addRouteToRoad(map->cities[start]->vertex->road, route)) {
-            correct = false;
+bool canRoadBeRemoved(Map *map, Road *road) {
+    bool error = false;
+    Road **previous = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+    int start, stop;
+    int idA = road->cityA, idB = road->cityB;
+    ListOfRoutes *node = road->firstRoute;
+
+    if (previous == NULL) {
+        error = true;
+    }
+
+    while ((node != NULL) && !error) {
+        findDetourEnds(road, node, &start, &stop);
+        if (!isDetourFound(map, node->route, idB, idA, previous)) {
+            error = true;
+        }
+        else if ((start != idB) && !isDetourFound(map, node->route, start,
+                                                  stop, previous)) {
+            error = true;
         }
-        start = previous[start];
+        node = node->next;
     }
 
-    return correct;
+    free(previous);
+
+    if (error) {
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+void detachRoad(Map *map, Road *road) {
+    City *cityA = map->cities[road->cityA];
+    City *cityB = map->cities[road->cityB];
+    ListOfRoads *nodes[ROAD_LISTS];
+
+    nodes[MAP_ROADS] = unlinkRoad(&map->firstRoad, &map->lastRoad, road);
+    nodes[CITY_A_ROADS] = unlinkRoad(&cityA->firstRoad, &cityA->lastRoad, road);
+    nodes[CITY_B_ROADS] = unlinkRoad(&cityB->firstRoad, &cityB->lastRoad, road);
+    logRemovedRoad(map, road, nodes);
 }
 
 /**
  * @brief Tworzy objazd w drodze krajowej.
- * Funkcja sprawdza różne warianty umiejscowienia odcinka drogi do usunięcia
- * i w zależności od tego tworzy objazd w drodze krajowej. Na koniec funkcja
- * usuwa węzeł listy odcinków dróg zawierający odcinek do usunięcia.
- * @param[in] map            – wskaźnik na strukturę mapy;
- * @param[in,out] route      – wskaźnik na strukturę wydłużanej drogi krajowej;
- * @param[in] start          – identyfikator miasta, od którego wydłużamy drogę;
- * @param[in] previous       – tablica identyfikatorów poprzedników miast;
- * @param[in] node           – wskaźnik na węzeł listy odcinków dróg.
+ * Zastępuje odcinek drogi na podanej pozycji ścieżką wyznaczoną przez tablicę
+ * poprzedników. Aby zrobić miejsce na objazd, przesuwa krótszą z części drogi
+ * krajowej leżących przed i za usuwanym odcinkiem. Zapisuje zmianę
+ * w dzienniku, a usuwany odcinek drogi pozostaje na liście dróg krajowych
+ * odcinka do czasu zatwierdzenia zmian.
+ * @param[in,out] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] position       – pozycja usuwanego odcinka drogi;
+ * @param[in] start          – identyfikator miasta, od którego zaczyna się
+ *                             objazd;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
  * @return Wartość @p true, jeśli udało się utworzyć objazd.
  * Wartość @p false, w przeciwnym przypadku.
  */
-static bool fillTheRoute(Map *map, Route *route, int start, int previous[],
-                         ListOfRoads *node) {
-    ListOfRoads *nodeToRemove, *helpNode;
-    ListOfRoads *last = route->lastRoad;
+static bool fillTheRoute(Map *map, Route *route, int position, int start,
+                         Road *previous[]) {
+    City *city = map->cities[start];
+    int shift = pathLength(city, previous) - 1;
+    int before = position - route->first;
+    int after = route->numberOfRoads - before - 1;
+    Road *road = route->roads[position];
+    ListOfRoutes *link = route->links[position];
     bool correct = true;
 
-    if (node == NULL) {
-        nodeToRemove = route->firstRoad;
-        if (route->lastRoad == nodeToRemove) {
-            route->firstRoad = NULL;
-            route->lastRoad = NULL;
-            if (!fillListOfRoads(map, route, start, previous)) {
-                correct = false;
-            }
-        }
-        else {
-            helpNode = nodeToRemove->next;
-            route->firstRoad = NULL;
-            route->lastRoad = NULL;
-            if (!fillListOfRoads(map, route, start, previous)) {
-                correct = false;
-            }
-            else {
-                route->lastRoad->next = helpNode;
-                route->lastRoad = last;
-            }
-        }
+    if (!reserveChange(map)) {
+        correct = false;
     }
-    else if (node->next == route->lastRoad) {
-        nodeToRemove = route->lastRoad;
-        node->next = NULL;
-        route->lastRoad = node;
-        if (!fillListOfRoads(map, route, start, previous)) {
+    else if (before < after) {
+        if (!reserveRouteSpace(route, shift, 0)) {
             correct = false;
         }
+        else {
+            position = route->first + before;
+            memmove(route->roads + route->first - shift,
+                    route->roads + route->first, before * sizeof(Road *));
+            memmove(route->cities + route->first - shift,
+                    route->cities + route->first, before * sizeof(City *));
+            memmove(route->links + route->first - shift,
+                    route->links + route->first,
+                    before * sizeof(ListOfRoutes *));
+            route->first -= shift;
+            position -= shift;
+            updateLinksPositions(route, route->first, position);
+        }
     }
     else {
-        nodeToRemove = node->next;
-        helpNode = nodeToRemove->next;
-        route->lastRoad = node;
-        if (!fillListOfRoads(map, route, start, previous)) {
+        if (!reserveRouteSpace(route, 0, shift)) {
             correct = false;
         }
         else {
-            route->lastRoad->next = helpNode;
-            route->lastRoad = last;
+            position = route->first + before;
+            memmove(route->roads + position + 1 + shift,
+                    route->roads + position + 1, after * sizeof(Road *));
+            memmove(route->cities + position + 1 + shift,
+                    route->cities + position + 1, (after + 1) * sizeof(City *));
+            memmove(route->links + position + 1 + shift,
+                    route->links + position + 1,
+                    after * sizeof(ListOfRoutes *));
+            updateLinksPositions(route, position + 1 + shift,
+                                 position + 1 + shift + after);
         }
     }
 
-    free(nodeToRemove);
+    if (correct) {
+        route->numberOfRoads += shift;
+        clearRoutePart(route, position, position + shift + 1, position + 1,
+                       position + shift + 1);
+        logDetouredRoute(map, route, before, shift, road, link);
+        correct = writePath(map, route, position, city, previous);
+    }
 
     return correct;
 }
 
 bool removeRoadWithFillingRoutes(Map *map, Road *road) {
-    ListOfRoads *node;
     ListOfRoutes *routes = road->firstRoute;
     bool correct = true;
-    int previous[map->numberOfCities];
-    int start = -1, stop = -1;
+    Road **previous = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+    int start, stop;
+
+    if (previous == NULL) {
+        correct = false;
+    }
 
     while ((routes != NULL) && correct) {
-        node = findCorrectCitiesForDijkstra(&start, &stop, routes->route, road);
-        markVerticies(routes->route, true);
-        dijkstra(map, stop, start, previous);
-        fillTheRoute(map, routes->route, start, previous, node);
-        markVerticies(routes->route, false);
+        findDetourEnds(road, routes, &start, &stop);
+        if (!isDetourFound(map, routes->route, start, stop, previous)
+            || !fillTheRoute(map, routes->route, routes->position, start,
+                             previous)) {
+            correct = false;
+        }
         routes = routes->next;
     }
 
+    free(previous);
+
     return correct;
 }
 
-/**
- * @brief Usuwa drogę krajową z odcinka drogi.
- * @param[in,out] road       – wskaźnik na strukturę odcinka drogi;
- * @param[in] route          – wskaźnik na strukturę drogi krajowej.
- */
-static void removeRouteFromRoad(Road *road, Route *route) {
-    ListOfRoutes *node, *nodeToRemove;
-    bool end = false;
-
-    if (road->firstRoute->route == route) {
-        nodeToRemove = road->firstRoute;
-        if (road->lastRoute->route == route) {
-            road->firstRoute = NULL;
-            road->lastRoute = NULL;
-        }
-        else {
-            road->firstRoute = nodeToRemove->next;
-        }
+bool detachRoute(Map *map, ListOfRoutes *node) {
+    Route *route = node->route;
+    int last = route->first + route->numberOfRoads;
+    ListOfRoutes **cityNodes;
+    bool correct = true;
+
+    cityNodes = (ListOfRoutes **)malloc((route->numberOfRoads + 1)
+                                        * sizeof(ListOfRoutes *));
+    if ((cityNodes == NULL) || !reserveChange(map)) {
+        free(cityNodes);
+        correct = false;
     }
     else {
-        node = road->firstRoute;
-        while ((node != NULL) && (node->next != NULL) && !end) {
-            if (node->next->route == route) {
-                end = true;
-            }
-            else {
-                node = node->next;
+        for (int i = route->first; i <= last; i++) {
+            if (i < last) {
+                unlinkRouteNode(&route->roads[i]->firstRoute,
+                                &route->roads[i]->lastRoute, route->links[i]);
             }
+            cityNodes[i - route->first] = unlinkRouteFromCity(route->cities[i],
+                                                              route);
         }
-
-        nodeToRemove = node->next;
-        node->next = nodeToRemove->next;
-
-        if (nodeToRemove == road->lastRoute) {
-            road->lastRoute = node;
-        }
+        unlinkRouteNode(&map->firstRoute, &map->lastRoute, node);
+        logRemovedRoute(map, route, node, cityNodes);
     }
 
-    free(nodeToRemove);
+    return correct;
+}
+
+void discardRoute(Route *route) {
+    removeRouteFromRoads(route);
+    freeRoute(route);
 }
 
 void removeRouteFromRoads(Route *route) {
-    ListOfRoads *node = route->firstRoad;
-    ListOfRoads *helpNode = NULL;
+    int last = route->first + route->numberOfRoads;
 
-    while (node != NULL) {
-        removeRouteFromRoad(node->road, route);
-        helpNode = node;
-        node = node->next;
-        free(helpNode);
+    for (int i = route->first; i < last; i++) {
+        removeRouteFromRoad(route->roads[i], route->links[i]);
+        removeRouteFromCity(route->cities[i], route);
     }
+    removeRouteFromCity(route->cities[last], route);
 }
 
 /**
@@ -508,14 +659,15 @@ void removeRouteFromRoads(Route *route) {
  */
 static int lengthOfInteger(int x) {
     int counter = 0;
+    long long y = x;
 
-    if (x < 0) {
+    if (y < 0) {
         counter++;
-        x = -x;
+        y = -y;
     }
 
-    while (x > 0) {
-        x /= 10;
+    while (y > 0) {
+        y /= 10;
         counter++;
     }
 
@@ -540,42 +692,108 @@ static int lengthOfUnsigned(unsigned x) {
     return counter;
 }
 
-char const* routeDescription(Route *route) {
+/**
+ * @brief Tworzy opis drogi krajowej lub ścieżki.
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej;
+ * @param[in] withId         – informacja, czy opis ma się zaczynać od numeru
+ *                             drogi krajowej.
+ * @return Napis reprezentujący opis lub NULL, gdy nie udało się zaalokować
+ * pamięci.
+ */
+static char const* describeRoute(Route *route, bool withId) {
     char *description = NULL;
-    size_t size, tempSize, cityNameLength;
-    int lengthNumberLength, yearNumberLength;
-    ListOfRoads *node = route->firstRoad;
-    City *city = route->firstCity;
-
-    size = lengthOfUnsigned(route->id) + 1;
-    cityNameLength = strlen(route->firstCity->name) + 1;
-    description = (char *)malloc(size + cityNameLength);
+    size_t size = 0, tempSize;
+    int lengthNumberLength, yearNumberLength, written;
+    int i = route->first, last = route->first + route->numberOfRoads;
+    City *city = route->cities[i];
+    Road *road;
+
+    if (withId) {
+        size = lengthOfUnsigned(route->id) + 1;
+    }
+    description = (char *)malloc(size + city->nameLength + 1);
     if (description != NULL) {
-        sprintf(description, "%u;", route->id);
-        sprintf(description + size, "%s", city->name);
-        size += cityNameLength;
+        if (withId) {
+            sprintf(description, "%u;", route->id);
+        }
+        memcpy(description + size, city->name, city->nameLength + 1);
+        size += city->nameLength + 1;
     }
 
-    while ((node != NULL) && (description != NULL)) {
-        if (node->road->cityA == city) {
-            city = node->road->cityB;
-        }
-        else {
-            city = node->road->cityA;
-        }
-        
-        lengthNumberLength = lengthOfUnsigned(node->road->length) + 1;
-        yearNumberLength = lengthOfInteger(node->road->year) + 1;
-        cityNameLength = strlen(city->name) + 1;
-        tempSize = lengthNumberLength + yearNumberLength + cityNameLength;
+    while ((i < last) && (description != NULL)) {
+        road = route->roads[i];
+        city = route->cities[i + 1];
+
+        lengthNumberLength = lengthOfUnsigned(road->length) + 1;
+        yearNumberLength = lengthOfInteger(road->year) + 1;
+        tempSize = lengthNumberLength + yearNumberLength + city->nameLength + 1;
         description = (char *)realloc(description, size + tempSize);
         
         if (description != NULL) {
-            sprintf(description + size - 1, ";%u;%d;%s", node->road->length,
-                    node->road->year, city->name);
+            written = sprintf(description + size - 1, ";%u;%d;",
+                              road->length, road->year);
+            memcpy(description + size - 1 + written, city->name,
+                   city->nameLength + 1);
             size += tempSize;
-            node = node->next;
+            i++;
+        }
+    }
+
+    return description;
+}
+
+char const* routeDescription(Route *route) {
+    return describeRoute(route, true);
+}
+
+char const* pathDescription(Map *map, int start, Road *previous[]) {
+    const char *description = NULL;
+    Route *path = (Route *)malloc(sizeof(Route));
+    City *city = map->cities[start];
+    int length = pathLength(city, previous);
+
+    if (path != NULL) {
+        setRouteValues(path, 0);
+        if (reserveRouteSpace(path, 0, length)) {
+            for (int i = path->first; i < path->first + length; i++) {
+                path->roads[i] = previous[city->id];
+                path->cities[i] = city;
+                city = otherCity(map, previous[city->id], city);
+            }
+            path->cities[path->first + length] = city;
+            path->numberOfRoads = length;
+            description = describeRoute(path, false);
+        }
+        freeRoute(path);
+    }
+
+    return description;
+}
+
+char const* cityRoutesDescription(City *city) {
+    bool isRouteInCity[MAX_ROUTE_ID + 1] = {false};
+    char *description;
+    size_t size = 1;
+    ListOfRoutes *node = city->firstRoute;
+
+    while (node != NULL) {
+        isRouteInCity[node->route->id] = true;
+        size += MAX_ROUTE_ID_LENGTH + 1;
+        node = node->next;
+    }
+
+    description = (char *)malloc(size);
+    if (description != NULL) {
+        size = 0;
+        for (unsigned id = MIN_ROUTE_ID; id <= MAX_ROUTE_ID; id++) {
+            if (isRouteInCity[id]) {
+                if (size > 0) {
+                    description[size++] = ';';
+                }
+                size += sprintf(description + size, "%u", id);
+            }
         }
+        description[size] = '\0';
     }
 
     return description;
@@ -20,6 +20,7 @@ bool isCityNameCorrect(const char *name);
 
 /**
  * @brief Dodaje miasto o podanej nazwie do mapy.
+ * Zapisuje dodanie miasta w dzienniku zmian.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] name           – napis reprezentujący nazwę miasta.
  * @return Wskaźnik na nowoutworzone miasto lub wartość NULL, jeśli
@@ -29,6 +30,8 @@ City* addCity(Map *map, const char *name);
 
 /**
  * @brief Dodaje drogę podanych wartościach do mapy.
+ * Zapisuje dodanie drogi w dzienniku zmian. Jeśli nie udało się dodać drogi,
+ * mapa pozostaje niezmieniona.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] cityA          – wskaźnik na strukturę miasta;
  * @param[in] cityB          – wskaźnik na strukturę miasta;
@@ -39,6 +42,17 @@ City* addCity(Map *map, const char *name);
  */
 Road* newRoad(Map *map, City *cityA, City *cityB, unsigned length, int year);
 
+/**
+ * @brief Zmienia rok budowy lub ostatniego remontu odcinka drogi.
+ * Zapisuje zmianę w dzienniku zmian.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] road       – wskaźnik na strukturę odcinka drogi;
+ * @param[in] year           – nowy rok odcinka drogi.
+ * @return Wartość @p true, jeśli udało się zmienić rok.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool updateRoadYear(Map *map, Road *road, int year);
+
 /**
  * @brief Sprawdza, czy podana długość drogi jest poprawna.
  * @param[in] length         – długość drogi.
@@ -68,40 +82,97 @@ bool isRouteIdCorrect(unsigned routeId);
  * @brief Dodaje nową drogę krajową o podanych wartościach do mapy.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] id             – identyfikator drogi krajowej;
- * @param[in] start          – identyfikator miasta początkowego;
- * @param[in] stop           – identyfikator miasta końcowego;
- * @param[in] previous       – tablica identyfikatorów poprzedników miast.
+ * @param[in] start          – identyfikator miasta początkowego; drogę
+ *                             krajową tworzy ścieżka od tego miasta wyznaczona
+ *                             przez tablicę poprzedników;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Wskaźnik na nowoutworzoną drogę krajową lub NULL, gdy nie udało się
+ * zaalokować pamięci; wtedy mapa pozostaje niezmieniona.
+ */
+Route* addRoute(Map *map, unsigned id, int start, Road *previous[]);
+
+/**
+ * @brief Tworzy nową drogę krajową o przebiegu podanym w tablicach.
+ * W odróżnieniu od @ref addRoute nie potrzebuje tablicy poprzedników
+ * o rozmiarze liczby miast mapy, więc jej koszt zależy tylko od długości
+ * drogi krajowej.
+ * @param[in] id             – identyfikator drogi krajowej;
+ * @param[in] cities         – tablica wskaźników na kolejne miasta, o jeden
+ *                             element dłuższa od tablicy @p roads;
+ * @param[in] roads          – tablica wskaźników na kolejne odcinki dróg;
+ *                             odcinek @p roads[i] łączy miasta @p cities[i]
+ *                             oraz @p cities[i + 1];
+ * @param[in] numberOfRoads  – liczba odcinków dróg.
  * @return Wskaźnik na nowoutworzoną drogę krajową lub NULL, gdy nie udało się
- * zaalokować pamięci. 
+ * zaalokować pamięci; wtedy mapa pozostaje niezmieniona.
  */
-Route* addRoute(Map *map, unsigned id, int start, int stop, int previous[]);
+Route* addRouteAlong(unsigned id, City *cities[], Road *roads[],
+                     int numberOfRoads);
+
+/**
+ * @brief Tworzy drogę krajową o przebiegu podanym w tablicach i dodaje ją
+ * do mapy.
+ * Zapisuje dodanie drogi krajowej w dzienniku zmian. Jeśli nie udało się
+ * utworzyć drogi krajowej, mapa pozostaje niezmieniona.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – identyfikator drogi krajowej;
+ * @param[in] cities         – tablica wskaźników na kolejne miasta, o jeden
+ *                             element dłuższa od tablicy @p roads;
+ * @param[in] roads          – tablica wskaźników na kolejne odcinki dróg;
+ * @param[in] numberOfRoads  – liczba odcinków dróg.
+ * @return Wartość @p true, jeśli udało się utworzyć drogę krajową.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool addRouteAlongToMap(Map *map, unsigned id, City *cities[], Road *roads[],
+                        int numberOfRoads);
+
+/**
+ * @brief Usuwa drogę krajową z list dróg krajowych odcinków dróg i miast
+ * zapisanych w podanych fragmentach jej tablic.
+ * Pomija pozycje o wartości NULL.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] roadsFrom      – pierwsza pozycja odcinków dróg;
+ * @param[in] roadsTo        – pozycja za ostatnią pozycją odcinków dróg;
+ * @param[in] citiesFrom     – pierwsza pozycja miast;
+ * @param[in] citiesTo       – pozycja za ostatnią pozycją miast.
+ */
+void detachRoutePart(Route *route, int roadsFrom, int roadsTo, int citiesFrom,
+                     int citiesTo);
 
 /**
  * @brief Wydłuża drogę krajową od pierwszego miasta.
+ * Zapisuje zmianę w dzienniku zmian.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in,out] route      – wskaźnik na strukturę wydłużanej drogi krajowej;
  * @param[in] start          – identyfikator nowego miasta początkowego;
- * @param[in] previous       – tablica identyfikatorów poprzedników miast.
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
  * @return Wartość @p true, jeśli udało się wydłużyć drogę.
  * Wartość @p false, w przeciwnym przypadku.
  */
-bool extendFromFirstCity(Map *map, Route *route, int start, int previous[]);
+bool extendFromFirstCity(Map *map, Route *route, int start,
+                         Road *previous[]);
 
 /**
  * @brief Wydłuża drogę krajową od ostatniego miasta.
+ * Zapisuje zmianę w dzienniku zmian.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in,out] route      – wskaźnik na strukturę wydłużanej drogi krajowej;
  * @param[in] start          – identyfikator miasta, od którego wydłużamy drogę;
- * @param[in] previous       – tablica identyfikatorów poprzedników miast.
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
  * @return Wartość @p true, jeśli udało się wydłużyć drogę.
  * Wartość @p false, w przeciwnym przypadku.
  */
-bool extendFromLastCity(Map *map, Route *route, int start, int previous[]);
+bool extendFromLastCity(Map *map, Route *route, int start, Road *previous[]);
 
 /**
  * @brief Sprawdza, czy odcinek drogi może zostać usunięty.
  * Sprawdza, czy da się utworzyć objazd dla każdej drogi krajowej, której
  * elementem jest podany odcinek drogi.
+ * Objazd jest wyszukiwany w obu kierunkach, aby usunięcie odcinka nie
+ * zakończyło się niepowodzeniem w trakcie uzupełniania dróg krajowych.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] road           – wskaźnik na strukturę odcinka drogi.
  * @return Wartość @p true, jeśli można usunąć podany odcinek drogi.
@@ -110,22 +181,13 @@ bool extendFromLastCity(Map *map, Route *route, int start, int previous[]);
 bool canRoadBeRemoved(Map *map, Road *road);
 
 /**
- * @brief Usuwa dany odcinek drogi z miasta.
- * Szuka w mieście węzła listy odcinków dróg zawierającego dany odcinek
- * drogi, a następnie usuwa ten węzeł z listy.
- * @param[in,out] city       – wskaźnik na strukturę miasta;
- * @param[in] road           – wskaźnik na strukturę odcinka drogi.
- */
-void removeListOfRoadsNodeFromCity(City *city, Road *road);
-
-/**
- * @brief Usuwa dany odcinek drogi z mapy.
- * Szuka w mapie węzła listy odcinków dróg zawierającego dany odcinek drogi,
- * a następnie usuwa ten węzeł z listy oraz dany odcinek drogi z mapy.
+ * @brief Odłącza odcinek drogi od list odcinków dróg mapy i jego miast.
+ * Zapisuje usunięcie odcinka drogi w dzienniku zmian, który zwolni jego pamięć
+ * przy zatwierdzeniu zmian. Zakłada, że w dzienniku jest miejsce na zmianę.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] road           – wskaźnik na strukturę odcinka drogi.
  */
-void removeRoadFromMap(Map *map, Road *road);
+void detachRoad(Map *map, Road *road);
 
 /**
  * @brief Usuwa dany odcinek drogi z list tworząc objazd w drodze krajowej.
@@ -137,12 +199,29 @@ void removeRoadFromMap(Map *map, Road *road);
 bool removeRoadWithFillingRoutes(Map *map, Road *road);
 
 /**
- * @brief Usuwa drogę krajową z odcinków dróg, jednocześnie usuwając węzły
- * listy odcinków dróg z drogi krajowej.
+ * @brief Usuwa drogę krajową z list dróg krajowych wszystkich jej odcinków
+ * dróg oraz miast.
  * @param[in,out] route      – wskaźnik na strukturę drogi krajowej.
  */
 void removeRouteFromRoads(Route *route);
 
+/**
+ * @brief Odłącza drogę krajową od mapy, jej odcinków dróg i miast.
+ * Zapisuje usunięcie drogi krajowej w dzienniku zmian, który zwolni jej pamięć
+ * przy zatwierdzeniu zmian.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] node           – wskaźnik na węzeł listy dróg krajowych mapy.
+ * @return Wartość @p true, jeśli udało się odłączyć drogę krajową.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool detachRoute(Map *map, ListOfRoutes *node);
+
+/**
+ * @brief Usuwa drogę krajową, która nie została dodana do mapy.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej.
+ */
+void discardRoute(Route *route);
+
 /**
  * @brief Tworzy opis drogi krajowej.
  * Alokuje pamięć potrzebną do utworzenia opisu oraz skleja parametry w napis.
@@ -152,6 +231,28 @@ void removeRouteFromRoads(Route *route);
  */
 char const* routeDescription(Route *route);
 
+/**
+ * @brief Tworzy opis ścieżki wyznaczonej przez tablicę poprzedników.
+ * Opis ma format opisu drogi krajowej bez jej numeru.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] start          – identyfikator miasta początkowego;
+ * @param[in] previous       – tablica odcinków dróg prowadzących do
+ *                             poprzedników miast.
+ * @return Napis reprezentujący opis ścieżki lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+char const* pathDescription(Map *map, int start, Road *previous[]);
+
+/**
+ * @brief Tworzy listę numerów dróg krajowych przechodzących przez miasto.
+ * Alokuje pamięć na napis zawierający rosnący ciąg numerów dróg krajowych
+ * oddzielonych średnikami.
+ * @param[in] city           – wskaźnik na strukturę miasta.
+ * @return Napis z numerami dróg krajowych lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+char const* cityRoutesDescription(City *city);
+
 /**
  * @brief Sprawdza, czy podana liczba mieści się w zakresie typu int.
  * @param[in] x              – liczba typu long.
@@ -10,11 +10,16 @@
 
 #include "stdbool.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+#define INFINITE_DISTANCE UINT64_MAX ///< odległość do nieosiągalnego wierzchołka
+
 /**
- * Struktura przechowująca węzeł potrzebny do wyszukiwania
+ * Struktura przechowująca dane wierzchołków potrzebne do wyszukiwania
  * najkrótszej ścieżki w grafie.
  */
-typedef struct Vertex Vertex;
+typedef struct Vertices Vertices;
 
 /**
  * Struktura przechowująca listę odcinków dróg.
@@ -41,44 +46,127 @@ typedef struct City City;
  */
 typedef struct Route Route;
 
+/**
+ * Struktura przechowująca blok pamięci na nazwy miast.
+ */
+typedef struct NamesBlock NamesBlock;
+
+/**
+ * Struktura przechowująca zmianę mapy zapisaną w dzienniku zmian.
+ */
+typedef struct Change Change;
+
+/**
+ * Struktura przechowująca dziennik zmian mapy.
+ */
+typedef struct UndoLog UndoLog;
+
+/**
+ * Struktura przechowująca wersje mapy udostępniane czytelnikom.
+ */
+typedef struct Versions Versions;
+
+
+/**
+ * @brief Struktura przechowująca dane wierzchołków potrzebne do wyszukiwania
+ * najkrótszej ścieżki w grafie.
+ * Wierzchołki są jednoznacznie powiązane z miastami, a ich dane przechowywane
+ * są w osobnych tablicach indeksowanych identyfikatorami miast, dzięki czemu
+ * przy wyszukiwaniu ścieżki odczytywane są tylko potrzebne pola.
+ * Struktura wierzchołków zawiera tablice:
+ * odległości wierzchołków od źródła przy obliczaniu najkrótszej ścieżki,
+ * przechowywanych na 64 bitach, aby suma długości odcinków dróg nie mogła się
+ * przepełnić;
+ * lat budowy lub ostatniego remontu najstarszych odcinków dróg, prowadzących
+ * do wierzchołków;
+ * znaczników, równych znacznikowi mapy wtedy i tylko wtedy, gdy wierzchołek
+ * jest oznaczony, np. jako należący do drogi krajowej omijanej przy
+ * wyszukiwaniu ścieżki;
+ * informacji o tym, czy w ścieżce do wierzchołka wystąpił błąd;
+ * numerów wyszukiwań, w których wierzchołki zostały osiągnięte.
+ * Zawiera też numer bieżącego wyszukiwania. Pozostałe wartości wierzchołka są
+ * aktualne tylko wtedy, gdy został on osiągnięty w bieżącym wyszukiwaniu,
+ * dzięki czemu wyszukiwanie nie musi ich ustawiać dla całego grafu.
+ */
+struct Vertices {
+    uint64_t *distance; ///< tablica odległości wierzchołków od źródła
+    int *oldestYear;    ///< tablica lat budowy najstarszych odcinków dróg
+    unsigned *mark;     ///< tablica znaczników oznaczenia wierzchołków
+    bool *error;        ///< tablica informacji o błędach
+    unsigned *reached;  ///< tablica numerów wyszukiwań osiągnięcia wierzchołków
+    unsigned search;    ///< numer bieżącego wyszukiwania
+};
+
+/**
+ * @brief Struktura przechowująca dziennik zmian mapy.
+ * Funkcje zmieniające mapę zapisują w dzienniku tylko zmienione elementy
+ * i dane potrzebne do cofnięcia zmiany, a usuwane elementy zwalniają dopiero
+ * przy zatwierdzeniu zmian. Dzięki temu nieudane polecenie lub cała grupa
+ * poleceń może zostać wycofana bez kopiowania mapy.
+ * Struktura dziennika zawiera:
+ * tablicę zapisanych zmian, ich liczbę i rozmiar tablicy;
+ * liczbę zmian zapisanych przed rozpoczęciem bieżącego polecenia;
+ * informacje o tym, czy grupa zmian jest otwarta i czy wystąpił w niej błąd.
+ */
+struct UndoLog {
+    Change *changes;     ///< tablica zapisanych zmian
+    int numberOfChanges; ///< liczba zapisanych zmian
+    int size;            ///< rozmiar tablicy zmian
+    int savepoint;       ///< liczba zmian sprzed bieżącego polecenia
+    bool batch;          ///< informacja o tym, czy grupa zmian jest otwarta
+    bool failed;         ///< informacja o błędzie w grupie zmian
+};
 
 /**
  * @brief Struktura przechowująca mapę dróg krajowych.
  * Struktura mapy zawiera:
  * tablicę wskaźników na miasta oraz ich liczbę i rozmiar tablicy;
+ * tablice danych wierzchołków powiązanych z miastami, o rozmiarze tablicy
+ * wskaźników na miasta;
+ * tablicę mieszającą identyfikatorów miast, indeksowaną skrótami ich nazw;
+ * bieżący znacznik oznaczonych wierzchołków;
+ * ograniczenia długości objazdów i liczby miast przeglądanych przy ich
+ * wyszukiwaniu;
+ * listę bloków pamięci, w których przechowywane są nazwy miast;
  * wskaźniki na pierwszy i ostatni element listy zawierającej odcinki dróg;
- * wskaźniki na pierwszy i ostatni element listy zawierającej drogi krajowe.
+ * wskaźniki na pierwszy i ostatni element listy zawierającej drogi krajowe;
+ * dziennik zmian;
+ * wersje mapy udostępniane czytelnikom, jeśli są publikowane.
  */
 struct Map {
     int numberOfCities;       ///< liczba miast
     int sizeOfCitiesArray;    ///< rozmiar tablicy wskaźników na miasta
     City **cities;            ///< tablica wskaźników na miasta
+    Vertices vertices;        ///< tablice danych wierzchołków
+    int sizeOfCitiesIndex;    ///< rozmiar tablicy mieszającej miast
+    int *citiesIndex;         ///< tablica mieszająca identyfikatorów miast
+    NamesBlock *namesBlock;   ///< wskaźnik na bieżący blok pamięci na nazwy
+    unsigned mark;            ///< znacznik bieżąco oznaczonych wierzchołków
+    uint64_t maxDetourLength; ///< największa długość objazdu
+    int maxDetourCities;      ///< największa liczba miast przeglądanych
     ListOfRoads *firstRoad;   ///< wskaźnik na pierwszą drogę
     ListOfRoads *lastRoad;    ///< wskaźnik na ostatnią drogę
     ListOfRoutes *firstRoute; ///< wskaźnik na pierwszą drogę krajową
     ListOfRoutes *lastRoute;  ///< wskaźnik na ostatnią drogę krajową
+    UndoLog undoLog;          ///< dziennik zmian
+    Versions *versions;       ///< wskaźnik na wersje mapy lub NULL
 };
 
 /**
- * @brief Struktura przechowująca węzeł potrzebny do wyszukiwania najkrótszej
- * ścieżki w grafie.
- * Struktura wierzchołka zawiera:
- * identyfikator;
- * odległość wierzchołka od źródła przy obliczniu najkrótszej ścieżki w grafie;
- * informację o tym, czy dane miasto, jednoznacznie połączone z wierzchołkiem,
- * zostało użyte w drodze krajowej;
- * wskaźnik na odcinek drogi, potrzebny do zbudowania drogi krajowej;
- * informację o roku budowy lub ostatniego remontu najstarszego odcinka drogi,
- * prowadzącego do danego wierzchołka;
- * informację o tym, czy w podanej ścieżce podczas tworzenia drogi wystąpił błąd.
- */
-struct Vertex {
-    int id;                 ///< identyfikator wierzchołka
-    int distanceFromSource; ///< odległość wierzchołka od źródłą
-    bool usedInRoute;       ///< informacja o tym, czy miasto jest użyte w drodze
-    Road *road;             ///< wskaźnik na strukturę odcinka drogi
-    int oldestYear;         ///< rok budowy lub ostatniego remontu najstarszej drogi
-    bool error;             ///< informacja o błędzie
+ * @brief Struktura przechowująca blok pamięci na nazwy miast.
+ * Nazwy miast są zapisywane jedna za drugą w kolejnych blokach, dzięki czemu
+ * nie wymagają osobnych alokacji, a raz zapisana nazwa nigdy nie zmienia
+ * położenia w pamięci.
+ * Struktura bloku zawiera:
+ * wskaźnik na poprzednio zaalokowany blok;
+ * rozmiar bloku oraz liczbę zajętych w nim bajtów;
+ * tablicę znaków, w której zapisywane są nazwy.
+ */
+struct NamesBlock {
+    NamesBlock *previous; ///< wskaźnik na poprzedni blok
+    size_t size;          ///< rozmiar tablicy znaków
+    size_t used;          ///< liczba zajętych znaków
+    char names[];         ///< tablica znaków z nazwami miast
 };
 
 /**
@@ -94,19 +182,29 @@ struct ListOfRoads {
 
 /**
  * @brief Struktura przechowująca listę dróg krajowych.
+ * W listach dróg krajowych odcinków dróg węzeł opisuje przynależność odcinka
+ * do drogi krajowej: przechowuje pozycję odcinka w tablicach drogi krajowej
+ * oraz jego kierunek, dzięki czemu odcinek można odnaleźć w drodze krajowej,
+ * a węzeł usunąć z listy, w czasie stałym.
  * Struktura listy dróg krajowych zawiera:
  * wskaźnik na powiązaną drogę krajową;
- * wskaźnik na następny element listy.
+ * wskaźniki na poprzedni i następny element listy;
+ * pozycję odcinka drogi w tablicach drogi krajowej;
+ * informację o tym, czy droga krajowa przechodzi przez odcinek od miasta
+ * @p cityA do miasta @p cityB.
  */
 struct ListOfRoutes {
-    Route *route;       ///< wskaźnik na drogę krajową
-    ListOfRoutes *next; ///< wskaźnik na następny element
+    Route *route;           ///< wskaźnik na drogę krajową
+    ListOfRoutes *previous; ///< wskaźnik na poprzedni element
+    ListOfRoutes *next;     ///< wskaźnik na następny element
+    int position;           ///< pozycja odcinka drogi w drodze krajowej
+    bool forward;           ///< informacja o kierunku przejścia przez odcinek
 };
 
 /**
  * @brief Struktura przechowująca odcinek drogi.
  * Struktura odcinka drogi zawiera: 
- * wskaźniki na miasta, które dany odcinek łączy;
+ * identyfikatory miast, które dany odcinek łączy;
  * długość odcinka drogi;
  * rok budowy lub ostatniego remontu odcinka drogi;
  * zmienną określającą, czy dany odcinek drogi ma zostać usunięty,
@@ -114,8 +212,8 @@ struct ListOfRoutes {
  * wskaźniki na pierwszą i ostatnią drogę krajową zawierającą dany odcinek.
  */
 struct Road {
-    City *cityA;              ///< wskaźnik na strukturę miasta
-    City *cityB;              ///< wskaźnik na strukturę miasta
+    int cityA;                ///< identyfikator miasta
+    int cityB;                ///< identyfikator miasta
     unsigned length;          ///< długość odcinka drogi
     int year;                 ///< rok budowy lub ostatniego remontu odcinka drogi
     bool toRemove;            ///< informacja o tym, czy droga jest do usunięcia
@@ -126,31 +224,48 @@ struct Road {
 /**
  * @brief Struktura przechowująca miasto.
  * Struktura miasta zawiera:
- * nazwę miasta;
+ * nazwę miasta wraz z jej długością i skrótem;
  * wskaźniki na pierwszy i ostatni element listy odcinków dróg;
- * wskaźnik na powiązany z danym miastem wierzchołek,
- * wykorzystywany przy obliczaniu najkrótszej ścieżki w grafie.
+ * wskaźniki na pierwszy i ostatni element listy dróg krajowych
+ * przechodzących przez miasto;
+ * identyfikator miasta, będący indeksem w tablicy miast oraz w tablicach
+ * danych wierzchołków mapy.
  */
 struct City {
     const char *name;       ///< nazwa miasta
+    size_t nameLength;      ///< długość nazwy miasta
+    unsigned nameHash;      ///< skrót nazwy miasta
     ListOfRoads *firstRoad; ///< wskaźnik na pierwszą drogę
     ListOfRoads *lastRoad;  ///< wskaźnik na ostatnią drogę
-    Vertex *vertex;         ///< wskaźnik na powiązany z miastem wierzchołek
+    ListOfRoutes *firstRoute; ///< wskaźnik na pierwszą drogę krajową
+    ListOfRoutes *lastRoute;  ///< wskaźnik na ostatnią drogę krajową
+    int id;                 ///< identyfikator miasta
 };
 
 /**
  * @brief Struktura przechowująca drogę krajową.
+ * Przebieg drogi krajowej jest przechowywany w ciągłych tablicach, w których
+ * po obu stronach zajętego fragmentu zostawiane jest wolne miejsce, dzięki
+ * czemu drogę można wydłużać z obu końców bez przesuwania jej elementów.
+ * Odcinek @p roads[i] łączy miasta @p cities[i] oraz @p cities[i + 1].
  * Struktura drogi krajowej zawiera:
- * identyfikator; 
- * wskaźniki na pierwszy i ostatni element listy odcinków dróg;
- * wskaźniki na pierwsze i ostatnie miasto należące do danej drogi krajowej.
+ * identyfikator;
+ * indeks pierwszego zajętego elementu tablic oraz liczbę odcinków dróg;
+ * rozmiar tablicy wskaźników na odcinki dróg;
+ * tablicę wskaźników na kolejne odcinki dróg;
+ * tablicę wskaźników na kolejne miasta, o jeden element dłuższą od tablicy
+ * odcinków dróg;
+ * tablicę wskaźników na węzły list dróg krajowych kolejnych odcinków dróg,
+ * odpowiadające tej drodze krajowej.
  */
 struct Route {
     unsigned id;            ///< identyfikator drogi krajowej
-    ListOfRoads *firstRoad; ///< wskaźnik na pierwszą drogę
-    ListOfRoads *lastRoad;  ///< wskaźnik na ostatnią drogę
-    City *firstCity;        ///< wskaźnik na pierwsze miasto
-    City *lastCity;         ///< wskaźnik na ostatnie miasto
+    int first;              ///< indeks pierwszego odcinka drogi w tablicy
+    int numberOfRoads;      ///< liczba odcinków dróg w drodze krajowej
+    int size;               ///< rozmiar tablicy wskaźników na odcinki dróg
+    Road **roads;           ///< tablica wskaźników na kolejne odcinki dróg
+    City **cities;          ///< tablica wskaźników na kolejne miasta
+    ListOfRoutes **links;   ///< tablica wskaźników na węzły w odcinkach dróg
 };
 
 #endif /* __HELP_STRUCTURES_H__ */
\ No newline at end of file
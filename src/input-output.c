@@ -8,47 +8,141 @@
 #define _GNU_SOURCE
 
 #include "input-output.h"
+#include "map-pool.h"
+#include "partition.h"
 #include "help-functions.h"
+#include "string-scan.h"
+#include "undo-log.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#define PIPELINE_SIZE 1024 ///< liczba poleceń w buforze cyklicznym potoku
+#define PIPELINE_SPINS 64  ///< liczba prób przed uśpieniem wątku potoku
+#define MAX_KEPT_LINE 1024 ///< największy zachowywany bufor linii polecenia
+#define MAX_KEPT_ROUTE 64  ///< największa zachowywana liczba miast polecenia
+#define MAX_PIPELINE_BYTES (16 << 20) ///< limit buforów czekających poleceń
+#define CACHE_LINE 64      ///< rozmiar linii pamięci podręcznej procesora
 
 /**
- * @brief Drukuje informację o błędzie standardowe wyjście diagnostyczne.
- * @param[in] lineNumber     – numer linii, w której wystąpił błąd.
+ * Rodzaj polecenia przekazywanego przez wątek czytający.
  */
-static void printError(int lineNumber) {
-    fprintf(stderr, "ERROR %d\n", lineNumber);
+typedef enum CommandKind CommandKind;
+
+/**
+ * Struktura przechowująca wczytane polecenie.
+ */
+typedef struct Command Command;
+
+/**
+ * Struktura przechowująca bufor cykliczny poleceń.
+ */
+typedef struct Pipeline Pipeline;
+
+/**
+ * @brief Rodzaj polecenia przekazywanego przez wątek czytający.
+ */
+enum CommandKind {
+    INCORRECT_COMMAND, ///< polecenie, o którym już wiadomo, że jest błędne
+    PARSED_ROUTE,      ///< sparsowane polecenie utworzenia drogi krajowej
+    UNPARSED_COMMAND   ///< polecenie parsowane dopiero przy wykonaniu
+};
+
+/**
+ * @brief Struktura przechowująca wczytane polecenie.
+ * Struktura zawiera:
+ * rodzaj polecenia i numer linii, w której zostało wczytane;
+ * wczytaną linię wraz z rozmiarem jej bufora;
+ * dla polecenia utworzenia drogi krajowej jej numer, liczbę miast oraz tablice
+ * pomocnicze z jej danymi, używane też przy jej tworzeniu;
+ * łączny rozmiar buforów polecenia w chwili przekazania go do wykonania.
+ * Bufory są zachowywane między kolejnymi poleceniami zapisywanymi w tym samym
+ * miejscu bufora cyklicznego, o ile nie są większe niż @ref MAX_KEPT_LINE
+ * znaków i @ref MAX_KEPT_ROUTE miast.
+ */
+struct Command {
+    CommandKind kind;    ///< rodzaj polecenia
+    int lineNumber;      ///< numer linii
+    char *line;          ///< wczytana linia
+    size_t lineSize;     ///< rozmiar bufora linii
+    unsigned routeId;    ///< numer drogi krajowej
+    int numberOfCities;  ///< liczba miast w drodze krajowej
+    RouteData route;     ///< tablice pomocnicze drogi krajowej
+    size_t bytes;        ///< rozmiar buforów polecenia
+};
+
+/**
+ * @brief Struktura przechowująca bufor cykliczny poleceń.
+ * Do bufora pisze tylko wątek czytający, a czyta z niego tylko wątek
+ * wykonujący polecenia, więc wystarczą liczniki wstawionych i wykonanych
+ * poleceń, zmieniane tylko przez jeden z wątków. Liczniki są w osobnych
+ * liniach pamięci podręcznej, żeby wątki nie unieważniały sobie nawzajem
+ * danych. Wątek, który przez @ref PIPELINE_SPINS prób nie doczekał się zmiany
+ * licznika drugiego wątku, zasypia na zmiennej warunkowej. Wątek czytający
+ * czeka też, gdy bufory niewykonanych poleceń zajmują więcej niż
+ * @ref MAX_PIPELINE_BYTES bajtów, więc długie linie nie są wczytywane
+ * dużo wcześniej, niż zostaną wykonane.
+ * Struktura zawiera:
+ * tablicę poleceń;
+ * liczbę poleceń wstawionych do bufora i liczbę poleceń wykonanych;
+ * łączny rozmiar buforów niewykonanych poleceń;
+ * informację o tym, czy wątek czytający skończył pracę;
+ * muteks, zmienną warunkową i liczbę uśpionych wątków.
+ */
+struct Pipeline {
+    Command commands[PIPELINE_SIZE];        ///< tablica poleceń
+    _Alignas(CACHE_LINE) atomic_size_t head; ///< liczba wstawionych poleceń
+    _Alignas(CACHE_LINE) atomic_size_t tail; ///< liczba wykonanych poleceń
+    atomic_size_t bytes;                     ///< rozmiar buforów poleceń
+    atomic_bool finished;                    ///< informacja o końcu danych
+    atomic_int sleeping;                     ///< liczba uśpionych wątków
+    pthread_mutex_t mutex;                   ///< muteks usypiania wątków
+    pthread_cond_t changed;                  ///< zmienna warunkowa zmiany
+};
+
+void printError(Map *map, int lineNumber, Output *output) {
+    failBatch(map);
+    fprintf(output->errors, "ERROR %d\n", lineNumber);
 }
 
 /**
- * @brief Daje w wyniku wskaźnik na następny parametr.
- * Przechodzi po napisie do czasu napotkania znaku ';', następnie wstawia
- * w jego miejsce znak końca napisu i przesuwa wskaźnik @p parameters na
- * pierwszy element po wstawionym znaku końca napisu.
+ * @brief Daje w wyniku wskaźnik na następny parametr i jego długość.
+ * Szuka w napisie pierwszego znaku ';' lub '\n'. Znak ';' bezpośrednio przed
+ * znakiem nowej linii nie kończy parametru, więc wtedy parametr kończy się
+ * na znaku nowej linii. W miejsce znaku kończącego parametr wstawia znak końca
+ * napisu i przesuwa wskaźnik @p parameters na pierwszy element po nim.
  * Nic nie robi, jeśli wskaźnik podany jako parametr ma wartość NULL.
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami;
+ * @param[out] length        – długość parametru.
  * @return Wskaźnik na pierwszy element parametru lub NULL, gdy w podanym
  * jako parametr napisie nie ma znaku ';', lub jeśli znak ';' jest ostatnim
  * znakiem w napisie przed znakiem nowej linii.
  */
-static char* getParameter(char **parameters) {
+static char* getToken(char **parameters, size_t *length) {
     char *param = *parameters;
-    int i = 0;
-    bool end = false;
+    size_t i;
 
-    if (*parameters != NULL) {
-        while ((param[i] != '\0') && !end) {
-            if (((param[i] == ';') && (param[i + 1] != '\n'))
-                || (param[i] == '\n')) {
-                *parameters += i + 1;
-                param[i] = '\0';
-                end = true;
-            }
+    if (param != NULL) {
+        i = strcspn(param, ";\n");
+        if ((param[i] == ';') && (param[i + 1] == '\n')) {
             i++;
         }
 
-        if (!end) {
+        if (param[i] != '\0') {
+            *parameters += i + 1;
+            param[i] = '\0';
+            *length = i;
+        }
+        else {
             param = NULL;
         }
     }
@@ -56,37 +150,189 @@ static char* getParameter(char **parameters) {
     return param;
 }
 
+char* getParameter(char **parameters) {
+    size_t length;
+
+    return getToken(parameters, &length);
+}
+
 /**
- * @brief Sprawdza czy podany jako parametr napis może być liczbą.
- * Przechodzi (aż do napotkania znaku końca napisu) po każdym znaku podanego
- * jako parametr napisu i sprawdza czy dany znak jest znakiem reprezentującym
- * cyfrę. Jeśli liczba nie musi być nieujemna, funckja pomija pierwszy znak.
- * @param[in] string         – wskaźnik na pierwszy element sprawdzanego napisu;
- * @param[in] isUnsigned     – zmienna zawierająca informację o tym czy dana 
- *                             liczba ma być nieujemna.
- * @return Wartość @p true, jeśli podany napis może być liczbą.
+ * @brief Sprawdza i oblicza wartość krótkiego ciągu cyfr, cyfra po cyfrze.
+ * @param[in] digits         – wskaźnik na pierwszy znak ciągu;
+ * @param[in] size           – liczba znaków ciągu, co najwyżej 8;
+ * @param[out] value         – wartość ciągu.
+ * @return Wartość @p true, jeśli ciąg składa się z samych cyfr.
  * Wartość @p false, w przeciwnym przypadku.
  */
-static bool isNumber(char *string, bool isUnsigned) {
-    int i = 0;
-    bool number = true;
+static bool digitsValue(const char *digits, size_t size, uint64_t *value) {
+    size_t i = 0;
+    bool correct = true;
 
-    if ((string[0] == '-') && !isUnsigned) {
+    *value = 0;
+    while ((i < size) && correct) {
+        if ((digits[i] < '0') || (digits[i] > '9')) {
+            correct = false;
+        }
+        else {
+            *value = *value * 10 + (digits[i] - '0');
+        }
         i++;
     }
 
-    while ((string[i] != '\0') && number) {
-        if ((string[i] < '0') || (string[i] > '9')) {
-            number = false;
+    return correct;
+}
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/**
+ * @brief Sprawdza i oblicza wartość ciągu 8 cyfr.
+ * Wczytuje ciąg do jednego słowa maszynowego i przetwarza wszystkie jego
+ * cyfry naraz: sprawdza, czy każdy bajt jest z przedziału od '0' do '9',
+ * a następnie składa wartości cyfr parami, czwórkami i ósemkami.
+ * @param[in] digits         – wskaźnik na pierwszy znak ciągu;
+ * @param[out] value         – wartość ciągu.
+ * @return Wartość @p true, jeśli ciąg składa się z samych cyfr.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool eightDigitsValue(const char *digits, uint64_t *value) {
+    uint64_t chunk;
+
+    memcpy(&chunk, digits, sizeof(chunk));
+    if (((chunk & 0xF0F0F0F0F0F0F0F0)
+         | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+        != 0x3333333333333333) {
+        return false;
+    }
+    else {
+        chunk = (chunk & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+        chunk = (chunk & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+        *value = (chunk & 0x0000FFFF0000FFFF) * 42949672960001 >> 32;
+        return true;
+    }
+}
+
+#else
+
+/**
+ * @brief Sprawdza i oblicza wartość ciągu 8 cyfr.
+ * @param[in] digits         – wskaźnik na pierwszy znak ciągu;
+ * @param[out] value         – wartość ciągu.
+ * @return Wartość @p true, jeśli ciąg składa się z samych cyfr.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool eightDigitsValue(const char *digits, uint64_t *value) {
+    return digitsValue(digits, 8, value);
+}
+
+#endif
+
+/**
+ * @brief Sprawdza i oblicza wartość ciągu cyfr.
+ * Początkowe cyfry, których liczba jest resztą z dzielenia długości ciągu
+ * przez 8, przetwarza pojedynczo, a pozostałe fragmentami po 8 cyfr.
+ * Przerywa, gdy tylko wartość przekroczy podane ograniczenie. Przed
+ * dołączeniem fragmentu sprawdza, czy wynik nie przekroczy ograniczenia,
+ * więc obliczenia mieszczą się w 64 bitach dla każdego ograniczenia.
+ * @param[in] digits         – wskaźnik na pierwszy znak ciągu;
+ * @param[in] length         – liczba znaków ciągu;
+ * @param[in] limit          – największa dopuszczalna wartość;
+ * @param[out] value         – wartość ciągu.
+ * @return Wartość @p true, jeśli ciąg składa się z samych cyfr, a jego wartość
+ * nie przekracza ograniczenia. Wartość @p false, w przeciwnym przypadku.
+ */
+static bool parseDigits(const char *digits, size_t length, uint64_t limit,
+                        uint64_t *value) {
+    uint64_t chunk;
+    size_t i = length % 8;
+    bool correct = true;
+
+    if (!digitsValue(digits, i, value) || (*value > limit)) {
+        correct = false;
+    }
+
+    while ((i < length) && correct) {
+        if (!eightDigitsValue(digits + i, &chunk) || (chunk > limit)
+            || (*value > (limit - chunk) / 100000000)) {
+            correct = false;
         }
-        i++;
+        else {
+            *value = *value * 100000000 + chunk;
+        }
+        i += 8;
     }
 
-    if (i == 0) {
-        number = false;
+    return correct;
+}
+
+bool getUnsignedParameter(char **parameters, unsigned *value) {
+    size_t length = 0;
+    char *param = getToken(parameters, &length);
+    uint64_t number;
+    bool correct = false;
+
+    if ((param != NULL) && (length > 0)
+        && parseDigits(param, length, UINT_MAX, &number)) {
+        *value = (unsigned)number;
+        correct = true;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wyodrębnia następny parametr i parsuje go na 64-bitową liczbę
+ * nieujemną.
+ * Parametr musi być niepustym ciągiem cyfr o wartości mieszczącej się
+ * w typie @p uint64_t.
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami;
+ * @param[out] value         – wartość parametru.
+ * @return Wartość @p true, jeśli parametr istnieje i jest poprawną liczbą.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool getUnsigned64Parameter(char **parameters, uint64_t *value) {
+    size_t length = 0;
+    char *param = getToken(parameters, &length);
+    bool correct = false;
+
+    if ((param != NULL) && (length > 0)
+        && parseDigits(param, length, UINT64_MAX, value)) {
+        correct = true;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wyodrębnia następny parametr i parsuje go na liczbę całkowitą.
+ * Parametr musi być niepustym ciągiem cyfr, poprzedzonym opcjonalnie znakiem
+ * '-', o wartości mieszczącej się w typie @p int. Parametr złożony z samego
+ * znaku '-' ma wartość 0.
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami;
+ * @param[out] value         – wartość parametru.
+ * @return Wartość @p true, jeśli parametr istnieje i jest poprawną liczbą.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool getIntegerParameter(char **parameters, int *value) {
+    size_t length = 0;
+    char *param = getToken(parameters, &length);
+    uint64_t number;
+    bool correct = false;
+
+    if ((param != NULL) && (length > 0)) {
+        if (param[0] == '-') {
+            if (parseDigits(param + 1, length - 1, (uint64_t)INT_MAX + 1,
+                            &number)) {
+                *value = (int)(-(int64_t)number);
+                correct = true;
+            }
+        }
+        else if (parseDigits(param, length, INT_MAX, &number)) {
+            *value = (int)number;
+            correct = true;
+        }
     }
 
-    return number;
+    return correct;
 }
 
 /**
@@ -97,43 +343,33 @@ static bool isNumber(char *string, bool isUnsigned) {
  * o błędzie, jeśli podczas działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję.
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void addRoadCommand(Map *map, char *parameters, int lineNumber) {
-    char *city1, *city2, *length, *builtYear;
-    unsigned long lengthNumber;
-    long yearNumber;
+static void addRoadCommand(Map *map, char *parameters, int lineNumber,
+                           Output *output) {
+    char *city1, *city2;
+    unsigned lengthNumber;
+    int yearNumber;
     bool error = false;
 
     city1 = getParameter(&parameters);
     city2 = getParameter(&parameters);
-    length = getParameter(&parameters);
-    builtYear = getParameter(&parameters);
 
-    if ((city1 == NULL) || (city2 == NULL) || (length == NULL)
-        || (builtYear == NULL) || (parameters[0] != '\0')) {
+    if ((city1 == NULL) || (city2 == NULL)
+        || !getUnsignedParameter(&parameters, &lengthNumber)
+        || !getIntegerParameter(&parameters, &yearNumber)
+        || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(length, true) || !isNumber(builtYear, false)) {
+        if (!addRoad(map, city1, city2, lengthNumber, yearNumber)) {
             error = true;
         }
-        else {
-            lengthNumber = strtoul(length, NULL, 10);
-            yearNumber = strtol(builtYear, NULL, 10);
-            if (!isUnsigned(lengthNumber) || !isInteger(yearNumber)) {
-                error = true;
-            }
-            else {
-                if (!addRoad(map, city1, city2, lengthNumber, yearNumber)) {
-                    error = true;
-                }
-            }
-        }
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
@@ -145,40 +381,31 @@ static void addRoadCommand(Map *map, char *parameters, int lineNumber) {
  * o błędzie, jeśli podczas działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void repairRoadCommand(Map *map, char *parameters, int lineNumber) {
-    char *city1, *city2, *repairYear;
-    long yearNumber;
+static void repairRoadCommand(Map *map, char *parameters, int lineNumber,
+                              Output *output) {
+    char *city1, *city2;
+    int yearNumber;
     bool error = false;
 
     city1 = getParameter(&parameters);
     city2 = getParameter(&parameters);
-    repairYear = getParameter(&parameters);
 
-    if ((city1 == NULL) || (city2 == NULL) || (repairYear == NULL)
+    if ((city1 == NULL) || (city2 == NULL)
+        || !getIntegerParameter(&parameters, &yearNumber)
         || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(repairYear, false)) {
+        if (!repairRoad(map, city1, city2, yearNumber)) {
             error = true;
         }
-        else {
-            yearNumber = strtol(repairYear, NULL, 10);
-            if (!isInteger(yearNumber)) {
-                error = true;
-            }
-            else {
-                if (!repairRoad(map, city1, city2, yearNumber)) {
-                    error = true;
-                }
-            }
-        }
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
@@ -186,152 +413,197 @@ static void repairRoadCommand(Map *map, char *parameters, int lineNumber) {
  * Funkcja odpowiedzialna za obsługę polecenia getRouteDescription.
  * Funkcja wyodrębnia potrzebny parametr z podanego napisu, następnie,
  * jeśli udało się sparsować identyfikator drogi krajowej na liczbę,
- * wywołuje funkcję getRouteDescription z interfejsu mapy.
+ * wywołuje funkcję getRouteDescription z interfejsu mapy lub jej odpowiednik
+ * dla przypiętej wersji mapy.
  * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
  * działania funkcji wystąpił błąd.
- * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] map        – wskaźnik na strukturę mapy lub NULL, gdy
+ *                             polecenie jest wykonywane na przypiętej wersji;
+ * @param[in] snapshot       – wskaźnik na przypiętą wersję mapy lub NULL;
+ * @param[in] parameters     – napis zawierający potrzebny parametr;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void getRouteDescriptionCommand(Map *map, Snapshot *snapshot,
+                                       char *parameters, int lineNumber,
+                                       Output *output) {
+    const char *description;
+    unsigned routeIdNumber;
+    bool error = false;
+
+    if (!getUnsignedParameter(&parameters, &routeIdNumber)
+        || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (snapshot != NULL) {
+            description = getSnapshotRouteDescription(snapshot, routeIdNumber);
+        }
+        else {
+            description = getRouteDescription(map, routeIdNumber);
+        }
+        if (description == NULL) {
+            error = true;
+        }
+        else {
+            fprintf(output->results, "%s\n", description);
+        }
+        free((void *)description);
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia getCityRoutes.
+ * Funkcja wyodrębnia potrzebny parametr z podanego napisu, następnie wywołuje
+ * funkcję getCityRoutes z interfejsu mapy lub jej odpowiednik dla przypiętej
+ * wersji mapy i drukuje jej wynik.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy lub NULL, gdy
+ *                             polecenie jest wykonywane na przypiętej wersji;
+ * @param[in] snapshot       – wskaźnik na przypiętą wersję mapy lub NULL;
  * @param[in] parameters     – napis zawierający potrzebny parametr;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void getRouteDescriptionCommand(Map *map, char *parameters,
-                                       int lineNumber) {
-    char *routeId;
+static void getCityRoutesCommand(Map *map, Snapshot *snapshot,
+                                 char *parameters, int lineNumber,
+                                 Output *output) {
+    char *city;
     const char *description;
-    unsigned long routeIdNumber;
     bool error = false;
 
-    routeId = getParameter(&parameters);
+    city = getParameter(&parameters);
 
-    if ((routeId == NULL) || (parameters[0] != '\0')) {
+    if ((city == NULL) || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(routeId, true)) {
+        if (snapshot != NULL) {
+            description = getSnapshotCityRoutes(snapshot, city);
+        }
+        else {
+            description = getCityRoutes(map, city);
+        }
+        if (description == NULL) {
             error = true;
         }
         else {
-            routeIdNumber = strtoul(routeId, NULL, 10);
-            if (!isUnsigned(routeIdNumber)) {
-                error = true;
-            }
-            else {
-                description = getRouteDescription(map, routeIdNumber);
-                if (description == NULL) {
-                    error = true;
-                }
-                else {
-                    printf("%s\n", description);
-                }
-                free((void *)description);
-            }
+            fprintf(output->results, "%s\n", description);
         }
+        free((void *)description);
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
 /**
- * Funkcja odpowiedzialna za obsługę polecenia newRoute.
+ * Funkcja odpowiedzialna za obsługę polecenia alternatives.
  * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
- * jeśli parametry są poprawne, wywołuje funkcję newRoute z interfejsu mapy.
- * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
- * funkcji wystąpił błąd.
+ * jeśli udało się sparsować liczbę ścieżek, wywołuje funkcję getAlternatives
+ * z interfejsu mapy i drukuje jej wynik.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void newRouteCommand(Map *map, char *parameters, int lineNumber) {
-    char *routeId, *city1, *city2;
-    unsigned long routeIdNumber;
+static void alternativesCommand(Map *map, char *parameters, int lineNumber,
+                                Output *output) {
+    char *city1, *city2;
+    const char *description;
+    unsigned kNumber;
     bool error = false;
 
-    routeId = getParameter(&parameters);
     city1 = getParameter(&parameters);
     city2 = getParameter(&parameters);
 
-    if ((routeId == NULL) || (city1 == NULL) || (city2 == NULL)
+    if ((city1 == NULL) || (city2 == NULL)
+        || !getUnsignedParameter(&parameters, &kNumber)
         || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(routeId, true)) {
+        description = getAlternatives(map, city1, city2, kNumber);
+        if (description == NULL) {
             error = true;
         }
-        else {
-            routeIdNumber = strtoul(routeId, NULL, 10);
-            if (!isUnsigned(routeIdNumber)) {
-                error = true;
-            }
-            else {
-                if (!newRoute(map, routeIdNumber, city1, city2)) {
-                    error = true;
-                }
-            }
+        else if (description[0] != '\0') {
+            fprintf(output->results, "%s\n", description);
         }
+        free((void *)description);
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
 /**
- * Funkcja odpowiedzialna za obsługę polecenia extendRoute.
+ * Funkcja odpowiedzialna za obsługę polecenia pathFromYear.
  * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
- * jeśli parametry są poprawne, wywołuje funkcję extendRoute z interfejsu mapy.
- * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
- * funkcji wystąpił błąd.
+ * jeśli udało się sparsować rok, wywołuje funkcję getPathFromYear
+ * z interfejsu mapy i drukuje jej wynik.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void extendRouteCommand(Map *map, char *parameters, int lineNumber) {
-    char *routeId, *city;
-    unsigned long routeIdNumber;
+static void pathFromYearCommand(Map *map, char *parameters, int lineNumber,
+                                Output *output) {
+    char *city1, *city2;
+    const char *description;
+    int yearNumber;
     bool error = false;
 
-    routeId = getParameter(&parameters);
-    city = getParameter(&parameters);
+    city1 = getParameter(&parameters);
+    city2 = getParameter(&parameters);
 
-    if ((routeId == NULL) || (city == NULL) || (parameters[0] != '\0')) {
+    if ((city1 == NULL) || (city2 == NULL)
+        || !getIntegerParameter(&parameters, &yearNumber)
+        || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(routeId, true)) {
+        description = getPathFromYear(map, city1, city2, yearNumber);
+        if (description == NULL) {
             error = true;
         }
-        else {
-            routeIdNumber = strtoul(routeId, NULL, 10);
-            if (!isUnsigned(routeIdNumber)) {
-                error = true;
-            }
-            else {
-                if (!extendRoute(map, routeIdNumber, city)) {
-                    error = true;
-                }
-            }
+        else if (description[0] != '\0') {
+            fprintf(output->results, "%s\n", description);
         }
+        free((void *)description);
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
 /**
- * Funkcja odpowiedzialna za obsługę polecenia removeRoad.
- * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
- * jeśli parametry są poprawne, wywołuje funkcję removeRoad z interfejsu mapy.
- * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
- * funkcji wystąpił błąd.
+ * Funkcja odpowiedzialna za obsługę polecenia paretoRoutes.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie
+ * wywołuje funkcję getParetoRoutes z interfejsu mapy i drukuje jej wynik.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void removeRoadCommand(Map *map, char *parameters, int lineNumber) {
+static void paretoRoutesCommand(Map *map, char *parameters, int lineNumber,
+                                Output *output) {
     char *city1, *city2;
+    const char *description;
     bool error = false;
 
     city1 = getParameter(&parameters);
@@ -341,212 +613,1312 @@ static void removeRoadCommand(Map *map, char *parameters, int lineNumber) {
         error = true;
     }
     else {
-        if (!removeRoad(map, city1, city2)) {
+        description = getParetoRoutes(map, city1, city2);
+        if (description == NULL) {
             error = true;
         }
+        else if (description[0] != '\0') {
+            fprintf(output->results, "%s\n", description);
+        }
+        free((void *)description);
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
 /**
- * Funkcja odpowiedzialna za obsługę polecenia removeRoute.
- * Funkcja wyodrębnia potrzebny parametr z podanego napisu, następnie,
- * jeśli identyfikator drogi jest poprawną liczbą, wywołuje funkcję
- * removeRoute z interfejsu mapy.
+ * Funkcja odpowiedzialna za obsługę polecenia setDetourLimits.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli udało się sparsować ograniczenia na liczby, wywołuje funkcję
+ * setDetourLimits z interfejsu mapy.
  * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
  * działania funkcji wystąpił błąd.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] parameters     – napis zawierający potrzebny parametr;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static void removeRouteCommand(Map *map, char *parameters, int lineNumber) {
-    char *routeId;
-    unsigned long routeIdNumber;
+static void setDetourLimitsCommand(Map *map, char *parameters,
+                                   int lineNumber, Output *output) {
+    uint64_t maxLength;
+    unsigned maxCities;
     bool error = false;
 
-    routeId = getParameter(&parameters);
-
-    if ((routeId == NULL) || (parameters[0] != '\0')) {
+    if (!getUnsigned64Parameter(&parameters, &maxLength)
+        || !getUnsignedParameter(&parameters, &maxCities)
+        || (parameters[0] != '\0')) {
         error = true;
     }
     else {
-        if (!isNumber(routeId, true)) {
+        if (!setDetourLimits(map, maxLength, maxCities)) {
             error = true;
         }
-        else {
-            routeIdNumber = strtoul(routeId, NULL, 10);
-            if (!isUnsigned(routeIdNumber)) {
-                error = true;
-            }
-            else {
-                if (!removeRoute(map, routeIdNumber)) {
-                    error = true;
-                }
-            }
-        }
     }
 
     if (error) {
-        printError(lineNumber);
+        printError(map, lineNumber, output);
     }
 }
 
 /**
- * @brief Oblicza liczbę miast w poleceniu tworzenia drogi krajowej.
- * Przechodzi przez podany jako parametr napis i zlicza wystąpienia znaku ';',
- * następnie sprawdza czy podana liczba jest podzielna przez 3. Jeśli tak,
- * ustawia zmienną @p result na podzieloną przez 3 i zwiększoną o 1 liczbę
- * średników w poleceniu, co odpowiada liczbie nazw miast w poprawnym poleceniu.
- * W przeciwnym wypadku ustawia wartość zmiennej @p result na 1.
- * @param[in] line           – wskaźnik na pierwszy element polecenia.
- * @return Zmienna @result reprezentującą liczbę miast lub, w przypadku
- * niepoprawnego polecenia, liczbę 1.
+ * @brief Oblicza liczbę parametrów w napisie.
+ * @param[in] parameters     – napis zawierający parametry oddzielone znakami
+ *                             ';'.
+ * @return Liczba znaków ';' w napisie zwiększona o 1.
  */
-static int calculateNumberOfCities(char *line) {
-    int counter = 0, i = 0;
-    int result;
+static int countParameters(char *parameters) {
+    int counter = 1, i = 0;
 
-    while (line[i] != '\0') {
-        if (line[i] == ';') {
+    while (parameters[i] != '\0') {
+        if (parameters[i] == ';') {
             counter++;
         }
         i++;
     }
 
-    if (counter % 3 == 0) {
-        result = counter / 3 + 1;
-    }
-    else {
-        result = 1;
-    }
-
-    return result;
+    return counter;
 }
 
 /**
- * @brief Wydziela z podanego napisu potrzebne dane.
- * Funkcja wyodrębnia z podanego jako parametr napisu potrzebne później dane,
- * takie jak: nazwy miast, długości dróg oraz lata budowy lub ostatniego
- * remontu dróg, a następnie zapisuje je do odpowiednich tablic.
- * @param[in] parameters     – napis zawierający parametry;
- * @param[in] numberOfCities – liczba miast w poleceniu budowy drogi krajowej;
- * @param[in,out] lengths    – tablica długości dróg;
- * @param[in,out] years      – tablica lat budowy lub ostatniego remontu dróg;
- * @param[in,out] names      – tablica nazw miast.
- * @return Wartość @p true, jeśli dane są poprawne.
- * Wartość @p false, w przeciwnym przypadku.
+ * @brief Wyodrębnia z napisu podaną liczbę parametrów.
+ * @param[in,out] parameters – wskaźnik na napis zawierający parametry;
+ * @param[out] names         – tablica, w której zapisywane są parametry;
+ * @param[in] number         – liczba parametrów do wyodrębnienia.
+ * @return Wartość @p true, jeśli napis zawierał dokładnie podaną liczbę
+ * parametrów. Wartość @p false, w przeciwnym przypadku.
  */
-static bool getData(char *parameters, int numberOfCities,
-                    unsigned lengths[], int years[], char *names[]) {
+static bool getNames(char **parameters, const char *names[], int number) {
     int i = 0;
     bool correct = true;
-    char *length, *year;
-    long yearNumber;
-    unsigned long lengthNumber;
-
-    while ((i < numberOfCities - 1) && correct) {
-        names[i] = getParameter(&parameters);
-        length = getParameter(&parameters);
-        year = getParameter(&parameters);
 
-        if ((names[i] == NULL) || (length == NULL) || (year == NULL)) {
+    while ((i < number) && correct) {
+        names[i] = getParameter(parameters);
+        if (names[i] == NULL) {
             correct = false;
         }
-        else {
-            if (!isCityNameCorrect(names[i]) || !isNumber(length, true)
-                || !isNumber(year, false)) {
-                correct = false;
-            }
-            else {
-                lengthNumber = strtoul(length, NULL, 10);
-                yearNumber = strtol(year, NULL, 10);
-                if (!isUnsigned(lengthNumber) || !isInteger(yearNumber)) {
-                    correct = false;
-                }
-                else {
-                    if ((lengthNumber == 0) || (yearNumber == 0)) {
-                        correct = false;
-                    }
-                    else {
-                        lengths[i] = (unsigned)lengthNumber;
-                        years[i] = (int)yearNumber;
-                    }
-                }
-            }
-        }
         i++;
     }
 
-    if (correct) {
-        names[i] = getParameter(&parameters);
-        if ((names[i] == NULL) || !isCityNameCorrect(names[i])) {
-            correct = false;
-        }
+    if (correct && ((*parameters)[0] != '\0')) {
+        correct = false;
     }
 
     return correct;
 }
 
 /**
- * @brief Sprawdza, czy droga krajowa może zostać utworzona.
- * Szuka miast o podanych nazwach i jeśli łączy je już odcinek drogi, sprawdza,
- * czy podana długość oraz rok budowy nie przeszkadzają w utworzeniu drogi
- * krajowej wraz ze znalezionym odcinkiem drogi.
- * @param[in] map            – wskaźnik na strukturę mapy;
- * @param[in] numberOfCities – liczba miast w drodze krajowej;
- * @param[in] names          – tablica nazw miast;
+ * Funkcja odpowiedzialna za obsługę polecenia pathAvoiding.
+ * Funkcja wyodrębnia nazwy miast z podanego napisu, następnie wywołuje
+ * funkcję getPathAvoiding z interfejsu mapy dla dwóch pierwszych miast jako
+ * końców ścieżki i pozostałych miast jako miast omijanych, drukując jej wynik.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void pathAvoidingCommand(Map *map, char *parameters, int lineNumber,
+                                Output *output) {
+    int numberOfNames = countParameters(parameters);
+    const char **names = (const char **)malloc(numberOfNames * sizeof(char *));
+    const char *description;
+    bool error = false;
+
+    if ((names == NULL) || (numberOfNames < 3)
+        || !getNames(&parameters, names, numberOfNames)) {
+        error = true;
+    }
+    else {
+        description = getPathAvoiding(map, names[0], names[1], names + 2,
+                                      numberOfNames - 2);
+        if (description == NULL) {
+            error = true;
+        }
+        else if (description[0] != '\0') {
+            fprintf(output->results, "%s\n", description);
+        }
+        free((void *)description);
+    }
+
+    free(names);
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * @brief Drukuje wiersz macierzy odległości.
+ * Odległości są oddzielone średnikami, a brak jednoznacznej najkrótszej
+ * ścieżki jest oznaczany znakiem '-'.
+ * @param[in] distances      – tablica odległości;
+ * @param[in] numberOfTargets – liczba odległości w tablicy;
+ * @param[in] data           – wskaźnik na strumienie wyjściowe.
+ */
+static void printDistancesRow(const uint64_t distances[], int numberOfTargets,
+                              void *data) {
+    Output *output = (Output *)data;
+
+    for (int i = 0; i < numberOfTargets; i++) {
+        if (i > 0) {
+            fputc(';', output->results);
+        }
+        if (distances[i] == UINT64_MAX) {
+            fputc('-', output->results);
+        }
+        else {
+            fprintf(output->results, "%" PRIu64, distances[i]);
+        }
+    }
+    fputc('\n', output->results);
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia distances.
+ * Funkcja wyodrębnia nazwy miast z podanego napisu, następnie wywołuje
+ * funkcję getDistances z interfejsu mapy dla pierwszego miasta jako miasta
+ * początkowego i pozostałych miast jako miast docelowych, drukując jeden
+ * wiersz odległości.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void distancesCommand(Map *map, char *parameters, int lineNumber,
+                             Output *output) {
+    int numberOfNames = countParameters(parameters);
+    const char **names = (const char **)malloc(numberOfNames * sizeof(char *));
+    bool error = false;
+
+    if ((names == NULL) || (numberOfNames < 2)
+        || !getNames(&parameters, names, numberOfNames)) {
+        error = true;
+    }
+    else {
+        if (!getDistances(map, names, 1, names + 1, numberOfNames - 1,
+                          printDistancesRow, output)) {
+            error = true;
+        }
+    }
+
+    free(names);
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia distanceMatrix.
+ * Funkcja wyodrębnia z podanego napisu liczbę miast początkowych, a następnie
+ * nazwy miast początkowych i docelowych. Wywołuje funkcję getDistances
+ * z interfejsu mapy, drukując po jednym wierszu odległości dla każdego miasta
+ * początkowego.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void distanceMatrixCommand(Map *map, char *parameters, int lineNumber,
+                                  Output *output) {
+    int numberOfNames = countParameters(parameters) - 1;
+    const char **names = NULL;
+    unsigned numberOfSources;
+    bool error = false;
+
+    if (!getUnsignedParameter(&parameters, &numberOfSources)
+        || (numberOfNames < 2)) {
+        error = true;
+    }
+    else {
+        names = (const char **)malloc(numberOfNames * sizeof(char *));
+        if ((numberOfSources == 0)
+            || (numberOfSources >= (unsigned)numberOfNames)
+            || (names == NULL) || !getNames(&parameters, names, numberOfNames)) {
+            error = true;
+        }
+        else {
+            if (!getDistances(map, names, numberOfSources,
+                              names + numberOfSources,
+                              numberOfNames - numberOfSources,
+                              printDistancesRow, output)) {
+                error = true;
+            }
+        }
+    }
+
+    free(names);
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * @brief Drukuje miasto znalezione przez polecenie isochrone.
+ * @param[in] city           – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] distance       – odległość miasta od miasta początkowego;
+ * @param[in] data           – wskaźnik na strumienie wyjściowe.
+ */
+static void printIsochroneCity(const char *city, uint64_t distance,
+                               void *data) {
+    Output *output = (Output *)data;
+
+    fprintf(output->results, "%s;%" PRIu64 "\n", city, distance);
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia isochrone.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli udało się sparsować odległość, wywołuje funkcję getIsochrone
+ * z interfejsu mapy, drukując po jednym wierszu dla każdego znalezionego
+ * miasta.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void isochroneCommand(Map *map, char *parameters, int lineNumber,
+                             Output *output) {
+    char *city;
+    uint64_t maxDistance;
+    bool error = false;
+
+    city = getParameter(&parameters);
+
+    if ((city == NULL) || !getUnsigned64Parameter(&parameters, &maxDistance)
+        || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!getIsochrone(map, city, maxDistance, printIsochroneCity,
+                          output)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia nearestOnRoute.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli udało się sparsować numer drogi krajowej, wywołuje funkcję
+ * getNearestOnRoute z interfejsu mapy i drukuje nazwę znalezionego miasta
+ * oraz jego odległość.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void nearestOnRouteCommand(Map *map, char *parameters, int lineNumber,
+                                  Output *output) {
+    char *city;
+    const char *nearest;
+    unsigned routeIdNumber;
+    uint64_t distance;
+    bool error = false, correctId;
+
+    correctId = getUnsignedParameter(&parameters, &routeIdNumber);
+    city = getParameter(&parameters);
+
+    if (!correctId || (city == NULL) || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!getNearestOnRoute(map, routeIdNumber, city, &nearest,
+                               &distance)) {
+            error = true;
+        }
+        else if (nearest != NULL) {
+            fprintf(output->results, "%s;%" PRIu64 "\n", nearest, distance);
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia newRoute.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli parametry są poprawne, wywołuje funkcję newRoute z interfejsu mapy.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
+ * funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void newRouteCommand(Map *map, char *parameters, int lineNumber,
+                            Output *output) {
+    char *city1, *city2;
+    unsigned routeIdNumber;
+    bool error = false, correctId;
+
+    correctId = getUnsignedParameter(&parameters, &routeIdNumber);
+    city1 = getParameter(&parameters);
+    city2 = getParameter(&parameters);
+
+    if (!correctId || (city1 == NULL) || (city2 == NULL)
+        || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!newRoute(map, routeIdNumber, city1, city2)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia extendRoute.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli parametry są poprawne, wywołuje funkcję extendRoute z interfejsu mapy.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
+ * funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void extendRouteCommand(Map *map, char *parameters, int lineNumber,
+                               Output *output) {
+    char *city;
+    unsigned routeIdNumber;
+    bool error = false, correctId;
+
+    correctId = getUnsignedParameter(&parameters, &routeIdNumber);
+    city = getParameter(&parameters);
+
+    if (!correctId || (city == NULL) || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!extendRoute(map, routeIdNumber, city)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia removeRoad.
+ * Funkcja wyodrębnia potrzebne parametry z podanego napisu, następnie,
+ * jeśli parametry są poprawne, wywołuje funkcję removeRoad z interfejsu mapy.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas działania
+ * funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void removeRoadCommand(Map *map, char *parameters, int lineNumber,
+                              Output *output) {
+    char *city1, *city2;
+    bool error = false;
+
+    city1 = getParameter(&parameters);
+    city2 = getParameter(&parameters);
+
+    if ((city1 == NULL) || (city2 == NULL) || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!removeRoad(map, city1, city2)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę polecenia removeRoute.
+ * Funkcja wyodrębnia potrzebny parametr z podanego napisu, następnie,
+ * jeśli identyfikator drogi jest poprawną liczbą, wywołuje funkcję
+ * removeRoute z interfejsu mapy.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli podczas 
+ * działania funkcji wystąpił błąd.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebny parametr;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void removeRouteCommand(Map *map, char *parameters, int lineNumber,
+                               Output *output) {
+    unsigned routeIdNumber;
+    bool error = false;
+
+    if (!getUnsignedParameter(&parameters, &routeIdNumber)
+        || (parameters[0] != '\0')) {
+        error = true;
+    }
+    else {
+        if (!removeRoute(map, routeIdNumber)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * @brief Oblicza liczbę miast w poleceniu tworzenia drogi krajowej.
+ * Przechodzi przez podany jako parametr napis i zlicza wystąpienia znaku ';',
+ * następnie sprawdza czy podana liczba jest podzielna przez 3. Jeśli tak,
+ * ustawia zmienną @p result na podzieloną przez 3 i zwiększoną o 1 liczbę
+ * średników w poleceniu, co odpowiada liczbie nazw miast w poprawnym poleceniu.
+ * W przeciwnym wypadku ustawia wartość zmiennej @p result na 1.
+ * @param[in] line           – wskaźnik na pierwszy element polecenia.
+ * @return Zmienna @result reprezentującą liczbę miast lub, w przypadku
+ * niepoprawnego polecenia, liczbę 1.
+ */
+static int calculateNumberOfCities(char *line) {
+    size_t counter = countCharacter(line, strlen(line), ';');
+    int result;
+
+    if (counter % 3 == 0) {
+        result = counter / 3 + 1;
+    }
+    else {
+        result = 1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Wydziela z podanego napisu potrzebne dane.
+ * Funkcja wyodrębnia z podanego jako parametr napisu potrzebne później dane,
+ * takie jak: nazwy miast, długości dróg oraz lata budowy lub ostatniego
+ * remontu dróg, a następnie zapisuje je do odpowiednich tablic.
+ * @param[in] parameters     – napis zawierający parametry;
+ * @param[in] numberOfCities – liczba miast w poleceniu budowy drogi krajowej;
+ * @param[in,out] lengths    – tablica długości dróg;
+ * @param[in,out] years      – tablica lat budowy lub ostatniego remontu dróg;
+ * @param[in,out] names      – tablica nazw miast.
+ * @return Wartość @p true, jeśli dane są poprawne.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool getData(char *parameters, int numberOfCities,
+                    unsigned lengths[], int years[], char *names[]) {
+    int i = 0;
+    bool correct = true;
+
+    while ((i < numberOfCities - 1) && correct) {
+        names[i] = getParameter(&parameters);
+
+        if ((names[i] == NULL) || !isCityNameCorrect(names[i])
+            || !getUnsignedParameter(&parameters, &lengths[i])
+            || !getIntegerParameter(&parameters, &years[i])) {
+            correct = false;
+        }
+        else {
+            if ((lengths[i] == 0) || (years[i] == 0)) {
+                correct = false;
+            }
+        }
+        i++;
+    }
+
+    if (correct) {
+        names[i] = getParameter(&parameters);
+        if ((names[i] == NULL) || !isCityNameCorrect(names[i])) {
+            correct = false;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Sprawdza, czy droga krajowa może zostać utworzona.
+ * Szuka miast o podanych nazwach i jeśli łączy je już odcinek drogi, sprawdza,
+ * czy podana długość oraz rok budowy nie przeszkadzają w utworzeniu drogi
+ * krajowej wraz ze znalezionym odcinkiem drogi.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] numberOfCities – liczba miast w drodze krajowej;
+ * @param[in] names          – tablica nazw miast;
  * @param[in] lengths        – tablica długości odcinków dróg;
  * @param[in] years          – tablica lat budowy lub ostatniego remontu dróg.
  * @return Wartość @p true, jeśli można utworzyć drogę krajową.
  * Wartość @p false, w przeciwnym przypadku.
  */
-static bool canRouteBeMade(Map *map, int numberOfCities, char *names[],
-                           unsigned lengths[], int years[]) {
-    City *cityA, *cityB;
-    Road *road;
-    int i = 0;
+static bool canRouteBeMade(Map *map, int numberOfCities, char *names[],
+                           unsigned lengths[], int years[]) {
+    City *cityA, *cityB;
+    Road *road;
+    int i = 0;
+    bool correct = true;
+
+    cityA = findCity(map, names[i]);
+    while ((i < numberOfCities - 1) && correct) {
+        cityB = findCity(map, names[i + 1]);
+        if ((cityA != NULL) && (cityB != NULL)) {
+            road = findRoad(cityA, cityB);
+            if (road != NULL) {
+                if ((road->length != lengths[i]) || (road->year > years[i])) {
+                    correct = false;
+                }
+            }
+        }
+        cityA = cityB;
+        i++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Szuka miasta o podanej nazwie w mapie lub dodaje miasto, jeśli
+ * miasto podanej nazwie nie istnieje.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] name           – nazwa miasta;
+ * @param[in,out] cities     – tablica wskaźników na miasta;
+ * @param[in] index          – indeks szukanego miasta w tablicy @p cities.
+ * @return Wartość @p true, jeśli znaleziono miasto lub udało się utworzyć
+ * miasto o podanej nazwie.
+ * Wartość @p false, jeśli nie udało się dodać miasta.
+ */
+static bool findOrAddCity(Map *map, char *name, City **cities, int index) {
+    cities[index] = findCity(map, name);
+    
+    if (cities[index] == NULL) {
+        cities[index] = addCity(map, name);
+    }
+
+    if (cities[index] != NULL) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Wypełnia tablicę wskaźników na miasta.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] numberOfCities – liczba miast w drodze krajowej;
+ * @param[in] names          – tablica nazw miast;
+ * @param[out] cities        – tablica wskaźników na miasta.
+ * @return Wartość @p true, jeśli udało się znaleźć lub dodać wszystkie miasta.
+ * Wartość @p false, jeśli nie udało się dodać miasta.
+ */
+static bool fillCitiesArray(Map *map, int numberOfCities, char *names[],
+                            City **cities) {
+    bool correct = true;
+    int i = 0;
+
+    while ((i < numberOfCities) && correct) {
+        if (!findOrAddCity(map, names[i], cities, i)) {
+            correct = false;
+        }
+        i++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Sprawdza, czy w tworzonej drodze nie ma pętli lub samoprzecięć.
+ * Przechodzi po tablicy miast oznaczając odwiedzone miasta nowym znacznikiem.
+ * W przypadku napotkania odwiedzonego już wcześniej miasta, przerywa pętlę
+ * i zapisuje informację o błędzie. Na koniec zmienia znacznik mapy, przez co
+ * wszystkie miasta przestają być oznaczone.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] cities         – tablica wskaźników na miasta;
+ * @param[in] numberOfCities – liczba miast w tablicy.
+ * @return Wartość @p true, jeśli w tworzonej drodze nie ma pętli.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool checkLoops(Map *map, City **cities, int numberOfCities) {
+    int i = 0;
+    bool correct = true;
+    unsigned mark = newMark(map);
+    
+    while ((i < numberOfCities) && correct) {
+        if (map->vertices.mark[cities[i]->id] == mark) {
+            correct = false;
+        }
+        else {
+            map->vertices.mark[cities[i]->id] = mark;
+        }
+        i++;
+    }
+
+    newMark(map);
+
+    return correct;
+}
+
+/**
+ * @brief Dodaje potrzebne do utworzenia drogi krajowej odcinki dróg.
+ * Jeśli droga między miastami nie istnieje, to ją tworzy. Jeśli podany rok
+ * budowy lub ostatniego remontu jest większy od roku drogi, aktualizuje
+ * ten rok.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] cities         – tablica wskaźników na miasta;
+ * @param[in] numberOfCities – liczba miast w drodze krajowej;
+ * @param[in] lengths        – tablica długości odcinków dróg;
+ * @param[in] years          – tablica lat budowy lub ostatniego remontu dróg;
+ * @param[in,out] roads      – tablica, do której zapisywane są wskaźniki
+ *                             na kolejne odcinki dróg.
+ * @return Wartość @p true, jeśli udało się utworzyć potrzebne odcinki dróg.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool addRoads(Map *map, City **cities, int numberOfCities,
+                     unsigned lengths[], int years[], Road *roads[]) {
+    int i = 0;
+    bool correct = true;
+    Road *road;
+
+    while ((i < numberOfCities - 1) && correct) {
+        road = findRoad(cities[i], cities[i + 1]);
+        if (road == NULL) {
+            road = newRoad(map, cities[i], cities[i + 1], lengths[i], years[i]);
+            if (road == NULL) {
+                correct = false;
+            }
+        }
+        else if ((road->year < years[i])
+                 && !updateRoadYear(map, road, years[i])) {
+            correct = false;
+        }
+
+        roads[i] = road;
+        i++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Tworzy drogę krajową z wyodrębnionych już danych.
+ * Sprawdza, czy droga krajowa o podanym numerze jeszcze nie istnieje i czy
+ * istniejące odcinki dróg pozwalają ją utworzyć, a następnie dodaje brakujące
+ * miasta i odcinki dróg oraz tworzy drogę krajową. Wskaźniki na miasta
+ * i odcinki dróg zapisuje w tablicach pomocniczych. Jeśli nie udało się
+ * utworzyć drogi krajowej, wycofuje dodane miasta i odcinki dróg oraz zmiany
+ * lat odcinków dróg.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – poprawny identyfikator drogi krajowej;
+ * @param[in] numberOfCities – liczba miast w drodze krajowej;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze z poprawnymi
+ *                             nazwami miast, długościami odcinków dróg i latami
+ *                             ich budowy lub ostatniego remontu.
+ * @return Wartość @p true, jeśli udało się utworzyć drogę krajową.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool buildRoute(Map *map, unsigned id, int numberOfCities,
+                       RouteData *data) {
     bool correct = true;
+    int savepoint = startChanges(map);
 
-    cityA = findCity(map, names[i]);
-    while ((i < numberOfCities - 1) && correct) {
-        cityB = findCity(map, names[i + 1]);
-        if ((cityA != NULL) && (cityB != NULL)) {
-            road = findRoad(cityA, cityB);
-            if (road != NULL) {
-                if ((road->length != lengths[i]) || (road->year > years[i])) {
-                    correct = false;
+    if ((findRoute(map, id) != NULL)
+        || !canRouteBeMade(map, numberOfCities, data->names, data->lengths,
+                           data->years)) {
+        correct = false;
+    }
+    else {
+        if (!fillCitiesArray(map, numberOfCities, data->names, data->cities)
+            || !checkLoops(map, data->cities, numberOfCities)
+            || !addRoads(map, data->cities, numberOfCities, data->lengths,
+                         data->years, data->roads)
+            || !addRouteAlongToMap(map, id, data->cities, data->roads,
+                                   numberOfCities - 1)) {
+            correct = false;
+        }
+    }
+
+    finishChanges(map, savepoint, correct);
+
+    return correct;
+}
+
+void freeRouteData(RouteData *data) {
+    free(data->names);
+    free(data->lengths);
+    free(data->years);
+    free(data->cities);
+    free(data->roads);
+}
+
+/**
+ * @brief Zapewnia miejsce na dane drogi krajowej w tablicach pomocniczych.
+ * Powiększa tablice co najmniej dwukrotnie, więc przy kolejnych coraz
+ * dłuższych drogach krajowych łączny koszt powiększania jest liniowy.
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze;
+ * @param[in] numberOfCities – liczba miast w drodze krajowej.
+ * @return Wartość @p true, jeśli w tablicach jest miejsce na drogę krajową.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveRouteData(RouteData *data, int numberOfCities) {
+    int newSize = 2 * data->size;
+    char **names;
+    unsigned *lengths;
+    int *years;
+    City **cities;
+    Road **roads;
+    bool correct = true;
+
+    if (numberOfCities > data->size) {
+        if (newSize < numberOfCities) {
+            newSize = numberOfCities;
+        }
+
+        names = (char **)realloc(data->names, newSize * sizeof(char *));
+        if (names != NULL) {
+            data->names = names;
+        }
+        lengths = (unsigned *)realloc(data->lengths,
+                                      newSize * sizeof(unsigned));
+        if (lengths != NULL) {
+            data->lengths = lengths;
+        }
+        years = (int *)realloc(data->years, newSize * sizeof(int));
+        if (years != NULL) {
+            data->years = years;
+        }
+        cities = (City **)realloc(data->cities, newSize * sizeof(City *));
+        if (cities != NULL) {
+            data->cities = cities;
+        }
+        roads = (Road **)realloc(data->roads, newSize * sizeof(Road *));
+        if (roads != NULL) {
+            data->roads = roads;
+        }
+
+        if ((names != NULL) && (lengths != NULL) && (years != NULL)
+            && (cities != NULL) && (roads != NULL)) {
+            data->size = newSize;
+        }
+        else {
+            correct = false;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Funkcja odpowiedzialna za obsługę polecenia tworzenia nowej drogi.
+ * Funkcja sprawdza różne przypadki, w których mógł wystąpić błąd, a następnie,
+ * jeśli nie ma błędu, wywołuje funkcję tworzącą nową drogę krajową.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – identyfikator drogi krajowej;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void makeRouteCommand(Map *map, unsigned id, char *parameters,
+                             int lineNumber, RouteData *data, Output *output) {
+    bool error = false;
+    int numberOfCities = calculateNumberOfCities(parameters);
+
+    if ((numberOfCities == 1) || !isRouteIdCorrect(id)
+        || !reserveRouteData(data, numberOfCities)) {
+        error = true;
+    }
+    else {
+        if (!getData(parameters, numberOfCities, data->lengths, data->years,
+                     data->names)
+            || !buildRoute(map, id, numberOfCities, data)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+unsigned routeIdNumber(char *route) {
+    unsigned routeIdNumber;
+
+    if (!getUnsignedParameter(&route, &routeIdNumber)) {
+        routeIdNumber = 0;
+    }
+
+    return routeIdNumber;
+}
+
+/**
+ * @brief Wykonuje polecenie odłożone w trybie zbiorczym zwykłą ścieżką.
+ * Używana, gdy nie udało się zaalokować pamięci na tablice pomocnicze trybu
+ * zbiorczego. Wywołuje funkcję drukującą informację o błędzie, jeśli
+ * polecenie się nie powiodło.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] record         – wskaźnik na polecenie;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void replayBulkRecord(Map *map, BulkLoad *bulk, BulkRecord *record,
+                             RouteData *data, Output *output) {
+    BulkName *names = &bulk->names[record->firstName];
+    bool error = false;
+
+    if (record->numberOfNames == 0) {
+        error = true;
+    }
+    else if (record->search) {
+        if (!newRoute(map, record->routeId, bulkName(bulk, record->firstName),
+                      bulkName(bulk, record->firstName + 1))) {
+            error = true;
+        }
+    }
+    else if (record->routeId == 0) {
+        if (!addRoad(map, bulkName(bulk, record->firstName),
+                     bulkName(bulk, record->firstName + 1), names[0].length,
+                     names[0].year)) {
+            error = true;
+        }
+    }
+    else if (!reserveRouteData(data, record->numberOfNames)) {
+        error = true;
+    }
+    else {
+        for (int i = 0; i < record->numberOfNames; i++) {
+            data->names[i] = bulkName(bulk, record->firstName + i);
+            data->lengths[i] = names[i].length;
+            data->years[i] = names[i].year;
+        }
+        if (!buildRoute(map, record->routeId, record->numberOfNames, data)) {
+            error = true;
+        }
+    }
+
+    if (error) {
+        printError(map, record->lineNumber, output);
+    }
+}
+
+void flushBulkLoad(Map *map, BulkLoad *bulk, RouteData *data,
+                   Output *output) {
+    if (bulk->numberOfRecords > 0) {
+        if (finishBulkLoad(map, bulk)) {
+            for (int i = 0; i < bulk->numberOfRecords; i++) {
+                if (bulk->records[i].failed) {
+                    printError(map, bulk->records[i].lineNumber, output);
                 }
             }
         }
-        cityA = cityB;
-        i++;
+        else {
+            for (int i = 0; i < bulk->numberOfRecords; i++) {
+                replayBulkRecord(map, bulk, &bulk->records[i], data, output);
+            }
+        }
+        clearBulkLoad(bulk);
+    }
+}
+
+/**
+ * @brief Odkłada polecenie w trybie zbiorczym.
+ * Najpierw wykonuje odłożone wcześniej polecenia newRoute. Jeśli nie udało
+ * się zaalokować pamięci na polecenie, wykonuje polecenia odłożone wcześniej
+ * i drukuje informację o błędzie, tak jak dla każdego polecenia, któremu
+ * zabrakło pamięci.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in] routeId        – numer drogi krajowej lub 0;
+ * @param[in] numberOfNames  – liczba miast polecenia lub 0 dla błędnego
+ *                             polecenia;
+ * @param[in] names          – tablica nazw miast;
+ * @param[in] lengths        – tablica długości odcinków dróg;
+ * @param[in] years          – tablica lat budowy lub ostatniego remontu
+ *                             odcinków dróg;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void deferCommand(Map *map, BulkLoad *bulk, RouteData *data,
+                         int lineNumber, unsigned routeId, int numberOfNames,
+                         char *names[], unsigned lengths[], int years[],
+                         Output *output) {
+    if ((bulk->numberOfRecords > 0) && bulk->records[0].search) {
+        flushBulkLoad(map, bulk, data, output);
+    }
+
+    if (!addBulkRecord(bulk, lineNumber, routeId, numberOfNames, names,
+                       lengths, years)) {
+        flushBulkLoad(map, bulk, data, output);
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * @brief Odkłada w trybie zbiorczym polecenie addRoad.
+ * Sprawdza parametry tak jak funkcja addRoad z interfejsu mapy, a polecenie
+ * z błędnymi parametrami odkłada jako błędne.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void deferRoadCommand(Map *map, char *parameters, int lineNumber,
+                             BulkLoad *bulk, RouteData *data, Output *output) {
+    char *names[2];
+    unsigned lengthNumber = 0;
+    int yearNumber = 0, numberOfNames = 2;
+
+    names[0] = getParameter(&parameters);
+    names[1] = getParameter(&parameters);
+
+    if ((names[0] == NULL) || (names[1] == NULL)
+        || !getUnsignedParameter(&parameters, &lengthNumber)
+        || !getIntegerParameter(&parameters, &yearNumber)
+        || (parameters[0] != '\0') || !isLengthCorrect(lengthNumber)
+        || !isYearCorrect(yearNumber) || (strcmp(names[0], names[1]) == 0)
+        || !isCityNameCorrect(names[0]) || !isCityNameCorrect(names[1])) {
+        numberOfNames = 0;
+    }
+
+    deferCommand(map, bulk, data, lineNumber, 0, numberOfNames, names,
+                 &lengthNumber, &yearNumber, output);
+}
+
+/**
+ * @brief Odkłada w trybie zbiorczym polecenie utworzenia drogi krajowej.
+ * Sprawdza wszystko, co nie zależy od stanu mapy, a polecenie z błędnymi
+ * parametrami odkłada jako błędne.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] parameters     – wskaźnik na pierwszy znak po numerze drogi
+ *                             krajowej;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void deferRouteCommand(Map *map, char *line, char *parameters,
+                              int lineNumber, BulkLoad *bulk,
+                              RouteData *data, Output *output) {
+    unsigned routeId = routeIdNumber(line);
+    int numberOfCities = calculateNumberOfCities(parameters);
+
+    if ((routeId == 0) || (numberOfCities == 1) || !isRouteIdCorrect(routeId)
+        || !reserveRouteData(data, numberOfCities)
+        || !getData(parameters, numberOfCities, data->lengths, data->years,
+                    data->names)) {
+        numberOfCities = 0;
+    }
+
+    deferCommand(map, bulk, data, lineNumber, routeId, numberOfCities,
+                 data->names, data->lengths, data->years, output);
+}
+
+/**
+ * @brief Odkłada polecenie newRoute w trybie równoległego tworzenia dróg
+ * krajowych.
+ * Najpierw wykonuje odłożone wcześniej polecenia innego rodzaju. Polecenie
+ * z błędnymi parametrami odkłada jako błędne. Jeśli nie udało się
+ * zaalokować pamięci na polecenie, wykonuje polecenia odłożone wcześniej
+ * i drukuje informację o błędzie.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] parameters     – napis zawierający potrzebne parametry;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void deferNewRouteCommand(Map *map, char *parameters, int lineNumber,
+                                 BulkLoad *bulk, RouteData *data,
+                                 Output *output) {
+    char *names[2];
+    unsigned routeId = 0;
+    int numberOfNames = 2;
+    bool correctId;
+
+    if ((bulk->numberOfRecords > 0) && !bulk->records[0].search) {
+        flushBulkLoad(map, bulk, data, output);
+    }
+
+    correctId = getUnsignedParameter(&parameters, &routeId);
+    names[0] = getParameter(&parameters);
+    names[1] = getParameter(&parameters);
+
+    if (!correctId || (names[0] == NULL) || (names[1] == NULL)
+        || (parameters[0] != '\0')) {
+        numberOfNames = 0;
+    }
+
+    if (!addBulkSearch(bulk, lineNumber, routeId, numberOfNames, names)) {
+        flushBulkLoad(map, bulk, data, output);
+        printError(map, lineNumber, output);
+    }
+}
+
+/**
+ * Funkcja odpowiedzialna za obsługę poleceń beginBatch, commitBatch,
+ * abortBatch, beginBulkLoad, endBulkLoad, beginParallelRoutes
+ * i endParallelRoutes.
+ * Polecenia te nie mają parametrów. Funkcja wywołuje odpowiednią funkcję
+ * z interfejsu mapy albo włącza lub wyłącza tryb zbiorczy lub tryb
+ * równoległego tworzenia dróg krajowych.
+ * Wywołuje funkcję drukującą informację o błędzie, jeśli polecenie jest
+ * nieznane lub wywołana funkcja się nie powiodła.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] lineNumber     – numer linii, w której wywołano funkcję;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void modeCommand(Map *map, char *line, int lineNumber, BulkLoad *bulk,
+                        Output *output) {
+    bool error = false;
+
+    if (strcmp(line, "beginBatch\n") == 0) {
+        if (!beginBatch(map)) {
+            error = true;
+        }
+    }
+    else if (strcmp(line, "commitBatch\n") == 0) {
+        if (!commitBatch(map)) {
+            error = true;
+        }
+    }
+    else if (strcmp(line, "abortBatch\n") == 0) {
+        if (!abortBatch(map)) {
+            error = true;
+        }
+    }
+    else if (strcmp(line, "beginBulkLoad\n") == 0) {
+        if (bulk->active) {
+            error = true;
+        }
+        else {
+            bulk->active = true;
+        }
+    }
+    else if (strcmp(line, "endBulkLoad\n") == 0) {
+        if (!bulk->active) {
+            error = true;
+        }
+        else {
+            bulk->active = false;
+        }
+    }
+    else if (strcmp(line, "beginParallelRoutes\n") == 0) {
+        if (bulk->parallel) {
+            error = true;
+        }
+        else {
+            bulk->parallel = true;
+        }
+    }
+    else if (strcmp(line, "endParallelRoutes\n") == 0) {
+        if (!bulk->parallel) {
+            error = true;
+        }
+        else {
+            bulk->parallel = false;
+        }
+    }
+    else {
+        error = true;
+    }
+
+    if (error) {
+        printError(map, lineNumber, output);
+    }
+}
+
+void chooseFunction(Map *map, char *line, int lineNumber,
+                    RouteData *data, BulkLoad *bulk, Output *output) {
+    char *parameters = strchr(line, ';');
+    char *route;
+    unsigned routeId;
+
+    if (parameters != NULL) {
+        parameters++;
+        if (strstr(line, "addRoad;") == line) {
+            addRoadCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "repairRoad;") == line) {
+            repairRoadCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "getRouteDescription;") == line) {
+            getRouteDescriptionCommand(map, NULL, parameters, lineNumber,
+                                       output);
+        }
+        else if (strstr(line, "getCityRoutes;") == line) {
+            getCityRoutesCommand(map, NULL, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "alternatives;") == line) {
+            alternativesCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "pathFromYear;") == line) {
+            pathFromYearCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "pathAvoiding;") == line) {
+            pathAvoidingCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "paretoRoutes;") == line) {
+            paretoRoutesCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "setDetourLimits;") == line) {
+            setDetourLimitsCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "distances;") == line) {
+            distancesCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "distanceMatrix;") == line) {
+            distanceMatrixCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "isochrone;") == line) {
+            isochroneCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "nearestOnRoute;") == line) {
+            nearestOnRouteCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "newRoute;") == line) {
+            newRouteCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "extendRoute;") == line) {
+            extendRouteCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "removeRoad;") == line) {
+            removeRoadCommand(map, parameters, lineNumber, output);
+        }
+        else if (strstr(line, "removeRoute;") == line) {
+            removeRouteCommand(map, parameters, lineNumber, output);
+        }
+        else {
+            route = line;
+            routeId = routeIdNumber(route);
+            if (routeId != 0) {
+                makeRouteCommand(map, routeId, parameters, lineNumber, data,
+                                 output);
+            }
+            else {
+                printError(map, lineNumber, output);
+            }
+        }
+    }
+    else {
+        modeCommand(map, line, lineNumber, bulk, output);
+    }
+}
+
+void handleCommand(Map *map, char *line, int lineNumber,
+                   RouteData *data, BulkLoad *bulk, Output *output) {
+    char *parameters = strchr(line, ';');
+
+    if (bulk->parallel && (parameters != NULL)
+        && (strstr(line, "newRoute;") == line)) {
+        deferNewRouteCommand(map, parameters + 1, lineNumber, bulk, data,
+                             output);
+    }
+    else if (bulk->active && (parameters != NULL)
+             && (strstr(line, "addRoad;") == line)) {
+        deferRoadCommand(map, parameters + 1, lineNumber, bulk, data, output);
+    }
+    else if (bulk->active && (parameters != NULL) && (line[0] >= '0')
+             && (line[0] <= '9')) {
+        deferRouteCommand(map, line, parameters + 1, lineNumber, bulk, data,
+                          output);
+    }
+    else {
+        flushBulkLoad(map, bulk, data, output);
+        chooseFunction(map, line, lineNumber, data, bulk, output);
+    }
+}
+
+/**
+ * @brief Parsuje polecenie utworzenia drogi krajowej.
+ * Wyodrębnia numer drogi krajowej, nazwy miast, długości odcinków dróg
+ * i lata ich budowy lub ostatniego remontu, sprawdzając przy tym wszystko,
+ * co nie zależy od stanu mapy. Jeśli nie udało się zarezerwować miejsca
+ * na dane, nie zmienia polecenia, więc zostanie ono sparsowane dopiero
+ * przy wykonaniu.
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in] parameters     – wskaźnik na pierwszy znak po numerze drogi
+ *                             krajowej.
+ */
+static void parseRouteCommand(Command *command, char *parameters) {
+    int numberOfCities = calculateNumberOfCities(parameters);
+
+    if (reserveRouteData(&command->route, numberOfCities)) {
+        command->routeId = routeIdNumber(command->line);
+        command->numberOfCities = numberOfCities;
+        if ((command->routeId == 0) || (numberOfCities == 1)
+            || !isRouteIdCorrect(command->routeId)
+            || !getData(parameters, numberOfCities, command->route.lengths,
+                        command->route.years, command->route.names)) {
+            command->kind = INCORRECT_COMMAND;
+        }
+        else {
+            command->kind = PARSED_ROUTE;
+        }
     }
-
-    return correct;
 }
 
 /**
- * @brief Szuka miasta o podanej nazwie w mapie lub dodaje miasto, jeśli
- * miasto podanej nazwie nie istnieje.
- * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] name           – nazwa miasta;
- * @param[in,out] cities     – tablica wskaźników na miasta;
- * @param[in] index          – indeks szukanego miasta w tablicy @p cities.
- * @return Wartość @p true, jeśli znaleziono miasto lub udało się utworzyć
- * miasto o podanej nazwie.
- * Wartość @p false, jeśli nie udało się dodać miasta.
+ * @brief Parsuje wczytaną linię.
+ * Linie bez znaku nowej linii na końcu są błędne. Polecenia utworzenia drogi
+ * krajowej, czyli linie zaczynające się cyfrą, są parsowane w całości,
+ * a pozostałe polecenia są parsowane dopiero przy wykonaniu.
+ * @param[in,out] command    – wskaźnik na polecenie z wczytaną linią;
+ * @param[in] characters     – liczba znaków wczytanej linii.
  */
-static bool findOrAddCity(Map *map, char *name, City **cities, int index) {
-    cities[index] = findCity(map, name);
-    
-    if (cities[index] == NULL) {
-        cities[index] = addCity(map, name);
+static void parseCommand(Command *command, ssize_t characters) {
+    char *line = command->line;
+    char *parameters = strchr(line, ';');
+
+    command->kind = UNPARSED_COMMAND;
+    if (line[characters - 1] != '\n') {
+        command->kind = INCORRECT_COMMAND;
+    }
+    else if ((line[0] >= '0') && (line[0] <= '9') && (parameters != NULL)) {
+        parseRouteCommand(command, parameters + 1);
     }
+}
 
-    if (cities[index] != NULL) {
+/**
+ * @brief Sprawdza, czy licznik bufora cyklicznego ma daną wartość, a wątek
+ * czytający nie skończył pracy.
+ * @param[in] pipeline       – wskaźnik na bufor cykliczny;
+ * @param[in] counter        – wskaźnik na licznik bufora;
+ * @param[in] value          – wartość licznika.
+ * @return Wartość @p true, jeśli licznik ma wartość @p value, a wątek
+ * czytający nie skończył pracy.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isUnchanged(Pipeline *pipeline, atomic_size_t *counter,
+                        size_t value) {
+    if ((atomic_load(counter) == value)
+        && !atomic_load(&pipeline->finished)) {
         return true;
     }
     else {
@@ -555,323 +1927,561 @@ static bool findOrAddCity(Map *map, char *name, City **cities, int index) {
 }
 
 /**
- * @brief Tworzy tablicę wskaźników na miasta.
- * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] numberOfCities – liczba miast w drodze krajowej;
- * @param[in] names          – tablica nazw miast.
- * @return Wskaźnik na tablicę wskaźników na miasta lub wartość NULL,
- * jeśli nie udało się zaalokować pamięci.
+ * @brief Czeka, aż licznik bufora cyklicznego zmieni wartość albo wątek
+ * czytający skończy pracę.
+ * Najpierw oddaje procesor przez @ref PIPELINE_SPINS prób, a potem zasypia
+ * do czasu zmiany. Przed uśpieniem zwiększa liczbę uśpionych wątków
+ * i sprawdza licznik jeszcze raz, więc nie przegapi zmiany ogłoszonej przez
+ * @ref announceChange.
+ * @param[in,out] pipeline   – wskaźnik na bufor cykliczny;
+ * @param[in] counter        – wskaźnik na licznik bufora;
+ * @param[in] value          – wartość licznika, na której zmianę czeka.
  */
-static City** makeCitiesArray(Map *map, int numberOfCities, char *names[]) {
-    bool error = false;
-    int i = 1;
-    City **cities = (City **)malloc(numberOfCities * sizeof(City *));
+static void waitForChange(Pipeline *pipeline, atomic_size_t *counter,
+                          size_t value) {
+    int spins = 0;
 
-    if (cities != NULL) {
-        if (!findOrAddCity(map, names[0], cities, 0)) {
-            error = true;
-        }
-        else {
-            while ((i < numberOfCities) && !error) {
-                if (!findOrAddCity(map, names[i], cities, i)) {
-                    error = true;
-                }
-                i++;
-            }
+    while (isUnchanged(pipeline, counter, value) && (spins < PIPELINE_SPINS)) {
+        sched_yield();
+        spins++;
+    }
+
+    if (isUnchanged(pipeline, counter, value)) {
+        pthread_mutex_lock(&pipeline->mutex);
+        atomic_fetch_add(&pipeline->sleeping, 1);
+        while (isUnchanged(pipeline, counter, value)) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
         }
+        atomic_fetch_sub(&pipeline->sleeping, 1);
+        pthread_mutex_unlock(&pipeline->mutex);
     }
+}
 
-    if (error) {
-        free(cities);
-        cities = NULL;
+/**
+ * @brief Budzi wątek uśpiony w oczekiwaniu na zmianę bufora cyklicznego.
+ * Wywoływana po zmianie licznika bufora lub końcu pracy wątku czytającego.
+ * Muteks jest brany tylko wtedy, gdy jakiś wątek śpi.
+ * @param[in,out] pipeline   – wskaźnik na bufor cykliczny.
+ */
+static void announceChange(Pipeline *pipeline) {
+    if (atomic_load(&pipeline->sleeping) > 0) {
+        pthread_mutex_lock(&pipeline->mutex);
+        pthread_cond_broadcast(&pipeline->changed);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+}
+
+/**
+ * @brief Czeka, aż w buforze cyklicznym zwolni się miejsce.
+ * Miejsce jest wolne, gdy bufor nie jest pełny, a bufory niewykonanych
+ * poleceń nie przekraczają @ref MAX_PIPELINE_BYTES bajtów lub wszystkie
+ * polecenia zostały wykonane.
+ * @param[in,out] pipeline   – wskaźnik na bufor cykliczny;
+ * @param[in] head           – liczba poleceń wstawionych do bufora.
+ */
+static void waitForFreeCommand(Pipeline *pipeline, size_t head) {
+    size_t tail = atomic_load(&pipeline->tail);
+
+    while ((head - tail == PIPELINE_SIZE)
+           || ((head != tail)
+               && (atomic_load(&pipeline->bytes) > MAX_PIPELINE_BYTES))) {
+        waitForChange(pipeline, &pipeline->tail, tail);
+        tail = atomic_load(&pipeline->tail);
     }
+}
+
+/**
+ * @brief Oblicza łączny rozmiar buforów polecenia.
+ * @param[in] command        – wskaźnik na polecenie.
+ * @return Rozmiar buforów polecenia w bajtach.
+ */
+static size_t commandBytes(Command *command) {
+    size_t cityBytes = sizeof(char *) + sizeof(unsigned) + sizeof(int)
+                       + sizeof(City *) + sizeof(Road *);
 
-    return cities;
+    return command->lineSize + (size_t)command->route.size * cityBytes;
 }
 
 /**
- * @brief Sprawdza, czy w tworzonej drodze nie ma pętli lub samoprzecięć.
- * Przechodzi po tablicy miast zaznaczająć odwiedzone miasta. W przypadku
- * napotkania odwiedzonego już wcześniej miasta, przerywa pętlę i zapisuje
- * informację o błędzie. Na koniec, zaznacza wszystkie miasta jako nieodwiedzone.
- * @param[in] cities         – tablica wskaźników na miasta;
- * @param[in] numberOfCities – liczba miast w tablicy.
- * @return Wartość @p true, jeśli w tworzonej drodze nie ma pętli.
- * Wartość @p false, w przeciwnym przypadku.
+ * @brief Funkcja wątku czytającego polecenia.
+ * Wczytuje kolejne linie ze standardowego wejścia bezpośrednio do wolnych
+ * miejsc bufora cyklicznego, pomija linie rozpoczynające się znakami '#'
+ * lub '\n', a pozostałe parsuje i przekazuje wątkowi wykonującemu polecenia.
+ * Na końcu danych zaznacza, że skończył pracę.
+ * @param[in,out] data       – wskaźnik na bufor cykliczny.
+ * @return Wartość NULL.
  */
-static bool checkLoops(City **cities, int numberOfCities) {
-    int i = 0;
-    bool correct = true;
-    
-    while ((i < numberOfCities) && correct) {
-        if (cities[i]->vertex->usedInRoute == true) {
-            correct = false;
+static void* readCommands(void *data) {
+    Pipeline *pipeline = (Pipeline *)data;
+    Command *command;
+    ssize_t charactersInString = 0;
+    size_t head = 0;
+    int lineNumber = 1;
+
+    while (charactersInString != -1) {
+        waitForFreeCommand(pipeline, head);
+        command = &pipeline->commands[head % PIPELINE_SIZE];
+        charactersInString = getline(&command->line, &command->lineSize,
+                                     stdin);
+        if (charactersInString != -1) {
+            if ((command->line[0] != '#') && (command->line[0] != '\n')) {
+                command->lineNumber = lineNumber;
+                parseCommand(command, charactersInString);
+                command->bytes = commandBytes(command);
+                atomic_fetch_add(&pipeline->bytes, command->bytes);
+                head++;
+                atomic_store(&pipeline->head, head);
+                announceChange(pipeline);
+            }
+            lineNumber++;
         }
-        else {
-            cities[i]->vertex->usedInRoute = true;
+    }
+
+    atomic_store(&pipeline->finished, true);
+    announceChange(pipeline);
+
+    return NULL;
+}
+
+/**
+ * @brief Wykonuje polecenie przekazane przez wątek czytający.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+static void executeCommand(Map *map, Command *command, BulkLoad *bulk,
+                           Output *output) {
+    if (command->kind == INCORRECT_COMMAND) {
+        flushBulkLoad(map, bulk, &command->route, output);
+        printError(map, command->lineNumber, output);
+    }
+    else if ((command->kind == PARSED_ROUTE) && bulk->active) {
+        deferCommand(map, bulk, &command->route, command->lineNumber,
+                     command->routeId, command->numberOfCities,
+                     command->route.names, command->route.lengths,
+                     command->route.years, output);
+    }
+    else if (command->kind == PARSED_ROUTE) {
+        flushBulkLoad(map, bulk, &command->route, output);
+        if (!buildRoute(map, command->routeId, command->numberOfCities,
+                        &command->route)) {
+            printError(map, command->lineNumber, output);
         }
-        i++;
     }
+    else {
+        handleCommand(map, command->line, command->lineNumber,
+                      &command->route, bulk, output);
+    }
+}
 
-    i = 0;
-    while (i < numberOfCities) {
-        cities[i]->vertex->usedInRoute = false;
-        i++;
+/**
+ * @brief Zwalnia duże bufory polecenia.
+ * Dzięki temu pamięć zajmowana przez bufor cykliczny po wykonaniu długich
+ * poleceń nie zależy od ich długości.
+ * @param[in,out] command    – wskaźnik na wykonane polecenie.
+ */
+static void releaseLargeBuffers(Command *command) {
+    RouteData empty = {0, NULL, NULL, NULL, NULL, NULL};
+
+    if (command->lineSize > MAX_KEPT_LINE) {
+        free(command->line);
+        command->line = NULL;
+        command->lineSize = 0;
     }
 
-    return correct;
+    if (command->route.size > MAX_KEPT_ROUTE) {
+        freeRouteData(&command->route);
+        command->route = empty;
+    }
 }
 
 /**
- * @brief Dodaje potrzebne do utworzenia drogi krajowej odcinki dróg.
- * Jeśli droga między miastami nie istnieje, to ją tworzy. Jeśli podany rok
- * budowy lub ostatniego remontu jest większy od roku drogi, aktualizuje
- * ten rok.
+ * @brief Wykonuje w kolejności polecenia przekazywane przez wątek czytający.
+ * Kończy działanie, gdy wątek czytający skończył pracę, a wszystkie
+ * przekazane przez niego polecenia zostały wykonane.
  * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] cities         – tablica wskaźników na miasta;
- * @param[in] numberOfCities – liczba miast w drodze krajowej;
- * @param[in] lengths        – tablica długości odcinków dróg;
- * @param[in] years          – tablica lat budowy lub ostatniego remontu dróg.
- * @return Wartość @p true, jeśli udało się utworzyć potrzebne odcinki dróg.
- * Wartość @p false, w przeciwnym przypadku.
+ * @param[in,out] pipeline   – wskaźnik na bufor cykliczny;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
  */
-static bool addRoads(Map *map, City **cities, int numberOfCities,
-                     unsigned lengths[], int years[]) {
-    int i = 0;
-    bool correct = true;
-    Road *road;
+static void executeCommands(Map *map, Pipeline *pipeline, Output *output) {
+    RouteData data = {0, NULL, NULL, NULL, NULL, NULL};
+    BulkLoad bulk;
+    Command *command;
+    size_t head, tail = 0;
+    bool end = false;
 
-    while ((i < numberOfCities - 1) && correct) {
-        road = findRoad(cities[i], cities[i + 1]);
-        if (road == NULL) {
-            road = newRoad(map, cities[i], cities[i + 1], lengths[i], years[i]);
-            if (road == NULL) {
-                correct = false;
+    setBulkLoadValues(&bulk);
+
+    while (!end) {
+        head = atomic_load_explicit(&pipeline->head, memory_order_acquire);
+        if (head != tail) {
+            while (tail != head) {
+                command = &pipeline->commands[tail % PIPELINE_SIZE];
+                executeCommand(map, command, &bulk, output);
+                releaseLargeBuffers(command);
+                atomic_fetch_sub(&pipeline->bytes, command->bytes);
+                tail++;
+                atomic_store(&pipeline->tail, tail);
+                announceChange(pipeline);
             }
         }
-        else {
-            if (road->year < years[i]) {
-                road->year = years[i];
+        else if (atomic_load_explicit(&pipeline->finished,
+                                      memory_order_acquire)) {
+            head = atomic_load_explicit(&pipeline->head, memory_order_acquire);
+            if (head == tail) {
+                end = true;
             }
         }
-
-        if (correct) {
-            cities[i]->vertex->road = road;
+        else {
+            waitForChange(pipeline, &pipeline->head, tail);
         }
-        i++;
     }
 
-    return correct;
+    flushBulkLoad(map, &bulk, &data, output);
+    freeBulkLoad(&bulk);
+    freeRouteData(&data);
 }
 
 /**
- * @brief Tworzy drogę krajową o podanym przebiegu.
- * Tworzy tablicę identyfikatorów poprzedników miast, a następnie wywołuje
- * funkcję tworzącą drogę krajową. Na końcu zapisuje nowoutworzoną drogę do mapy.
- * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] id             – identyfikator drogi krajowej;
- * @param[in] cities         – tablica wskaźników na miasta;
- * @param[in] numberOfCities – liczba miast w drodze krajowej.
- * @return Wartość @p true, jeśli udało utworzyć się drogę krajową.
- * Wartość @p false, w przeciwnym przypadku.
+ * @brief Tworzy pusty bufor cykliczny poleceń.
+ * @return Wskaźnik na bufor cykliczny lub NULL, gdy nie udało się zaalokować
+ * pamięci.
  */
-static bool makeRoute(Map *map, unsigned id, City **cities, int numberOfCities) {
-    int previous[map->numberOfCities];
-    Route *route;
-    int i = 0;
-    bool correct = true;
+static Pipeline* newPipeline(void) {
+    Pipeline *pipeline = (Pipeline *)calloc(1, sizeof(Pipeline));
+
+    if (pipeline != NULL) {
+        atomic_init(&pipeline->head, 0);
+        atomic_init(&pipeline->tail, 0);
+        atomic_init(&pipeline->bytes, 0);
+        atomic_init(&pipeline->finished, false);
+        atomic_init(&pipeline->sleeping, 0);
+        pthread_mutex_init(&pipeline->mutex, NULL);
+        pthread_cond_init(&pipeline->changed, NULL);
+    }
 
-    while ((i < numberOfCities - 1) && correct) {
-        previous[cities[i]->vertex->id] = cities[i + 1]->vertex->id;
-        i++;
+    return pipeline;
+}
+
+/**
+ * @brief Usuwa bufor cykliczny poleceń.
+ * @param[in] pipeline       – wskaźnik na bufor cykliczny.
+ */
+static void deletePipeline(Pipeline *pipeline) {
+    int i;
+
+    if (pipeline != NULL) {
+        for (i = 0; i < PIPELINE_SIZE; i++) {
+            free(pipeline->commands[i].line);
+            freeRouteData(&pipeline->commands[i].route);
+        }
+        pthread_cond_destroy(&pipeline->changed);
+        pthread_mutex_destroy(&pipeline->mutex);
+        free(pipeline);
     }
-    previous[cities[i]->vertex->id] = -1;
+}
 
-    route = addRoute(map, id, cities[0]->vertex->id,
-                     cities[numberOfCities - 1]->vertex->id, previous);
-    
-    if (route == NULL) {
-        correct = false;
+bool isReadCommand(char *line) {
+    if ((strstr(line, "getRouteDescription;") == line)
+        || (strstr(line, "getCityRoutes;") == line)
+        || (strstr(line, "pathFromYear;") == line)
+        || (strstr(line, "paretoRoutes;") == line)
+        || (strstr(line, "distances;") == line)
+        || (strstr(line, "distanceMatrix;") == line)
+        || (strstr(line, "isochrone;") == line)
+        || (strstr(line, "nearestOnRoute;") == line)) {
+        return true;
     }
     else {
-        addRouteToMap(map, route);
+        return false;
     }
-
-    return correct;
 }
 
 /**
- * @brief Funkcja odpowiedzialna za obsługę polecenia tworzenia nowej drogi.
- * Funkcja sprawdza różne przypadki, w których mógł wystąpić błąd, a następnie,
- * jeśli nie ma błędu, wywołuje funkcję tworzącą nową drogę krajową.
- * @param[in,out] map        – wskaźnik na strukturę mapy;
- * @param[in] id             – identyfikator drogi krajowej;
- * @param[in] parameters     – napis zawierający potrzebne parametry;
- * @param[in] lineNumber     – numer linii, w której wywołano funkcję. 
+ * @brief Uzyskuje dostęp do współdzielonej mapy przed wykonaniem polecenia.
+ * Polecenia tylko odczytujące mapę dostają dostęp współdzielony, o ile nie
+ * trzeba przed nimi wykonać poleceń odłożonych w trybie zbiorczym, a pozostałe
+ * polecenia dostęp wyłączny. Sesja, która ma już dostęp wyłączny, zachowuje
+ * go. Nic nie robi, jeśli mapa nie jest współdzielona.
+ * @param[in,out] lock       – wskaźnik na blokadę mapy lub NULL;
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] exclusive  – informacja o tym, czy sesja ma wyłączny dostęp
+ *                             do mapy.
  */
-static void makeRouteCommand(Map *map, unsigned id, char *parameters,
-                             int lineNumber) {
-    bool error = false;
-    int numberOfCities = calculateNumberOfCities(parameters);
-    char *names[numberOfCities];
-    unsigned lengths[numberOfCities - 1];
-    int years[numberOfCities - 1];
-    City **cities = NULL;
-
-    if ((numberOfCities == 1) || !isRouteIdCorrect(id)
-        || (findRoute(map, id) != NULL)) {
-        error = true;
-    }
-    else {
-        if (!getData(parameters, numberOfCities, lengths, years, names)) {
-            error = true;
+static void lockMap(pthread_rwlock_t *lock, char *line, BulkLoad *bulk,
+                    bool *exclusive) {
+    if ((lock != NULL) && !*exclusive) {
+        if (isReadCommand(line) && (bulk->numberOfRecords == 0)) {
+            pthread_rwlock_rdlock(lock);
         }
         else {
-            if (!canRouteBeMade(map, numberOfCities, names, lengths, years)) {
-                error = true;
-            }
-            else {
-                cities = makeCitiesArray(map, numberOfCities, names);
-                if (cities == NULL) {
-                    error = true;
-                }
-                else {
-                    if (!checkLoops(cities, numberOfCities)
-                        || !addRoads(map, cities, numberOfCities, lengths, years)) {
-                        error = true;
-                    }
-                    else {
-                        if (!makeRoute(map, id, cities, numberOfCities)) {
-                            error = true;
-                        }
-                    }
-                }
-            }
+            pthread_rwlock_wrlock(lock);
+            *exclusive = true;
         }
     }
+}
 
-    free(cities);
-    if (error) {
-        printError(lineNumber);
+/**
+ * @brief Zwalnia dostęp do współdzielonej mapy po wykonaniu polecenia.
+ * Sesja z otwartą grupą zmian zachowuje wyłączny dostęp aż do zatwierdzenia
+ * lub wycofania grupy, dzięki czemu inne sesje nie widzą jej częściowych
+ * zmian. Nic nie robi, jeśli mapa nie jest współdzielona.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] lock       – wskaźnik na blokadę mapy lub NULL;
+ * @param[in,out] exclusive  – informacja o tym, czy sesja ma wyłączny dostęp
+ *                             do mapy.
+ */
+static void unlockMap(Map *map, pthread_rwlock_t *lock, bool *exclusive) {
+    if ((lock != NULL) && (!*exclusive || !map->undoLog.batch)) {
+        pthread_rwlock_unlock(lock);
+        *exclusive = false;
     }
 }
 
 /**
- * @brief Wyodrębnia z napisu numer drogi krajowej.
- * Wywołuje funkcję dającą w wyniku kolejny parametr, następnie sprawdza
- * czy parametr ten jest liczbą i parsuje ten parametr na liczbę.
- * W przypadku, gdy podany parametr nie jest liczbą, lub parsowanie
- * nie powiodło się, ustawia wartość @p routeIdNumber na -1.
- * @param[in] route      – wskaźnik na napis zawierający identyfikator drogi
- *                         krajowej jako pierwszy element.
- * @return Wartość @p route reprezentującą numer drogi krajowej lub -1,
- * w przypadku niepoprawnych danych.
+ * @brief Ogranicza czas oczekiwania na kolejne polecenie sesji, która ma
+ * wyłączny dostęp do współdzielonej mapy.
+ * Sesja z otwartą grupą zmian blokuje mapę innym sesjom, więc jeśli jej
+ * klient nie przyśle kolejnego polecenia w podanym czasie, czytanie kończy
+ * się błędem, a grupa jest wycofywana tak jak na końcu danych. Po zwolnieniu
+ * mapy znosi ograniczenie. Zmienia ustawienia gniazda tylko wtedy, gdy
+ * zmienił się rodzaj dostępu do mapy.
+ * @param[in,out] input      – strumień wejściowy sesji;
+ * @param[in] batchTimeout   – limit czasu w sekundach lub 0, jeśli czas
+ *                             oczekiwania nie jest ograniczony;
+ * @param[in] exclusive      – informacja o tym, czy sesja ma wyłączny dostęp
+ *                             do mapy;
+ * @param[in,out] limited    – informacja o tym, czy czas oczekiwania jest
+ *                             ograniczony.
  */
-static unsigned routeIdNumber(char *route) {
-    char *routeId;
-    unsigned long routeIdNumber;
-    bool error = false;
+static void limitBatchTime(FILE *input, int batchTimeout, bool exclusive,
+                           bool *limited) {
+    struct timeval limit = {0, 0};
 
-    routeId = getParameter(&route);
-    if ((routeId == NULL) || (routeId[0] == '\0')) {
-        error = true;
+    if ((batchTimeout > 0) && (exclusive != *limited)) {
+        if (exclusive) {
+            limit.tv_sec = batchTimeout;
+        }
+        setsockopt(fileno(input), SOL_SOCKET, SO_RCVTIMEO, &limit,
+                   sizeof(limit));
+        *limited = exclusive;
     }
-    else {
-        if (!isNumber(routeId, true)) {
-            error = true;
+}
+
+/**
+ * @brief Wykonuje polecenie na przypiętej wersji mapy, jeśli to możliwe.
+ * Polecenia getRouteDescription i getCityRoutes sesji, która nie ma
+ * wyłącznego dostępu do mapy ani poleceń odłożonych w trybie zbiorczym, są
+ * wykonywane na najnowszej zatwierdzonej wersji mapy, bez blokady mapy, więc
+ * nie czekają na zakończenie zmian wprowadzanych przez inne sesje. Sesja
+ * z otwartą grupą zmian ma wyłączny dostęp do mapy, więc widzi swoje
+ * niezatwierdzone zmiany.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej, pełnej
+ *                             linii;
+ * @param[in] lineNumber     – numer wczytanej linii;
+ * @param[in] bulk           – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in] exclusive      – informacja o tym, czy sesja ma wyłączny dostęp
+ *                             do mapy;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ * @return Wartość @p true, jeśli polecenie zostało wykonane.
+ * Wartość @p false, gdy polecenie trzeba wykonać na mapie lub nie udało się
+ * przypiąć wersji mapy.
+ */
+static bool doSnapshotCommand(Map *map, char *line, int lineNumber,
+                              BulkLoad *bulk, bool exclusive,
+                              Output *output) {
+    char *parameters = strchr(line, ';');
+    Snapshot *snapshot = NULL;
+    bool routeQuery = (strstr(line, "getRouteDescription;") == line);
+    bool cityQuery = (strstr(line, "getCityRoutes;") == line);
+
+    if (!exclusive && (bulk->numberOfRecords == 0)
+        && (routeQuery || cityQuery)) {
+        snapshot = pinSnapshot(map);
+    }
+
+    if (snapshot != NULL) {
+        if (routeQuery) {
+            getRouteDescriptionCommand(NULL, snapshot, parameters + 1,
+                                       lineNumber, output);
         }
         else {
-            routeIdNumber = strtoul(routeId, NULL, 10);
-            if (!isUnsigned(routeIdNumber)) {
-                error = true;
-            }
+            getCityRoutesCommand(NULL, snapshot, parameters + 1, lineNumber,
+                                 output);
         }
+        releaseSnapshot(map, snapshot);
     }
 
-    if (error) {
-        routeIdNumber = 0;
-    }
-
-    return routeIdNumber;
+    return snapshot != NULL;
 }
 
 /**
- * @brief Wybiera poprawną funkcję obsługującą dane polecenie.
- * Sprawdza, które polecenie zostało wczytane ze standardowego wejścia,
- * następnie wywołuje funkcję do obsługi danego polecenia. Oprócz tego
- * na zmienną @p parameters zapisuje wskaźnik na pierwszy element po
- * pierwszym średniku, czyli po poleceniu.
- * @param[in,out] map    – wskaźnik na strukturę mapy;
- * @param[in] line       – wskaźnik na pierwszy znak wczytanej linii;
- * @param[in] lineNumber – numer wczytanej linii.
+ * @brief Czyta pojedyncze linie z podanego strumienia i wykonuje polecenia
+ * na podanej mapie.
+ * Na końcu danych wycofuje otwarte grupy zmian. Jeśli podany jest zbiór map,
+ * polecenia są wykonywane na mapie wybranej poleceniem useMap, a w przeciwnym
+ * przypadku na podanej mapie, a polecenie useMap jest błędem. Jeśli podana
+ * jest blokada, mapa jest współdzielona z innymi sesjami, a każde polecenie
+ * jest wykonywane z odpowiednim dostępem do niej lub na przypiętej wersji
+ * mapy. Sesja, która na końcu danych nie ma wyłącznego dostępu do mapy ani
+ * odłożonych poleceń, kończy się bez czekania na dostęp do mapy.
+ * @param[in,out] maps       – wskaźnik na zbiór map lub NULL;
+ * @param[in,out] map        – wskaźnik na strukturę mapy, gdy nie podano
+ *                             zbioru map;
+ * @param[in,out] input      – strumień wejściowy;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe;
+ * @param[in,out] lock       – wskaźnik na blokadę mapy lub NULL;
+ * @param[in] batchTimeout   – limit czasu w sekundach, przez jaki sesja
+ *                             z otwartą grupą zmian czeka na kolejne
+ *                             polecenie, lub 0, jeśli czas ten nie jest
+ *                             ograniczony.
  */
-static void chooseFunction(Map *map, char *line, int lineNumber) {
-    char *parameters = strchr(line, ';');
-    char *route;
-    unsigned routeId;
+static void doCommands(MapSet *maps, Map *map, FILE *input, Output *output,
+                       pthread_rwlock_t *lock, int batchTimeout) {
+    RouteData data = {0, NULL, NULL, NULL, NULL, NULL};
+    BulkLoad session;
+    BulkLoad *bulk = &session;
+    char *line = NULL;
+    int charactersInString = 0, lineNumber = 1, target;
+    size_t length;
+    bool exclusive = false, limited = false;
 
-    if (parameters != NULL) {
-        parameters++;
-        if (strstr(line, "addRoad;") == line) {
-            addRoadCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "repairRoad;") == line) {
-            repairRoadCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "getRouteDescription;") == line) {
-            getRouteDescriptionCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "newRoute;") == line) {
-            newRouteCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "extendRoute;") == line) {
-            extendRouteCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "removeRoad;") == line) {
-            removeRoadCommand(map, parameters, lineNumber);
-        }
-        else if (strstr(line, "removeRoute;") == line) {
-            removeRouteCommand(map, parameters, lineNumber);
-        }
-        else {
-            route = line;
-            routeId = routeIdNumber(route);
-            if (routeId != 0) {
-                makeRouteCommand(map, routeId, parameters, lineNumber);
+    setBulkLoadValues(&session);
+    if (maps != NULL) {
+        map = maps->streams[maps->current].map;
+        bulk = &maps->streams[maps->current].bulk;
+    }
+
+    while ((charactersInString = getline(&line, &length, input)) != -1) {
+        if ((line[0] != '#') && (line[0] != '\n')
+            && ((line[charactersInString - 1] != '\n')
+                || !doSnapshotCommand(map, line, lineNumber, bulk, exclusive,
+                                      output))) {
+            lockMap(lock, line, bulk, &exclusive);
+            if ((line[charactersInString - 1] == '\n') && (maps != NULL)
+                && (strstr(line, "useMap;") == line)) {
+                target = findMapStream(maps, strchr(line, ';') + 1);
+                useMapCommand(&maps->streams[maps->current], target,
+                              lineNumber, &data, output);
+                if (target >= 0) {
+                    maps->current = target;
+                }
+                map = maps->streams[maps->current].map;
+                bulk = &maps->streams[maps->current].bulk;
+            }
+            else if (line[charactersInString - 1] == '\n') {
+                handleCommand(map, line, lineNumber, &data, bulk, output);
             }
             else {
-                printError(lineNumber);
+                flushBulkLoad(map, bulk, &data, output);
+                printError(map, lineNumber, output);
             }
+            unlockMap(map, lock, &exclusive);
+            limitBatchTime(input, batchTimeout, exclusive, &limited);
         }
+        lineNumber++;
     }
-    else {
-        printError(lineNumber);
+
+    if (maps != NULL) {
+        for (int i = 0; i < maps->numberOfStreams; i++) {
+            finishMapStream(&maps->streams[i], &data, output);
+        }
     }
+    else if ((lock == NULL) || exclusive || (bulk->numberOfRecords > 0)) {
+        lockMap(lock, "", bulk, &exclusive);
+        flushBulkLoad(map, bulk, &data, output);
+        if (map->undoLog.batch) {
+            abortBatch(map);
+        }
+        unlockMap(map, lock, &exclusive);
+    }
+
+    freeBulkLoad(&session);
+    freeRouteData(&data);
+    free(line);
+}
+
+int numberOfWindowThreads(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = MAX_WINDOW_THREADS;
+
+    if ((processors > 0) && (processors < threads)) {
+        threads = processors;
+    }
+
+    return threads;
 }
 
 void readAndDoCommands(void) {
-    Map *map = NULL;
-    char *line = NULL;
-    int charactersInString = 0, lineNumber = 1;
-    size_t length;
+    MapSet maps;
+    Output output = {stdout, stderr};
+
+    if (newMapSet(&maps)) {
+        doCommands(&maps, NULL, stdin, &output, NULL, 0);
+    }
+    deleteMapSet(&maps);
+}
+
+void readAndDoPipelinedCommands(void) {
+    Map *map = newMap();
+    Pipeline *pipeline = newPipeline();
+    Output output = {stdout, stderr};
+    pthread_t reader;
 
-    map = newMap();
     if (map != NULL) {
         setMapValues(map);
-
-        while ((charactersInString = getline(&line, &length, stdin)) != -1) {
-            if ((line[0] != '#') && (line[0] != '\n')) {
-                if (line[charactersInString - 1] == '\n') {
-                    chooseFunction(map, line, lineNumber);
-                }
-                else {
-                    printError(lineNumber);
-                }
-            }
-            lineNumber++;
+        if ((pipeline != NULL)
+            && (pthread_create(&reader, NULL, readCommands, pipeline) == 0)) {
+            executeCommands(map, pipeline, &output);
+            pthread_join(reader, NULL);
+        }
+        else {
+            doCommands(NULL, map, stdin, &output, NULL, 0);
         }
+        deleteMap(map);
+    }
+
+    deletePipeline(pipeline);
+}
+
+void readAndDoPartitionedCommands(void) {
+    Map *map = newMap();
+    Output output = {stdout, stderr};
+    Partition *partition;
 
+    if (map != NULL) {
+        setMapValues(map);
+        partition = newPartition(map, &output);
+        if (partition != NULL) {
+            doPartitionedCommands(partition);
+            deletePartition(partition);
+        }
+        else {
+            doCommands(NULL, map, stdin, &output, NULL, 0);
+        }
         deleteMap(map);
-        free(line);
     }
 }
+
+void readAndDoMapWorkerCommands(void) {
+    Output output = {stdout, stderr};
+    MapPool *pool = newMapPool(&output);
+
+    if (pool != NULL) {
+        doMapPoolCommands(pool);
+        deleteMapPool(pool);
+    }
+    else {
+        readAndDoCommands();
+    }
+}
+
+void serveCommands(Map *map, pthread_rwlock_t *lock, FILE *input,
+                   FILE *output, int batchTimeout) {
+    Output streams = {output, output};
+
+    doCommands(NULL, map, input, &streams, lock, batchTimeout);
+}
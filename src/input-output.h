@@ -8,14 +8,254 @@
 #ifndef __INPUT_OUTPUT_H__
 #define __INPUT_OUTPUT_H__
 
+#include "map.h"
+#include "bulk-load.h"
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define WINDOW_SIZE 1024      ///< największa liczba poleceń okna wykonania
+#define MAX_WINDOW_THREADS 64 ///< największa liczba wątków wykonania okna
+
+/**
+ * Struktura przechowująca tablice pomocnicze do tworzenia drogi krajowej.
+ */
+typedef struct RouteData RouteData;
+
+/**
+ * Struktura przechowująca strumienie wyjściowe poleceń.
+ */
+typedef struct Output Output;
+
+/**
+ * @brief Struktura przechowująca tablice pomocnicze do tworzenia drogi
+ * krajowej.
+ * Tablice są alokowane na stercie i powiększane tylko wtedy, gdy kolejna
+ * droga krajowa się w nich nie mieści, więc są używane ponownie przez kolejne
+ * polecenia, a ich rozmiar nie jest ograniczony rozmiarem stosu.
+ * Struktura zawiera:
+ * liczbę miast, na które jest miejsce w tablicach;
+ * tablice nazw miast, długości odcinków dróg i lat ich budowy lub ostatniego
+ * remontu;
+ * tablice wskaźników na miasta i odcinki dróg tworzonej drogi krajowej.
+ */
+struct RouteData {
+    int size;          ///< liczba miast, na które jest miejsce w tablicach
+    char **names;      ///< tablica nazw miast
+    unsigned *lengths; ///< tablica długości odcinków dróg
+    int *years;        ///< tablica lat budowy lub ostatniego remontu dróg
+    City **cities;     ///< tablica wskaźników na miasta
+    Road **roads;      ///< tablica wskaźników na odcinki dróg
+};
+
+/**
+ * @brief Struktura przechowująca strumienie wyjściowe poleceń.
+ * Przy czytaniu poleceń ze standardowego wejścia są to standardowe wyjście
+ * i standardowe wyjście diagnostyczne, a w trybie serwera oba strumienie
+ * prowadzą do gniazda klienta.
+ */
+struct Output {
+    FILE *results; ///< strumień wyników poleceń
+    FILE *errors;  ///< strumień informacji o błędach
+};
+
+/**
+ * @brief Drukuje informację o błędzie standardowe wyjście diagnostyczne.
+ * Błąd w otwartej grupie zmian powoduje wycofanie całej grupy przy jej
+ * zatwierdzeniu.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] lineNumber     – numer linii, w której wystąpił błąd;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+void printError(Map *map, int lineNumber, Output *output);
+
+/**
+ * @brief Daje w wyniku wskaźnik na następny parametr.
+ * Parametr kończy się pierwszym znakiem ';' lub '\n', w którego miejsce jest
+ * wstawiany znak końca napisu, a wskaźnik @p parameters jest przesuwany
+ * na pierwszy element po nim.
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami.
+ * @return Wskaźnik na pierwszy element parametru lub NULL, gdy nie ma
+ * kolejnego parametru.
+ */
+char* getParameter(char **parameters);
+
+/**
+ * @brief Wyodrębnia następny parametr i parsuje go na liczbę nieujemną.
+ * Parametr musi być niepustym ciągiem cyfr o wartości mieszczącej się
+ * w typie @p unsigned.
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami;
+ * @param[out] value         – wartość parametru.
+ * @return Wartość @p true, jeśli parametr istnieje i jest poprawną liczbą.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+bool getUnsignedParameter(char **parameters, unsigned *value);
+
+/**
+ * @brief Zwalnia tablice pomocnicze do tworzenia drogi krajowej.
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze.
+ */
+void freeRouteData(RouteData *data);
+
+/**
+ * @brief Wyodrębnia z napisu numer drogi krajowej.
+ * Wywołuje funkcję dającą w wyniku kolejny parametr, następnie sprawdza
+ * czy parametr ten jest liczbą i parsuje ten parametr na liczbę.
+ * W przypadku, gdy podany parametr nie jest liczbą, lub parsowanie
+ * nie powiodło się, ustawia wartość @p routeIdNumber na -1.
+ * @param[in] route      – wskaźnik na napis zawierający identyfikator drogi
+ *                         krajowej jako pierwszy element.
+ * @return Wartość @p route reprezentującą numer drogi krajowej lub -1,
+ * w przypadku niepoprawnych danych.
+ */
+unsigned routeIdNumber(char *route);
+
+/**
+ * @brief Wykonuje polecenia odłożone w trybie zbiorczym.
+ * Drukuje informacje o błędach nieudanych poleceń w kolejności ich linii.
+ * Jeśli nie udało się zaalokować pamięci na tablice pomocnicze trybu
+ * zbiorczego, wykonuje polecenia po kolei zwykłą ścieżką.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] bulk       – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+void flushBulkLoad(Map *map, BulkLoad *bulk, RouteData *data,
+                   Output *output);
+
+/**
+ * @brief Wybiera poprawną funkcję obsługującą dane polecenie.
+ * Sprawdza, które polecenie zostało wczytane ze standardowego wejścia,
+ * następnie wywołuje funkcję do obsługi danego polecenia. Oprócz tego
+ * na zmienną @p parameters zapisuje wskaźnik na pierwszy element po
+ * pierwszym średniku, czyli po poleceniu.
+ * @param[in,out] map    – wskaźnik na strukturę mapy;
+ * @param[in] line       – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] lineNumber – numer wczytanej linii;
+ * @param[in,out] data   – wskaźnik na tablice pomocnicze do tworzenia drogi
+ *                         krajowej;
+ * @param[in,out] bulk   – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] output – wskaźnik na strumienie wyjściowe.
+ */
+void chooseFunction(Map *map, char *line, int lineNumber,
+                    RouteData *data, BulkLoad *bulk, Output *output);
+
+/**
+ * @brief Obsługuje wczytane polecenie.
+ * W trybie zbiorczym odkłada polecenia addRoad i polecenia utworzenia drogi
+ * krajowej, a w trybie równoległego tworzenia dróg krajowych polecenia
+ * newRoute. Przed każdym innym poleceniem wykonuje polecenia odłożone
+ * wcześniej, dzięki czemu wynik jest taki sam jak bez tych trybów.
+ * @param[in,out] map    – wskaźnik na strukturę mapy;
+ * @param[in] line       – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] lineNumber – numer wczytanej linii;
+ * @param[in,out] data   – wskaźnik na tablice pomocnicze do tworzenia drogi
+ *                         krajowej;
+ * @param[in,out] bulk   – wskaźnik na strukturę trybu zbiorczego;
+ * @param[in,out] output – wskaźnik na strumienie wyjściowe.
+ */
+void handleCommand(Map *map, char *line, int lineNumber,
+                   RouteData *data, BulkLoad *bulk, Output *output);
+
+/**
+ * @brief Sprawdza, czy polecenie tylko odczytuje mapę.
+ * Takie polecenia nie zmieniają mapy ani jej tablic pomocniczych, więc mogą
+ * być wykonywane jednocześnie przez wiele sesji.
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej linii.
+ * @return Wartość @p true, jeśli polecenie tylko odczytuje mapę.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+bool isReadCommand(char *line);
+
+/**
+ * @brief Oblicza liczbę wątków wykonujących polecenia okna.
+ * @return Liczba dostępnych procesorów, ograniczona przez
+ * @ref MAX_WINDOW_THREADS.
+ */
+int numberOfWindowThreads(void);
+
 /**
  * @brief Czyta pojedyncze linie ze standardowego wejścia i wykonuje polecenia.
  * Tworzy nową mapę, a następnie pojedynczo wczytuje linie teskstu
  * ze standardowego wejścia, dopóki nie napotka znaku końca danych. Pomija
  * linie rozpoczynające się znakami '#' lub '\n'. Jeśli linia tekstu jest
  * poprawna tj. kończy się znakiem nowej linii, wywołuje od niej funkcję
- * wybierającą funkcję do obsługi wczytanego polecenia.
+ * wybierającą funkcję do obsługi wczytanego polecenia. Polecenie useMap
+ * wybiera z rejestru map mapę, na której są wykonywane kolejne polecenia,
+ * i tworzy ją, jeśli jeszcze nie istnieje.
  */
 void readAndDoCommands(void);
 
+/**
+ * @brief Czyta pojedyncze linie ze standardowego wejścia i wykonuje polecenia
+ * w dwóch wątkach.
+ * Działa tak jak @ref readAndDoCommands, ale linie są wczytywane i parsowane
+ * przez osobny wątek, który przekazuje je przez bufor cykliczny wątkowi
+ * wykonującemu polecenia. Polecenia są wykonywane w kolejności wczytania,
+ * a informacje o błędach są drukowane tylko przez wątek wykonujący polecenia,
+ * więc wyjście jest takie samo jak w @ref readAndDoCommands. Jeśli nie udało
+ * się utworzyć wątku, wykonuje polecenia tak jak @ref readAndDoCommands.
+ * Polecenia są wykonywane na jednej mapie, a polecenie useMap jest błędem.
+ */
+void readAndDoPipelinedCommands(void);
+
+/**
+ * @brief Czyta pojedyncze linie ze standardowego wejścia i wykonuje polecenia
+ * różnych składowych mapy równolegle.
+ * Działa tak jak @ref readAndDoCommands, ale polecenia są wczytywane oknami
+ * i dzielone na składowe mapy, do których się odwołują. Polecenia tylko
+ * odczytujące mapę i wyszukiwanie ścieżek poleceń newRoute są wykonywane
+ * równolegle przez kilka wątków, a polecenia zmieniające mapę po kolei,
+ * w kolejności wczytania. Polecenie jest wykonywane dopiero wtedy, gdy
+ * wykonano wszystkie wcześniejsze polecenia jego składowej, które mogą na nie
+ * wpłynąć. Wyniki są wypisywane w kolejności wczytania, więc wyjście jest
+ * takie samo jak w @ref readAndDoCommands. Polecenia w grupie zmian,
+ * w trybach odkładania poleceń i polecenia setDetourLimits są wykonywane tak
+ * jak w @ref readAndDoCommands. Polecenia są wykonywane na jednej mapie,
+ * a polecenie useMap jest błędem.
+ */
+void readAndDoPartitionedCommands(void);
+
+/**
+ * @brief Czyta pojedyncze linie ze standardowego wejścia i wykonuje polecenia
+ * różnych map równolegle.
+ * Działa tak jak @ref readAndDoCommands, ale polecenia są wczytywane oknami,
+ * a każda mapa ma stały wątek, który wykonuje jej polecenia w kolejności
+ * wczytania. Mapy nie mają wspólnych danych, więc wątki wykonują polecenia
+ * swoich map jednocześnie, bez żadnej synchronizacji w obrębie okna. Wyniki
+ * są wypisywane w kolejności wczytania, więc wyjście jest takie samo jak
+ * w @ref readAndDoCommands. Jeśli nie udało się zaalokować pamięci, wykonuje
+ * polecenia tak jak @ref readAndDoCommands.
+ */
+void readAndDoMapWorkerCommands(void);
+
+/**
+ * @brief Czyta pojedyncze linie z podanego strumienia i wykonuje polecenia
+ * na mapie współdzielonej z innymi sesjami.
+ * Działa tak jak @ref readAndDoCommands, ale wyniki poleceń i informacje
+ * o błędach pisze do jednego strumienia, linie są numerowane od początku
+ * sesji, a polecenie useMap jest błędem. Polecenia tylko odczytujące mapę są wykonywane jednocześnie
+ * z poleceniami odczytującymi innych sesji, a pozostałe polecenia mają
+ * wyłączny dostęp do mapy, więc każde polecenie działa tak, jakby wszystkie
+ * polecenia były wykonywane po kolei. Jeśli wersje mapy są udostępniane,
+ * polecenia getRouteDescription i getCityRoutes odczytują najnowszą
+ * zatwierdzoną wersję mapy bez czekania na dostęp do niej. Grupa zmian zachowuje wyłączny dostęp
+ * do mapy aż do jej zatwierdzenia lub wycofania, a grupa otwarta na końcu
+ * danych jest wycofywana. Jeśli klient sesji z otwartą grupą zmian nie
+ * przyśle kolejnego polecenia w podanym czasie, grupa jest wycofywana,
+ * a sesja się kończy, dzięki czemu bezczynny klient nie blokuje mapy innym
+ * sesjom.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] lock       – wskaźnik na blokadę mapy wspólną dla sesji;
+ * @param[in,out] input      – strumień wejściowy sesji, czytany z gniazda;
+ * @param[in,out] output     – strumień wyjściowy sesji;
+ * @param[in] batchTimeout   – limit czasu w sekundach, przez jaki sesja
+ *                             z otwartą grupą zmian czeka na kolejne
+ *                             polecenie, lub 0, jeśli czas ten nie jest
+ *                             ograniczony.
+ */
+void serveCommands(Map *map, pthread_rwlock_t *lock, FILE *input,
+                   FILE *output, int batchTimeout);
+
 #endif /* __INPUT_OUTPUT_H__ */
@@ -0,0 +1,490 @@
+/** @file
+ * Plik zawierający funkcje wykonywania poleceń wielu nazwanych map.
+ *
+ * Nazwane mapy są przechowywane w rejestrze map wraz ze stanem ich poleceń.
+ * W trybie wątków map każda mapa ma stały wątek, który wykonuje jej
+ * polecenia w kolejności wczytania, a rejestr jest zmieniany tylko przez
+ * wątek główny między oknami poleceń.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "map-pool.h"
+#include "help-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/**
+ * Struktura przechowująca polecenie okna wykonywanego przez wątki map.
+ */
+typedef struct PoolCommand PoolCommand;
+
+/**
+ * Struktura przechowująca dane jednego wątku wykonującego polecenia map.
+ */
+typedef struct PoolWorker PoolWorker;
+
+/**
+ * @brief Struktura przechowująca polecenie okna wykonywanego przez wątki
+ * map.
+ * Struktura zawiera:
+ * wczytaną linię wraz z rozmiarem jej bufora i numerem oraz informacją
+ * o tym, czy jest pełna;
+ * numer mapy, na której polecenie jest wykonywane;
+ * dla polecenia useMap numer wybranej mapy lub -1;
+ * położenie wyników polecenia w buforze wątku mapy.
+ * Bufory linii są zachowywane między kolejnymi oknami.
+ */
+struct PoolCommand {
+    char *line;          ///< wczytana linia
+    size_t lineSize;     ///< rozmiar bufora linii
+    int lineNumber;      ///< numer linii
+    bool complete;       ///< informacja o tym, czy linia jest pełna
+    int stream;          ///< numer mapy polecenia
+    bool switches;       ///< informacja o tym, czy to polecenie useMap
+    int target;          ///< numer mapy wybranej przez useMap lub -1
+    bool buffered;       ///< informacja o tym, czy wyniki są w buforze
+    long resultsStart;   ///< początek wyników w buforze
+    long resultsEnd;     ///< koniec wyników w buforze
+    long errorsStart;    ///< początek informacji o błędach w buforze
+    long errorsEnd;      ///< koniec informacji o błędach w buforze
+};
+
+/**
+ * @brief Struktura przechowująca dane jednego wątku wykonującego polecenia
+ * map.
+ * Struktura zawiera:
+ * wskaźnik na wspólny stan wykonania;
+ * tablice pomocnicze do tworzenia drogi krajowej, używane tylko przez ten
+ * wątek;
+ * bufory w pamięci, do których wątek wypisuje wyniki poleceń i informacje
+ * o błędach;
+ * identyfikator wątku.
+ */
+struct PoolWorker {
+    MapPool *pool;        ///< wskaźnik na wspólny stan wykonania
+    RouteData data;       ///< tablice pomocnicze drogi krajowej
+    FILE *results;        ///< strumień bufora wyników
+    char *resultsText;    ///< bufor wyników
+    size_t resultsSize;   ///< liczba znaków w buforze wyników
+    FILE *errors;         ///< strumień bufora informacji o błędach
+    char *errorsText;     ///< bufor informacji o błędach
+    size_t errorsSize;    ///< liczba znaków w buforze informacji o błędach
+    pthread_t thread;     ///< identyfikator wątku
+};
+
+/**
+ * @brief Struktura przechowująca stan wykonania poleceń map przez wątki
+ * map.
+ * Polecenia są wczytywane oknami. Każda mapa ma stały wątek, który wykonuje
+ * jej polecenia w kolejności wczytania, a wątki wykonują polecenia
+ * swoich map jednocześnie. Rejestr map jest zmieniany tylko przez wątek
+ * główny między oknami.
+ * Struktura zawiera:
+ * nazwane mapy i strumienie wyjściowe;
+ * polecenia okna wraz z ich liczbą;
+ * wątki wykonujące polecenia, z których pierwszym jest wątek główny, oraz
+ * stan ich wspólnej pracy.
+ */
+struct MapPool {
+    MapSet maps;              ///< nazwane mapy i stan ich poleceń
+    Output *output;           ///< wskaźnik na strumienie wyjściowe
+    PoolCommand commands[WINDOW_SIZE]; ///< tablica poleceń okna
+    int numberOfCommands;     ///< liczba poleceń okna
+    PoolWorker workers[MAX_WINDOW_THREADS]; ///< tablica wątków
+    int numberOfWorkers;      ///< liczba wątków wraz z wątkiem głównym
+    pthread_mutex_t mutex;    ///< muteks chroniący stan wspólnej pracy
+    pthread_cond_t work;      ///< zmienna warunkowa nowej fazy pracy
+    pthread_cond_t idle;      ///< zmienna warunkowa końca fazy pracy
+    int busy;                 ///< liczba wątków pracujących w bieżącej fazie
+    unsigned phase;           ///< numer bieżącej fazy pracy
+    bool end;                 ///< informacja o końcu pracy wątków
+};
+
+/**
+ * @brief Wykonuje polecenie okna na jego mapie.
+ * Jeśli wątek ma bufory w pamięci, polecenie wypisuje do nich wyniki,
+ * a w przeciwnym przypadku wypisuje je od razu.
+ * @param[in,out] pool       – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in] worker         – numer wątku.
+ */
+static void doPoolCommand(MapPool *pool, PoolCommand *command, int worker) {
+    PoolWorker *self = &pool->workers[worker];
+    MapStream *stream = &pool->maps.streams[command->stream];
+    Output output = *pool->output;
+
+    command->buffered = (self->results != NULL);
+    if (command->buffered) {
+        output.results = self->results;
+        output.errors = self->errors;
+        command->resultsStart = ftell(self->results);
+        command->errorsStart = ftell(self->errors);
+    }
+
+    if (command->switches) {
+        useMapCommand(stream, command->target, command->lineNumber,
+                      &self->data, &output);
+    }
+    else if (command->complete) {
+        handleCommand(stream->map, command->line, command->lineNumber,
+                      &self->data, &stream->bulk, &output);
+    }
+    else {
+        flushBulkLoad(stream->map, &stream->bulk, &self->data, &output);
+        printError(stream->map, command->lineNumber, &output);
+    }
+
+    if (command->buffered) {
+        command->resultsEnd = ftell(self->results);
+        command->errorsEnd = ftell(self->errors);
+    }
+}
+
+/**
+ * @brief Wykonuje w kolejności wczytania polecenia okna na mapach wątku.
+ * Mapa o numerze @p n należy do wątku o numerze @p n modulo liczba wątków.
+ * @param[in,out] pool       – wskaźnik na stan wykonania;
+ * @param[in] worker         – numer wątku.
+ */
+static void doPoolCommands(MapPool *pool, int worker) {
+    PoolCommand *command;
+
+    for (int i = 0; i < pool->numberOfCommands; i++) {
+        command = &pool->commands[i];
+        if (command->stream % pool->numberOfWorkers == worker) {
+            doPoolCommand(pool, command, worker);
+        }
+    }
+}
+
+/**
+ * @brief Funkcja wykonywana przez wątek wykonujący polecenia map.
+ * Czeka na kolejne okna i wykonuje polecenia swoich map, dopóki nie nastąpi
+ * koniec pracy.
+ * @param[in,out] argument   – wskaźnik na strukturę danych wątku.
+ * @return Wartość NULL.
+ */
+static void* runPoolWorker(void *argument) {
+    PoolWorker *worker = (PoolWorker *)argument;
+    MapPool *pool = worker->pool;
+    unsigned phase = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->end) {
+        if (pool->phase == phase) {
+            pthread_cond_wait(&pool->work, &pool->mutex);
+        }
+        else {
+            phase = pool->phase;
+            pthread_mutex_unlock(&pool->mutex);
+            doPoolCommands(pool, worker - pool->workers);
+            pthread_mutex_lock(&pool->mutex);
+            pool->busy--;
+            if (pool->busy == 0) {
+                pthread_cond_signal(&pool->idle);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Tworzy bufory w pamięci, do których wątki wypisują wyniki.
+ * @param[in,out] pool       – wskaźnik na stan wykonania.
+ * @return Wartość @p true, jeśli bufory zostały utworzone.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool openPoolBuffers(MapPool *pool) {
+    PoolWorker *worker;
+    bool correct = true;
+
+    for (int i = 0; i < pool->numberOfWorkers; i++) {
+        worker = &pool->workers[i];
+        worker->results = open_memstream(&worker->resultsText,
+                                         &worker->resultsSize);
+        worker->errors = open_memstream(&worker->errorsText,
+                                        &worker->errorsSize);
+        if ((worker->results == NULL) || (worker->errors == NULL)) {
+            correct = false;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Usuwa bufory w pamięci, do których wątki wypisują wyniki.
+ * @param[in,out] pool       – wskaźnik na stan wykonania.
+ */
+static void closePoolBuffers(MapPool *pool) {
+    PoolWorker *worker;
+
+    for (int i = 0; i < pool->numberOfWorkers; i++) {
+        worker = &pool->workers[i];
+        if (worker->results != NULL) {
+            fclose(worker->results);
+            free(worker->resultsText);
+        }
+        if (worker->errors != NULL) {
+            fclose(worker->errors);
+            free(worker->errorsText);
+        }
+        worker->results = NULL;
+        worker->resultsText = NULL;
+        worker->errors = NULL;
+        worker->errorsText = NULL;
+    }
+}
+
+/**
+ * @brief Wypisuje wyniki poleceń okna w kolejności wczytania.
+ * @param[in,out] pool       – wskaźnik na stan wykonania.
+ */
+static void printPoolCommands(MapPool *pool) {
+    PoolCommand *command;
+    PoolWorker *worker;
+
+    for (int i = 0; i < pool->numberOfWorkers; i++) {
+        fflush(pool->workers[i].results);
+        fflush(pool->workers[i].errors);
+    }
+
+    for (int i = 0; i < pool->numberOfCommands; i++) {
+        command = &pool->commands[i];
+        worker = &pool->workers[command->stream % pool->numberOfWorkers];
+        if (command->buffered && (command->resultsEnd > command->resultsStart)) {
+            fwrite(worker->resultsText + command->resultsStart, 1,
+                   command->resultsEnd - command->resultsStart,
+                   pool->output->results);
+        }
+        if (command->buffered && (command->errorsEnd > command->errorsStart)) {
+            fwrite(worker->errorsText + command->errorsStart, 1,
+                   command->errorsEnd - command->errorsStart,
+                   pool->output->errors);
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje polecenia okna.
+ * Wszystkie wątki wykonują jednocześnie polecenia swoich map, a wyniki
+ * poleceń są wypisywane w kolejności wczytania. Jeśli nie udało się utworzyć
+ * buforów, wątek główny wykonuje polecenia po kolei.
+ * @param[in,out] pool       – wskaźnik na stan wykonania.
+ */
+static void doPoolWindow(MapPool *pool) {
+    if (pool->numberOfCommands > 0) {
+        if (openPoolBuffers(pool)) {
+            pthread_mutex_lock(&pool->mutex);
+            if (pool->numberOfWorkers > 1) {
+                pool->busy = pool->numberOfWorkers - 1;
+                pool->phase++;
+                pthread_cond_broadcast(&pool->work);
+            }
+            pthread_mutex_unlock(&pool->mutex);
+
+            doPoolCommands(pool, 0);
+
+            pthread_mutex_lock(&pool->mutex);
+            while (pool->busy > 0) {
+                pthread_cond_wait(&pool->idle, &pool->mutex);
+            }
+            pthread_mutex_unlock(&pool->mutex);
+
+            printPoolCommands(pool);
+        }
+        else {
+            closePoolBuffers(pool);
+            for (int i = 0; i < pool->numberOfCommands; i++) {
+                doPoolCommand(pool, &pool->commands[i], 0);
+            }
+        }
+        closePoolBuffers(pool);
+        pool->numberOfCommands = 0;
+    }
+}
+
+bool newMapSet(MapSet *maps) {
+    bool correct = false;
+
+    maps->registry = newMapRegistry();
+    maps->streams = NULL;
+    maps->numberOfStreams = 0;
+    maps->sizeOfStreams = 0;
+    maps->current = 0;
+    if (maps->registry != NULL) {
+        maps->streams = (MapStream *)malloc(sizeof(MapStream));
+        if ((maps->streams != NULL)
+            && (useMap(maps->registry, DEFAULT_MAP_NAME) == 0)) {
+            maps->sizeOfStreams = 1;
+            maps->numberOfStreams = 1;
+            maps->streams[0].map = getRegisteredMap(maps->registry, 0);
+            setBulkLoadValues(&maps->streams[0].bulk);
+            correct = true;
+        }
+    }
+
+    return correct;
+}
+
+void deleteMapSet(MapSet *maps) {
+    for (int i = 0; i < maps->numberOfStreams; i++) {
+        freeBulkLoad(&maps->streams[i].bulk);
+    }
+    free(maps->streams);
+    deleteMapRegistry(maps->registry);
+}
+
+int findMapStream(MapSet *maps, char *parameters) {
+    char *name = getParameter(&parameters);
+    int size = enlargeSize(maps->sizeOfStreams);
+    MapStream *streams;
+    int number = -1;
+
+    if (maps->numberOfStreams == maps->sizeOfStreams) {
+        streams = (MapStream *)realloc(maps->streams,
+                                       size * sizeof(MapStream));
+        if (streams != NULL) {
+            maps->streams = streams;
+            maps->sizeOfStreams = size;
+        }
+    }
+
+    if ((name != NULL) && (parameters[0] == '\0')
+        && (maps->numberOfStreams < maps->sizeOfStreams)) {
+        number = useMap(maps->registry, name);
+        if (number == maps->numberOfStreams) {
+            maps->streams[number].map = getRegisteredMap(maps->registry,
+                                                         number);
+            setBulkLoadValues(&maps->streams[number].bulk);
+            maps->numberOfStreams++;
+        }
+    }
+
+    return number;
+}
+
+void useMapCommand(MapStream *stream, int target, int lineNumber,
+                   RouteData *data, Output *output) {
+    flushBulkLoad(stream->map, &stream->bulk, data, output);
+    if (target < 0) {
+        printError(stream->map, lineNumber, output);
+    }
+}
+
+void finishMapStream(MapStream *stream, RouteData *data,
+                     Output *output) {
+    flushBulkLoad(stream->map, &stream->bulk, data, output);
+    if (stream->map->undoLog.batch) {
+        abortBatch(stream->map);
+    }
+}
+
+MapPool* newMapPool(Output *output) {
+    MapPool *pool = (MapPool *)calloc(1, sizeof(MapPool));
+    PoolWorker *worker;
+    int threads = numberOfWindowThreads();
+
+    if (pool != NULL) {
+        if (!newMapSet(&pool->maps)) {
+            deleteMapSet(&pool->maps);
+            free(pool);
+            pool = NULL;
+        }
+    }
+
+    if (pool != NULL) {
+        pool->output = output;
+        pthread_mutex_init(&pool->mutex, NULL);
+        pthread_cond_init(&pool->work, NULL);
+        pthread_cond_init(&pool->idle, NULL);
+        for (int i = 0; i < threads; i++) {
+            pool->workers[i].pool = pool;
+        }
+
+        pool->numberOfWorkers = 1;
+        worker = &pool->workers[1];
+        while ((pool->numberOfWorkers < threads)
+               && (pthread_create(&worker->thread, NULL, runPoolWorker,
+                                  worker) == 0)) {
+            pool->numberOfWorkers++;
+            worker++;
+        }
+    }
+
+    return pool;
+}
+
+void deleteMapPool(MapPool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->end = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 1; i < pool->numberOfWorkers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool->numberOfWorkers; i++) {
+        freeRouteData(&pool->workers[i].data);
+    }
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        free(pool->commands[i].line);
+    }
+
+    deleteMapSet(&pool->maps);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->idle);
+    free(pool);
+}
+
+void doMapPoolCommands(MapPool *pool) {
+    PoolCommand *command;
+    MapSet *maps = &pool->maps;
+    ssize_t charactersInString = 0;
+    int lineNumber = 1;
+
+    while (charactersInString != -1) {
+        command = &pool->commands[pool->numberOfCommands];
+        charactersInString = getline(&command->line, &command->lineSize,
+                                     stdin);
+        if (charactersInString != -1) {
+            if ((command->line[0] != '#') && (command->line[0] != '\n')) {
+                command->lineNumber = lineNumber;
+                command->complete =
+                    (command->line[charactersInString - 1] == '\n');
+                command->stream = maps->current;
+                command->switches = command->complete
+                                    && (strstr(command->line, "useMap;")
+                                        == command->line);
+                if (command->switches) {
+                    command->target =
+                        findMapStream(maps, strchr(command->line, ';') + 1);
+                    if (command->target >= 0) {
+                        maps->current = command->target;
+                    }
+                }
+                pool->numberOfCommands++;
+                if (pool->numberOfCommands == WINDOW_SIZE) {
+                    doPoolWindow(pool);
+                }
+            }
+            lineNumber++;
+        }
+    }
+
+    doPoolWindow(pool);
+    for (int i = 0; i < maps->numberOfStreams; i++) {
+        finishMapStream(&maps->streams[i], &pool->workers[0].data,
+                        pool->output);
+    }
+}
@@ -0,0 +1,135 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje wykonywania poleceń wielu nazwanych
+ * map.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __MAP_POOL_H__
+#define __MAP_POOL_H__
+
+#include "input-output.h"
+
+#define DEFAULT_MAP_NAME "default" ///< nazwa mapy przed pierwszym useMap
+
+/**
+ * Struktura przechowująca stan poleceń jednej nazwanej mapy.
+ */
+typedef struct MapStream MapStream;
+
+/**
+ * Struktura przechowująca nazwane mapy i stan ich poleceń.
+ */
+typedef struct MapSet MapSet;
+
+/**
+ * Struktura przechowująca stan wykonania poleceń map przez wątki map.
+ */
+typedef struct MapPool MapPool;
+
+/**
+ * @brief Struktura przechowująca stan poleceń jednej nazwanej mapy.
+ * Tryby i grupy zmian należą do mapy, więc po wybraniu innej mapy pozostają
+ * włączone lub otwarte aż do ponownego wybrania tej mapy.
+ */
+struct MapStream {
+    Map *map;      ///< wskaźnik na strukturę mapy
+    BulkLoad bulk; ///< struktura trybu zbiorczego mapy
+};
+
+/**
+ * @brief Struktura przechowująca nazwane mapy i stan ich poleceń.
+ * Stany poleceń są indeksowane numerami map z rejestru.
+ * Struktura zawiera:
+ * wskaźnik na rejestr map;
+ * tablicę stanów poleceń map wraz z liczbą map i rozmiarem tablicy;
+ * numer mapy, na której są wykonywane polecenia.
+ */
+struct MapSet {
+    MapRegistry *registry; ///< wskaźnik na rejestr map
+    MapStream *streams;    ///< tablica stanów poleceń map
+    int numberOfStreams;   ///< liczba map
+    int sizeOfStreams;     ///< rozmiar tablicy stanów poleceń
+    int current;           ///< numer wybranej mapy
+};
+
+/**
+ * @brief Tworzy zbiór nazwanych map.
+ * Wybraną mapą jest pusta mapa o nazwie @ref DEFAULT_MAP_NAME.
+ * @param[out] maps          – wskaźnik na zbiór map.
+ * @return Wartość @p true, jeśli zbiór map został utworzony.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool newMapSet(MapSet *maps);
+
+/**
+ * @brief Usuwa zbiór nazwanych map wraz z mapami.
+ * @param[in,out] maps       – wskaźnik na zbiór map.
+ */
+void deleteMapSet(MapSet *maps);
+
+/**
+ * @brief Wyszukuje lub tworzy mapę wybieraną przez polecenie useMap.
+ * Nie zmienia wybranej mapy.
+ * @param[in,out] maps       – wskaźnik na zbiór map;
+ * @param[in] parameters     – napis zawierający nazwę mapy.
+ * @return Numer mapy lub -1, gdy parametry są niepoprawne lub nie udało się
+ * zaalokować pamięci.
+ */
+int findMapStream(MapSet *maps, char *parameters);
+
+/**
+ * @brief Kończy wykonywanie poleceń mapy przed wybraniem innej mapy.
+ * Wykonuje polecenia odłożone w trybie zbiorczym, dzięki czemu informacje
+ * o błędach są wypisywane w kolejności linii. Niepoprawne polecenie useMap
+ * jest błędem mapy, która pozostaje wybrana.
+ * @param[in,out] stream     – wskaźnik na stan poleceń wybranej mapy;
+ * @param[in] target         – numer mapy wybieranej przez polecenie lub -1;
+ * @param[in] lineNumber     – numer linii polecenia;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+void useMapCommand(MapStream *stream, int target, int lineNumber,
+                   RouteData *data, Output *output);
+
+/**
+ * @brief Kończy wykonywanie poleceń mapy na końcu danych.
+ * Wykonuje polecenia odłożone w trybie zbiorczym i wycofuje otwartą grupę
+ * zmian.
+ * @param[in,out] stream     – wskaźnik na stan poleceń mapy;
+ * @param[in,out] data       – wskaźnik na tablice pomocnicze do tworzenia
+ *                             drogi krajowej;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ */
+void finishMapStream(MapStream *stream, RouteData *data,
+                     Output *output);
+
+/**
+ * @brief Tworzy stan wykonania poleceń map przez wątki map.
+ * Uruchamia wątki wykonujące polecenia map. Jeśli nie udało się utworzyć
+ * żadnego z nich, wszystkie mapy należą do wątku głównego.
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+MapPool* newMapPool(Output *output);
+
+/**
+ * @brief Usuwa stan wykonania poleceń map przez wątki map wraz z mapami.
+ * Kończy pracę wątków wykonujących polecenia map.
+ * @param[in] pool           – wskaźnik na usuwaną strukturę.
+ */
+void deleteMapPool(MapPool *pool);
+
+/**
+ * @brief Czyta linie ze standardowego wejścia i wykonuje polecenia oknami.
+ * Polecenie useMap wybiera mapę dla następnych poleceń już przy wczytaniu,
+ * a wykonuje je wątek mapy, która była wcześniej wybrana. Na końcu danych
+ * wycofuje otwarte grupy zmian.
+ * @param[in,out] pool       – wskaźnik na stan wykonania.
+ */
+void doMapPoolCommands(MapPool *pool);
+
+#endif /* __MAP_POOL_H__ */
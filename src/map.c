@@ -8,12 +8,30 @@
 #include "map.h"
 #include "dijkstra.h"
 #include "help-functions.h"
+#include "distance-matrix.h"
+#include "alternatives.h"
+#include "pareto.h"
+#include "undo-log.h"
+#include "snapshot.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 
+/**
+ * @brief Struktura przechowująca rejestr nazwanych map.
+ * Struktura zawiera:
+ * tablice map i ich nazw, indeksowane numerami map;
+ * liczbę map i rozmiar tablic.
+ */
+struct MapRegistry {
+    Map **maps;       ///< tablica map
+    char **names;     ///< tablica nazw map
+    int numberOfMaps; ///< liczba map
+    int size;         ///< rozmiar tablic
+};
+
 Map* newMap(void) {
     Map *map = NULL; 
 
@@ -28,11 +46,16 @@ Map* newMap(void) {
 
 void deleteMap(Map *map) {
     if (map != NULL) {
+        freeUndoLog(map);
+        freeVersions(map);
         for (int i = 0; i < map->numberOfCities; i++) {
             freeCity(map->cities[i]);
         }
         freeRoads(map->firstRoad);
         freeRoutes(map->firstRoute);
+        freeNamesBlocks(map);
+        free(map->citiesIndex);
+        freeVertices(map);
         free(map->cities);
         free(map);
     }
@@ -43,6 +66,7 @@ bool addRoad(Map *map, const char *city1, const char *city2,
     Road *road = NULL;
     City *cityA = NULL, *cityB = NULL;
     bool correct = true;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || !isLengthCorrect(length) || !isYearCorrect(builtYear)
         || (strcmp(city1, city2) == 0) || !isCityNameCorrect(city1)
@@ -76,6 +100,8 @@ bool addRoad(Map *map, const char *city1, const char *city2,
         }
     }
 
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
@@ -83,6 +109,7 @@ bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear)
     City *cityA, *cityB;
     Road *road;
     bool correct = true;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || !isYearCorrect(repairYear)
         || (strcmp(city1, city2) == 0)) {
@@ -100,16 +127,16 @@ bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear)
                 correct = false;
             }
             else {
-                if (road->year > repairYear) {
+                if ((road->year > repairYear)
+                    || !updateRoadYear(map, road, repairYear)) {
                     correct = false;
                 }
-                else {
-                    road->year = repairYear;
-                }
             }
         }
     }
 
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
@@ -117,8 +144,9 @@ bool newRoute(Map *map, unsigned routeId,
               const char *city1, const char *city2) {
     Route *route;
     City *start, *stop;
-    int previous[map->numberOfCities];
+    Road **previous = NULL;
     bool correct = true;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || !isRouteIdCorrect(routeId) 
         || (strcmp(city1, city2) == 0)) {
@@ -132,30 +160,37 @@ bool newRoute(Map *map, unsigned routeId,
         else {
             start = findCity(map, city1);
             stop = findCity(map, city2);
-            if ((start == NULL) || (stop == NULL)) {
+            previous = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+            if ((start == NULL) || (stop == NULL) || (previous == NULL)) {
                 correct = false;
             }
             else {
-                dijkstra(map, stop->vertex->id, start->vertex->id, previous);
-                if (previous[start->vertex->id] == -1) {
+                dijkstra(map, stop->id, start->id, previous);
+                if (previous[start->id] == NULL) {
                     correct = false;
                 }
                 else {
-                    route = addRoute(map, routeId, start->vertex->id,
-                                     stop->vertex->id, previous);
+                    route = addRoute(map, routeId, start->id,
+                                     previous);
                     if (route == NULL) {
                         correct = false;
                     }
+                    else if (!reserveChange(map)
+                             || !addRouteToMap(map, route)) {
+                        discardRoute(route);
+                        correct = false;
+                    }
                     else {
-                        if (!addRouteToMap(map, route)) {
-                            correct = false;
-                        }
+                        logAddedRoute(map, route);
                     }
                 }
             }
         }
     }
 
+    free(previous);
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
@@ -164,8 +199,9 @@ bool extendRoute(Map *map, unsigned routeId, const char *city) {
     Route *route;
     bool correct = true;
     int start;
-    int distance1, distance2;
-    int previous1[map->numberOfCities], previous2[map->numberOfCities];
+    uint64_t distance1, distance2;
+    Road **previous1 = NULL, **previous2 = NULL;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || !isRouteIdCorrect(routeId)) {
         correct = false;
@@ -173,7 +209,10 @@ bool extendRoute(Map *map, unsigned routeId, const char *city) {
     else {
         stop = findCity(map, city);
         route = findRoute(map, routeId);
-        if ((stop == NULL) || (route == NULL)) {
+        previous1 = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+        previous2 = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+        if ((stop == NULL) || (route == NULL) || (previous1 == NULL)
+            || (previous2 == NULL)) {
             correct = false;
         }
         else {
@@ -181,20 +220,20 @@ bool extendRoute(Map *map, unsigned routeId, const char *city) {
                 correct = false;
             }
             else {
-                markVerticies(route, true);
-                distance1 = dijkstra(map, route->firstCity->vertex->id,
-                                     stop->vertex->id, previous1);
-                distance2 = dijkstra(map, stop->vertex->id,
-                                     route->lastCity->vertex->id, previous2);
-                markVerticies(route, false);
-                if ((distance1 != INT_MAX) && (distance1 < distance2)) {
-                    start = stop->vertex->id;
+                markVerticies(map, route);
+                distance1 = dijkstra(map, routeFirstCity(route)->id,
+                                     stop->id, previous1);
+                distance2 = dijkstra(map, stop->id,
+                                     routeLastCity(route)->id, previous2);
+                newMark(map);
+                if ((distance1 != INFINITE_DISTANCE) && (distance1 < distance2)) {
+                    start = stop->id;
                     if (!extendFromFirstCity(map, route, start, previous1)) {
                         correct = false;
                     }
                 }
-                else if ((distance2 != INT_MAX) && (distance2 < distance1)) {
-                    start = route->lastCity->vertex->id;
+                else if ((distance2 != INFINITE_DISTANCE) && (distance2 < distance1)) {
+                    start = routeLastCity(route)->id;
                     if (!extendFromLastCity(map, route, start, previous2)) {
                         correct = false;
                     }
@@ -206,6 +245,10 @@ bool extendRoute(Map *map, unsigned routeId, const char *city) {
         }
     }
 
+    free(previous1);
+    free(previous2);
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
@@ -213,6 +256,7 @@ bool removeRoad(Map *map, const char *city1, const char *city2) {
     bool correct = true;
     City *cityA, *cityB;
     Road *road;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || (strcmp(city1, city2) == 0)) {
         correct = false;
@@ -230,67 +274,46 @@ bool removeRoad(Map *map, const char *city1, const char *city2) {
             }
             else {
                 road->toRemove = true;
-                if (!canRoadBeRemoved(map, road)) {
+                if (!canRoadBeRemoved(map, road)
+                    || !removeRoadWithFillingRoutes(map, road)
+                    || !reserveChange(map)) {
                     correct = false;
                     road->toRemove = false;
                 }
                 else {
-                    removeRoadWithFillingRoutes(map, road);
-                    removeListOfRoadsNodeFromCity(cityA, road);
-                    removeListOfRoadsNodeFromCity(cityB, road);
-                    removeRoadFromMap(map, road);
+                    detachRoad(map, road);
                 }
             }
         }
     }
 
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
 bool removeRoute(Map *map, unsigned routeId) {
     bool correct = true;
-    ListOfRoutes *nodeToRemove, *previousNode;
+    ListOfRoutes *node;
+    int savepoint = startChanges(map);
 
     if ((map == NULL) || !isRouteIdCorrect(routeId)) {
         correct = false;
     }
     else {
-        previousNode = NULL;
-        nodeToRemove = map->firstRoute;
+        node = map->firstRoute;
 
-        while ((nodeToRemove != NULL)
-               && (nodeToRemove->route->id != routeId)) {
-            previousNode = nodeToRemove;
-            nodeToRemove = nodeToRemove->next;
+        while ((node != NULL) && (node->route->id != routeId)) {
+            node = node->next;
         }
 
-        if (nodeToRemove == NULL) {
+        if ((node == NULL) || !detachRoute(map, node)) {
             correct = false;
         }
-        else {
-            removeRouteFromRoads(nodeToRemove->route);
-            if (nodeToRemove == map->firstRoute) {
-                if (nodeToRemove == map->lastRoute) {
-                    map->firstRoute = NULL;
-                    map->lastRoute = NULL;
-                }
-                else {
-                    map->firstRoute = nodeToRemove->next;
-                }
-            }
-            else if (nodeToRemove == map->lastRoute) {
-                map->lastRoute = previousNode;
-                previousNode->next = NULL;
-            }
-            else {
-                previousNode->next = nodeToRemove->next;
-            }
-
-            free(nodeToRemove->route);
-            free(nodeToRemove);
-        }
     }
 
+    finishChanges(map, savepoint, correct);
+
     return correct;
 }
 
@@ -315,3 +338,478 @@ char const* getRouteDescription(Map *map, unsigned routeId) {
 
     return description;
 }
+
+char const* getCityRoutes(Map *map, const char *city) {
+    const char *description = NULL;
+    City *found;
+
+    if (map != NULL) {
+        found = findCity(map, city);
+        if (found != NULL) {
+            description = cityRoutesDescription(found);
+        }
+    }
+
+    return description;
+}
+
+char const* getAlternatives(Map *map, const char *city1, const char *city2,
+                            unsigned k) {
+    const char *description = NULL;
+    City *from, *to;
+
+    if ((map != NULL) && (k > 0) && (strcmp(city1, city2) != 0)) {
+        from = findCity(map, city1);
+        to = findCity(map, city2);
+        if ((from != NULL) && (to != NULL)) {
+            description = alternativesDescription(map, from, to, k);
+        }
+    }
+
+    return description;
+}
+
+char const* getParetoRoutes(Map *map, const char *city1, const char *city2) {
+    const char *description = NULL;
+    City *from, *to;
+
+    if ((map != NULL) && (strcmp(city1, city2) != 0)) {
+        from = findCity(map, city1);
+        to = findCity(map, city2);
+        if ((from != NULL) && (to != NULL)) {
+            description = paretoDescription(map, from, to);
+        }
+    }
+
+    return description;
+}
+
+bool setDetourLimits(Map *map, uint64_t maxLength, unsigned maxCities) {
+    bool correct = true;
+    int savepoint = startChanges(map);
+
+    if ((map == NULL) || !reserveChange(map)) {
+        correct = false;
+    }
+    else {
+        logChangedLimits(map);
+        if (maxLength == 0) {
+            map->maxDetourLength = INFINITE_DISTANCE;
+        }
+        else {
+            map->maxDetourLength = maxLength;
+        }
+
+        if ((maxCities == 0) || (maxCities > INT_MAX)) {
+            map->maxDetourCities = INT_MAX;
+        }
+        else {
+            map->maxDetourCities = maxCities;
+        }
+    }
+
+    finishChanges(map, savepoint, correct);
+
+    return correct;
+}
+
+bool beginBatch(Map *map) {
+    if ((map == NULL) || map->undoLog.batch) {
+        return false;
+    }
+    else {
+        map->undoLog.batch = true;
+        map->undoLog.failed = false;
+        return true;
+    }
+}
+
+bool commitBatch(Map *map) {
+    bool correct = true;
+
+    if ((map == NULL) || !map->undoLog.batch) {
+        correct = false;
+    }
+    else {
+        if (map->undoLog.failed) {
+            undoChanges(map, 0);
+            correct = false;
+        }
+        map->undoLog.batch = false;
+        commitChanges(map);
+    }
+
+    return correct;
+}
+
+bool abortBatch(Map *map) {
+    if ((map == NULL) || !map->undoLog.batch) {
+        return false;
+    }
+    else {
+        undoChanges(map, 0);
+        map->undoLog.batch = false;
+        return true;
+    }
+}
+
+/**
+ * @brief Zamienia nazwy miast na ich identyfikatory.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] names          – tablica nazw miast;
+ * @param[in] numberOfCities – liczba nazw w tablicy.
+ * @return Wskaźnik na zaalokowaną tablicę identyfikatorów lub NULL, gdy
+ * któreś z miast nie istnieje lub nie udało się zaalokować pamięci.
+ */
+static int* findCitiesIds(Map *map, const char *names[], int numberOfCities) {
+    City *city;
+    int *ids = (int *)malloc(numberOfCities * sizeof(int));
+    int i = 0;
+    bool correct = true;
+
+    if (ids == NULL) {
+        correct = false;
+    }
+
+    while ((i < numberOfCities) && correct) {
+        city = findCity(map, names[i]);
+        if (city == NULL) {
+            correct = false;
+        }
+        else {
+            ids[i] = city->id;
+        }
+        i++;
+    }
+
+    if (!correct) {
+        free(ids);
+        ids = NULL;
+    }
+
+    return ids;
+}
+
+bool getDistances(Map *map, const char *sources[], int numberOfSources,
+                  const char *targets[], int numberOfTargets,
+                  DistancesHandler handler, void *data) {
+    int *sourcesIds = NULL, *targetsIds = NULL;
+    bool correct = true;
+
+    if ((map == NULL) || (numberOfSources <= 0) || (numberOfTargets <= 0)
+        || (handler == NULL)) {
+        correct = false;
+    }
+    else {
+        sourcesIds = findCitiesIds(map, sources, numberOfSources);
+        targetsIds = findCitiesIds(map, targets, numberOfTargets);
+        if ((sourcesIds == NULL) || (targetsIds == NULL)) {
+            correct = false;
+        }
+        else {
+            correct = distanceMatrix(map, sourcesIds, numberOfSources,
+                                     targetsIds, numberOfTargets, handler,
+                                     data);
+        }
+    }
+
+    free(sourcesIds);
+    free(targetsIds);
+
+    return correct;
+}
+
+bool getIsochrone(Map *map, const char *city, uint64_t maxDistance,
+                  IsochroneHandler handler, void *data) {
+    City *start;
+    bool correct = true;
+
+    if ((map == NULL) || (handler == NULL)) {
+        correct = false;
+    }
+    else {
+        start = findCity(map, city);
+        if (start == NULL) {
+            correct = false;
+        }
+        else {
+            correct = isochrone(map, start->id, maxDistance, handler, data);
+        }
+    }
+
+    return correct;
+}
+
+bool getNearestOnRoute(Map *map, unsigned routeId, const char *city,
+                       const char **nearest, uint64_t *distance) {
+    Route *route;
+    City *start;
+    int nearestId;
+    bool correct = true;
+
+    if ((map == NULL) || !isRouteIdCorrect(routeId)) {
+        correct = false;
+    }
+    else {
+        route = findRoute(map, routeId);
+        start = findCity(map, city);
+        if ((route == NULL) || (start == NULL)) {
+            correct = false;
+        }
+        else if (!nearestOnRoute(map, start->id, route, &nearestId,
+                                 distance)) {
+            correct = false;
+        }
+        else {
+            if (nearestId == -1) {
+                *nearest = NULL;
+            }
+            else {
+                *nearest = map->cities[nearestId]->name;
+            }
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Tworzy opis najkrótszej ścieżki między miastami, spełniającej warunki
+ * filtra i omijającej oznaczone miasta.
+ * Ścieżka jest wyznaczana tak, jak przy tworzeniu drogi krajowej funkcją
+ * @ref newRoute.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] start          – wskaźnik na miasto początkowe;
+ * @param[in] stop           – wskaźnik na miasto końcowe;
+ * @param[in] filter         – wskaźnik na filtr ścieżek lub NULL.
+ * @return Wskaźnik na zaalokowany opis ścieżki, pusty, gdy nie istnieje
+ * jednoznaczna najkrótsza ścieżka, lub NULL, gdy nie udało się zaalokować
+ * pamięci.
+ */
+static char const* filteredPath(Map *map, City *start, City *stop,
+                                const PathFilter *filter) {
+    Workspace *workspace = newWorkspace(map->numberOfCities);
+    char *description = NULL;
+
+    if (workspace != NULL) {
+        filteredDijkstra(map, workspace, stop->id, start->id, filter);
+        if (workspace->previous[start->id] == NULL) {
+            description = (char *)malloc(1);
+            if (description != NULL) {
+                description[0] = '\0';
+            }
+        }
+        else {
+            description = (char *)pathDescription(map, start->id,
+                                                  workspace->previous);
+        }
+    }
+
+    freeWorkspace(workspace);
+
+    return description;
+}
+
+char const* getPathFromYear(Map *map, const char *city1, const char *city2,
+                            int minYear) {
+    const char *description = NULL;
+    City *start, *stop;
+    PathFilter filter;
+
+    if ((map != NULL) && (strcmp(city1, city2) != 0)) {
+        start = findCity(map, city1);
+        stop = findCity(map, city2);
+        if ((start != NULL) && (stop != NULL)) {
+            filter.minYear = minYear;
+            description = filteredPath(map, start, stop, &filter);
+        }
+    }
+
+    return description;
+}
+
+char const* getPathAvoiding(Map *map, const char *city1, const char *city2,
+                            const char *avoided[], int numberOfAvoided) {
+    const char *description = NULL;
+    City *start, *stop;
+    int *avoidedIds = NULL;
+    bool correct = true;
+
+    if ((map == NULL) || (numberOfAvoided <= 0) || (strcmp(city1, city2) == 0)) {
+        correct = false;
+    }
+    else {
+        start = findCity(map, city1);
+        stop = findCity(map, city2);
+        avoidedIds = findCitiesIds(map, avoided, numberOfAvoided);
+        if ((start == NULL) || (stop == NULL) || (avoidedIds == NULL)) {
+            correct = false;
+        }
+    }
+
+    for (int i = 0; correct && (i < numberOfAvoided); i++) {
+        if ((avoidedIds[i] == start->id) || (avoidedIds[i] == stop->id)) {
+            correct = false;
+        }
+    }
+
+    if (correct) {
+        newMark(map);
+        for (int i = 0; i < numberOfAvoided; i++) {
+            markVertex(map, avoidedIds[i]);
+        }
+        description = filteredPath(map, start, stop, NULL);
+        newMark(map);
+    }
+
+    free(avoidedIds);
+
+    return description;
+}
+
+bool enableSnapshots(Map *map) {
+    if (map == NULL) {
+        return false;
+    }
+    else {
+        return enableVersions(map);
+    }
+}
+
+Snapshot* pinSnapshot(Map *map) {
+    Snapshot *snapshot = NULL;
+
+    if (map != NULL) {
+        snapshot = pinVersion(map);
+    }
+
+    return snapshot;
+}
+
+void releaseSnapshot(Map *map, Snapshot *snapshot) {
+    if ((map != NULL) && (snapshot != NULL)) {
+        releaseVersion(map, snapshot);
+    }
+}
+
+char const* getSnapshotRouteDescription(Snapshot *snapshot, unsigned routeId) {
+    const char *description = NULL;
+
+    if (snapshot != NULL) {
+        description = snapshotRouteDescription(snapshot, routeId);
+    }
+
+    return description;
+}
+
+char const* getSnapshotCityRoutes(Snapshot *snapshot, const char *city) {
+    const char *description = NULL;
+
+    if (snapshot != NULL) {
+        description = snapshotCityRoutes(snapshot, city);
+    }
+
+    return description;
+}
+
+MapRegistry* newMapRegistry(void) {
+    MapRegistry *registry = (MapRegistry *)malloc(sizeof(MapRegistry));
+
+    if (registry != NULL) {
+        registry->maps = NULL;
+        registry->names = NULL;
+        registry->numberOfMaps = 0;
+        registry->size = 0;
+    }
+
+    return registry;
+}
+
+void deleteMapRegistry(MapRegistry *registry) {
+    if (registry != NULL) {
+        for (int i = 0; i < registry->numberOfMaps; i++) {
+            deleteMap(registry->maps[i]);
+            free(registry->names[i]);
+        }
+        free(registry->maps);
+        free(registry->names);
+        free(registry);
+    }
+}
+
+/**
+ * @brief Powiększa tablice rejestru, jeśli nie ma w nich miejsca na kolejną
+ * mapę.
+ * @param[in,out] registry – wskaźnik na rejestr map.
+ * @return Wartość @p true, jeśli w tablicach jest miejsce na kolejną mapę.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveMapRegistry(MapRegistry *registry) {
+    int size = enlargeSize(registry->size);
+    Map **maps;
+    char **names;
+    bool correct = true;
+
+    if (registry->numberOfMaps == registry->size) {
+        maps = (Map **)realloc(registry->maps, size * sizeof(Map *));
+        if (maps != NULL) {
+            registry->maps = maps;
+        }
+        names = (char **)realloc(registry->names, size * sizeof(char *));
+        if (names != NULL) {
+            registry->names = names;
+        }
+
+        if ((maps == NULL) || (names == NULL)) {
+            correct = false;
+        }
+        else {
+            registry->size = size;
+        }
+    }
+
+    return correct;
+}
+
+int useMap(MapRegistry *registry, const char *name) {
+    int number = -1;
+    Map *map;
+    char *copy;
+
+    if ((registry != NULL) && isCityNameCorrect(name)) {
+        for (int i = 0; (i < registry->numberOfMaps) && (number < 0); i++) {
+            if (strcmp(registry->names[i], name) == 0) {
+                number = i;
+            }
+        }
+
+        if ((number < 0) && reserveMapRegistry(registry)) {
+            map = newMap();
+            copy = (char *)malloc((strlen(name) + 1) * sizeof(char));
+            if ((map == NULL) || (copy == NULL)) {
+                deleteMap(map);
+                free(copy);
+            }
+            else {
+                strcpy(copy, name);
+                number = registry->numberOfMaps;
+                registry->maps[number] = map;
+                registry->names[number] = copy;
+                registry->numberOfMaps++;
+            }
+        }
+    }
+
+    return number;
+}
+
+Map* getRegisteredMap(MapRegistry *registry, int number) {
+    Map *map = NULL;
+
+    if ((registry != NULL) && (number >= 0)
+        && (number < registry->numberOfMaps)) {
+        map = registry->maps[number];
+    }
+
+    return map;
+}
@@ -10,12 +10,42 @@
 #define __MAP_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Struktura przechowująca mapę dróg krajowych.
  */
 typedef struct Map Map;
 
+/**
+ * Struktura przechowująca niezmienną wersję mapy.
+ */
+typedef struct Snapshot Snapshot;
+
+/**
+ * Struktura przechowująca rejestr nazwanych map.
+ */
+typedef struct MapRegistry MapRegistry;
+
+/**
+ * Typ funkcji, której przekazywane są kolejne wiersze macierzy odległości
+ * obliczanej przez funkcję @ref getDistances. Funkcja otrzymuje tablicę
+ * odległości do kolejnych miast docelowych, liczbę tych miast oraz wskaźnik
+ * podany w wywołaniu funkcji @ref getDistances. Tablica jest ważna tylko
+ * w trakcie wywołania.
+ */
+typedef void (*DistancesHandler)(const uint64_t distances[],
+                                 int numberOfTargets, void *data);
+
+/**
+ * Typ funkcji, której przekazywane są kolejne miasta znalezione przez funkcję
+ * @ref getIsochrone. Funkcja otrzymuje nazwę miasta, jego odległość od miasta
+ * początkowego oraz wskaźnik podany w wywołaniu funkcji @ref getIsochrone.
+ * Nie może zmieniać mapy.
+ */
+typedef void (*IsochroneHandler)(const char *city, uint64_t distance,
+                                 void *data);
+
 /** @brief Tworzy nową strukturę.
  * Tworzy nową, pustą strukturę niezawierającą żadnych miast, odcinków dróg ani
  * dróg krajowych.
@@ -147,4 +177,302 @@ bool removeRoute(Map *map, unsigned routeId);
  */
 char const* getRouteDescription(Map *map, unsigned routeId);
 
+/** @brief Udostępnia numery dróg krajowych przechodzących przez miasto.
+ * Zwraca wskaźnik na napis, który zawiera rosnący ciąg numerów dróg krajowych
+ * przechodzących przez podane miasto, oddzielonych średnikami. Alokuje pamięć
+ * na ten napis. Zwraca pusty napis, jeśli przez miasto nie przechodzi żadna
+ * droga krajowa. Zaalokowaną pamięć trzeba zwolnić za pomocą funkcji free.
+ * @param[in] map        – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city       – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Wskaźnik na napis lub NULL, gdy podane miasto nie istnieje lub nie
+ * udało się zaalokować pamięci.
+ */
+char const* getCityRoutes(Map *map, const char *city);
+
+/** @brief Udostępnia przebiegi drogi między dwoma miastami optymalne
+ * w sensie Pareto.
+ * Zwraca wskaźnik na napis opisujący wszystkie ścieżki od miasta @p city1 do
+ * miasta @p city2, których żadna inna ścieżka nie przewyższa jednocześnie pod
+ * względem długości i roku budowy lub ostatniego remontu najstarszego odcinka
+ * drogi, czyli cały kompromis między krótką ścieżką a ścieżką o młodych
+ * odcinkach dróg. Dla ścieżek o tej samej długości i tym samym roku
+ * najstarszego odcinka drogi opisuje tylko jedną z nich. Ścieżki są opisane
+ * po jednej w linii, w kolejności rosnących długości, w formacie:
+ * długość ścieżki;rok najstarszego odcinka drogi;nazwa miasta;długość odcinka
+ * drogi;rok budowy lub ostatniego remontu;nazwa miasta;…;nazwa miasta.
+ * Zwraca pusty napis, jeśli miasta nie są połączone. Nie zmienia mapy.
+ * Zaalokowaną pamięć trzeba zwolnić za pomocą funkcji free.
+ * @param[in] map        – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2      – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Wskaźnik na napis lub NULL, gdy któreś z podanych miast nie
+ * istnieje, podane miasta są takie same lub nie udało się zaalokować pamięci.
+ */
+char const* getParetoRoutes(Map *map, const char *city1, const char *city2);
+
+/** @brief Ustawia ograniczenia objazdów tworzonych przy usuwaniu odcinków dróg.
+ * Funkcja @ref removeRoad nie usuwa odcinka drogi, jeśli objazd którejś
+ * z przechodzących przez niego dróg krajowych byłby dłuższy niż @p maxLength
+ * lub jeśli do jego wyznaczenia trzeba by przejrzeć więcej niż @p maxCities
+ * miast. Wartość 0 oznacza brak danego ograniczenia.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] maxLength  – największa długość objazdu;
+ * @param[in] maxCities  – największa liczba miast przeglądanych przy
+ *                         wyszukiwaniu objazdu.
+ * @return Wartość @p true, jeśli ograniczenia zostały ustawione.
+ * Wartość @p false, jeśli wskaźnik na mapę ma wartość NULL lub nie udało się
+ * zaalokować pamięci.
+ */
+bool setDetourLimits(Map *map, uint64_t maxLength, unsigned maxCities);
+
+/** @brief Rozpoczyna grupę zmian mapy.
+ * Funkcje zmieniające mapę są niepodzielne: jeśli się nie powiodą, mapa
+ * pozostaje niezmieniona. Zmiany wprowadzone od wywołania tej funkcji do
+ * wywołania funkcji @ref commitBatch lub @ref abortBatch tworzą grupę, która
+ * jest wprowadzana w całości albo wcale. Zmiany grupy są widoczne od razu,
+ * ale pamięć usuniętych elementów mapy jest zwalniana dopiero przy
+ * zatwierdzeniu grupy. Grupy nie mogą być zagnieżdżone. Grupa otwarta
+ * w chwili usunięcia mapy jest wycofywana.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wartość @p true, jeśli grupa zmian została rozpoczęta.
+ * Wartość @p false, jeśli wskaźnik na mapę ma wartość NULL lub grupa zmian
+ * jest już otwarta.
+ */
+bool beginBatch(Map *map);
+
+/** @brief Zatwierdza grupę zmian mapy.
+ * Jeśli któraś z funkcji zmieniających mapę wywołanych w grupie się nie
+ * powiodła, wycofuje wszystkie zmiany grupy. W obu przypadkach zamyka grupę.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wartość @p true, jeśli zmiany grupy zostały wprowadzone.
+ * Wartość @p false, jeśli wskaźnik na mapę ma wartość NULL, grupa zmian nie
+ * jest otwarta lub zmiany grupy zostały wycofane.
+ */
+bool commitBatch(Map *map);
+
+/** @brief Wycofuje grupę zmian mapy.
+ * Przywraca mapę do stanu sprzed wywołania funkcji @ref beginBatch i zamyka
+ * grupę.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wartość @p true, jeśli zmiany grupy zostały wycofane.
+ * Wartość @p false, jeśli wskaźnik na mapę ma wartość NULL lub grupa zmian
+ * nie jest otwarta.
+ */
+bool abortBatch(Map *map);
+
+/** @brief Udostępnia alternatywne przebiegi drogi między dwoma miastami.
+ * Zwraca wskaźnik na napis zawierający opisy co najwyżej @p k najkrótszych
+ * ścieżek bez cykli od miasta @p city1 do miasta @p city2, po jednym w linii,
+ * w kolejności od najlepszej. Ścieżki o równej długości są uporządkowane tak,
+ * jak przy wyborze przebiegu drogi krajowej: wcześniej jest ta, której
+ * najstarszy odcinek drogi jest najmłodszy. Opis ma format opisu drogi
+ * krajowej z funkcji @ref getRouteDescription, w którym zamiast numeru drogi
+ * krajowej występuje pozycja ścieżki; ścieżki o równej długości i równym roku
+ * najstarszego odcinka drogi mają tę samą pozycję. Zwraca pusty napis, jeśli
+ * miasta nie są połączone. Nie zmienia mapy. Zaalokowaną pamięć trzeba
+ * zwolnić za pomocą funkcji free.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] k          – największa liczba ścieżek.
+ * @return Wskaźnik na napis lub NULL, gdy któreś z podanych miast nie
+ * istnieje, podane miasta są takie same, @p k ma wartość 0 lub nie udało się
+ * zaalokować pamięci.
+ */
+char const* getAlternatives(Map *map, const char *city1, const char *city2,
+                            unsigned k);
+
+/** @brief Wyznacza przebieg drogi między dwoma miastami złożony
+ * z odcinków dróg zbudowanych lub wyremontowanych nie wcześniej niż podany rok.
+ * Wyznacza ścieżkę tak, jak funkcja @ref newRoute, ale pomija odcinki dróg,
+ * których rok budowy lub ostatniego remontu jest mniejszy niż @p minYear.
+ * Zwraca wskaźnik na napis zawierający opis ścieżki w formacie opisu drogi
+ * krajowej z funkcji @ref getRouteDescription bez numeru drogi krajowej lub
+ * pusty napis, jeśli nie istnieje jednoznaczna najkrótsza taka ścieżka. Nie
+ * zmienia mapy. Zaalokowaną pamięć trzeba zwolnić za pomocą funkcji free.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] minYear    – najmniejszy dopuszczalny rok budowy lub ostatniego
+ *                         remontu odcinka drogi.
+ * @return Wskaźnik na napis lub NULL, gdy któreś z podanych miast nie
+ * istnieje, podane miasta są takie same lub nie udało się zaalokować pamięci.
+ */
+char const* getPathFromYear(Map *map, const char *city1, const char *city2,
+                            int minYear);
+
+/** @brief Wyznacza przebieg drogi między dwoma miastami omijający podane
+ * miasta.
+ * Wyznacza ścieżkę tak, jak funkcja @ref newRoute, ale ścieżka nie przechodzi
+ * przez żadne z miast z tablicy @p avoided. Zwraca wskaźnik na napis
+ * zawierający opis ścieżki w formacie opisu drogi krajowej z funkcji
+ * @ref getRouteDescription bez numeru drogi krajowej lub pusty napis, jeśli
+ * nie istnieje jednoznaczna najkrótsza taka ścieżka. Nie zmienia mapy.
+ * Zaalokowaną pamięć trzeba zwolnić za pomocą funkcji free.
+ * @param[in,out] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1           – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2           – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] avoided         – tablica nazw omijanych miast;
+ * @param[in] numberOfAvoided – liczba omijanych miast.
+ * @return Wskaźnik na napis lub NULL, gdy któreś z podanych miast nie
+ * istnieje, podane miasta są takie same, któreś z nich jest omijane, tablica
+ * omijanych miast jest pusta lub nie udało się zaalokować pamięci.
+ */
+char const* getPathAvoiding(Map *map, const char *city1, const char *city2,
+                            const char *avoided[], int numberOfAvoided);
+
+/** @brief Oblicza odległości między miastami, nie zmieniając mapy.
+ * Dla każdego miasta z tablicy @p sources, w kolejności tej tablicy, wywołuje
+ * funkcję @p handler z tablicą długości najkrótszych ścieżek do kolejnych
+ * miast z tablicy @p targets. Długość wynosi @p UINT64_MAX, jeśli nie da się
+ * jednoznacznie wyznaczyć najkrótszej ścieżki, czyli wtedy, gdy funkcja
+ * @ref newRoute nie utworzyłaby drogi krajowej od miasta docelowego do miasta
+ * początkowego. Obliczenia dla różnych miast początkowych
+ * są wykonywane równolegle, a wiersze przekazywane funkcji @p handler, gdy
+ * tylko zostaną obliczone.
+ * @param[in] map             – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] sources         – tablica nazw miast początkowych;
+ * @param[in] numberOfSources – liczba miast początkowych;
+ * @param[in] targets         – tablica nazw miast docelowych;
+ * @param[in] numberOfTargets – liczba miast docelowych;
+ * @param[in] handler         – funkcja wywoływana dla kolejnych wierszy;
+ * @param[in] data            – wskaźnik przekazywany funkcji @p handler.
+ * @return Wartość @p true, jeśli odległości zostały obliczone.
+ * Wartość @p false, jeśli któryś z parametrów ma niepoprawną wartość, któreś
+ * z podanych miast nie istnieje lub nie udało się zaalokować pamięci;
+ * funkcja @p handler nie jest wtedy wywoływana.
+ */
+bool getDistances(Map *map, const char *sources[], int numberOfSources,
+                  const char *targets[], int numberOfTargets,
+                  DistancesHandler handler, void *data);
+
+/** @brief Wyznacza miasta, do których da się dojechać z danego miasta,
+ * pokonując drogę nie dłuższą niż podana.
+ * Wywołuje funkcję @p handler dla każdego miasta, którego odległość od
+ * miasta @p city nie przekracza @p maxDistance, łącznie z samym miastem
+ * @p city, w kolejności niemalejących odległości. Koszt wyszukiwania zależy
+ * tylko od wielkości znalezionego obszaru. Nie zmienia mapy.
+ * @param[in,out] map         – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city            – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] maxDistance     – największa odległość od miasta;
+ * @param[in] handler         – funkcja wywoływana dla kolejnych miast;
+ * @param[in] data            – wskaźnik przekazywany funkcji @p handler.
+ * @return Wartość @p true, jeśli miasta zostały wyznaczone.
+ * Wartość @p false, jeśli któryś z parametrów ma niepoprawną wartość, miasto
+ * nie istnieje lub nie udało się zaalokować pamięci; funkcja @p handler nie
+ * jest wtedy wywoływana.
+ */
+bool getIsochrone(Map *map, const char *city, uint64_t maxDistance,
+                  IsochroneHandler handler, void *data);
+
+/** @brief Znajduje miasto drogi krajowej położone najbliżej danego miasta.
+ * Szuka miasta, przez które przechodzi droga krajowa o numerze @p routeId,
+ * o najmniejszej odległości od miasta @p city. Jeśli droga krajowa przechodzi
+ * przez miasto @p city, jest nim samo to miasto. Spośród miast w tej samej
+ * odległości wybiera dowolne. Nie zmienia mapy.
+ * @param[in,out] map     – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId     – numer drogi krajowej;
+ * @param[in] city        – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[out] nearest    – wskaźnik na nazwę znalezionego miasta, ważną do
+ *                          usunięcia mapy, lub NULL, gdy z miasta nie da się
+ *                          dojechać do drogi krajowej;
+ * @param[out] distance   – odległość znalezionego miasta.
+ * @return Wartość @p true, jeśli wyszukiwanie zostało wykonane.
+ * Wartość @p false, jeśli któryś z parametrów ma niepoprawną wartość, droga
+ * krajowa lub miasto nie istnieje lub nie udało się zaalokować pamięci.
+ */
+bool getNearestOnRoute(Map *map, unsigned routeId, const char *city,
+                       const char **nearest, uint64_t *distance);
+
+/** @brief Włącza udostępnianie niezmiennych wersji mapy.
+ * Od tej chwili każde zatwierdzenie zmian mapy, czyli zakończenie polecenia
+ * zmieniającego mapę poza grupą zmian lub zatwierdzenie grupy, tworzy nową
+ * wersję mapy. Wersja współdzieli z poprzednią wszystko poza danymi
+ * zmienionych dróg krajowych i listami dróg krajowych miast, przez które
+ * zaczęły one przechodzić lub przestały przechodzić. Opisy dróg krajowych są
+ * tworzone dopiero przy ich odczytaniu. Funkcja nie może być wywołana
+ * w trakcie zmieniania mapy. Nic nie robi, jeśli wersje są już udostępniane.
+ * @param[in,out] map     – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wartość @p true, jeśli wersje są udostępniane.
+ * Wartość @p false, jeśli wskaźnik na mapę ma wartość NULL, grupa zmian jest
+ * otwarta lub nie udało się zaalokować pamięci.
+ */
+bool enableSnapshots(Map *map);
+
+/** @brief Przypina najnowszą wersję mapy.
+ * Przypięta wersja zawiera wszystkie zatwierdzone zmiany sprzed przypięcia
+ * i nie zmienia się aż do jej zwolnienia funkcją @ref releaseSnapshot,
+ * nawet jeśli mapa jest w tym czasie zmieniana. Przypięcie i odczyty z wersji
+ * mogą być wykonywane w innych wątkach w trakcie zmieniania mapy i nigdy nie
+ * czekają na zakończenie zmian.
+ * @param[in,out] map     – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wskaźnik na przypiętą wersję lub NULL, jeśli wskaźnik na mapę ma
+ * wartość NULL, wersje nie są udostępniane lub przy ostatnim zatwierdzeniu
+ * zmian nie udało się zaalokować pamięci na nową wersję; wtedy trzeba
+ * odczytać samą mapę.
+ */
+Snapshot* pinSnapshot(Map *map);
+
+/** @brief Zwalnia przypiętą wersję mapy.
+ * Po zwolnieniu wersji nie wolno z niej odczytywać. Pamięć wersji jest
+ * zwalniana, gdy nie jest przypięta ani ona, ani żadna starsza wersja.
+ * Wszystkie wersje muszą zostać zwolnione przed usunięciem mapy.
+ * @param[in,out] map     – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] snapshot    – wskaźnik na wersję przypiętą funkcją
+ *                          @ref pinSnapshot.
+ */
+void releaseSnapshot(Map *map, Snapshot *snapshot);
+
+/** @brief Udostępnia informacje o drodze krajowej w przypiętej wersji mapy.
+ * Działa jak funkcja @ref getRouteDescription dla mapy w chwili przypięcia
+ * wersji.
+ * @param[in] snapshot    – wskaźnik na przypiętą wersję mapy;
+ * @param[in] routeId     – numer drogi krajowej.
+ * @return Wskaźnik na napis lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+char const* getSnapshotRouteDescription(Snapshot *snapshot, unsigned routeId);
+
+/** @brief Udostępnia listę dróg krajowych miasta w przypiętej wersji mapy.
+ * Działa jak funkcja @ref getCityRoutes dla mapy w chwili przypięcia wersji.
+ * @param[in] snapshot    – wskaźnik na przypiętą wersję mapy;
+ * @param[in] city        – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Wskaźnik na napis lub NULL, gdy miasto nie istnieje w tej wersji
+ * lub nie udało się zaalokować pamięci.
+ */
+char const* getSnapshotCityRoutes(Snapshot *snapshot, const char *city);
+
+/** @brief Tworzy nowy, pusty rejestr map.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+MapRegistry* newMapRegistry(void);
+
+/** @brief Usuwa rejestr map wraz ze wszystkimi zarejestrowanymi mapami.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] registry    – wskaźnik na usuwany rejestr.
+ */
+void deleteMapRegistry(MapRegistry *registry);
+
+/** @brief Daje w wyniku numer mapy o podanej nazwie.
+ * Jeśli w rejestrze nie ma mapy o tej nazwie, tworzy nową, pustą mapę
+ * i rejestruje ją pod kolejnym numerem. Mapy są numerowane od zera
+ * w kolejności rejestracji, a numer mapy nie zmienia się aż do usunięcia
+ * rejestru. Nazwa mapy musi spełniać te same warunki co nazwa miasta.
+ * Różne mapy nie mają wspólnych danych, więc mogą być jednocześnie używane
+ * przez różne wątki, o ile rejestr nie jest w tym czasie zmieniany.
+ * @param[in,out] registry – wskaźnik na rejestr map;
+ * @param[in] name         – wskaźnik na napis reprezentujący nazwę mapy.
+ * @return Numer mapy lub -1, jeśli nazwa jest niepoprawna, wskaźnik na
+ * rejestr ma wartość NULL lub nie udało się zaalokować pamięci.
+ */
+int useMap(MapRegistry *registry, const char *name);
+
+/** @brief Udostępnia mapę o podanym numerze.
+ * @param[in] registry    – wskaźnik na rejestr map;
+ * @param[in] number      – numer mapy nadany przez funkcję @ref useMap.
+ * @return Wskaźnik na mapę lub NULL, jeśli wskaźnik na rejestr ma wartość
+ * NULL lub nie ma mapy o tym numerze.
+ */
+Map* getRegisteredMap(MapRegistry *registry, int number);
+
 #endif /* __MAP_H__ */
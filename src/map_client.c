@@ -0,0 +1,134 @@
+/** @file
+ * Klient trybu serwera.
+ * Przesyła do serwera polecenia ze standardowego wejścia, a odpowiedzi
+ * serwera drukuje na standardowe wyjście, z wyjątkiem informacji o błędach,
+ * które drukuje na standardowe wyjście diagnostyczne, tak jak program
+ * czytający polecenia ze standardowego wejścia.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define BUFFER_SIZE 65536 ///< rozmiar bufora przesyłanych poleceń
+
+/**
+ * @brief Łączy się z serwerem.
+ * @param[in] path           – ścieżka gniazda serwera.
+ * @return Deskryptor gniazda lub -1, gdy nie udało się połączyć.
+ */
+static int connectToServer(const char *path) {
+    struct sockaddr_un address;
+    int server = -1;
+
+    if (strlen(path) < sizeof(address.sun_path)) {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, path);
+        server = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((server != -1) && (connect(server, (struct sockaddr *)&address,
+                                       sizeof(address)) != 0)) {
+            close(server);
+            server = -1;
+        }
+    }
+
+    return server;
+}
+
+/**
+ * @brief Funkcja wątku przesyłającego polecenia.
+ * Przesyła do serwera całe standardowe wejście, a na końcu zamyka gniazdo
+ * do pisania, dzięki czemu serwer wie, że poleceń już nie będzie.
+ * @param[in] data           – wskaźnik na deskryptor gniazda serwera.
+ * @return Wartość NULL.
+ */
+static void* sendCommands(void *data) {
+    int server = *(int *)data;
+    char buffer[BUFFER_SIZE];
+    ssize_t length, written;
+    bool correct = true;
+
+    while (correct
+           && ((length = read(STDIN_FILENO, buffer, BUFFER_SIZE)) > 0)) {
+        for (ssize_t i = 0; correct && (i < length); i += written) {
+            written = write(server, buffer + i, length - i);
+            if (written <= 0) {
+                correct = false;
+            }
+        }
+    }
+    shutdown(server, SHUT_WR);
+
+    return NULL;
+}
+
+/**
+ * @brief Sprawdza, czy linia odpowiedzi jest informacją o błędzie.
+ * Żaden wynik polecenia zaczynający się od słowa ERROR nie jest pozbawiony
+ * średników, więc informacje o błędach dają się jednoznacznie odróżnić.
+ * @param[in] line           – wskaźnik na linię odpowiedzi.
+ * @return Wartość @p true, jeśli linia jest informacją o błędzie.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isError(const char *line) {
+    if ((strncmp(line, "ERROR ", strlen("ERROR ")) == 0)
+        && (strchr(line, ';') == NULL)) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+int main(int argc, char *argv[]) {
+  int server;
+  FILE *answers;
+  pthread_t sender;
+  char *line = NULL;
+  size_t size = 0;
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s SOCKET\n", argv[0]);
+    return 1;
+  }
+
+  server = connectToServer(argv[1]);
+  if (server == -1) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  answers = fdopen(dup(server), "r");
+  if ((answers == NULL)
+      || (pthread_create(&sender, NULL, sendCommands, &server) != 0)) {
+    perror(argv[0]);
+    return 1;
+  }
+
+  while (getline(&line, &size, answers) != -1) {
+    if (isError(line)) {
+      fputs(line, stderr);
+    }
+    else {
+      fputs(line, stdout);
+    }
+  }
+
+  pthread_join(sender, NULL);
+  free(line);
+  fclose(answers);
+  close(server);
+
+  return 0;
+}
@@ -1,8 +1,40 @@
+#define _GNU_SOURCE
+
 #include "input-output.h"
+#include "server.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 
-int main() {
+int main(int argc, char *argv[]) {
+  long batchTimeout = BATCH_TIMEOUT;
+  char *end = NULL;
 
-  readAndDoCommands();
+  if ((argc > 1) && (strcmp(argv[1], "--pipelined") == 0)) {
+    readAndDoPipelinedCommands();
+  }
+  else if ((argc > 1) && (strcmp(argv[1], "--partitioned") == 0)) {
+    readAndDoPartitionedCommands();
+  }
+  else if ((argc > 1) && (strcmp(argv[1], "--map-workers") == 0)) {
+    readAndDoMapWorkerCommands();
+  }
+  else if ((argc > 2) && (strcmp(argv[1], "--server") == 0)) {
+    if (argc > 3) {
+      batchTimeout = strtol(argv[3], &end, 10);
+      if ((*argv[3] == '\0') || (*end != '\0') || (batchTimeout < 0)
+          || (batchTimeout > INT_MAX)) {
+        return 1;
+      }
+    }
+    if (!runServer(argv[2], (int)batchTimeout)) {
+      return 1;
+    }
+  }
+  else {
+    readAndDoCommands();
+  }
 
   return 0;
 }
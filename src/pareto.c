@@ -0,0 +1,514 @@
+/** @file
+ * Plik zawierający funkcje do wyznaczania przebiegów dróg optymalnych
+ * w sensie Pareto.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "pareto.h"
+#include "help-functions.h"
+#include "dijkstra.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+
+/**
+ * Struktura przechowująca etykietę, czyli ścieżkę od źródła do wierzchołka.
+ */
+typedef struct Label Label;
+
+/**
+ * Struktura przechowująca stan wyszukiwania ścieżek optymalnych w sensie
+ * Pareto.
+ */
+typedef struct LabelSearch LabelSearch;
+
+/**
+ * @brief Struktura przechowująca etykietę, czyli ścieżkę od źródła do
+ * wierzchołka.
+ * Ścieżka jest zapisana jako etykieta poprzedniego wierzchołka i odcinek drogi
+ * prowadzący do niego.
+ * Struktura zawiera:
+ * długość ścieżki i rok budowy lub ostatniego remontu jej najstarszego
+ * odcinka drogi;
+ * długość ścieżki powiększoną o odległość wierzchołka od miasta końcowego,
+ * według której etykiety są przetwarzane;
+ * identyfikator wierzchołka;
+ * indeks etykiety poprzedniego wierzchołka i odcinek drogi prowadzący do niego.
+ */
+struct Label {
+    uint64_t length; ///< długość ścieżki
+    int year;        ///< rok najstarszego odcinka drogi ścieżki
+    uint64_t key;    ///< klucz etykiety w kopcu
+    int vertex;      ///< identyfikator wierzchołka
+    int parent;      ///< indeks etykiety poprzednika lub -1
+    Road *road;      ///< odcinek drogi prowadzący do poprzednika
+};
+
+/**
+ * @brief Struktura przechowująca stan wyszukiwania ścieżek optymalnych
+ * w sensie Pareto.
+ * Etykiety są przetwarzane w kolejności rosnących kluczy, a przy równych
+ * kluczach malejących lat. Klucze etykiet jednego wierzchołka różnią się
+ * od ich długości o tę samą wartość, więc przetworzone etykiety wierzchołka
+ * tworzą schodki: każda kolejna jest dłuższa i ma młodszy najstarszy odcinek
+ * drogi. Dlatego zbiór etykiet wierzchołka jest reprezentowany tylko przez rok
+ * ostatniej z nich, a sprawdzenie, czy nowa etykieta jest zdominowana, polega
+ * na porównaniu z nim jej roku.
+ * Struktura zawiera:
+ * tablicę wszystkich utworzonych etykiet wraz z ich liczbą i rozmiarem
+ * tablicy;
+ * kopiec indeksów nieprzetworzonych etykiet wraz z jego rozmiarem i rozmiarem
+ * tablicy;
+ * tablicę lat ostatnich przetworzonych etykiet wierzchołków;
+ * tablice odległości wierzchołków od miasta końcowego oraz najmłodszych lat
+ * najstarszych odcinków dróg na ścieżkach z wierzchołków do miasta
+ * końcowego, ograniczające wyniki, jakie może dać etykieta;
+ * tablicę indeksów etykiet miasta końcowego wraz z ich liczbą i rozmiarem
+ * tablicy.
+ */
+struct LabelSearch {
+    Label *labels;       ///< tablica etykiet
+    int numberOfLabels;  ///< liczba etykiet
+    int sizeOfLabels;    ///< rozmiar tablicy etykiet
+    int *heap;           ///< kopiec indeksów nieprzetworzonych etykiet
+    int heapSize;        ///< liczba etykiet w kopcu
+    int sizeOfHeap;      ///< rozmiar tablicy kopca
+    int *bestYear;       ///< tablica lat ostatnich przetworzonych etykiet
+    uint64_t *lengthBound; ///< tablica odległości od miasta końcowego
+    int *yearBound;      ///< tablica najmłodszych lat osiągalnych ścieżek
+    int *results;        ///< tablica indeksów etykiet miasta końcowego
+    int numberOfResults; ///< liczba etykiet miasta końcowego
+    int sizeOfResults;   ///< rozmiar tablicy etykiet miasta końcowego
+};
+
+/**
+ * @brief Zapewnia miejsce na kolejny element tablicy liczb.
+ * @param[in,out] array      – wskaźnik na tablicę;
+ * @param[in] number         – liczba elementów w tablicy;
+ * @param[in,out] size       – wskaźnik na rozmiar tablicy.
+ * @return Wartość @p true, jeśli w tablicy jest miejsce.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool reserveIndex(int **array, int number, int *size) {
+    int *newArray;
+    int newSize;
+    bool correct = true;
+
+    if (number == *size) {
+        newSize = enlargeSize(*size);
+        newArray = (int *)realloc(*array, newSize * sizeof(int));
+        if (newArray == NULL) {
+            correct = false;
+        }
+        else {
+            *array = newArray;
+            *size = newSize;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Sprawdza, czy pierwsza etykieta powinna być przetworzona przed drugą.
+ * @param[in] label          – wskaźnik na etykietę;
+ * @param[in] other          – wskaźnik na etykietę.
+ * @return Wartość @p true, jeśli pierwsza etykieta ma mniejszy klucz lub ma
+ * taki sam klucz, ale ma młodszy najstarszy odcinek drogi.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isLabelBefore(Label *label, Label *other) {
+    if (label->key < other->key) {
+        return true;
+    }
+    else if ((label->key == other->key) && (label->year > other->year)) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Tworzy etykietę i dodaje ją do kopca.
+ * @param[in,out] search     – wskaźnik na stan wyszukiwania;
+ * @param[in] length         – długość ścieżki;
+ * @param[in] year           – rok najstarszego odcinka drogi ścieżki;
+ * @param[in] vertex         – identyfikator wierzchołka;
+ * @param[in] parent         – indeks etykiety poprzednika lub -1;
+ * @param[in] road           – odcinek drogi prowadzący do poprzednika lub NULL.
+ * @return Wartość @p true, jeśli udało się dodać etykietę.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool pushLabel(LabelSearch *search, uint64_t length, int year,
+                      int vertex, int parent, Road *road) {
+    Label *labels;
+    Label *label;
+    int son, father, newSize, temp;
+    bool correct = true, end = false;
+
+    if (search->numberOfLabels == search->sizeOfLabels) {
+        newSize = enlargeSize(search->sizeOfLabels);
+        labels = (Label *)realloc(search->labels, newSize * sizeof(Label));
+        if (labels == NULL) {
+            correct = false;
+        }
+        else {
+            search->labels = labels;
+            search->sizeOfLabels = newSize;
+        }
+    }
+
+    if (correct && !reserveIndex(&search->heap, search->heapSize,
+                                 &search->sizeOfHeap)) {
+        correct = false;
+    }
+
+    if (correct) {
+        label = &search->labels[search->numberOfLabels];
+        label->length = length;
+        label->year = year;
+        label->key = 0;
+        if (search->lengthBound != NULL) {
+            label->key = length + search->lengthBound[vertex];
+        }
+        label->vertex = vertex;
+        label->parent = parent;
+        label->road = road;
+
+        son = search->heapSize;
+        search->heap[son] = search->numberOfLabels;
+        search->numberOfLabels++;
+        search->heapSize++;
+
+        while ((son > 0) && !end) {
+            father = (son - 1) / 2;
+            if (isLabelBefore(&search->labels[search->heap[son]],
+                              &search->labels[search->heap[father]])) {
+                temp = search->heap[son];
+                search->heap[son] = search->heap[father];
+                search->heap[father] = temp;
+                son = father;
+            }
+            else {
+                end = true;
+            }
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Usuwa z kopca etykietę, która powinna być przetworzona jako pierwsza.
+ * @param[in,out] search     – wskaźnik na stan wyszukiwania z niepustym
+ *                             kopcem.
+ * @return Indeks usuniętej etykiety.
+ */
+static int popLabel(LabelSearch *search) {
+    int *heap = search->heap;
+    int first = heap[0];
+    int father = 0, son, temp;
+    bool end = false;
+
+    search->heapSize--;
+    heap[0] = heap[search->heapSize];
+
+    while (!end) {
+        son = 2 * father + 1;
+        if ((son + 1 < search->heapSize)
+            && isLabelBefore(&search->labels[heap[son + 1]],
+                             &search->labels[heap[son]])) {
+            son++;
+        }
+
+        if ((son < search->heapSize)
+            && isLabelBefore(&search->labels[heap[son]],
+                             &search->labels[heap[father]])) {
+            temp = heap[son];
+            heap[son] = heap[father];
+            heap[father] = temp;
+            father = son;
+        }
+        else {
+            end = true;
+        }
+    }
+
+    return first;
+}
+
+/**
+ * @brief Sprawdza, czy etykieta może dać nową ścieżkę optymalną.
+ * @param[in] search         – wskaźnik na stan wyszukiwania;
+ * @param[in] vertex         – identyfikator wierzchołka etykiety;
+ * @param[in] year           – rok najstarszego odcinka drogi etykiety;
+ * @param[in] target         – identyfikator miasta końcowego lub -1, gdy
+ *                             wyszukiwanie obejmuje cały graf.
+ * @return Wartość @p false, jeśli etykieta jest zdominowana przez przetworzoną
+ * już etykietę wierzchołka, jeśli z wierzchołka nie da się dojść do miasta
+ * końcowego lub jeśli każda jej kontynuacja jest zdominowana przez przetworzoną
+ * już etykietę miasta końcowego. Wartość @p true, w przeciwnym przypadku.
+ */
+static bool isLabelUseful(LabelSearch *search, int vertex, int year,
+                          int target) {
+    int reachableYear = year;
+
+    if ((search->yearBound != NULL) && (search->yearBound[vertex] < year)) {
+        reachableYear = search->yearBound[vertex];
+    }
+
+    if (year <= search->bestYear[vertex]) {
+        return false;
+    }
+    else if ((search->lengthBound != NULL)
+             && (search->lengthBound[vertex] == INFINITE_DISTANCE)) {
+        return false;
+    }
+    else if ((target != -1) && (reachableYear <= search->bestYear[target])) {
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+/**
+ * @brief Tworzy etykiety sąsiadów wierzchołka przetwarzanej etykiety.
+ * Pomija etykiety, które nie mogą dać nowej ścieżki optymalnej.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] search     – wskaźnik na stan wyszukiwania;
+ * @param[in] index          – indeks przetwarzanej etykiety;
+ * @param[in] target         – identyfikator miasta końcowego lub -1.
+ * @return Wartość @p true, jeśli udało się dodać etykiety.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool extendLabel(Map *map, LabelSearch *search, int index, int target) {
+    Label label = search->labels[index];
+    ListOfRoads *list = map->cities[label.vertex]->firstRoad;
+    Road *road;
+    int vertex, year;
+    bool correct = true;
+
+    while ((list != NULL) && correct) {
+        road = list->road;
+        vertex = otherCityId(road, label.vertex);
+        if (road->year < label.year) {
+            year = road->year;
+        }
+        else {
+            year = label.year;
+        }
+
+        if ((road->toRemove == false)
+            && isLabelUseful(search, vertex, year, target)) {
+            correct = pushLabel(search, label.length + road->length, year,
+                                vertex, index, road);
+        }
+        list = list->next;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wyznacza etykiety miasta końcowego optymalne w sensie Pareto.
+ * Przetwarza etykiety w kolejności rosnących kluczy i malejących lat,
+ * odrzucając etykiety, które nie mogą dać nowej ścieżki optymalnej. W mieście
+ * końcowym klucz jest równy długości, więc jego etykiety są zapisywane
+ * w kolejności rosnących długości. Gdy nie podano odległości od miasta
+ * końcowego, wszystkie klucze są zerowe, więc etykiety są przetwarzane tylko
+ * w kolejności malejących lat, a każdy wierzchołek ma jedną przetworzoną
+ * etykietę z najmłodszym rokiem najstarszego odcinka drogi na ścieżkach
+ * ze źródła.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] search     – wskaźnik na stan wyszukiwania;
+ * @param[in] source         – identyfikator miasta początkowego wyszukiwania;
+ * @param[in] target         – identyfikator miasta końcowego wyszukiwania
+ *                             lub -1.
+ * @return Wartość @p true, jeśli udało się wyznaczyć etykiety.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool findLabels(Map *map, LabelSearch *search, int source, int target) {
+    Label *label;
+    int index;
+    bool correct = true;
+
+    for (int i = 0; i < map->numberOfCities; i++) {
+        search->bestYear[i] = INT_MIN;
+    }
+
+    correct = pushLabel(search, 0, INT_MAX, source, -1, NULL);
+    while (correct && (search->heapSize > 0)) {
+        index = popLabel(search);
+        label = &search->labels[index];
+        if (isLabelUseful(search, label->vertex, label->year, target)) {
+            search->bestYear[label->vertex] = label->year;
+            if (label->vertex == target) {
+                if (!reserveIndex(&search->results, search->numberOfResults,
+                                  &search->sizeOfResults)) {
+                    correct = false;
+                }
+                else {
+                    search->results[search->numberOfResults] = index;
+                    search->numberOfResults++;
+                }
+            }
+            else if (!extendLabel(map, search, index, target)) {
+                correct = false;
+            }
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Tworzy opis ścieżki zapisanej w etykiecie.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] search         – wskaźnik na stan wyszukiwania;
+ * @param[in] index          – indeks etykiety miasta końcowego wyszukiwania;
+ * @param[in,out] previous   – tablica, w której zapisywane są odcinki dróg
+ *                             prowadzące do poprzedników miast ścieżki.
+ * @return Wskaźnik na zaalokowany napis lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static char* labelDescription(Map *map, LabelSearch *search, int index,
+                              Road *previous[]) {
+    Label *label = &search->labels[index];
+    int start = label->vertex, year = label->year;
+    uint64_t length = label->length;
+    const char *path;
+    char *description = NULL;
+    int prefixSize;
+
+    while (index != -1) {
+        label = &search->labels[index];
+        previous[label->vertex] = label->road;
+        index = label->parent;
+    }
+
+    path = pathDescription(map, start, previous);
+    if (path != NULL) {
+        prefixSize = snprintf(NULL, 0, "%" PRIu64 ";%d;", length, year);
+        description = (char *)malloc(prefixSize + strlen(path) + 1);
+        if (description != NULL) {
+            sprintf(description, "%" PRIu64 ";%d;%s", length, year, path);
+        }
+        free((void *)path);
+    }
+
+    return description;
+}
+
+/**
+ * @brief Tworzy opis ścieżek zapisanych w etykietach miasta końcowego.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] search         – wskaźnik na stan wyszukiwania;
+ * @param[in,out] previous   – tablica pomocnicza o rozmiarze równym liczbie
+ *                             miast.
+ * @return Wskaźnik na zaalokowany napis lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static char const* resultsDescription(Map *map, LabelSearch *search,
+                                      Road *previous[]) {
+    char *description = (char *)malloc(1);
+    char *line;
+    size_t size = 0, lineSize;
+
+    if (description != NULL) {
+        description[0] = '\0';
+    }
+
+    for (int i = 0; (i < search->numberOfResults) && (description != NULL);
+         i++) {
+        line = labelDescription(map, search, search->results[i], previous);
+        if (line == NULL) {
+            free(description);
+            description = NULL;
+        }
+        else {
+            lineSize = strlen(line);
+            description = (char *)realloc(description, size + lineSize + 2);
+            if (description != NULL) {
+                if (i > 0) {
+                    description[size] = '\n';
+                    size++;
+                }
+                memcpy(description + size, line, lineSize + 1);
+                size += lineSize;
+            }
+            free(line);
+        }
+    }
+
+    return description;
+}
+
+/**
+ * @brief Wyznacza ograniczenia wyników, jakie mogą dać etykiety.
+ * Dla każdego wierzchołka wyznacza najmłodszy rok najstarszego odcinka drogi
+ * na ścieżkach do miasta końcowego, wyszukując etykiety o zerowych kluczach,
+ * oraz odległość od miasta końcowego.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] search     – wskaźnik na stan wyszukiwania bez ograniczeń;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze, w których
+ *                             zapisywane są odległości;
+ * @param[in] target         – identyfikator miasta końcowego.
+ * @return Wartość @p true, jeśli udało się wyznaczyć ograniczenia.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool findBounds(Map *map, LabelSearch *search, Workspace *workspace,
+                       int target) {
+    int *yearBound = search->yearBound;
+    bool correct;
+
+    search->yearBound = NULL;
+    correct = findLabels(map, search, target, -1);
+#ifdef PARETO_STATISTICS
+    fprintf(stderr, "pareto bound labels %d\n", search->numberOfLabels);
+#endif
+    search->yearBound = search->bestYear;
+    search->bestYear = yearBound;
+    search->numberOfLabels = 0;
+    search->heapSize = 0;
+
+    shortestPath(map, workspace, target, -1, NULL);
+    search->lengthBound = workspace->vertices.distance;
+
+    return correct;
+}
+
+char const* paretoDescription(Map *map, City *from, City *to) {
+    LabelSearch search = {NULL, 0, 0, NULL, 0, 0, NULL, NULL, NULL, NULL, 0, 0};
+    Workspace *workspace = newWorkspace(map->numberOfCities);
+    Road **previous = (Road **)malloc(map->numberOfCities * sizeof(Road *));
+    const char *description = NULL;
+
+    search.bestYear = (int *)malloc(map->numberOfCities * sizeof(int));
+    search.yearBound = (int *)malloc(map->numberOfCities * sizeof(int));
+    if ((workspace != NULL) && (previous != NULL) && (search.bestYear != NULL)
+        && (search.yearBound != NULL)
+        && findBounds(map, &search, workspace, from->id)
+        && findLabels(map, &search, to->id, from->id)) {
+        description = resultsDescription(map, &search, previous);
+#ifdef PARETO_STATISTICS
+        fprintf(stderr, "pareto labels %d\n", search.numberOfLabels);
+#endif
+    }
+
+    free(search.labels);
+    free(search.heap);
+    free(search.bestYear);
+    free(search.yearBound);
+    free(search.results);
+    freeWorkspace(workspace);
+    free(previous);
+
+    return description;
+}
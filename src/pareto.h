@@ -0,0 +1,33 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje do wyznaczania przebiegów dróg
+ * optymalnych w sensie Pareto.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __PARETO_H__
+#define __PARETO_H__
+
+#include "structures-functions.h"
+
+/**
+ * @brief Wyznacza ścieżki między dwoma miastami optymalne w sensie Pareto
+ * i tworzy ich opis.
+ * Ścieżka jest optymalna, jeśli żadna inna ścieżka nie jest od niej krótsza,
+ * mając najstarszy odcinek drogi nie starszy, ani nie ma młodszego
+ * najstarszego odcinka drogi, będąc nie dłuższą. Dla każdej pary długości
+ * i roku najstarszego odcinka drogi wyznacza jedną ścieżkę. Ścieżki opisuje
+ * w kolejności rosnących długości, po jednej w linii, w formacie:
+ * długość ścieżki;rok najstarszego odcinka drogi;opis ścieżki w formacie
+ * opisu drogi krajowej bez jej numeru.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] from           – wskaźnik na miasto początkowe;
+ * @param[in] to             – wskaźnik na miasto końcowe, różne od
+ *                             początkowego.
+ * @return Wskaźnik na zaalokowany napis, pusty, gdy miasta nie są połączone,
+ * lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+char const* paretoDescription(Map *map, City *from, City *to);
+
+#endif /* __PARETO_H__ */
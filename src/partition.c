@@ -0,0 +1,1012 @@
+/** @file
+ * Plik zawierający funkcje wykonywania poleceń podzielonych na składowe mapy.
+ *
+ * Polecenia są wczytywane oknami i dzielone na składowe, do których się
+ * odwołują. Polecenia tylko odczytujące mapę i wyszukiwanie ścieżek poleceń
+ * newRoute są wykonywane równolegle przez kilka wątków, a polecenia
+ * zmieniające mapę wykonuje po kolei wątek główny, w kolejności wczytania,
+ * także wtedy, gdy należą do różnych składowych.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "partition.h"
+#include "components.h"
+#include "help-functions.h"
+#include "route-search.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/**
+ * Rodzaj dostępu polecenia okna do mapy.
+ */
+typedef enum AccessKind AccessKind;
+
+/**
+ * Struktura przechowująca polecenie okna.
+ */
+typedef struct WindowCommand WindowCommand;
+
+/**
+ * Struktura przechowująca dane jednego wątku wykonującego polecenia okna.
+ */
+typedef struct WindowWorker WindowWorker;
+
+/**
+ * @brief Rodzaj dostępu polecenia okna do mapy.
+ */
+enum AccessKind {
+    READ_ACCESS,   ///< polecenie tylko odczytujące mapę
+    SEARCH_ACCESS, ///< polecenie newRoute wyszukujące ścieżkę przy odczycie
+    WRITE_ACCESS   ///< polecenie wymagające wyłącznego dostępu do mapy
+};
+
+/**
+ * @brief Struktura przechowująca polecenie okna.
+ * Struktura zawiera:
+ * wczytaną linię wraz z rozmiarem jej bufora i numerem;
+ * kopię linii podzieloną na parametry, z której pochodzą nazwy miast
+ * polecenia, oraz numer drogi krajowej polecenia;
+ * rodzaj dostępu do mapy, składową i stan wykonania polecenia;
+ * wyszukiwanie przebiegu dla polecenia newRoute;
+ * numer bufora, do którego polecenie wypisało wyniki, i położenie wyników
+ * w tym buforze.
+ * Bufory linii są zachowywane między kolejnymi oknami.
+ */
+struct WindowCommand {
+    char *line;          ///< wczytana linia
+    size_t lineSize;     ///< rozmiar bufora linii
+    int lineNumber;      ///< numer linii
+    char *copy;          ///< kopia linii podzielona na parametry
+    size_t copySize;     ///< rozmiar bufora kopii linii
+    int firstName;       ///< indeks pierwszej nazwy miasta polecenia
+    int numberOfNames;   ///< liczba nazw miast polecenia
+    unsigned routeId;    ///< numer drogi krajowej polecenia lub 0
+    AccessKind access;   ///< rodzaj dostępu do mapy
+    bool joins;          ///< informacja o tym, czy polecenie łączy składowe
+    int component;       ///< numer składowej polecenia w oknie
+    bool done;           ///< informacja o tym, czy polecenie zostało wykonane
+    RouteSearch search;  ///< wyszukiwanie przebiegu drogi krajowej
+    int buffer;          ///< numer bufora wyników lub -1
+    long resultsStart;   ///< początek wyników w buforze
+    long resultsEnd;     ///< koniec wyników w buforze
+    long errorsStart;    ///< początek informacji o błędach w buforze
+    long errorsEnd;      ///< koniec informacji o błędach w buforze
+};
+
+/**
+ * @brief Struktura przechowująca dane jednego wątku wykonującego polecenia
+ * okna.
+ * Struktura zawiera:
+ * wskaźnik na wspólny stan wykonania;
+ * tablice pomocnicze do wyszukiwania ścieżek wraz z ich rozmiarem;
+ * bufory w pamięci, do których wątek wypisuje wyniki poleceń i informacje
+ * o błędach;
+ * identyfikator wątku.
+ */
+struct WindowWorker {
+    Partition *partition; ///< wskaźnik na wspólny stan wykonania
+    Workspace *workspace; ///< tablice pomocnicze wątku lub NULL
+    int workspaceSize;    ///< liczba miast, na które są tablice pomocnicze
+    FILE *results;        ///< strumień bufora wyników
+    char *resultsText;    ///< bufor wyników
+    size_t resultsSize;   ///< liczba znaków w buforze wyników
+    FILE *errors;         ///< strumień bufora informacji o błędach
+    char *errorsText;     ///< bufor informacji o błędach
+    size_t errorsSize;    ///< liczba znaków w buforze informacji o błędach
+    pthread_t thread;     ///< identyfikator wątku
+};
+
+/**
+ * @brief Struktura przechowująca stan wykonania poleceń podzielonych na
+ * składowe.
+ * Polecenia są wczytywane oknami. Każde polecenie okna należy do jednej
+ * składowej, a polecenia różnych składowych nie odczytują ani nie zmieniają
+ * tych samych miast, odcinków dróg ani dróg krajowych. Dla każdej składowej
+ * przechowywane są, w kolejności wczytania, polecenia odczytujące mapę
+ * i polecenia ją zmieniające, wraz z liczbą już wykonanych.
+ * Struktura zawiera:
+ * wskaźnik na mapę, podział na składowe i strumienie wyjściowe;
+ * tablice pomocnicze do tworzenia drogi krajowej i strukturę trybu
+ * zbiorczego, używane przy wykonywaniu poleceń;
+ * polecenia okna wraz z ich liczbą i nazwy miast poleceń;
+ * listy poleceń składowych oraz listę wszystkich poleceń zmieniających mapę;
+ * liczbę poleceń, których wyniki zostały wypisane;
+ * wątki wykonujące polecenia, z których pierwszym jest wątek główny, oraz
+ * stan ich wspólnej pracy;
+ * informację o tym, czy podział trzeba wyznaczyć od nowa.
+ */
+struct Partition {
+    Map *map;                 ///< wskaźnik na strukturę mapy
+    Components *components;   ///< wskaźnik na podział na składowe
+    Output *output;           ///< wskaźnik na strumienie wyjściowe
+    RouteData data;           ///< tablice pomocnicze drogi krajowej
+    BulkLoad bulk;            ///< struktura trybu zbiorczego
+    WindowCommand commands[WINDOW_SIZE]; ///< tablica poleceń okna
+    int numberOfCommands;     ///< liczba poleceń okna
+    const char **names;       ///< tablica nazw miast poleceń
+    int numberOfNames;        ///< liczba nazw miast poleceń
+    int sizeOfNames;          ///< rozmiar tablicy nazw miast
+    int numberOfComponents;   ///< liczba składowych okna
+    int readStart[WINDOW_SIZE + 1];  ///< początki list odczytów składowych
+    int readList[WINDOW_SIZE];       ///< listy odczytów składowych
+    int readCursor[WINDOW_SIZE];     ///< pierwsze niewykonane odczyty
+    int writeStart[WINDOW_SIZE + 1]; ///< początki list zmian składowych
+    int writeList[WINDOW_SIZE];      ///< listy zmian składowych
+    int writeCursor[WINDOW_SIZE];    ///< pierwsze niewykonane zmiany
+    int writes[WINDOW_SIZE];  ///< lista poleceń zmieniających mapę
+    int numberOfWrites;       ///< liczba poleceń zmieniających mapę
+    int nextWrite;            ///< pierwsze niewykonane polecenie z listy
+    int printed;              ///< liczba poleceń z wypisanymi wynikami
+    WindowWorker workers[MAX_WINDOW_THREADS]; ///< tablica wątków
+    int numberOfWorkers;      ///< liczba wątków wraz z wątkiem głównym
+    pthread_mutex_t mutex;    ///< muteks chroniący stan wspólnej pracy
+    pthread_cond_t work;      ///< zmienna warunkowa nowej fazy pracy
+    pthread_cond_t idle;      ///< zmienna warunkowa końca fazy pracy
+    int tasks[WINDOW_SIZE];   ///< polecenia bieżącej fazy pracy
+    int numberOfTasks;        ///< liczba poleceń bieżącej fazy pracy
+    int nextTask;             ///< następne polecenie do wykonania
+    int busy;                 ///< liczba wątków pracujących w bieżącej fazie
+    unsigned phase;           ///< numer bieżącej fazy pracy
+    bool end;                 ///< informacja o końcu pracy wątków
+    bool rebuild;             ///< informacja o konieczności odbudowy podziału
+};
+
+/**
+ * @brief Dodaje nazwę miasta polecenia.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in] name           – wskaźnik na nazwę miasta lub NULL.
+ * @return Wartość @p true, jeśli nazwa została dodana lub ma wartość NULL.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool addCommandName(Partition *partition, WindowCommand *command,
+                           const char *name) {
+    int size = enlargeSize(partition->sizeOfNames);
+    const char **names;
+    bool correct = true;
+
+    if ((name != NULL)
+        && (partition->numberOfNames == partition->sizeOfNames)) {
+        names = (const char **)realloc(partition->names,
+                                       size * sizeof(char *));
+        if (names == NULL) {
+            correct = false;
+        }
+        else {
+            partition->names = names;
+            partition->sizeOfNames = size;
+        }
+    }
+
+    if ((name != NULL) && correct) {
+        partition->names[partition->numberOfNames] = name;
+        partition->numberOfNames++;
+        command->numberOfNames++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Dodaje kolejne parametry jako nazwy miast polecenia.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in,out] parameters – wskaźnik na wskaźnik na napis z parametrami;
+ * @param[in] number         – liczba parametrów lub -1, gdy trzeba przejrzeć
+ *                             wszystkie parametry;
+ * @param[in] step           – co który parametr, licząc od pierwszego, jest
+ *                             nazwą miasta.
+ * @return Wartość @p true, jeśli nazwy zostały dodane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool addCommandNames(Partition *partition, WindowCommand *command,
+                            char **parameters, int number, int step) {
+    char *parameter = getParameter(parameters);
+    int i = 0;
+    bool correct = true;
+
+    while ((parameter != NULL) && (i != number) && correct) {
+        if (i % step == 0) {
+            correct = addCommandName(partition, command, parameter);
+        }
+        i++;
+        parameter = getParameter(parameters);
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wyznacza rodzaj dostępu polecenia do mapy oraz jego miasta i drogę
+ * krajową.
+ * Parametry są wyodrębniane z kopii linii tak samo jak przy wykonaniu
+ * polecenia, więc polecenie odczytuje lub zmienia tylko podane miasta
+ * i drogę krajową oraz to, co jest z nimi połączone w mapie. Nazwy miast są
+ * dopisywane na koniec nazw miast poleceń. Polecenia alternatives
+ * i pathAvoiding nie zmieniają mapy, ale używają jej znaczników wierzchołków,
+ * więc wymagają wyłącznego dostępu do mapy. Polecenie newRoute o poprawnej
+ * składni wyszukuje ścieżkę, odczytując mapę.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie z pełną linią.
+ * @return Wartość @p true, jeśli polecenie zostało opisane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool classifyCommand(Partition *partition, WindowCommand *command) {
+    size_t size = strlen(command->line) + 1;
+    char *copy = command->copy, *parameters = NULL, *city1, *city2;
+    bool correct = true, correctId;
+
+    command->firstName = partition->numberOfNames;
+    command->numberOfNames = 0;
+    command->routeId = 0;
+    command->access = WRITE_ACCESS;
+    command->joins = false;
+
+    if (size > command->copySize) {
+        copy = (char *)realloc(command->copy, size);
+        if (copy == NULL) {
+            correct = false;
+        }
+        else {
+            command->copy = copy;
+            command->copySize = size;
+        }
+    }
+    if (correct) {
+        memcpy(copy, command->line, size);
+        parameters = strchr(copy, ';');
+    }
+
+    if (parameters != NULL) {
+        parameters++;
+        if (isReadCommand(copy)) {
+            command->access = READ_ACCESS;
+        }
+
+        if ((strstr(copy, "getRouteDescription;") == copy)
+            || (strstr(copy, "removeRoute;") == copy)) {
+            getUnsignedParameter(&parameters, &command->routeId);
+        }
+        else if ((strstr(copy, "getCityRoutes;") == copy)
+                 || (strstr(copy, "isochrone;") == copy)) {
+            correct = addCommandNames(partition, command, &parameters, 1, 1);
+        }
+        else if ((strstr(copy, "pathFromYear;") == copy)
+                 || (strstr(copy, "paretoRoutes;") == copy)
+                 || (strstr(copy, "alternatives;") == copy)) {
+            correct = addCommandNames(partition, command, &parameters, 2, 1);
+        }
+        else if ((strstr(copy, "distances;") == copy)
+                 || (strstr(copy, "pathAvoiding;") == copy)) {
+            correct = addCommandNames(partition, command, &parameters, -1, 1);
+        }
+        else if (strstr(copy, "distanceMatrix;") == copy) {
+            getParameter(&parameters);
+            correct = addCommandNames(partition, command, &parameters, -1, 1);
+        }
+        else if ((strstr(copy, "nearestOnRoute;") == copy)
+                 || (strstr(copy, "extendRoute;") == copy)) {
+            getUnsignedParameter(&parameters, &command->routeId);
+            correct = addCommandNames(partition, command, &parameters, 1, 1);
+            command->joins = (command->access == WRITE_ACCESS);
+        }
+        else if (strstr(copy, "newRoute;") == copy) {
+            correctId = getUnsignedParameter(&parameters, &command->routeId);
+            city1 = getParameter(&parameters);
+            city2 = getParameter(&parameters);
+            correct = addCommandName(partition, command, city1)
+                      && addCommandName(partition, command, city2);
+            command->joins = true;
+            if (correctId && (city1 != NULL) && (city2 != NULL)
+                && (parameters[0] == '\0')) {
+                command->access = SEARCH_ACCESS;
+            }
+        }
+        else if ((strstr(copy, "addRoad;") == copy)
+                 || (strstr(copy, "repairRoad;") == copy)
+                 || (strstr(copy, "removeRoad;") == copy)) {
+            correct = addCommandNames(partition, command, &parameters, 2, 1);
+            command->joins = true;
+        }
+        else if (strstr(copy, "setDetourLimits;") != copy) {
+            command->routeId = routeIdNumber(copy);
+            if (command->routeId != 0) {
+                correct = addCommandNames(partition, command, &parameters,
+                                          -1, 3);
+                command->joins = true;
+            }
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Łączy składowe miast i drogi krajowej wykonanego polecenia.
+ * Nic nie robi, jeśli polecenie nie może łączyć składowych mapy. Jeśli nie
+ * udało się zaalokować pamięci, zaznacza, że podział trzeba wyznaczyć
+ * od nowa.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in] command        – wskaźnik na polecenie.
+ */
+static void joinCommand(Partition *partition, WindowCommand *command) {
+    if (command->joins
+        && !joinComponents(partition->components, partition->map,
+                           partition->names + command->firstName,
+                           command->numberOfNames, command->routeId)) {
+        partition->rebuild = true;
+    }
+}
+
+/**
+ * @brief Przygotowuje strumienie wyjściowe polecenia okna.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in] buffer         – numer wątku, do którego bufora polecenie ma
+ *                             wypisać wyniki, lub -1, gdy polecenie ma je
+ *                             wypisać od razu;
+ * @param[out] output        – wskaźnik na strumienie wyjściowe polecenia.
+ */
+static void openCommandOutput(Partition *partition, WindowCommand *command,
+                              int buffer, Output *output) {
+    WindowWorker *worker;
+
+    command->buffer = buffer;
+    if (buffer < 0) {
+        *output = *partition->output;
+    }
+    else {
+        worker = &partition->workers[buffer];
+        output->results = worker->results;
+        output->errors = worker->errors;
+        command->resultsStart = ftell(worker->results);
+        command->errorsStart = ftell(worker->errors);
+    }
+}
+
+/**
+ * @brief Zapisuje, gdzie kończą się wyniki polecenia okna w buforze.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie.
+ */
+static void closeCommandOutput(Partition *partition, WindowCommand *command) {
+    WindowWorker *worker;
+
+    if (command->buffer >= 0) {
+        worker = &partition->workers[command->buffer];
+        command->resultsEnd = ftell(worker->results);
+        command->errorsEnd = ftell(worker->errors);
+    }
+}
+
+/**
+ * @brief Wypisuje wyniki wykonanych poleceń okna w kolejności wczytania.
+ * Kończy na pierwszym niewykonanym poleceniu.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void printCommands(Partition *partition) {
+    WindowCommand *command;
+    WindowWorker *worker;
+
+    while ((partition->printed < partition->numberOfCommands)
+           && partition->commands[partition->printed].done) {
+        command = &partition->commands[partition->printed];
+        if (command->buffer >= 0) {
+            worker = &partition->workers[command->buffer];
+            fflush(worker->results);
+            fflush(worker->errors);
+            if (command->resultsEnd > command->resultsStart) {
+                fwrite(worker->resultsText + command->resultsStart, 1,
+                       command->resultsEnd - command->resultsStart,
+                       partition->output->results);
+            }
+            if (command->errorsEnd > command->errorsStart) {
+                fwrite(worker->errorsText + command->errorsStart, 1,
+                       command->errorsEnd - command->errorsStart,
+                       partition->output->errors);
+            }
+        }
+        partition->printed++;
+    }
+}
+
+/**
+ * @brief Wykonuje część polecenia okna odczytującą mapę.
+ * Polecenie tylko odczytujące mapę wypisuje wyniki do bufora wątku. Takie
+ * polecenia nie używają tablic pomocniczych do tworzenia drogi krajowej ani
+ * struktury trybu zbiorczego. Polecenie newRoute wyszukuje ścieżkę, używając
+ * tablic pomocniczych wątku, a gdy ich nie ma, wyszukiwanie pozostaje
+ * niewykonane.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in] buffer         – numer wątku;
+ * @param[in] index          – numer polecenia w oknie.
+ */
+static void readWindowCommand(Partition *partition, int buffer, int index) {
+    WindowCommand *command = &partition->commands[index];
+    WindowWorker *worker = &partition->workers[buffer];
+    Output output;
+
+    if (command->access == READ_ACCESS) {
+        openCommandOutput(partition, command, buffer, &output);
+        chooseFunction(partition->map, command->line, command->lineNumber,
+                       NULL, NULL, &output);
+        closeCommandOutput(partition, command);
+    }
+    else {
+        planRouteSearch(partition->map, command->routeId,
+                        partition->names[command->firstName],
+                        partition->names[command->firstName + 1],
+                        &command->search);
+        if ((command->search.start >= 0) && (worker->workspace != NULL)) {
+            searchRoute(partition->map, worker->workspace, &command->search);
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje polecenia bieżącej fazy pracy, dopóki są niewykonane.
+ * Wywoływana z zablokowanym muteksem, który zwalnia na czas wykonania
+ * polecenia.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in] buffer         – numer wątku.
+ */
+static void takeTasks(Partition *partition, int buffer) {
+    int index;
+
+    while (partition->nextTask < partition->numberOfTasks) {
+        index = partition->tasks[partition->nextTask];
+        partition->nextTask++;
+        pthread_mutex_unlock(&partition->mutex);
+        readWindowCommand(partition, buffer, index);
+        pthread_mutex_lock(&partition->mutex);
+    }
+}
+
+/**
+ * @brief Funkcja wykonywana przez wątek wykonujący polecenia okna.
+ * Czeka na kolejne fazy pracy i bierze w nich udział, dopóki nie nastąpi
+ * koniec pracy.
+ * @param[in,out] argument   – wskaźnik na strukturę danych wątku.
+ * @return Wartość NULL.
+ */
+static void* runWindowWorker(void *argument) {
+    WindowWorker *worker = (WindowWorker *)argument;
+    Partition *partition = worker->partition;
+    int buffer = worker - partition->workers;
+    unsigned phase = 0;
+
+    pthread_mutex_lock(&partition->mutex);
+    while (!partition->end) {
+        if (partition->phase == phase) {
+            pthread_cond_wait(&partition->work, &partition->mutex);
+        }
+        else {
+            phase = partition->phase;
+            takeTasks(partition, buffer);
+            partition->busy--;
+            if (partition->busy == 0) {
+                pthread_cond_signal(&partition->idle);
+            }
+        }
+    }
+    pthread_mutex_unlock(&partition->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Zapewnia wątkom tablice pomocnicze na wszystkie miasta mapy.
+ * Wątek, dla którego nie udało się zaalokować pamięci, nie ma tablic
+ * pomocniczych.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void prepareWorkspaces(Partition *partition) {
+    WindowWorker *worker;
+
+    for (int i = 0; i < partition->numberOfWorkers; i++) {
+        worker = &partition->workers[i];
+        if (worker->workspaceSize < partition->map->numberOfCities) {
+            freeWorkspace(worker->workspace);
+            worker->workspaceSize = enlargeSize(partition->map->numberOfCities);
+            worker->workspace = newWorkspace(worker->workspaceSize);
+            if (worker->workspace == NULL) {
+                worker->workspaceSize = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wykonuje polecenia bieżącej fazy pracy we wszystkich wątkach.
+ * Wątek główny też wykonuje polecenia, a potem czeka na pozostałe wątki.
+ * Pojedyncze polecenie jest wykonywane tylko przez wątek główny.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void runTasks(Partition *partition) {
+    pthread_mutex_lock(&partition->mutex);
+    partition->nextTask = 0;
+    if ((partition->numberOfTasks > 1) && (partition->numberOfWorkers > 1)) {
+        partition->busy = partition->numberOfWorkers - 1;
+        partition->phase++;
+        pthread_cond_broadcast(&partition->work);
+    }
+    takeTasks(partition, 0);
+    while (partition->busy > 0) {
+        pthread_cond_wait(&partition->idle, &partition->mutex);
+    }
+    pthread_mutex_unlock(&partition->mutex);
+}
+
+/**
+ * @brief Daje w wyniku pierwsze niewykonane polecenie z listy składowej.
+ * @param[in] list           – listy poleceń składowych;
+ * @param[in] start          – początki list poleceń składowych;
+ * @param[in] cursor         – pierwsze niewykonane polecenia list;
+ * @param[in] component      – numer składowej;
+ * @param[in] none           – wynik dla listy bez niewykonanych poleceń.
+ * @return Numer polecenia w oknie lub @p none.
+ */
+static int firstPending(const int list[], const int start[],
+                        const int cursor[], int component, int none) {
+    int first = none;
+
+    if (cursor[component] < start[component + 1]) {
+        first = list[cursor[component]];
+    }
+
+    return first;
+}
+
+/**
+ * @brief Układa listy poleceń składowych okna.
+ * Polecenia tylko odczytujące mapę trafiają na listy odczytów, polecenia
+ * zmieniające mapę na listy zmian, a polecenia newRoute, wyszukujące
+ * ścieżkę przed utworzeniem drogi krajowej, na obie listy.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void planWindow(Partition *partition) {
+    WindowCommand *command;
+    int component;
+
+    for (int i = 0; i <= partition->numberOfComponents; i++) {
+        partition->readStart[i] = 0;
+        partition->writeStart[i] = 0;
+    }
+    for (int i = 0; i < partition->numberOfCommands; i++) {
+        command = &partition->commands[i];
+        if (command->access != WRITE_ACCESS) {
+            partition->readStart[command->component + 1]++;
+        }
+        if (command->access != READ_ACCESS) {
+            partition->writeStart[command->component + 1]++;
+        }
+    }
+    for (int i = 0; i < partition->numberOfComponents; i++) {
+        partition->readStart[i + 1] += partition->readStart[i];
+        partition->writeStart[i + 1] += partition->writeStart[i];
+        partition->readCursor[i] = partition->readStart[i];
+        partition->writeCursor[i] = partition->writeStart[i];
+    }
+
+    partition->numberOfWrites = 0;
+    for (int i = 0; i < partition->numberOfCommands; i++) {
+        command = &partition->commands[i];
+        component = command->component;
+        if (command->access != WRITE_ACCESS) {
+            partition->readList[partition->readCursor[component]] = i;
+            partition->readCursor[component]++;
+        }
+        if (command->access != READ_ACCESS) {
+            partition->writeList[partition->writeCursor[component]] = i;
+            partition->writeCursor[component]++;
+            partition->writes[partition->numberOfWrites] = i;
+            partition->numberOfWrites++;
+        }
+    }
+    for (int i = 0; i < partition->numberOfComponents; i++) {
+        partition->readCursor[i] = partition->readStart[i];
+        partition->writeCursor[i] = partition->writeStart[i];
+    }
+
+    partition->nextWrite = 0;
+    partition->printed = 0;
+}
+
+/**
+ * @brief Wykonuje równolegle wszystkie odczyty, które mogą być teraz
+ * wykonane.
+ * Odczyt może być wykonany, gdy wykonano już wszystkie wcześniejsze zmiany
+ * jego składowej. Odczyty nie zmieniają mapy, więc mogą być wykonywane
+ * jednocześnie, a zmiany innych składowych nie wpływają na ich wyniki.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void readWindow(Partition *partition) {
+    WindowCommand *command;
+    int firstWrite, index;
+    bool search = false;
+
+    partition->numberOfTasks = 0;
+    for (int i = 0; i < partition->numberOfComponents; i++) {
+        firstWrite = firstPending(partition->writeList, partition->writeStart,
+                                  partition->writeCursor, i,
+                                  partition->numberOfCommands);
+        while ((partition->readCursor[i] < partition->readStart[i + 1])
+               && (partition->readList[partition->readCursor[i]]
+                   <= firstWrite)) {
+            index = partition->readList[partition->readCursor[i]];
+            partition->tasks[partition->numberOfTasks] = index;
+            partition->numberOfTasks++;
+            partition->readCursor[i]++;
+            if (partition->commands[index].access == SEARCH_ACCESS) {
+                search = true;
+            }
+        }
+    }
+
+    if (partition->numberOfTasks > 0) {
+        if (search) {
+            prepareWorkspaces(partition);
+        }
+        runTasks(partition);
+        for (int i = 0; i < partition->numberOfTasks; i++) {
+            command = &partition->commands[partition->tasks[i]];
+            if (command->access == READ_ACCESS) {
+                command->done = true;
+            }
+        }
+        printCommands(partition);
+    }
+}
+
+/**
+ * @brief Wykonuje polecenie okna zmieniające mapę.
+ * Polecenie, przed którym wypisano już wyniki wszystkich poleceń, wypisuje
+ * swoje wyniki od razu, a pozostałe do bufora wątku głównego.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in] index          – numer polecenia w oknie.
+ */
+static void writeWindowCommand(Partition *partition, int index) {
+    WindowCommand *command = &partition->commands[index];
+    Map *map = partition->map;
+    Output output;
+    int buffer = 0;
+
+    if (partition->printed == index) {
+        buffer = -1;
+    }
+    openCommandOutput(partition, command, buffer, &output);
+
+    if (command->access == SEARCH_ACCESS) {
+        if (!createSearchedRoute(map, command->routeId,
+                                 partition->names[command->firstName],
+                                 partition->names[command->firstName + 1],
+                                 &command->search)) {
+            printError(map, command->lineNumber, &output);
+        }
+        freeRouteSearches(&command->search, 1);
+    }
+    else {
+        handleCommand(map, command->line, command->lineNumber,
+                      &partition->data, &partition->bulk, &output);
+    }
+
+    closeCommandOutput(partition, command);
+    joinCommand(partition, command);
+    command->done = true;
+}
+
+/**
+ * @brief Wykonuje po kolei zmiany, które mogą być teraz wykonane.
+ * Zmiany są wykonywane w kolejności wczytania, więc miasta dostają te same
+ * identyfikatory co przy wykonywaniu poleceń po kolei. Zmiana może być
+ * wykonana, gdy wykonano już wszystkie wcześniejsze odczyty jej składowej.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void writeWindow(Partition *partition) {
+    int index, component, firstRead;
+    bool ready = true;
+
+    while ((partition->nextWrite < partition->numberOfWrites) && ready) {
+        index = partition->writes[partition->nextWrite];
+        component = partition->commands[index].component;
+        firstRead = firstPending(partition->readList, partition->readStart,
+                                 partition->readCursor, component,
+                                 partition->numberOfCommands);
+        if (firstRead <= index) {
+            ready = false;
+        }
+        else {
+            writeWindowCommand(partition, index);
+            partition->writeCursor[component]++;
+            partition->nextWrite++;
+            printCommands(partition);
+        }
+    }
+}
+
+/**
+ * @brief Tworzy bufory w pamięci, do których wątki wypisują wyniki.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ * @return Wartość @p true, jeśli bufory zostały utworzone.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool openBuffers(Partition *partition) {
+    WindowWorker *worker;
+    bool correct = true;
+
+    for (int i = 0; i < partition->numberOfWorkers; i++) {
+        worker = &partition->workers[i];
+        worker->results = open_memstream(&worker->resultsText,
+                                         &worker->resultsSize);
+        worker->errors = open_memstream(&worker->errorsText,
+                                        &worker->errorsSize);
+        if ((worker->results == NULL) || (worker->errors == NULL)) {
+            correct = false;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Usuwa bufory w pamięci, do których wątki wypisują wyniki.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void closeBuffers(Partition *partition) {
+    WindowWorker *worker;
+
+    for (int i = 0; i < partition->numberOfWorkers; i++) {
+        worker = &partition->workers[i];
+        if (worker->results != NULL) {
+            fclose(worker->results);
+            free(worker->resultsText);
+        }
+        if (worker->errors != NULL) {
+            fclose(worker->errors);
+            free(worker->errorsText);
+        }
+        worker->results = NULL;
+        worker->resultsText = NULL;
+        worker->errors = NULL;
+        worker->errorsText = NULL;
+    }
+}
+
+/**
+ * @brief Przydziela składowe poleceniom okna.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ * @return Wartość @p true, jeśli składowe zostały przydzielone.
+ * Wartość @p false, gdy podział nie jest poprawny lub nie udało się
+ * zaalokować pamięci.
+ */
+static bool divideWindow(Partition *partition) {
+    Components *components = partition->components;
+    WindowCommand *command;
+    bool correct;
+
+    if (partition->rebuild) {
+        partition->rebuild = !rebuildComponents(components, partition->map);
+    }
+
+    partition->numberOfNames = 0;
+    correct = startWindow(components, partition->map);
+    for (int i = 0; (i < partition->numberOfCommands) && correct; i++) {
+        command = &partition->commands[i];
+        correct = classifyCommand(partition, command);
+        if (correct) {
+            command->component = addWindowCommand(components, partition->map,
+                                                  partition->names
+                                                  + command->firstName,
+                                                  command->numberOfNames,
+                                                  command->routeId);
+            correct = (command->component >= 0);
+        }
+    }
+
+    partition->numberOfComponents = 0;
+    for (int i = 0; (i < partition->numberOfCommands) && correct; i++) {
+        command = &partition->commands[i];
+        command->component = windowComponent(components, command->component);
+        command->done = false;
+        if (command->component >= partition->numberOfComponents) {
+            partition->numberOfComponents = command->component + 1;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Wykonuje polecenia okna.
+ * Na przemian wykonuje równolegle wszystkie odczyty, które mogą być
+ * wykonane, i po kolei zmiany, które mogą być wykonane, a wyniki poleceń
+ * wypisuje w kolejności wczytania. Jeśli nie udało się przydzielić
+ * składowych lub utworzyć buforów, wykonuje polecenia po kolei, a podział
+ * trzeba potem wyznaczyć od nowa.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+static void doWindow(Partition *partition) {
+    WindowCommand *command;
+
+    if (partition->numberOfCommands > 0) {
+        if (divideWindow(partition) && openBuffers(partition)) {
+            planWindow(partition);
+            while (partition->printed < partition->numberOfCommands) {
+                readWindow(partition);
+                writeWindow(partition);
+            }
+        }
+        else {
+            for (int i = 0; i < partition->numberOfCommands; i++) {
+                command = &partition->commands[i];
+                handleCommand(partition->map, command->line,
+                              command->lineNumber, &partition->data,
+                              &partition->bulk, partition->output);
+            }
+            partition->rebuild = true;
+        }
+        closeBuffers(partition);
+        partition->numberOfCommands = 0;
+    }
+}
+
+/**
+ * @brief Sprawdza, czy polecenie może zostać wykonane w oknie.
+ * Poza oknem są wykonywane niepełne linie, polecenia trybów i grup zmian,
+ * polecenie setDetourLimits, które dotyczy wszystkich składowych, oraz
+ * wszystkie polecenia w otwartej grupie zmian i w trybach, w których
+ * polecenia są odkładane.
+ * @param[in] partition      – wskaźnik na stan wykonania;
+ * @param[in] line           – wskaźnik na pierwszy znak wczytanej linii;
+ * @param[in] characters     – liczba znaków wczytanej linii.
+ * @return Wartość @p true, jeśli polecenie może zostać wykonane w oknie.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isWindowCommand(Partition *partition, char *line,
+                            ssize_t characters) {
+    return (line[characters - 1] == '\n') && (strchr(line, ';') != NULL)
+           && (strstr(line, "setDetourLimits;") != line)
+           && !partition->map->undoLog.batch && !partition->bulk.active
+           && !partition->bulk.parallel
+           && (partition->bulk.numberOfRecords == 0);
+}
+
+/**
+ * @brief Wykonuje polecenie poza oknem.
+ * Po poleceniu, które mogło połączyć składowe mapy, łączy składowe jego
+ * miast. Jeśli polecenie zostało odłożone, podział trzeba wyznaczyć od nowa
+ * przed następnym oknem.
+ * @param[in,out] partition  – wskaźnik na stan wykonania;
+ * @param[in,out] command    – wskaźnik na polecenie;
+ * @param[in] characters     – liczba znaków wczytanej linii.
+ */
+static void doSequentialCommand(Partition *partition, WindowCommand *command,
+                                ssize_t characters) {
+    bool classified;
+
+    if (command->line[characters - 1] == '\n') {
+        partition->numberOfNames = 0;
+        classified = classifyCommand(partition, command);
+        handleCommand(partition->map, command->line, command->lineNumber,
+                      &partition->data, &partition->bulk, partition->output);
+        if (!classified || (partition->bulk.numberOfRecords > 0)) {
+            partition->rebuild = true;
+        }
+        else {
+            joinCommand(partition, command);
+        }
+    }
+    else {
+        flushBulkLoad(partition->map, &partition->bulk, &partition->data,
+                      partition->output);
+        printError(partition->map, command->lineNumber, partition->output);
+    }
+}
+
+Partition* newPartition(Map *map, Output *output) {
+    Partition *partition = (Partition *)calloc(1, sizeof(Partition));
+    WindowWorker *worker;
+    int threads = numberOfWindowThreads();
+
+    if (partition != NULL) {
+        partition->components = newComponents();
+        if (partition->components == NULL) {
+            free(partition);
+            partition = NULL;
+        }
+    }
+
+    if (partition != NULL) {
+        partition->map = map;
+        partition->output = output;
+        setBulkLoadValues(&partition->bulk);
+        pthread_mutex_init(&partition->mutex, NULL);
+        pthread_cond_init(&partition->work, NULL);
+        pthread_cond_init(&partition->idle, NULL);
+        for (int i = 0; i < threads; i++) {
+            partition->workers[i].partition = partition;
+        }
+
+        partition->numberOfWorkers = 1;
+        worker = &partition->workers[1];
+        while ((partition->numberOfWorkers < threads)
+               && (pthread_create(&worker->thread, NULL, runWindowWorker,
+                                  worker) == 0)) {
+            partition->numberOfWorkers++;
+            worker++;
+        }
+    }
+
+    return partition;
+}
+
+void deletePartition(Partition *partition) {
+    pthread_mutex_lock(&partition->mutex);
+    partition->end = true;
+    pthread_cond_broadcast(&partition->work);
+    pthread_mutex_unlock(&partition->mutex);
+
+    for (int i = 1; i < partition->numberOfWorkers; i++) {
+        pthread_join(partition->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < partition->numberOfWorkers; i++) {
+        freeWorkspace(partition->workers[i].workspace);
+    }
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        free(partition->commands[i].line);
+        free(partition->commands[i].copy);
+    }
+
+    free(partition->names);
+    freeBulkLoad(&partition->bulk);
+    freeRouteData(&partition->data);
+    deleteComponents(partition->components);
+    pthread_mutex_destroy(&partition->mutex);
+    pthread_cond_destroy(&partition->work);
+    pthread_cond_destroy(&partition->idle);
+    free(partition);
+}
+
+void doPartitionedCommands(Partition *partition) {
+    WindowCommand *command;
+    ssize_t charactersInString = 0;
+    int lineNumber = 1;
+
+    while (charactersInString != -1) {
+        command = &partition->commands[partition->numberOfCommands];
+        charactersInString = getline(&command->line, &command->lineSize,
+                                     stdin);
+        if (charactersInString != -1) {
+            if ((command->line[0] != '#') && (command->line[0] != '\n')) {
+                command->lineNumber = lineNumber;
+                if (isWindowCommand(partition, command->line,
+                                    charactersInString)) {
+                    partition->numberOfCommands++;
+                    if (partition->numberOfCommands == WINDOW_SIZE) {
+                        doWindow(partition);
+                    }
+                }
+                else {
+                    doWindow(partition);
+                    doSequentialCommand(partition, command,
+                                        charactersInString);
+                }
+            }
+            lineNumber++;
+        }
+    }
+
+    doWindow(partition);
+    flushBulkLoad(partition->map, &partition->bulk, &partition->data,
+                  partition->output);
+    if (partition->map->undoLog.batch) {
+        abortBatch(partition->map);
+    }
+}
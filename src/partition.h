@@ -0,0 +1,44 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje wykonywania poleceń podzielonych
+ * na składowe mapy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __PARTITION_H__
+#define __PARTITION_H__
+
+#include "input-output.h"
+
+/**
+ * Struktura przechowująca stan wykonania poleceń podzielonych na składowe.
+ */
+typedef struct Partition Partition;
+
+/**
+ * @brief Tworzy stan wykonania poleceń podzielonych na składowe.
+ * Uruchamia wątki wykonujące polecenia okna. Jeśli nie udało się utworzyć
+ * żadnego z nich, polecenia okna wykonuje tylko wątek główny.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in,out] output     – wskaźnik na strumienie wyjściowe.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+Partition* newPartition(Map *map, Output *output);
+
+/**
+ * @brief Usuwa stan wykonania poleceń podzielonych na składowe.
+ * Kończy pracę wątków wykonujących polecenia okna.
+ * @param[in] partition      – wskaźnik na usuwaną strukturę.
+ */
+void deletePartition(Partition *partition);
+
+/**
+ * @brief Czyta linie ze standardowego wejścia i wykonuje polecenia oknami.
+ * Na końcu danych wycofuje otwartą grupę zmian.
+ * @param[in,out] partition  – wskaźnik na stan wykonania.
+ */
+void doPartitionedCommands(Partition *partition);
+
+#endif /* __PARTITION_H__ */
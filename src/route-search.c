@@ -0,0 +1,253 @@
+/** @file
+ * Plik zawierający funkcje do równoległego wyznaczania przebiegów dróg
+ * krajowych.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "route-search.h"
+#include "dijkstra.h"
+#include "help-functions.h"
+#include "structures-functions.h"
+#include "undo-log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAX_SEARCH_THREADS 64 ///< największa liczba wątków wyszukujących
+
+/**
+ * Struktura przechowująca stan równoległego wyznaczania przebiegów.
+ */
+typedef struct SearchJob SearchJob;
+
+/**
+ * Struktura przechowująca dane jednego wątku wyszukującego.
+ */
+typedef struct SearchWorker SearchWorker;
+
+/**
+ * @brief Struktura przechowująca stan równoległego wyznaczania przebiegów.
+ * Struktura zawiera:
+ * wskaźnik na mapę oraz tablicę wyszukiwań wraz z ich liczbą;
+ * numer następnego wyszukiwania do wykonania;
+ * muteks chroniący numer następnego wyszukiwania.
+ */
+struct SearchJob {
+    Map *map;               ///< wskaźnik na strukturę mapy
+    RouteSearch *searches;  ///< tablica wyszukiwań
+    int numberOfSearches;   ///< liczba wyszukiwań
+    int nextSearch;         ///< numer następnego wyszukiwania
+    pthread_mutex_t mutex;  ///< muteks chroniący numer wyszukiwania
+};
+
+/**
+ * @brief Struktura przechowująca dane jednego wątku wyszukującego.
+ * Struktura zawiera:
+ * wskaźnik na wspólny stan wyszukiwań;
+ * tablice pomocnicze do wyszukiwania najkrótszych ścieżek, używane tylko
+ * przez ten wątek;
+ * identyfikator wątku.
+ */
+struct SearchWorker {
+    SearchJob *job;       ///< wskaźnik na wspólny stan wyszukiwań
+    Workspace *workspace; ///< tablice pomocnicze wątku
+    pthread_t thread;     ///< identyfikator wątku
+};
+
+/**
+ * @brief Oblicza liczbę wątków.
+ * @param[in] numberOfSearches – liczba wyszukiwań.
+ * @return Liczba dostępnych procesorów, ograniczona przez liczbę wyszukiwań
+ * i @ref MAX_SEARCH_THREADS.
+ */
+static int numberOfThreads(int numberOfSearches) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = MAX_SEARCH_THREADS;
+
+    if ((processors > 0) && (processors < threads)) {
+        threads = processors;
+    }
+    if (numberOfSearches < threads) {
+        threads = numberOfSearches;
+    }
+
+    return threads;
+}
+
+void planRouteSearch(Map *map, unsigned routeId, const char *city1,
+                     const char *city2, RouteSearch *search) {
+    City *start, *stop;
+
+    search->start = -1;
+    search->stop = -1;
+    search->searched = false;
+    search->numberOfRoads = 0;
+    search->cities = NULL;
+    search->roads = NULL;
+    if (isRouteIdCorrect(routeId) && (strcmp(city1, city2) != 0)
+        && (findRoute(map, routeId) == NULL)) {
+        start = findCity(map, city1);
+        stop = findCity(map, city2);
+        if ((start != NULL) && (stop != NULL)) {
+            search->start = start->id;
+            search->stop = stop->id;
+        }
+    }
+}
+
+void searchRoute(Map *map, Workspace *workspace, RouteSearch *search) {
+    Road **previous = workspace->previous;
+    City *city = map->cities[search->start];
+    int length = 0;
+
+    filteredDijkstra(map, workspace, search->stop, search->start, NULL);
+    while (previous[city->id] != NULL) {
+        city = otherCity(map, previous[city->id], city);
+        length++;
+    }
+
+    search->searched = true;
+    if (length > 0) {
+        search->cities = (City **)malloc((length + 1) * sizeof(City *));
+        search->roads = (Road **)malloc(length * sizeof(Road *));
+        if ((search->cities == NULL) || (search->roads == NULL)) {
+            free(search->cities);
+            free(search->roads);
+            search->cities = NULL;
+            search->roads = NULL;
+            search->searched = false;
+        }
+        else {
+            search->numberOfRoads = length;
+            city = map->cities[search->start];
+            for (int i = 0; i < length; i++) {
+                search->cities[i] = city;
+                search->roads[i] = previous[city->id];
+                city = otherCity(map, previous[city->id], city);
+            }
+            search->cities[length] = city;
+        }
+    }
+}
+
+/**
+ * @brief Funkcja wykonywana przez wątek wyszukujący.
+ * Pobiera numery kolejnych wyszukiwań i wykonuje je, dopóki są niewykonane
+ * wyszukiwania.
+ * @param[in,out] argument   – wskaźnik na strukturę danych wątku.
+ * @return Wartość NULL.
+ */
+static void* computeSearches(void *argument) {
+    SearchWorker *worker = (SearchWorker *)argument;
+    SearchJob *job = worker->job;
+    RouteSearch *search;
+    bool end = false;
+
+    while (!end) {
+        pthread_mutex_lock(&job->mutex);
+        if (job->nextSearch == job->numberOfSearches) {
+            end = true;
+            search = NULL;
+        }
+        else {
+            search = &job->searches[job->nextSearch];
+            job->nextSearch++;
+        }
+        pthread_mutex_unlock(&job->mutex);
+
+        if ((search != NULL) && (search->start >= 0)) {
+            searchRoute(job->map, worker->workspace, search);
+        }
+    }
+
+    return NULL;
+}
+
+bool searchRoutes(Map *map, RouteSearch searches[], int numberOfSearches) {
+    SearchJob job;
+    int threads = numberOfThreads(numberOfSearches);
+    int started = 0;
+    SearchWorker workers[MAX_SEARCH_THREADS];
+    bool correct = true;
+
+    job.map = map;
+    job.searches = searches;
+    job.numberOfSearches = numberOfSearches;
+    job.nextSearch = 0;
+
+    for (int i = 0; i < numberOfSearches; i++) {
+        searches[i].searched = false;
+        searches[i].numberOfRoads = 0;
+        searches[i].cities = NULL;
+        searches[i].roads = NULL;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = &job;
+        workers[i].workspace = NULL;
+        if (correct) {
+            workers[i].workspace = newWorkspace(map->numberOfCities);
+            if (workers[i].workspace == NULL) {
+                correct = false;
+            }
+        }
+    }
+
+    if (correct) {
+        pthread_mutex_init(&job.mutex, NULL);
+
+        while ((started < threads)
+               && (pthread_create(&workers[started].thread, NULL,
+                                  computeSearches, &workers[started]) == 0)) {
+            started++;
+        }
+        for (int i = 0; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+
+        if ((started == 0) && (numberOfSearches > 0)) {
+            correct = false;
+        }
+
+        pthread_mutex_destroy(&job.mutex);
+    }
+
+    for (int i = 0; i < threads; i++) {
+        freeWorkspace(workers[i].workspace);
+    }
+
+    return correct;
+}
+
+bool createSearchedRoute(Map *map, unsigned routeId, const char *city1,
+                         const char *city2, RouteSearch *search) {
+    int savepoint;
+    bool correct;
+
+    if ((search->start >= 0) && !search->searched) {
+        correct = newRoute(map, routeId, city1, city2);
+    }
+    else {
+        savepoint = startChanges(map);
+        correct = (search->numberOfRoads > 0)
+                  && (findRoute(map, routeId) == NULL)
+                  && addRouteAlongToMap(map, routeId, search->cities,
+                                        search->roads, search->numberOfRoads);
+        finishChanges(map, savepoint, correct);
+    }
+
+    return correct;
+}
+
+void freeRouteSearches(RouteSearch searches[], int numberOfSearches) {
+    for (int i = 0; i < numberOfSearches; i++) {
+        free(searches[i].cities);
+        free(searches[i].roads);
+    }
+}
@@ -0,0 +1,114 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje do równoległego wyznaczania
+ * przebiegów dróg krajowych.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __ROUTE_SEARCH_H__
+#define __ROUTE_SEARCH_H__
+
+#include "map.h"
+#include "help-structures.h"
+#include "dijkstra.h"
+
+/**
+ * Struktura przechowująca wyszukiwanie przebiegu drogi krajowej.
+ */
+typedef struct RouteSearch RouteSearch;
+
+/**
+ * @brief Struktura przechowująca wyszukiwanie przebiegu drogi krajowej.
+ * Struktura zawiera:
+ * identyfikatory miasta początkowego i końcowego;
+ * informację o tym, czy wyszukiwanie zostało wykonane;
+ * znalezioną ścieżkę jako tablice kolejnych miast i odcinków dróg wraz
+ * z liczbą odcinków dróg.
+ */
+struct RouteSearch {
+    int start;         ///< identyfikator miasta początkowego lub -1
+    int stop;          ///< identyfikator miasta końcowego
+    bool searched;     ///< informacja o tym, czy wykonano wyszukiwanie
+    int numberOfRoads; ///< liczba odcinków dróg ścieżki lub 0
+    City **cities;     ///< tablica kolejnych miast ścieżki lub NULL
+    Road **roads;      ///< tablica kolejnych odcinków dróg ścieżki lub NULL
+};
+
+/**
+ * @brief Przygotowuje wyszukiwanie przebiegu dla polecenia newRoute.
+ * Pomija wyszukiwanie, czyli ustawia miasto początkowe na -1, jeśli już teraz
+ * wiadomo, że polecenie się nie powiedzie, bo numer drogi krajowej jest
+ * niepoprawny, miasta są takie same, któreś z nich nie istnieje lub droga
+ * krajowa o tym numerze istnieje. Ustawia wyszukiwanie jako niewykonane.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] routeId        – numer drogi krajowej;
+ * @param[in] city1          – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2          – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[out] search        – wskaźnik na wyszukiwanie.
+ */
+void planRouteSearch(Map *map, unsigned routeId, const char *city1,
+                     const char *city2, RouteSearch *search);
+
+/**
+ * @brief Wyznacza przebieg drogi krajowej dla jednego wyszukiwania.
+ * Ścieżka jest wyznaczana tak, jak wyznaczyłaby ją funkcja @ref newRoute,
+ * i przepisywana z tablicy poprzedników do tablic wyszukiwania, żeby tablice
+ * pomocnicze mogły zostać użyte ponownie. Jeśli nie udało się zaalokować
+ * pamięci na ścieżkę, wyszukiwanie pozostaje niewykonane.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] workspace  – wskaźnik na tablice pomocnicze o rozmiarze co
+ *                             najmniej liczby miast w mapie;
+ * @param[in,out] search     – wskaźnik na przygotowane wyszukiwanie o mieście
+ *                             początkowym różnym od -1.
+ */
+void searchRoute(Map *map, Workspace *workspace, RouteSearch *search);
+
+/**
+ * @brief Wyznacza przebiegi dróg krajowych między podanymi miastami.
+ * Każda ścieżka jest wyznaczana tak, jak wyznaczyłaby ją funkcja
+ * @ref newRoute, ale wyszukiwania są rozdzielane między wątki, a każdy wątek
+ * używa własnych tablic pomocniczych. Wyszukiwania o mieście początkowym -1
+ * są pomijane. Jeśli dla któregoś wyszukiwania nie udało się zaalokować
+ * pamięci na ścieżkę, pozostaje ono niewykonane. Mapa nie może być zmieniana
+ * w trakcie działania funkcji.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in,out] searches   – tablica wyszukiwań; po wywołaniu wykonane
+ *                             wyszukiwania zawierają ścieżki od miasta
+ *                             początkowego do końcowego, a liczba odcinków
+ *                             dróg wynosi 0, gdy nie istnieje jednoznaczna
+ *                             najkrótsza ścieżka;
+ * @param[in] numberOfSearches – liczba wyszukiwań.
+ * @return Wartość @p true, jeśli wyszukiwania zostały wykonane.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci lub utworzyć
+ * żadnego wątku; żadne wyszukiwanie nie jest wtedy wykonane.
+ */
+bool searchRoutes(Map *map, RouteSearch searches[], int numberOfSearches);
+
+/**
+ * @brief Tworzy drogę krajową wzdłuż ścieżki znalezionej przez wyszukiwanie.
+ * Działa tak jak @ref newRoute, o ile od wyszukiwania nie zmieniły się
+ * miasta ani odcinki dróg, przez które mogła przejść ścieżka. Wyszukiwanie,
+ * które nie zostało wykonane z braku pamięci, jest zastępowane wywołaniem
+ * funkcji @ref newRoute. Zmiany są zapisywane w dzienniku zmian jako jedno
+ * polecenie.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] routeId        – numer drogi krajowej;
+ * @param[in] city1          – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2          – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] search         – wskaźnik na wyszukiwanie przygotowane dla tych
+ *                             parametrów.
+ * @return Wartość @p true, jeśli droga krajowa została utworzona.
+ * Wartość @p false, gdy wystąpił błąd.
+ */
+bool createSearchedRoute(Map *map, unsigned routeId, const char *city1,
+                         const char *city2, RouteSearch *search);
+
+/**
+ * @brief Zwalnia ścieżki znalezione przez wyszukiwania.
+ * @param[in,out] searches   – tablica wyszukiwań;
+ * @param[in] numberOfSearches – liczba wyszukiwań.
+ */
+void freeRouteSearches(RouteSearch searches[], int numberOfSearches);
+
+#endif /* __ROUTE_SEARCH_H__ */
@@ -0,0 +1,375 @@
+/** @file
+ * Plik zawierający funkcje trybu serwera.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "server.h"
+#include "input-output.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define PENDING_CLIENTS 64 ///< długość kolejki klientów czekających na przyjęcie
+#define ACCEPT_RETRY_DELAY 100 ///< czas w milisekundach przed ponownym accept
+
+/**
+ * Struktura przechowująca stan serwera.
+ */
+typedef struct Server Server;
+
+/**
+ * Struktura przechowująca dane sesji klienta.
+ */
+typedef struct Session Session;
+
+/**
+ * @brief Struktura przechowująca stan serwera.
+ * Struktura zawiera:
+ * mapę współdzieloną przez wszystkie sesje i jej blokadę;
+ * limit czasu oczekiwania sesji z otwartą grupą zmian na kolejne polecenie;
+ * listę sesji, których gniazda są jeszcze otwarte, i liczbę działających
+ * wątków sesji wraz z muteksem i zmienną warunkową, na której wątek główny
+ * czeka na ich zakończenie.
+ */
+struct Server {
+    Map *map;                 ///< wskaźnik na współdzieloną mapę
+    pthread_rwlock_t lock;    ///< blokada mapy
+    int batchTimeout;         ///< limit czasu bezczynności grupy zmian
+    pthread_mutex_t mutex;    ///< muteks chroniący listę i liczbę sesji
+    pthread_cond_t finished;  ///< zmienna warunkowa zakończenia sesji
+    Session *sessions;        ///< lista sesji z otwartymi gniazdami
+    int running;              ///< liczba działających wątków sesji
+};
+
+/**
+ * @brief Struktura przechowująca dane sesji klienta.
+ * Struktura zawiera:
+ * wskaźnik na stan serwera;
+ * deskryptor gniazda klienta;
+ * sąsiednie sesje na liście sesji serwera.
+ */
+struct Session {
+    Server *server;         ///< wskaźnik na stan serwera
+    int client;             ///< deskryptor gniazda klienta
+    Session *previous;      ///< poprzednia sesja na liście lub NULL
+    Session *next;          ///< następna sesja na liście lub NULL
+};
+
+/**
+ * Deskryptor gniazda oczekującego na klientów, zamykanego przez sygnał
+ * kończący pracę serwera, lub -1.
+ */
+static volatile sig_atomic_t listeningSocket = -1;
+
+/**
+ * Informacja o tym, czy serwer otrzymał sygnał kończący pracę.
+ */
+static volatile sig_atomic_t stopping = 0;
+
+/**
+ * @brief Obsługuje sygnał kończący pracę serwera.
+ * Wyłącza gniazdo oczekujące na klientów, dzięki czemu oczekiwanie na
+ * kolejnego klienta kończy się błędem, także wtedy, gdy sygnał nadszedł tuż
+ * przed jego rozpoczęciem.
+ * @param[in] signalNumber   – numer sygnału.
+ */
+static void stopServer(int signalNumber) {
+    (void)signalNumber;
+    stopping = 1;
+    if (listeningSocket != -1) {
+        shutdown(listeningSocket, SHUT_RDWR);
+    }
+}
+
+/**
+ * @brief Usuwa sesję z listy sesji serwera.
+ * Po usunięciu gniazdo sesji nie jest już wyłączane przy kończeniu pracy
+ * serwera, więc można je zamknąć.
+ * @param[in,out] session    – wskaźnik na sesję.
+ */
+static void unlinkSession(Session *session) {
+    Server *server = session->server;
+
+    pthread_mutex_lock(&server->mutex);
+    if (session->previous != NULL) {
+        session->previous->next = session->next;
+    }
+    else {
+        server->sessions = session->next;
+    }
+    if (session->next != NULL) {
+        session->next->previous = session->previous;
+    }
+    pthread_mutex_unlock(&server->mutex);
+}
+
+/**
+ * @brief Funkcja wątku obsługującego klienta.
+ * Otwiera gniazdo klienta jako osobne strumienie do czytania i pisania,
+ * wykonuje polecenia sesji i zamyka gniazdo. Strumień wyjściowy jest
+ * buforowany wierszami, więc klient dostaje wyniki zaraz po wykonaniu
+ * każdego polecenia. Na końcu zgłasza zakończenie sesji wątkowi głównemu.
+ * @param[in] data           – wskaźnik na zaalokowaną strukturę sesji, którą
+ *                             funkcja zwalnia.
+ * @return Wartość NULL.
+ */
+static void* serveClient(void *data) {
+    Session *session = (Session *)data;
+    Server *server = session->server;
+    int duplicate = dup(session->client);
+    FILE *input = fdopen(session->client, "r");
+    FILE *output = NULL;
+
+    if (duplicate != -1) {
+        output = fdopen(duplicate, "w");
+    }
+
+    if ((input != NULL) && (output != NULL)) {
+        setvbuf(output, NULL, _IOLBF, 0);
+        serveCommands(server->map, &server->lock, input, output,
+                      server->batchTimeout);
+    }
+
+    unlinkSession(session);
+    if (input != NULL) {
+        fclose(input);
+    }
+    else {
+        close(session->client);
+    }
+    if (output != NULL) {
+        fclose(output);
+    }
+    else if (duplicate != -1) {
+        close(duplicate);
+    }
+    free(session);
+
+    pthread_mutex_lock(&server->mutex);
+    server->running--;
+    pthread_cond_signal(&server->finished);
+    pthread_mutex_unlock(&server->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Tworzy gniazdo lokalne oczekujące na klientów.
+ * Usuwa gniazdo pozostawione pod podaną ścieżką przez poprzedni serwer, ale
+ * nie usuwa plików innego rodzaju.
+ * @param[in] path           – ścieżka gniazda.
+ * @return Deskryptor gniazda lub -1, gdy nie udało się go utworzyć.
+ */
+static int openSocket(const char *path) {
+    struct sockaddr_un address;
+    struct stat status;
+    int listening = -1;
+
+    if (strlen(path) < sizeof(address.sun_path)) {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, path);
+        if ((stat(path, &status) == 0) && S_ISSOCK(status.st_mode)) {
+            unlink(path);
+        }
+
+        listening = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((listening != -1)
+            && ((bind(listening, (struct sockaddr *)&address,
+                      sizeof(address)) != 0)
+                || (listen(listening, PENDING_CLIENTS) != 0))) {
+            close(listening);
+            listening = -1;
+        }
+    }
+
+    return listening;
+}
+
+/**
+ * @brief Uruchamia wątek obsługujący przyjętego klienta.
+ * Dodaje sesję do listy sesji serwera. Wątek sesji blokuje sygnały kończące
+ * pracę serwera, więc trafiają one do wątku głównego i przerywają
+ * oczekiwanie na klienta. Jeśli nie udało się uruchomić wątku, zamyka
+ * gniazdo klienta.
+ * @param[in,out] server     – wskaźnik na stan serwera;
+ * @param[in] attributes     – atrybuty tworzonego wątku;
+ * @param[in] client         – deskryptor gniazda klienta.
+ */
+static void startSession(Server *server, pthread_attr_t *attributes,
+                         int client) {
+    Session *session = (Session *)malloc(sizeof(Session));
+    sigset_t signals, previous;
+    pthread_t thread;
+    int error;
+
+    if (session == NULL) {
+        close(client);
+    }
+    else {
+        session->server = server;
+        session->client = client;
+        session->previous = NULL;
+        pthread_mutex_lock(&server->mutex);
+        session->next = server->sessions;
+        if (server->sessions != NULL) {
+            server->sessions->previous = session;
+        }
+        server->sessions = session;
+        server->running++;
+        pthread_mutex_unlock(&server->mutex);
+
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, &previous);
+        error = pthread_create(&thread, attributes, serveClient, session);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+        if (error != 0) {
+            unlinkSession(session);
+            pthread_mutex_lock(&server->mutex);
+            server->running--;
+            pthread_mutex_unlock(&server->mutex);
+            close(client);
+            free(session);
+        }
+    }
+}
+
+/**
+ * @brief Sprawdza, czy błąd przyjmowania klienta jest przejściowy.
+ * Brak wolnych deskryptorów plików lub pamięci mija, gdy inne sesje się
+ * zakończą, więc po takim błędzie warto spróbować ponownie.
+ * @param[in] error          – kod błędu.
+ * @return Wartość @p true, jeśli błąd jest przejściowy.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isTransientError(int error) {
+    if ((error == EMFILE) || (error == ENFILE) || (error == ENOBUFS)
+        || (error == ENOMEM)) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Przyjmuje kolejnych klientów, dopóki serwer nie otrzyma sygnału
+ * kończącego pracę.
+ * Po przerwaniu oczekiwania i odrzuceniu połączenia przez klienta od razu
+ * czeka na kolejnego klienta, a po błędzie przejściowym robi to po krótkiej
+ * przerwie.
+ * @param[in,out] server     – wskaźnik na stan serwera;
+ * @param[in] listening      – deskryptor gniazda oczekującego na klientów.
+ * @return Wartość @p true, jeśli serwer otrzymał sygnał kończący pracę.
+ * Wartość @p false, gdy przyjmowanie klientów się nie powiodło.
+ */
+static bool acceptClients(Server *server, int listening) {
+    struct timespec delay = {0, ACCEPT_RETRY_DELAY * 1000000L};
+    pthread_attr_t attributes;
+    int client;
+    bool end = false;
+
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+
+    while (!end) {
+        client = accept(listening, NULL, NULL);
+        if (client != -1) {
+            startSession(server, &attributes, client);
+        }
+        else if (stopping) {
+            end = true;
+        }
+        else if (isTransientError(errno)) {
+            nanosleep(&delay, NULL);
+        }
+        else if ((errno != EINTR) && (errno != ECONNABORTED)) {
+            end = true;
+        }
+    }
+
+    pthread_attr_destroy(&attributes);
+
+    return stopping;
+}
+
+/**
+ * @brief Kończy sesje i czeka na zakończenie ich wątków.
+ * Wyłącza czytanie z gniazd sesji, więc sesje kończą się tak, jakby
+ * klienci przestali wysyłać polecenia, a ich otwarte grupy zmian są
+ * wycofywane.
+ * @param[in,out] server     – wskaźnik na stan serwera.
+ */
+static void finishSessions(Server *server) {
+    pthread_mutex_lock(&server->mutex);
+    for (Session *session = server->sessions; session != NULL;
+         session = session->next) {
+        shutdown(session->client, SHUT_RD);
+    }
+    while (server->running > 0) {
+        pthread_cond_wait(&server->finished, &server->mutex);
+    }
+    pthread_mutex_unlock(&server->mutex);
+}
+
+bool runServer(const char *path, int batchTimeout) {
+    Server server;
+    int listening = openSocket(path);
+    struct sigaction action;
+    bool stopped = false;
+
+    server.map = newMap();
+    if ((server.map == NULL) || (listening == -1)) {
+        deleteMap(server.map);
+    }
+    else {
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = stopServer;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = 0;
+        listeningSocket = listening;
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        signal(SIGPIPE, SIG_IGN);
+
+        enableSnapshots(server.map);
+        pthread_rwlock_init(&server.lock, NULL);
+        pthread_mutex_init(&server.mutex, NULL);
+        pthread_cond_init(&server.finished, NULL);
+        server.batchTimeout = batchTimeout;
+        server.sessions = NULL;
+        server.running = 0;
+
+        stopped = acceptClients(&server, listening);
+        finishSessions(&server);
+
+        pthread_cond_destroy(&server.finished);
+        pthread_mutex_destroy(&server.mutex);
+        pthread_rwlock_destroy(&server.lock);
+        deleteMap(server.map);
+        unlink(path);
+        listeningSocket = -1;
+    }
+
+    if (listening != -1) {
+        close(listening);
+    }
+
+    return stopped;
+}
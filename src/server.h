@@ -0,0 +1,40 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje trybu serwera.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+#include <stdbool.h>
+
+#define BATCH_TIMEOUT 10 ///< domyślny limit bezczynności grupy zmian w s
+
+/**
+ * @brief Udostępnia jedną mapę klientom łączącym się przez gniazdo lokalne.
+ * Tworzy nową mapę i gniazdo domeny Unix pod podaną ścieżką, usuwając
+ * wcześniej pozostawione pod nią gniazdo, a następnie przyjmuje kolejnych
+ * klientów. Każdy klient jest obsługiwany przez osobny wątek, który czyta
+ * polecenia z gniazda i odsyła wyniki oraz informacje o błędach tak, jak
+ * robi to @ref serveCommands. Włącza udostępnianie wersji mapy, dzięki czemu
+ * polecenia getRouteDescription i getCityRoutes nie czekają na zmiany
+ * wprowadzane przez innych klientów. Grupa zmian klienta, który przez podany
+ * czas nie przysłał kolejnego polecenia, jest wycofywana, a jego sesja
+ * kończona, aby bezczynny klient nie blokował mapy. Działa do otrzymania
+ * sygnału SIGINT lub SIGTERM. Wtedy przestaje przyjmować klientów, kończy sesje tak, jakby
+ * klienci przestali wysyłać polecenia, czeka na zakończenie ich wątków,
+ * usuwa mapę i gniazdo.
+ * @param[in] path           – ścieżka gniazda;
+ * @param[in] batchTimeout   – limit czasu w sekundach, przez jaki klient
+ *                             z otwartą grupą zmian może nie przysyłać
+ *                             poleceń, lub 0, jeśli czas ten nie jest
+ *                             ograniczony.
+ * @return Wartość @p true, jeśli serwer zakończył pracę po otrzymaniu
+ * sygnału. Wartość @p false, jeśli nie udało się utworzyć mapy lub gniazda
+ * albo przyjmowanie klientów się nie powiodło.
+ */
+bool runServer(const char *path, int batchTimeout);
+
+#endif /* __SERVER_H__ */
@@ -0,0 +1,1147 @@
+/** @file
+ * Plik zawierający funkcje wersji mapy udostępnianych czytelnikom.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#define _GNU_SOURCE
+
+#include "snapshot.h"
+#include "help-functions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define PAGE_BITS 8                ///< liczba bitów numeru elementu na stronie
+#define PAGE_SIZE (1 << PAGE_BITS) ///< liczba elementów strony
+#define ROUTE_PAGES ((ROUTE_SLOTS + PAGE_SIZE - 1) / PAGE_SIZE) ///< liczba stron dróg krajowych
+#define ROUTE_ID_LENGTH 3          ///< maksymalna liczba cyfr numeru drogi krajowej
+#define ROAD_DATA_LENGTH 24        ///< maksymalna liczba znaków danych odcinka drogi
+#define MIN_NAMES_SIZE 64          ///< najmniejszy rozmiar tablicy mieszającej nazw
+
+/**
+ * Struktura przechowująca stronę tablicy wersji.
+ */
+typedef struct Page Page;
+
+/**
+ * Struktura przechowująca tablicę wersji podzieloną na strony.
+ */
+typedef struct Table Table;
+
+/**
+ * Struktura przechowująca nazwę miasta w wersji.
+ */
+typedef struct CityName CityName;
+
+/**
+ * Struktura przechowująca tablicę mieszającą nazw miast.
+ */
+typedef struct Names Names;
+
+/**
+ * Struktura przechowująca listę dróg krajowych miasta w wersji.
+ */
+typedef struct CityRoutes CityRoutes;
+
+/**
+ * Struktura przechowująca miasto drogi krajowej w wersji.
+ */
+typedef struct RouteStop RouteStop;
+
+/**
+ * Struktura przechowująca drogę krajową w wersji.
+ */
+typedef struct RouteRecord RouteRecord;
+
+/**
+ * Struktura przechowująca tablicę wskaźników na obiekty wersji.
+ */
+typedef struct Objects Objects;
+
+/**
+ * Struktura przechowująca tworzoną wersję mapy.
+ */
+typedef struct Draft Draft;
+
+/**
+ * @brief Struktura przechowująca stronę tablicy wersji.
+ * Strona należy do wersji, która ją utworzyła, i tylko ta wersja może ją
+ * zmieniać, dopóki nie zostanie opublikowana. Późniejsze wersje zmieniają
+ * kopię strony.
+ */
+struct Page {
+    unsigned long version;  ///< numer wersji, która utworzyła stronę
+    void *items[PAGE_SIZE]; ///< wskaźniki na elementy lub NULL
+};
+
+/**
+ * @brief Struktura przechowująca tablicę wersji podzieloną na strony.
+ * Wersje współdzielą niezmienione strony, więc zmiana elementu kopiuje tylko
+ * tablicę wskaźników na strony i jedną stronę.
+ */
+struct Table {
+    unsigned long version; ///< numer wersji, która utworzyła tablicę
+    int numberOfPages;     ///< liczba stron
+    Page *pages[];         ///< wskaźniki na strony lub NULL
+};
+
+/**
+ * @brief Struktura przechowująca nazwę miasta w wersji.
+ * Nazwa miasta się nie zmienia, a zatwierdzone miasto nie jest usuwane, więc
+ * nazwa jest tworzona raz i współdzielona przez wszystkie późniejsze wersje.
+ */
+struct CityName {
+    int id;        ///< identyfikator miasta
+    unsigned hash; ///< skrót nazwy miasta
+    char name[];   ///< nazwa miasta
+};
+
+/**
+ * @brief Struktura przechowująca tablicę mieszającą nazw miast.
+ * Nazwy są do tablicy tylko dodawane, więc czytelnicy mogą jej przeszukiwać
+ * w trakcie dodawania kolejnych nazw, bez kopiowania tablicy dla każdej
+ * wersji. Nazwa jest wstawiana w wolne miejsce dopiero wtedy, gdy jest
+ * gotowa, a nazwy miast dodanych po utworzeniu wersji są pomijane dzięki
+ * porównaniu identyfikatora miasta z liczbą miast wersji. Gdy tablica
+ * zapełniłaby się w więcej niż połowie, zastępuje ją dwa razy większa kopia,
+ * a stara tablica jest zwalniana razem z wersjami, które jej używają.
+ */
+struct Names {
+    int size;                    ///< rozmiar tablicy, będący potęgą dwójki
+    _Atomic(CityName *) slots[]; ///< wskaźniki na nazwy miast lub NULL
+};
+
+/**
+ * @brief Struktura przechowująca listę dróg krajowych miasta w wersji.
+ * Miasto, przez które nie przechodzi żadna droga krajowa, nie ma listy.
+ */
+struct CityRoutes {
+    int numberOfRoutes; ///< liczba dróg krajowych
+    unsigned routes[];  ///< rosnące numery dróg krajowych
+};
+
+/**
+ * @brief Struktura przechowująca miasto drogi krajowej w wersji.
+ * Struktura zawiera nazwę miasta oraz długość i rok budowy lub ostatniego
+ * remontu odcinka drogi prowadzącego do następnego miasta drogi krajowej.
+ */
+struct RouteStop {
+    CityName *city;  ///< wskaźnik na nazwę miasta
+    unsigned length; ///< długość odcinka drogi do następnego miasta
+    int year;        ///< rok budowy lub ostatniego remontu tego odcinka
+};
+
+/**
+ * @brief Struktura przechowująca drogę krajową w wersji.
+ * Struktura zawiera kolejne miasta drogi krajowej wraz z odcinkami dróg między
+ * nimi. Opis drogi krajowej jest tworzony dopiero przy jego odczytaniu, poza
+ * blokadą mapy, więc publikacja zmienionej drogi krajowej tylko kopiuje jej
+ * dane.
+ */
+struct RouteRecord {
+    int numberOfCities; ///< liczba miast drogi krajowej
+    RouteStop stops[];  ///< kolejne miasta drogi krajowej
+};
+
+/**
+ * @brief Struktura przechowująca tablicę wskaźników na obiekty wersji.
+ */
+struct Objects {
+    void **items; ///< tablica wskaźników na obiekty
+    int number;   ///< liczba obiektów
+    int size;     ///< rozmiar tablicy
+};
+
+/**
+ * @brief Struktura przechowująca niezmienną wersję mapy.
+ * Struktura zawiera:
+ * numer wersji i liczbę jej przypięć;
+ * liczbę miast;
+ * tablicę mieszającą nazw miast, indeksowaną skrótami nazw, zawierającą
+ * nazwy wszystkich miast wersji;
+ * tablicę list dróg krajowych miast, indeksowaną identyfikatorami miast;
+ * tablicę dróg krajowych, indeksowaną ich numerami;
+ * obiekty, które następna wersja zastąpiła, zwalniane razem z tą wersją;
+ * wskaźnik na następną wersję.
+ */
+struct Snapshot {
+    unsigned long version; ///< numer wersji
+    int pins;              ///< liczba przypięć wersji
+    int numberOfCities;    ///< liczba miast
+    Names *names;          ///< tablica mieszająca nazw miast
+    Table *cities;         ///< tablica list dróg krajowych miast
+    Table *routes;         ///< tablica dróg krajowych
+    Objects retired;       ///< obiekty zastąpione w następnej wersji
+    Snapshot *next;        ///< wskaźnik na następną wersję
+};
+
+/**
+ * @brief Struktura przechowująca wersje mapy udostępniane czytelnikom.
+ * Wersje tworzą listę od najstarszej niezwolnionej do najnowszej. Obiekt
+ * zastąpiony w którejś wersji występuje tylko w starszych od niej, więc
+ * wersje są zwalniane od najstarszej, gdy nie są przypięte, co odpowiada
+ * zwalnianiu pamięci według epok.
+ * Struktura zawiera:
+ * muteks chroniący listę wersji, liczby ich przypięć i informację
+ * o nieaktualności;
+ * wskaźniki na najstarszą i najnowszą wersję;
+ * tablicę mieszającą, do której są dodawane nazwy nowych miast, oraz liczbę
+ * miast, których nazwy już do niej dodano;
+ * tablicę nazw miast indeksowaną identyfikatorami miast i jej rozmiar;
+ * numery dróg krajowych zmienionych od ostatniej publikacji, ich liczbę
+ * i wskaźniki na te drogi krajowe, indeksowane numerami;
+ * numer bieżącej publikacji i numery publikacji, w których drogi krajowe
+ * zostały zaznaczone jako zmienione, dzięki czemu każdy numer jest zapisany
+ * tylko raz, a tablicy numerów nie trzeba czyścić;
+ * informację o tym, czy najnowsza wersja nie zawiera wszystkich
+ * zatwierdzonych zmian, bo nie udało się zaalokować pamięci.
+ */
+struct Versions {
+    pthread_mutex_t mutex;                 ///< muteks chroniący wersje
+    Snapshot *oldest;                      ///< wskaźnik na najstarszą wersję
+    Snapshot *current;                     ///< wskaźnik na najnowszą wersję
+    Names *names;                          ///< tablica mieszająca nazw miast
+    int numberOfNames;                     ///< liczba miast z nazwą w tablicy
+    CityName **cityNames;                  ///< nazwy miast według id
+    int sizeOfCityNames;                   ///< rozmiar tablicy nazw miast
+    unsigned changedRoutes[ROUTE_SLOTS];   ///< numery zmienionych dróg
+    int numberOfChanged;                   ///< liczba zmienionych dróg
+    Route *routes[ROUTE_SLOTS];            ///< zmienione drogi lub NULL
+    unsigned long routeMarks[ROUTE_SLOTS]; ///< publikacje zaznaczenia dróg
+    unsigned long publication;             ///< numer bieżącej publikacji
+    bool outdated;                         ///< nieaktualność najnowszej wersji
+};
+
+/**
+ * @brief Struktura przechowująca tworzoną wersję mapy.
+ * Struktura zawiera tworzoną wersję oraz obiekty dla niej utworzone
+ * i obiekty poprzedniej wersji, które zastąpiła. Jeśli tworzenie wersji się
+ * nie powiedzie, utworzone obiekty są zwalniane, a poprzednia wersja
+ * pozostaje nienaruszona.
+ */
+struct Draft {
+    Snapshot *snapshot; ///< wskaźnik na tworzoną wersję
+    Objects created;    ///< obiekty utworzone dla wersji
+    Objects replaced;   ///< obiekty zastąpione w wersji
+};
+
+/**
+ * @brief Ustawia wartości początkowe tablicy obiektów.
+ * @param[out] objects       – wskaźnik na tablicę obiektów.
+ */
+static void setObjectsValues(Objects *objects) {
+    objects->items = NULL;
+    objects->number = 0;
+    objects->size = 0;
+}
+
+/**
+ * @brief Dodaje obiekt do tablicy obiektów.
+ * @param[in,out] objects    – wskaźnik na tablicę obiektów;
+ * @param[in] object         – wskaźnik na obiekt.
+ * @return Wartość @p true, jeśli udało się dodać obiekt.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool addObject(Objects *objects, void *object) {
+    void **items;
+    int newSize;
+    bool correct = true;
+
+    if (objects->number == objects->size) {
+        newSize = enlargeSize(objects->size);
+        items = (void **)realloc(objects->items, newSize * sizeof(void *));
+        if (items == NULL) {
+            correct = false;
+        }
+        else {
+            objects->items = items;
+            objects->size = newSize;
+        }
+    }
+
+    if (correct) {
+        objects->items[objects->number] = object;
+        objects->number++;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Zwalnia obiekty z tablicy obiektów oraz samą tablicę.
+ * @param[in,out] objects    – wskaźnik na tablicę obiektów.
+ */
+static void freeObjects(Objects *objects) {
+    for (int i = 0; i < objects->number; i++) {
+        free(objects->items[i]);
+    }
+
+    free(objects->items);
+    setObjectsValues(objects);
+}
+
+/**
+ * @brief Alokuje obiekt tworzonej wersji.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in] size           – rozmiar obiektu.
+ * @return Wskaźnik na obiekt lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static void* newObject(Draft *draft, size_t size) {
+    void *object = malloc(size);
+
+    if ((object != NULL) && !addObject(&draft->created, object)) {
+        free(object);
+        object = NULL;
+    }
+
+    return object;
+}
+
+/**
+ * @brief Zapisuje, że obiekt poprzedniej wersji został zastąpiony.
+ * Nic nie robi, jeśli wskaźnik na obiekt ma wartość NULL.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in] object         – wskaźnik na zastąpiony obiekt.
+ * @return Wartość @p true, jeśli udało się zapisać obiekt.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool replaceObject(Draft *draft, void *object) {
+    if (object == NULL) {
+        return true;
+    }
+    else {
+        return addObject(&draft->replaced, object);
+    }
+}
+
+/**
+ * @brief Daje w wyniku element tablicy wersji.
+ * @param[in] table          – wskaźnik na tablicę lub NULL;
+ * @param[in] position       – pozycja elementu.
+ * @return Wskaźnik na element lub NULL, gdy elementu nie ma w tablicy.
+ */
+static void* getItem(Table *table, int position) {
+    void *item = NULL;
+    Page *page;
+
+    if ((table != NULL) && ((position >> PAGE_BITS) < table->numberOfPages)) {
+        page = table->pages[position >> PAGE_BITS];
+        if (page != NULL) {
+            item = page->items[position & (PAGE_SIZE - 1)];
+        }
+    }
+
+    return item;
+}
+
+/**
+ * @brief Przygotowuje tablicę do zmian w tworzonej wersji.
+ * Jeśli tablica nie należy do tworzonej wersji lub ma za mało stron, zastępuje
+ * ją kopią o co najmniej podanej liczbie stron, współdzielącą z nią strony.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in,out] table      – wskaźnik na wskaźnik na tablicę lub na NULL;
+ * @param[in] numberOfPages  – potrzebna liczba stron.
+ * @return Wartość @p true, jeśli tablica jest gotowa do zmian.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool prepareTable(Draft *draft, Table **table, int numberOfPages) {
+    unsigned long version = draft->snapshot->version;
+    Table *old = *table, *copy;
+    int oldPages = 0;
+    bool correct = true;
+
+    if (old != NULL) {
+        oldPages = old->numberOfPages;
+    }
+    if (numberOfPages < oldPages) {
+        numberOfPages = oldPages;
+    }
+
+    if ((old == NULL) || (old->version != version)
+        || (oldPages < numberOfPages)) {
+        copy = (Table *)newObject(draft, sizeof(Table)
+                                         + numberOfPages * sizeof(Page *));
+        if ((copy == NULL) || !replaceObject(draft, old)) {
+            correct = false;
+        }
+        else {
+            copy->version = version;
+            copy->numberOfPages = numberOfPages;
+            for (int i = 0; i < numberOfPages; i++) {
+                if (i < oldPages) {
+                    copy->pages[i] = old->pages[i];
+                }
+                else {
+                    copy->pages[i] = NULL;
+                }
+            }
+            *table = copy;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Zmienia element tablicy w tworzonej wersji.
+ * Najpierw przygotowuje tablicę do zmian, tak aby miała stronę z podaną
+ * pozycją. Jeśli strona nie należy do tworzonej wersji, zastępuje ją kopią.
+ * Dzięki temu wersja kopiuje tylko tablice i strony, które zmienia.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in,out] table      – wskaźnik na wskaźnik na tablicę lub na NULL;
+ * @param[in] position       – pozycja elementu;
+ * @param[in] item           – wskaźnik na nowy element lub NULL.
+ * @return Wartość @p true, jeśli udało się zmienić element.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool setItem(Draft *draft, Table **table, int position, void *item) {
+    unsigned long version = draft->snapshot->version;
+    Page **page = NULL;
+    Page *copy;
+    bool correct = prepareTable(draft, table, (position >> PAGE_BITS) + 1);
+
+    if (correct) {
+        page = &(*table)->pages[position >> PAGE_BITS];
+    }
+
+    if (correct && ((*page == NULL) || ((*page)->version != version))) {
+        copy = (Page *)newObject(draft, sizeof(Page));
+        if ((copy == NULL) || !replaceObject(draft, *page)) {
+            correct = false;
+        }
+        else {
+            copy->version = version;
+            if (*page == NULL) {
+                for (int i = 0; i < PAGE_SIZE; i++) {
+                    copy->items[i] = NULL;
+                }
+            }
+            else {
+                memcpy(copy->items, (*page)->items, sizeof(copy->items));
+            }
+            *page = copy;
+        }
+    }
+
+    if (correct) {
+        (*page)->items[position & (PAGE_SIZE - 1)] = item;
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Tworzy pustą tablicę mieszającą nazw miast.
+ * @param[in] size           – rozmiar tablicy, będący potęgą dwójki.
+ * @return Wskaźnik na tablicę lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static Names* newNames(int size) {
+    Names *names = (Names *)malloc(sizeof(Names)
+                                   + size * sizeof(_Atomic(CityName *)));
+
+    if (names != NULL) {
+        names->size = size;
+        for (int i = 0; i < size; i++) {
+            atomic_init(&names->slots[i], NULL);
+        }
+    }
+
+    return names;
+}
+
+/**
+ * @brief Wstawia nazwę miasta do tablicy mieszającej.
+ * Zakłada, że w tablicy jest wolne miejsce. Nazwa staje się widoczna dla
+ * czytelników dopiero po zapisaniu jej w wolnym miejscu.
+ * @param[in,out] names      – wskaźnik na tablicę mieszającą;
+ * @param[in] name           – wskaźnik na wstawianą nazwę.
+ */
+static void insertName(Names *names, CityName *name) {
+    unsigned mask = names->size - 1;
+    unsigned slot = name->hash & mask;
+
+    while (atomic_load_explicit(&names->slots[slot], memory_order_relaxed)
+           != NULL) {
+        slot = (slot + 1) & mask;
+    }
+
+    atomic_store_explicit(&names->slots[slot], name, memory_order_release);
+}
+
+/**
+ * @brief Szuka nazwy miasta w tablicy mieszającej wersji.
+ * @param[in] snapshot       – wskaźnik na wersję;
+ * @param[in] name           – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Wskaźnik na znalezioną nazwę lub NULL, gdy miasta nie ma w wersji.
+ */
+static CityName* findName(Snapshot *snapshot, const char *name) {
+    Names *names = snapshot->names;
+    CityName *found = NULL, *item;
+    size_t length;
+    unsigned hash = hashCityName(name, &length), mask = 0, slot = hash;
+    bool searching = false;
+
+    if (names != NULL) {
+        mask = names->size - 1;
+        searching = true;
+    }
+
+    while (searching) {
+        item = atomic_load_explicit(&names->slots[slot & mask],
+                                    memory_order_acquire);
+        if (item == NULL) {
+            searching = false;
+        }
+        else if ((item->hash == hash) && (item->id < snapshot->numberOfCities)
+                 && (strcmp(item->name, name) == 0)) {
+            found = item;
+            searching = false;
+        }
+        else {
+            slot++;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief Dodaje nazwy nowych miast mapy do tablicy mieszającej nazw i do
+ * tablicy nazw według identyfikatorów miast.
+ * Jeśli tablica mieszająca zapełniłaby się w więcej niż połowie, najpierw
+ * zastępuje ją dwa razy większą kopią. Tablica, której nie używa jeszcze
+ * żadna wersja, jest od razu zwalniana. Nazwy dodane przed niepowodzeniem
+ * pozostają w tablicach, bo miasta, do których należą, już istnieją.
+ * @param[in,out] versions   – wskaźnik na strukturę wersji;
+ * @param[in] map            – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli udało się dodać wszystkie nazwy.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool addNames(Versions *versions, Map *map) {
+    Names *old = versions->names, *names = NULL;
+    CityName *name, *item, **cityNames;
+    City *city;
+    int size = MIN_NAMES_SIZE;
+    bool correct = true;
+
+    while (size < 2 * map->numberOfCities) {
+        size *= 2;
+    }
+
+    if ((old == NULL) || (old->size < size)) {
+        names = newNames(size);
+        if (names == NULL) {
+            correct = false;
+        }
+        else {
+            for (int i = 0; (old != NULL) && (i < old->size); i++) {
+                item = atomic_load_explicit(&old->slots[i],
+                                            memory_order_relaxed);
+                if (item != NULL) {
+                    insertName(names, item);
+                }
+            }
+            if (old != versions->current->names) {
+                free(old);
+            }
+            versions->names = names;
+        }
+    }
+
+    if (correct && (versions->sizeOfCityNames < map->numberOfCities)) {
+        cityNames = (CityName **)realloc(versions->cityNames,
+                                         size * sizeof(CityName *));
+        if (cityNames == NULL) {
+            correct = false;
+        }
+        else {
+            versions->cityNames = cityNames;
+            versions->sizeOfCityNames = size;
+        }
+    }
+
+    while (correct && (versions->numberOfNames < map->numberOfCities)) {
+        city = map->cities[versions->numberOfNames];
+        name = (CityName *)malloc(sizeof(CityName) + city->nameLength + 1);
+        if (name == NULL) {
+            correct = false;
+        }
+        else {
+            name->id = city->id;
+            name->hash = city->nameHash;
+            memcpy(name->name, city->name, city->nameLength + 1);
+            insertName(versions->names, name);
+            versions->cityNames[name->id] = name;
+            versions->numberOfNames++;
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Porównuje numery dróg krajowych przy sortowaniu.
+ * @param[in] a              – wskaźnik na pierwszy numer;
+ * @param[in] b              – wskaźnik na drugi numer.
+ * @return Liczba ujemna, zero lub dodatnia, gdy pierwszy numer jest
+ * odpowiednio mniejszy, równy lub większy od drugiego.
+ */
+static int compareRouteIds(const void *a, const void *b) {
+    unsigned idA = *(const unsigned *)a;
+    unsigned idB = *(const unsigned *)b;
+
+    return (idA > idB) - (idA < idB);
+}
+
+/**
+ * @brief Tworzy od nowa listę dróg krajowych miasta w tworzonej wersji.
+ * Nic nie robi, jeśli lista została już utworzona dla tej wersji, co jest
+ * zaznaczone oznaczeniem wierzchołka miasta.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – identyfikator miasta.
+ * @return Wartość @p true, jeśli lista jest aktualna.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool updateCity(Draft *draft, Map *map, int id) {
+    Table **cities = &draft->snapshot->cities;
+    CityRoutes *old = (CityRoutes *)getItem(*cities, id), *record = NULL;
+    ListOfRoutes *node = map->cities[id]->firstRoute;
+    int numberOfRoutes = 0;
+    bool correct = true;
+
+    if (!isVertexMarked(map, id)) {
+        markVertex(map, id);
+        while (node != NULL) {
+            numberOfRoutes++;
+            node = node->next;
+        }
+
+        if (numberOfRoutes > 0) {
+            record = (CityRoutes *)newObject(draft, sizeof(CityRoutes)
+                                             + numberOfRoutes
+                                               * sizeof(unsigned));
+            if (record == NULL) {
+                correct = false;
+            }
+            else {
+                record->numberOfRoutes = numberOfRoutes;
+                node = map->cities[id]->firstRoute;
+                for (int i = 0; i < numberOfRoutes; i++) {
+                    record->routes[i] = node->route->id;
+                    node = node->next;
+                }
+                qsort(record->routes, numberOfRoutes, sizeof(unsigned),
+                      compareRouteIds);
+            }
+        }
+
+        if (correct && ((old != NULL) || (record != NULL))) {
+            correct = replaceObject(draft, old)
+                      && setItem(draft, cities, id, record);
+        }
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Sprawdza, czy lista dróg krajowych miasta w wersji zawiera drogę
+ * krajową.
+ * @param[in] record         – wskaźnik na listę dróg krajowych miasta lub
+ *                             NULL, gdy miasto nie ma listy;
+ * @param[in] id             – numer drogi krajowej.
+ * @return Wartość @p true, jeśli lista zawiera drogę krajową.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool hasRoute(CityRoutes *record, unsigned id) {
+    if ((record == NULL)
+        || (bsearch(&id, record->routes, record->numberOfRoutes,
+                    sizeof(unsigned), compareRouteIds) == NULL)) {
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+/**
+ * @brief Sprawdza, czy droga krajowa o danym numerze przechodzi przez miasto
+ * mapy.
+ * @param[in] city           – wskaźnik na strukturę miasta;
+ * @param[in] id             – numer drogi krajowej.
+ * @return Wartość @p true, jeśli droga krajowa przechodzi przez miasto.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool isOnRoute(City *city, unsigned id) {
+    ListOfRoutes *node = city->firstRoute;
+    bool found = false;
+
+    while ((node != NULL) && !found) {
+        if (node->route->id == id) {
+            found = true;
+        }
+        node = node->next;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Tworzy od nowa drogę krajową w tworzonej wersji.
+ * Kopiuje miasta i odcinki dróg drogi krajowej, bez tworzenia jej opisu.
+ * Tworzy też od nowa listy dróg krajowych tylko tych miast, przez które droga
+ * krajowa przestała przechodzić lub zaczęła przechodzić, więc wydłużenie
+ * drogi krajowej zmienia listy tylko nowych miast.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – numer drogi krajowej;
+ * @param[in] route          – wskaźnik na drogę krajową lub NULL, gdy droga
+ *                             krajowa o tym numerze nie istnieje.
+ * @return Wartość @p true, jeśli droga krajowa jest aktualna.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool updateRoute(Draft *draft, Map *map, unsigned id, Route *route) {
+    CityName **cityNames = map->versions->cityNames;
+    Table **routes = &draft->snapshot->routes;
+    RouteRecord *old = (RouteRecord *)getItem(*routes, id), *record = NULL;
+    RouteStop *stop;
+    Road *road;
+    int numberOfCities = 0, city;
+    bool correct = true;
+
+    if (route != NULL) {
+        numberOfCities = route->numberOfRoads + 1;
+        record = (RouteRecord *)newObject(draft, sizeof(RouteRecord)
+                                          + numberOfCities
+                                            * sizeof(RouteStop));
+        if (record == NULL) {
+            correct = false;
+        }
+        else {
+            record->numberOfCities = numberOfCities;
+            for (int i = 0; i < numberOfCities; i++) {
+                stop = &record->stops[i];
+                stop->city = cityNames[route->cities[route->first + i]->id];
+                stop->length = 0;
+                stop->year = 0;
+                if (i < route->numberOfRoads) {
+                    road = route->roads[route->first + i];
+                    stop->length = road->length;
+                    stop->year = road->year;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; correct && (old != NULL) && (i < old->numberOfCities);
+         i++) {
+        city = old->stops[i].city->id;
+        if (!isOnRoute(map->cities[city], id)) {
+            correct = updateCity(draft, map, city);
+        }
+    }
+    for (int i = 0; correct && (i < numberOfCities); i++) {
+        city = record->stops[i].city->id;
+        if (!hasRoute((CityRoutes *)getItem(draft->snapshot->cities, city),
+                      id)) {
+            correct = updateCity(draft, map, city);
+        }
+    }
+
+    if (correct && ((old != NULL) || (record != NULL))) {
+        correct = replaceObject(draft, old)
+                  && setItem(draft, routes, id, record);
+    }
+
+    return correct;
+}
+
+/**
+ * @brief Rozpoczyna tworzenie wersji następującej po podanej.
+ * Nowa wersja początkowo współdzieli wszystkie tablice z poprzednią.
+ * @param[out] draft         – wskaźnik na tworzoną wersję;
+ * @param[in] current        – wskaźnik na najnowszą wersję.
+ * @return Wartość @p true, jeśli udało się rozpocząć tworzenie wersji.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool startDraft(Draft *draft, Snapshot *current) {
+    Snapshot *snapshot = (Snapshot *)malloc(sizeof(Snapshot));
+
+    draft->snapshot = snapshot;
+    setObjectsValues(&draft->created);
+    setObjectsValues(&draft->replaced);
+
+    if (snapshot != NULL) {
+        snapshot->version = current->version + 1;
+        snapshot->pins = 0;
+        snapshot->numberOfCities = current->numberOfCities;
+        snapshot->names = current->names;
+        snapshot->cities = current->cities;
+        snapshot->routes = current->routes;
+        setObjectsValues(&snapshot->retired);
+        snapshot->next = NULL;
+    }
+
+    return snapshot != NULL;
+}
+
+/**
+ * @brief Tworzy dane wersji zawierającej zatwierdzane zmiany.
+ * Dodaje nowe miasta i tworzy od nowa drogi krajowe zaznaczone jako
+ * zmienione. Jeśli poprzednia wersja jest nieaktualna, tworzy od nowa
+ * wszystkie drogi krajowe i listy dróg krajowych wszystkich miast.
+ * Oznaczenia wierzchołków użyte do zaznaczania utworzonych list przestają
+ * obowiązywać.
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] everything     – informacja o tym, czy trzeba utworzyć od nowa
+ *                             wszystkie dane.
+ * @return Wartość @p true, jeśli udało się utworzyć dane wersji.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+static bool buildDraft(Draft *draft, Map *map, bool everything) {
+    Versions *versions = map->versions;
+    Snapshot *snapshot = draft->snapshot;
+    Route *routes[ROUTE_SLOTS] = {NULL};
+    ListOfRoutes *node = map->firstRoute;
+    unsigned id;
+    bool correct;
+
+    newMark(map);
+    correct = addNames(versions, map);
+    if (correct && (snapshot->names != versions->names)) {
+        correct = replaceObject(draft, snapshot->names);
+        snapshot->names = versions->names;
+    }
+    snapshot->numberOfCities = map->numberOfCities;
+
+    if (everything) {
+        for (int i = 0; correct && (i < map->numberOfCities); i++) {
+            correct = updateCity(draft, map, i);
+        }
+        while (node != NULL) {
+            routes[node->route->id] = node->route;
+            node = node->next;
+        }
+        for (id = 0; correct && (id < ROUTE_SLOTS); id++) {
+            correct = updateRoute(draft, map, id, routes[id]);
+        }
+    }
+    else {
+        for (int i = 0; correct && (i < versions->numberOfChanged); i++) {
+            id = versions->changedRoutes[i];
+            correct = updateRoute(draft, map, id, versions->routes[id]);
+        }
+    }
+    newMark(map);
+
+    return correct;
+}
+
+/**
+ * @brief Wybiera wersje, których pamięć można zwolnić.
+ * Odłącza od listy wersji najstarsze wersje, które nie są przypięte, aż do
+ * pierwszej przypiętej lub najnowszej. Zakłada, że muteks wersji jest
+ * zablokowany.
+ * @param[in,out] versions   – wskaźnik na strukturę wersji.
+ * @return Wskaźnik na pierwszą z odłączonych wersji lub NULL, gdy żadnej
+ * nie odłączono.
+ */
+static Snapshot* collectUnused(Versions *versions) {
+    Snapshot *unused = versions->oldest, *last = NULL;
+
+    while ((versions->oldest != versions->current)
+           && (versions->oldest->pins == 0)) {
+        last = versions->oldest;
+        versions->oldest = versions->oldest->next;
+    }
+
+    if (last == NULL) {
+        unused = NULL;
+    }
+    else {
+        last->next = NULL;
+    }
+
+    return unused;
+}
+
+/**
+ * @brief Zwalnia listę wersji wraz z obiektami zastąpionymi w następnych
+ * wersjach.
+ * @param[in] snapshot       – wskaźnik na pierwszą wersję listy lub NULL.
+ */
+static void freeSnapshots(Snapshot *snapshot) {
+    Snapshot *next;
+
+    while (snapshot != NULL) {
+        next = snapshot->next;
+        freeObjects(&snapshot->retired);
+        free(snapshot);
+        snapshot = next;
+    }
+}
+
+/**
+ * @brief Kończy tworzenie wersji.
+ * Jeśli udało się utworzyć wersję, publikuje ją jako najnowszą i zwalnia
+ * wersje, których nikt już nie może odczytać. W przeciwnym przypadku zwalnia
+ * obiekty utworzone dla wersji i zaznacza, że najnowsza wersja jest
+ * nieaktualna, przez co nie można jej przypiąć.
+ * @param[in,out] versions   – wskaźnik na strukturę wersji;
+ * @param[in,out] draft      – wskaźnik na tworzoną wersję;
+ * @param[in] correct        – informacja o tym, czy udało się utworzyć wersję.
+ */
+static void finishDraft(Versions *versions, Draft *draft, bool correct) {
+    Snapshot *unused = NULL;
+
+    if (correct) {
+        pthread_mutex_lock(&versions->mutex);
+        versions->current->retired = draft->replaced;
+        versions->current->next = draft->snapshot;
+        versions->current = draft->snapshot;
+        versions->outdated = false;
+        unused = collectUnused(versions);
+        pthread_mutex_unlock(&versions->mutex);
+
+        free(draft->created.items);
+        freeSnapshots(unused);
+    }
+    else {
+        freeObjects(&draft->created);
+        free(draft->replaced.items);
+        free(draft->snapshot);
+
+        pthread_mutex_lock(&versions->mutex);
+        versions->outdated = true;
+        pthread_mutex_unlock(&versions->mutex);
+    }
+}
+
+void markChangedRoute(Map *map, unsigned id, Route *route) {
+    Versions *versions = map->versions;
+
+    if (versions != NULL) {
+        if (versions->routeMarks[id] != versions->publication) {
+            versions->routeMarks[id] = versions->publication;
+            versions->changedRoutes[versions->numberOfChanged] = id;
+            versions->numberOfChanged++;
+        }
+        versions->routes[id] = route;
+    }
+}
+
+void publishVersion(Map *map) {
+    Versions *versions = map->versions;
+    Draft draft;
+    bool correct;
+
+    if (versions != NULL) {
+        if (versions->outdated || (versions->numberOfChanged > 0)
+            || (versions->current->numberOfCities < map->numberOfCities)) {
+            correct = startDraft(&draft, versions->current)
+                      && buildDraft(&draft, map, versions->outdated);
+            finishDraft(versions, &draft, correct);
+        }
+
+        versions->numberOfChanged = 0;
+        versions->publication++;
+    }
+}
+
+bool enableVersions(Map *map) {
+    Versions *versions;
+    Snapshot *empty;
+    bool correct = true;
+
+    if (map->undoLog.batch) {
+        correct = false;
+    }
+    else if (map->versions == NULL) {
+        versions = (Versions *)malloc(sizeof(Versions));
+        empty = (Snapshot *)malloc(sizeof(Snapshot));
+        if ((versions == NULL) || (empty == NULL)) {
+            free(versions);
+            free(empty);
+            correct = false;
+        }
+        else {
+            empty->version = 0;
+            empty->pins = 0;
+            empty->numberOfCities = 0;
+            empty->names = NULL;
+            empty->cities = NULL;
+            empty->routes = NULL;
+            setObjectsValues(&empty->retired);
+            empty->next = NULL;
+
+            pthread_mutex_init(&versions->mutex, NULL);
+            versions->oldest = empty;
+            versions->current = empty;
+            versions->names = NULL;
+            versions->numberOfNames = 0;
+            versions->cityNames = NULL;
+            versions->sizeOfCityNames = 0;
+            versions->numberOfChanged = 0;
+            for (int id = 0; id < ROUTE_SLOTS; id++) {
+                versions->routeMarks[id] = 0;
+            }
+            versions->publication = 1;
+            versions->outdated = true;
+            map->versions = versions;
+
+            publishVersion(map);
+            if (versions->outdated) {
+                freeVersions(map);
+                correct = false;
+            }
+        }
+    }
+
+    return correct;
+}
+
+Snapshot* pinVersion(Map *map) {
+    Versions *versions = map->versions;
+    Snapshot *snapshot = NULL;
+
+    if (versions != NULL) {
+        pthread_mutex_lock(&versions->mutex);
+        if (!versions->outdated) {
+            snapshot = versions->current;
+            snapshot->pins++;
+        }
+        pthread_mutex_unlock(&versions->mutex);
+    }
+
+    return snapshot;
+}
+
+void releaseVersion(Map *map, Snapshot *snapshot) {
+    Versions *versions = map->versions;
+    Snapshot *unused;
+
+    pthread_mutex_lock(&versions->mutex);
+    snapshot->pins--;
+    unused = collectUnused(versions);
+    pthread_mutex_unlock(&versions->mutex);
+
+    freeSnapshots(unused);
+}
+
+/**
+ * @brief Zwalnia tablicę wersji wraz ze stronami i elementami.
+ * @param[in] table          – wskaźnik na tablicę lub NULL.
+ */
+static void freeTable(Table *table) {
+    Page *page;
+
+    if (table != NULL) {
+        for (int i = 0; i < table->numberOfPages; i++) {
+            page = table->pages[i];
+            for (int j = 0; (page != NULL) && (j < PAGE_SIZE); j++) {
+                free(page->items[j]);
+            }
+            free(page);
+        }
+        free(table);
+    }
+}
+
+void freeVersions(Map *map) {
+    Versions *versions = map->versions;
+    CityName *name;
+
+    if (versions != NULL) {
+        for (int i = 0; (versions->names != NULL)
+                        && (i < versions->names->size); i++) {
+            name = atomic_load_explicit(&versions->names->slots[i],
+                                        memory_order_relaxed);
+            free(name);
+        }
+        if (versions->current->names != versions->names) {
+            free(versions->current->names);
+        }
+        free(versions->names);
+        free(versions->cityNames);
+        freeTable(versions->current->cities);
+        freeTable(versions->current->routes);
+        freeSnapshots(versions->oldest);
+        pthread_mutex_destroy(&versions->mutex);
+        free(versions);
+        map->versions = NULL;
+    }
+}
+
+char const* snapshotRouteDescription(Snapshot *snapshot, unsigned routeId) {
+    RouteRecord *record = NULL;
+    RouteStop *stop;
+    char *description;
+    size_t size = 1, length = 0;
+    int numberOfCities = 0;
+
+    if (routeId < ROUTE_SLOTS) {
+        record = (RouteRecord *)getItem(snapshot->routes, routeId);
+    }
+    if (record != NULL) {
+        numberOfCities = record->numberOfCities;
+        size += ROUTE_ID_LENGTH;
+        for (int i = 0; i < numberOfCities; i++) {
+            size += strlen(record->stops[i].city->name) + ROAD_DATA_LENGTH;
+        }
+    }
+
+    description = (char *)malloc(size);
+    if (description != NULL) {
+        description[0] = '\0';
+        for (int i = 0; i < numberOfCities; i++) {
+            stop = &record->stops[i];
+            if (i == 0) {
+                length += sprintf(description, "%u;%s", routeId,
+                                  stop->city->name);
+            }
+            else {
+                length += sprintf(description + length, ";%u;%d;%s",
+                                  (stop - 1)->length, (stop - 1)->year,
+                                  stop->city->name);
+            }
+        }
+    }
+
+    return description;
+}
+
+char const* snapshotCityRoutes(Snapshot *snapshot, const char *city) {
+    CityName *name = findName(snapshot, city);
+    CityRoutes *record = NULL;
+    char *description = NULL;
+    size_t size = 0;
+    int numberOfRoutes = 0;
+
+    if (name != NULL) {
+        record = (CityRoutes *)getItem(snapshot->cities, name->id);
+        if (record != NULL) {
+            numberOfRoutes = record->numberOfRoutes;
+        }
+
+        description = (char *)malloc(numberOfRoutes * (ROUTE_ID_LENGTH + 1)
+                                     + 1);
+        if (description != NULL) {
+            for (int i = 0; i < numberOfRoutes; i++) {
+                if (i > 0) {
+                    description[size++] = ';';
+                }
+                size += sprintf(description + size, "%u", record->routes[i]);
+            }
+            description[size] = '\0';
+        }
+    }
+
+    return description;
+}
@@ -0,0 +1,99 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje wersji mapy udostępnianych
+ * czytelnikom.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include "structures-functions.h"
+
+#define ROUTE_SLOTS 1000 ///< liczba numerów dróg krajowych wraz z numerem 0
+
+/**
+ * @brief Włącza publikowanie wersji mapy.
+ * Tworzy wersję odpowiadającą bieżącej zawartości mapy. Od tej chwili każde
+ * zatwierdzenie zmian publikuje nową wersję. Nic nie robi, jeśli wersje są
+ * już publikowane.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli wersje są publikowane.
+ * Wartość @p false, gdy grupa zmian jest otwarta lub nie udało się
+ * zaalokować pamięci.
+ */
+bool enableVersions(Map *map);
+
+/**
+ * @brief Przypina najnowszą opublikowaną wersję mapy.
+ * Przypięta wersja nie zmienia się i nie jest zwalniana aż do jej
+ * odpięcia, a przypięcie nie czeka na zakończenie zmian mapy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Wskaźnik na przypiętą wersję lub NULL, gdy wersje nie są
+ * publikowane lub najnowszej wersji nie udało się utworzyć.
+ */
+Snapshot* pinVersion(Map *map);
+
+/**
+ * @brief Odpina wersję mapy.
+ * Zwalnia pamięć wersji, których nikt już nie może przypiąć ani odczytać.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] snapshot       – wskaźnik na przypiętą wersję.
+ */
+void releaseVersion(Map *map, Snapshot *snapshot);
+
+/**
+ * @brief Zaznacza drogę krajową jako zmienioną przez zatwierdzane zmiany.
+ * Numer drogi krajowej jest zapisywany tylko raz do następnej publikacji,
+ * a każde kolejne zaznaczenie zastępuje zapisaną drogę krajową, więc drogi
+ * krajowe należy zaznaczać w kolejności wprowadzania zmian. Nic nie robi,
+ * jeśli wersje nie są publikowane.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – numer drogi krajowej;
+ * @param[in] route          – wskaźnik na drogę krajową o tym numerze lub NULL,
+ *                             gdy droga krajowa została usunięta.
+ */
+void markChangedRoute(Map *map, unsigned id, Route *route);
+
+/**
+ * @brief Publikuje wersję mapy zawierającą zatwierdzane zmiany.
+ * Wywoływana przy zatwierdzaniu zmian, zanim dziennik zostanie opróżniony.
+ * Tworzy od nowa tylko drogi krajowe zaznaczone funkcją
+ * @ref markChangedRoute, listy dróg krajowych miast, przez które zaczęły
+ * one przechodzić lub przestały przechodzić, i dane nowych miast, więc jej
+ * koszt nie zależy od liczby wszystkich dróg krajowych. Pozostałe dane
+ * współdzieli z poprzednią wersją. Jeśli nie udało się zaalokować pamięci,
+ * żadnej wersji nie można przypiąć, dopóki następna publikacja nie utworzy
+ * wszystkich danych od nowa. Nic nie robi, jeśli wersje nie są publikowane.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void publishVersion(Map *map);
+
+/**
+ * @brief Zwalnia wszystkie wersje mapy.
+ * Zakłada, że żadna wersja nie jest przypięta.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void freeVersions(Map *map);
+
+/**
+ * @brief Daje w wyniku opis drogi krajowej w przypiętej wersji mapy.
+ * @param[in] snapshot       – wskaźnik na przypiętą wersję;
+ * @param[in] routeId        – numer drogi krajowej.
+ * @return Napis w formacie funkcji @ref getRouteDescription lub NULL, gdy
+ * nie udało się zaalokować pamięci.
+ */
+char const* snapshotRouteDescription(Snapshot *snapshot, unsigned routeId);
+
+/**
+ * @brief Daje w wyniku listę dróg krajowych przechodzących przez miasto
+ * w przypiętej wersji mapy.
+ * @param[in] snapshot       – wskaźnik na przypiętą wersję;
+ * @param[in] city           – wskaźnik na napis reprezentujący nazwę miasta.
+ * @return Napis w formacie funkcji @ref getCityRoutes lub NULL, gdy miasto
+ * nie istnieje w tej wersji lub nie udało się zaalokować pamięci.
+ */
+char const* snapshotCityRoutes(Snapshot *snapshot, const char *city);
+
+#endif /* __SNAPSHOT_H__ */
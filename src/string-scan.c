@@ -0,0 +1,220 @@
+/** @file
+ * Plik zawierający wektorowe funkcje przeszukujące napisy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "string-scan.h"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SCAN ///< wektorowe wersje funkcji są dostępne
+#include <immintrin.h>
+#endif
+
+#define LAST_CONTROL_CHARACTER 31 ///< największy kod znaku sterującego
+#define MAX_BYTE_SUMS 255 ///< liczba bloków, po której sumy bajtów są zbierane
+
+/**
+ * @brief Liczy wystąpienia znaku w napisie, znak po znaku.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu;
+ * @param[in] character      – szukany znak.
+ * @return Liczba wystąpień znaku @p character w napisie.
+ */
+static size_t countCharacterScalar(const char *string, size_t length,
+                                   char character) {
+    size_t i, counter = 0;
+
+    for (i = 0; i < length; i++) {
+        if (string[i] == character) {
+            counter++;
+        }
+    }
+
+    return counter;
+}
+
+/**
+ * @brief Sprawdza, znak po znaku, czy napis zawiera znak niedozwolony
+ * w nazwie miasta.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu.
+ * @return Wartość @p true, jeśli napis zawiera niedozwolony znak.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+static bool hasForbiddenCharacterScalar(const char *string, size_t length) {
+    size_t i = 0;
+    bool found = false;
+
+    while ((i < length) && !found) {
+        if (((unsigned char)string[i] <= LAST_CONTROL_CHARACTER)
+            || (string[i] == ';')) {
+            found = true;
+        }
+        i++;
+    }
+
+    return found;
+}
+
+#ifdef VECTOR_SCAN
+
+/**
+ * @brief Liczy wystąpienia znaku w napisie, po 16 bajtów naraz.
+ * Wystąpienia są sumowane osobno dla każdego z 16 bajtów bloku, a sumy
+ * są dodawane do wyniku co @ref MAX_BYTE_SUMS bloków, zanim mogłyby
+ * przekroczyć zakres bajtu.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu;
+ * @param[in] character      – szukany znak.
+ * @return Liczba wystąpień znaku @p character w napisie.
+ */
+__attribute__((target("sse2")))
+static size_t countCharacterSse2(const char *string, size_t length,
+                                 char character) {
+    __m128i pattern = _mm_set1_epi8(character);
+    __m128i zero = _mm_setzero_si128();
+    __m128i block, counters, sums = zero;
+    uint64_t halves[2];
+    size_t i = 0, blocks;
+
+    while (i + sizeof(block) <= length) {
+        counters = zero;
+        blocks = 0;
+        while ((blocks < MAX_BYTE_SUMS) && (i + sizeof(block) <= length)) {
+            block = _mm_loadu_si128((const __m128i *)(string + i));
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, pattern));
+            i += sizeof(block);
+            blocks++;
+        }
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+    }
+
+    _mm_storeu_si128((__m128i *)halves, sums);
+
+    return halves[0] + halves[1]
+           + countCharacterScalar(string + i, length - i, character);
+}
+
+/**
+ * @brief Liczy wystąpienia znaku w napisie, po 32 bajty naraz.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu;
+ * @param[in] character      – szukany znak.
+ * @return Liczba wystąpień znaku @p character w napisie.
+ */
+__attribute__((target("avx2,popcnt")))
+static size_t countCharacterAvx2(const char *string, size_t length,
+                                 char character) {
+    __m256i pattern = _mm256_set1_epi8(character);
+    __m256i block;
+    size_t i = 0, counter = 0;
+
+    while (i + sizeof(block) <= length) {
+        block = _mm256_loadu_si256((const __m256i *)(string + i));
+        counter += __builtin_popcount((unsigned)
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+        i += sizeof(block);
+    }
+
+    return counter + countCharacterScalar(string + i, length - i, character);
+}
+
+/**
+ * @brief Sprawdza, po 16 bajtów naraz, czy napis zawiera znak niedozwolony
+ * w nazwie miasta.
+ * Bajt jest znakiem sterującym, jeśli nie zmienia go minimum bez znaku
+ * z kodem ostatniego znaku sterującego.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu.
+ * @return Wartość @p true, jeśli napis zawiera niedozwolony znak.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+__attribute__((target("sse2")))
+static bool hasForbiddenCharacterSse2(const char *string, size_t length) {
+    __m128i control = _mm_set1_epi8(LAST_CONTROL_CHARACTER);
+    __m128i semicolon = _mm_set1_epi8(';');
+    __m128i block, forbidden;
+    size_t i = 0;
+    bool found = false;
+
+    while ((i + sizeof(block) <= length) && !found) {
+        block = _mm_loadu_si128((const __m128i *)(string + i));
+        forbidden = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_min_epu8(block, control), block),
+            _mm_cmpeq_epi8(block, semicolon));
+        if (_mm_movemask_epi8(forbidden) != 0) {
+            found = true;
+        }
+        i += sizeof(block);
+    }
+
+    if (!found) {
+        found = hasForbiddenCharacterScalar(string + i, length - i);
+    }
+
+    return found;
+}
+
+/**
+ * @brief Sprawdza, po 32 bajty naraz, czy napis zawiera znak niedozwolony
+ * w nazwie miasta.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu.
+ * @return Wartość @p true, jeśli napis zawiera niedozwolony znak.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+__attribute__((target("avx2")))
+static bool hasForbiddenCharacterAvx2(const char *string, size_t length) {
+    __m256i control = _mm256_set1_epi8(LAST_CONTROL_CHARACTER);
+    __m256i semicolon = _mm256_set1_epi8(';');
+    __m256i block, forbidden;
+    size_t i = 0;
+    bool found = false;
+
+    while ((i + sizeof(block) <= length) && !found) {
+        block = _mm256_loadu_si256((const __m256i *)(string + i));
+        forbidden = _mm256_or_si256(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(block, control), block),
+            _mm256_cmpeq_epi8(block, semicolon));
+        if (_mm256_movemask_epi8(forbidden) != 0) {
+            found = true;
+        }
+        i += sizeof(block);
+    }
+
+    if (!found) {
+        found = hasForbiddenCharacterSse2(string + i, length - i);
+    }
+
+    return found;
+}
+
+#endif
+
+size_t countCharacter(const char *string, size_t length, char character) {
+#ifdef VECTOR_SCAN
+    if (__builtin_cpu_supports("avx2")) {
+        return countCharacterAvx2(string, length, character);
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        return countCharacterSse2(string, length, character);
+    }
+#endif
+    return countCharacterScalar(string, length, character);
+}
+
+bool hasForbiddenCharacter(const char *string, size_t length) {
+#ifdef VECTOR_SCAN
+    if (__builtin_cpu_supports("avx2")) {
+        return hasForbiddenCharacterAvx2(string, length);
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        return hasForbiddenCharacterSse2(string, length);
+    }
+#endif
+    return hasForbiddenCharacterScalar(string, length);
+}
@@ -0,0 +1,38 @@
+/** @file
+ * Interfejs pliku zawierającego wektorowe funkcje przeszukujące napisy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __STRING_SCAN_H__
+#define __STRING_SCAN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Liczy wystąpienia znaku w napisie.
+ * Na procesorach x86 przetwarza po 32 bajty naraz rozkazami AVX2 lub po 16
+ * bajtów naraz rozkazami SSE2, zależnie od tego, co obsługuje procesor,
+ * na którym działa program. Na pozostałych procesorach przetwarza napis
+ * znak po znaku.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu;
+ * @param[in] character      – szukany znak.
+ * @return Liczba wystąpień znaku @p character w napisie.
+ */
+size_t countCharacter(const char *string, size_t length, char character);
+
+/**
+ * @brief Sprawdza, czy napis zawiera znak niedozwolony w nazwie miasta,
+ * czyli znak o kodzie od 0 do 31 lub średnik.
+ * Wybiera wersję funkcji tak jak @ref countCharacter.
+ * @param[in] string         – wskaźnik na pierwszy znak napisu;
+ * @param[in] length         – liczba znaków napisu.
+ * @return Wartość @p true, jeśli napis zawiera niedozwolony znak.
+ * Wartość @p false, w przeciwnym przypadku.
+ */
+bool hasForbiddenCharacter(const char *string, size_t length);
+
+#endif /* __STRING_SCAN_H__ */
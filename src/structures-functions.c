@@ -11,31 +11,57 @@
 #include <limits.h>
 #include <string.h>
 
-#define MULTIPLIER 3 ///< mnożnik do powiększania tablic
-#define DIVIDER 2    ///< dzielnik do powiększania tablic
+#define MULTIPLIER 3             ///< mnożnik do powiększania tablic
+#define DIVIDER 2                ///< dzielnik do powiększania tablic
+#define NAMES_BLOCK_SIZE 65536   ///< rozmiar bloku pamięci na nazwy miast
+#define FNV_OFFSET 2166136261u   ///< wartość początkowa skrótu FNV-1a
+#define FNV_PRIME 16777619u      ///< mnożnik skrótu FNV-1a
+#define EMPTY_INDEX_CELL -1      ///< wartość pustej komórki tablicy mieszającej
+#define MIN_INDEX_SIZE 16        ///< początkowy rozmiar tablicy mieszającej
 
 void setMapValues(Map *map) {
     map->numberOfCities = 0;
     map->sizeOfCitiesArray = 0;
     map->cities = NULL;
+    map->vertices.distance = NULL;
+    map->vertices.oldestYear = NULL;
+    map->vertices.mark = NULL;
+    map->vertices.error = NULL;
+    map->vertices.reached = NULL;
+    map->vertices.search = 0;
+    map->sizeOfCitiesIndex = 0;
+    map->citiesIndex = NULL;
+    map->namesBlock = NULL;
+    map->mark = 1;
+    map->maxDetourLength = INFINITE_DISTANCE;
+    map->maxDetourCities = INT_MAX;
     map->firstRoad = NULL;
     map->lastRoad = NULL;
     map->firstRoute = NULL;
     map->lastRoute = NULL;
+    map->undoLog.changes = NULL;
+    map->undoLog.numberOfChanges = 0;
+    map->undoLog.size = 0;
+    map->undoLog.savepoint = 0;
+    map->undoLog.batch = false;
+    map->undoLog.failed = false;
+    map->versions = NULL;
 }
 
 void freeCity(City *city) {
+    freeListOfRoads(city->firstRoad);
+    freeListOfRoutes(city->firstRoute);
+    free(city);
+}
+
+void freeListOfRoads(ListOfRoads *list) {
     ListOfRoads *node;
 
-    while (city->firstRoad != NULL) {
-        node = city->firstRoad;
-        city->firstRoad = city->firstRoad->next;
+    while (list != NULL) {
+        node = list;
+        list = list->next;
         free(node);
     }
-
-    free((void *)city->name);
-    free(city->vertex);
-    free(city);
 }
 
 void freeRoads(ListOfRoads *list) {
@@ -51,14 +77,9 @@ void freeRoads(ListOfRoads *list) {
 }
 
 void freeRoute(Route *route) {
-    ListOfRoads *node;
-
-    while (route->firstRoad != NULL) {
-        node = route->firstRoad;
-        route->firstRoad = route->firstRoad->next;
-        free(node);
-    }
-
+    free(route->roads);
+    free(route->cities);
+    free(route->links);
     free(route);
 }
 
@@ -83,42 +104,148 @@ void freeListOfRoutes(ListOfRoutes *list) {
     }
 }
 
-City* findCity(Map *map, const char *name) {
-    City *city = NULL;
-    int i = 0;
-    bool found = false;
+void freeNamesBlocks(Map *map) {
+    NamesBlock *block;
 
-    while ((i < map->numberOfCities) && !found) {
-        if (strcmp(map->cities[i]->name, name) == 0) {
-            city = map->cities[i];
-            found = true;
-        }
+    while (map->namesBlock != NULL) {
+        block = map->namesBlock;
+        map->namesBlock = block->previous;
+        free(block);
+    }
+}
+
+unsigned hashCityName(const char *name, size_t *length) {
+    unsigned hash = FNV_OFFSET;
+    size_t i = 0;
+
+    while (name[i] != '\0') {
+        hash = (hash ^ (unsigned char)name[i]) * FNV_PRIME;
         i++;
     }
 
+    *length = i;
+
+    return hash;
+}
+
+City* findCity(Map *map, const char *name) {
+    City *city = NULL, *candidate;
+    size_t length;
+    unsigned hash;
+    int mask, i;
+
+    if (map->sizeOfCitiesIndex > 0) {
+        hash = hashCityName(name, &length);
+        mask = map->sizeOfCitiesIndex - 1;
+        i = hash & mask;
+        while ((map->citiesIndex[i] != EMPTY_INDEX_CELL) && (city == NULL)) {
+            candidate = map->cities[map->citiesIndex[i]];
+            if ((candidate->nameHash == hash)
+                && (candidate->nameLength == length)
+                && (memcmp(candidate->name, name, length) == 0)) {
+                city = candidate;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
     return city;
 }
 
+int enlargeSize(int size) {
+    return 1 + size * MULTIPLIER / DIVIDER;
+}
+
 /**
- * @brief Powiększa podany rozmiar.
- * @param[in] size           – liczba całkowita.
- * @return Powiększony rozmiar.
+ * @brief Powiększa tablice danych wierzchołków do podanego rozmiaru.
+ * Tablice, które udało się powiększyć, pozostają w mapie nawet wtedy, gdy
+ * nie udało się powiększyć pozostałych.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] newSize        – nowy rozmiar tablic.
+ * @return Wartość @p true, jeśli udało się powiększyć wszystkie tablice.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
  */
-static int enlargeSize(int size) {
-    return 1 + size * MULTIPLIER / DIVIDER;
+static bool enlargeVertices(Map *map, int newSize) {
+    Vertices *vertices = &(map->vertices);
+    uint64_t *distance;
+    int *oldestYear;
+    unsigned *mark, *reached;
+    bool *error;
+    bool correct = true;
+
+    distance = (uint64_t *)realloc(vertices->distance,
+                                   newSize * sizeof(uint64_t));
+    if (distance == NULL) {
+        correct = false;
+    }
+    else {
+        vertices->distance = distance;
+    }
+
+    oldestYear = (int *)realloc(vertices->oldestYear, newSize * sizeof(int));
+    if (oldestYear == NULL) {
+        correct = false;
+    }
+    else {
+        vertices->oldestYear = oldestYear;
+    }
+
+    mark = (unsigned *)realloc(vertices->mark, newSize * sizeof(unsigned));
+    if (mark == NULL) {
+        correct = false;
+    }
+    else {
+        vertices->mark = mark;
+    }
+
+    error = (bool *)realloc(vertices->error, newSize * sizeof(bool));
+    if (error == NULL) {
+        correct = false;
+    }
+    else {
+        vertices->error = error;
+    }
+
+    reached = (unsigned *)realloc(vertices->reached,
+                                  newSize * sizeof(unsigned));
+    if (reached == NULL) {
+        correct = false;
+    }
+    else {
+        vertices->reached = reached;
+    }
+
+    return correct;
+}
+
+void freeVertices(Map *map) {
+    free(map->vertices.distance);
+    free(map->vertices.oldestYear);
+    free(map->vertices.mark);
+    free(map->vertices.error);
+    free(map->vertices.reached);
 }
 
 bool enlargeCitiesArray(Map *map) {
     int newSize;
+    City **cities;
     bool correct = true;
 
     newSize = enlargeSize(map->sizeOfCitiesArray);
-    map->cities = (City **)realloc(map->cities, newSize * sizeof(City *));
+    cities = (City **)realloc(map->cities, newSize * sizeof(City *));
 
-    if (map->cities == NULL) {
+    if (cities == NULL) {
         correct = false;
     }
     else {
+        map->cities = cities;
+    }
+
+    if (correct && !enlargeVertices(map, newSize)) {
+        correct = false;
+    }
+
+    if (correct) {
         for (int i = map->numberOfCities; i < newSize; i++) {
             map->cities[i] = NULL;
         }
@@ -128,34 +255,144 @@ bool enlargeCitiesArray(Map *map) {
     return correct;
 }
 
-void setCityValues(City *city, const char *name) {
-    char *cityName = (char *)malloc(strlen(name) + 1);
+/**
+ * @brief Wstawia identyfikator miasta do tablicy mieszającej.
+ * Zakłada, że w tablicy jest wolne miejsce.
+ * @param[in,out] index      – tablica mieszająca identyfikatorów miast;
+ * @param[in] size           – rozmiar tablicy, będący potęgą dwójki;
+ * @param[in] hash           – skrót nazwy miasta;
+ * @param[in] id             – identyfikator miasta.
+ */
+static void insertIntoCitiesIndex(int *index, int size, unsigned hash, int id) {
+    int mask = size - 1;
+    int i = hash & mask;
 
-    if (cityName == NULL) {
-        city->name = NULL;
+    while (index[i] != EMPTY_INDEX_CELL) {
+        i = (i + 1) & mask;
     }
-    else {
-        strcpy(cityName, name);
-        city->name = cityName;
-        city->firstRoad = NULL;
-        city->lastRoad = NULL;
-        city->vertex = NULL;
+
+    index[i] = id;
+}
+
+bool enlargeCitiesIndex(Map *map) {
+    int newSize;
+    int *newIndex;
+    bool correct = true;
+
+    if (2 * (map->numberOfCities + 1) > map->sizeOfCitiesIndex) {
+        if (map->sizeOfCitiesIndex == 0) {
+            newSize = MIN_INDEX_SIZE;
+        }
+        else {
+            newSize = 2 * map->sizeOfCitiesIndex;
+        }
+        newIndex = (int *)malloc(newSize * sizeof(int));
+        if (newIndex == NULL) {
+            correct = false;
+        }
+        else {
+            for (int i = 0; i < newSize; i++) {
+                newIndex[i] = EMPTY_INDEX_CELL;
+            }
+            for (int i = 0; i < map->numberOfCities; i++) {
+                insertIntoCitiesIndex(newIndex, newSize,
+                                      map->cities[i]->nameHash, i);
+            }
+            free(map->citiesIndex);
+            map->citiesIndex = newIndex;
+            map->sizeOfCitiesIndex = newSize;
+        }
     }
+
+    return correct;
 }
 
-void setVertexValues(Vertex *vertex, int id) {
-    vertex->id = id;
-    vertex->distanceFromSource = INT_MAX;
-    vertex->usedInRoute = false;
-    vertex->road = NULL;
-    vertex->oldestYear = 0;
-    vertex->error = false;
+void addCityToIndex(Map *map, City *city, int id) {
+    insertIntoCitiesIndex(map->citiesIndex, map->sizeOfCitiesIndex,
+                          city->nameHash, id);
+}
+
+/**
+ * @brief Zapisuje nazwę miasta w bloku pamięci na nazwy.
+ * Jeśli w bieżącym bloku brakuje miejsca, alokuje nowy blok.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] name           – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] length         – długość nazwy miasta.
+ * @return Wskaźnik na zapisaną nazwę lub NULL, gdy nie udało się zaalokować
+ * pamięci.
+ */
+static const char* storeCityName(Map *map, const char *name, size_t length) {
+    NamesBlock *block = map->namesBlock;
+    size_t size;
+    char *stored = NULL;
+
+    if ((block == NULL) || (block->size - block->used < length + 1)) {
+        size = NAMES_BLOCK_SIZE;
+        if (length + 1 > size) {
+            size = length + 1;
+        }
+        block = (NamesBlock *)malloc(sizeof(NamesBlock) + size);
+        if (block != NULL) {
+            block->previous = map->namesBlock;
+            block->size = size;
+            block->used = 0;
+            map->namesBlock = block;
+        }
+    }
+
+    if (block != NULL) {
+        stored = block->names + block->used;
+        memcpy(stored, name, length + 1);
+        block->used += length + 1;
+    }
+
+    return stored;
+}
+
+void removeLastCity(Map *map) {
+    City *city = map->cities[map->numberOfCities - 1];
+    NamesBlock *block = map->namesBlock;
+    int mask = map->sizeOfCitiesIndex - 1;
+    int i = city->nameHash & mask;
+
+    while (map->citiesIndex[i] != city->id) {
+        i = (i + 1) & mask;
+    }
+    map->citiesIndex[i] = EMPTY_INDEX_CELL;
+
+    block->used -= city->nameLength + 1;
+    if (block->used == 0) {
+        map->namesBlock = block->previous;
+        free(block);
+    }
+
+    map->cities[city->id] = NULL;
+    map->numberOfCities -= 1;
+    freeCity(city);
+}
+
+void setCityValues(Map *map, City *city, const char *name) {
+    city->nameHash = hashCityName(name, &city->nameLength);
+    city->name = storeCityName(map, name, city->nameLength);
+    city->firstRoad = NULL;
+    city->lastRoad = NULL;
+    city->firstRoute = NULL;
+    city->lastRoute = NULL;
+    city->id = 0;
+}
+
+void setVertexValues(Map *map, int id) {
+    map->vertices.distance[id] = INFINITE_DISTANCE;
+    map->vertices.oldestYear[id] = 0;
+    map->vertices.mark[id] = 0;
+    map->vertices.error[id] = false;
+    map->vertices.reached[id] = 0;
 }
 
 void setRoadValues(Road *road, City *cityA, City *cityB,
                    unsigned length, int builtYear) {
-    road->cityA = cityA;
-    road->cityB = cityB;
+    road->cityA = cityA->id;
+    road->cityB = cityB->id;
     road->length = length;
     road->year = builtYear;
     road->toRemove = false;
@@ -218,13 +455,90 @@ bool addRoadToCity(City *city, Road *road) {
     }
 }
 
+void truncateRoads(ListOfRoads **first, ListOfRoads **last,
+                   ListOfRoads *tail) {
+    ListOfRoads *node;
+
+    if (tail == NULL) {
+        node = *first;
+        *first = NULL;
+    }
+    else {
+        node = tail->next;
+        tail->next = NULL;
+    }
+    *last = tail;
+
+    freeListOfRoads(node);
+}
+
+ListOfRoads* unlinkRoad(ListOfRoads **first, ListOfRoads **last, Road *road) {
+    ListOfRoads *node = *first, *predecessor = NULL;
+
+    while ((node != NULL) && (node->road != road)) {
+        predecessor = node;
+        node = node->next;
+    }
+
+    if (node != NULL) {
+        if (predecessor == NULL) {
+            *first = node->next;
+        }
+        else {
+            predecessor->next = node->next;
+        }
+
+        if (node == *last) {
+            *last = predecessor;
+        }
+    }
+
+    return node;
+}
+
+void relinkRoad(ListOfRoads **first, ListOfRoads **last, ListOfRoads *node) {
+    ListOfRoads *predecessor = NULL;
+
+    if (*first != node->next) {
+        predecessor = *first;
+        while (predecessor->next != node->next) {
+            predecessor = predecessor->next;
+        }
+    }
+
+    if (predecessor == NULL) {
+        *first = node;
+    }
+    else {
+        predecessor->next = node;
+    }
+
+    if (node->next == NULL) {
+        *last = node;
+    }
+}
+
+int otherCityId(Road *road, int id) {
+    if (road->cityA == id) {
+        return road->cityB;
+    }
+    else {
+        return road->cityA;
+    }
+}
+
+City* otherCity(Map *map, Road *road, City *city) {
+    return map->cities[otherCityId(road, city->id)];
+}
+
 Road* findRoad(City *cityA, City *cityB) {
     Road *road = NULL;
     ListOfRoads *node = cityA->firstRoad;
     bool found = false;
 
     while ((node != NULL) && !found) {
-        if ((node->road->cityA == cityB) || (node->road->cityB == cityB)) {
+        if ((node->road->cityA == cityB->id)
+            || (node->road->cityB == cityB->id)) {
             road = node->road;
             found = true;
         }
@@ -247,7 +561,10 @@ static ListOfRoutes* addListOfRoutesNode(Route *route) {
     node = (ListOfRoutes *)malloc(sizeof(ListOfRoutes));
     if (node != NULL) {
         node->route = route;
+        node->previous = NULL;
         node->next = NULL;
+        node->position = 0;
+        node->forward = true;
     }
 
     return node;
@@ -262,6 +579,7 @@ bool addRouteToMap(Map *map, Route *route) {
             map->lastRoute = map->firstRoute;
         }
         else {
+            node->previous = map->lastRoute;
             map->lastRoute->next = node;
             map->lastRoute = node;
         }
@@ -272,34 +590,77 @@ bool addRouteToMap(Map *map, Route *route) {
     }
 }
 
-void setRouteValues(Route *route, unsigned id, City *firstCity, City *lastCity) {
+void setRouteValues(Route *route, unsigned id) {
     route->id = id;
-    route->firstRoad = NULL;
-    route->lastRoad = NULL;
-    route->firstCity = firstCity;
-    route->lastCity = lastCity;
+    route->first = 0;
+    route->numberOfRoads = 0;
+    route->size = 0;
+    route->roads = NULL;
+    route->cities = NULL;
+    route->links = NULL;
 }
 
-bool addRoadToRoute(Route *route, Road *road) {
-    ListOfRoads *node = addListOfRoadsNode(road);
+void updateLinksPositions(Route *route, int from, int to) {
+    for (int i = from; i < to; i++) {
+        route->links[i]->position = i;
+    }
+}
 
-    if (node != NULL) {
-        if (route->firstRoad == NULL) {
-            route->firstRoad = node;
-            route->lastRoad = route->firstRoad;
+City* routeFirstCity(Route *route) {
+    return route->cities[route->first];
+}
+
+City* routeLastCity(Route *route) {
+    return route->cities[route->first + route->numberOfRoads];
+}
+
+bool reserveRouteSpace(Route *route, int left, int right) {
+    int needed = route->numberOfRoads + left + right;
+    int newSize, newFirst;
+    Road **roads;
+    City **cities;
+    ListOfRoutes **links;
+    bool correct = true;
+
+    if ((route->first < left)
+        || (route->first + route->numberOfRoads + right > route->size)) {
+        newSize = enlargeSize(needed);
+        newFirst = left + (newSize - needed) / 2;
+        roads = (Road **)malloc(newSize * sizeof(Road *));
+        cities = (City **)malloc((newSize + 1) * sizeof(City *));
+        links = (ListOfRoutes **)malloc(newSize * sizeof(ListOfRoutes *));
+        if ((roads == NULL) || (cities == NULL) || (links == NULL)) {
+            free(roads);
+            free(cities);
+            free(links);
+            correct = false;
         }
         else {
-            route->lastRoad->next = node;
-            route->lastRoad = route->lastRoad->next;
+            if (route->cities != NULL) {
+                memcpy(roads + newFirst, route->roads + route->first,
+                       route->numberOfRoads * sizeof(Road *));
+                memcpy(cities + newFirst, route->cities + route->first,
+                       (route->numberOfRoads + 1) * sizeof(City *));
+                memcpy(links + newFirst, route->links + route->first,
+                       route->numberOfRoads * sizeof(ListOfRoutes *));
+            }
+            free(route->roads);
+            free(route->cities);
+            free(route->links);
+            route->roads = roads;
+            route->cities = cities;
+            route->links = links;
+            route->first = newFirst;
+            route->size = newSize;
+            updateLinksPositions(route, route->first,
+                                 route->first + route->numberOfRoads);
         }
-        return true;
-    }
-    else {
-        return false;
     }
+
+    return correct;
 }
 
-bool addRouteToRoad(Road *road, Route *route) {
+ListOfRoutes* addRouteToRoad(Road *road, Route *route) {
     ListOfRoutes *node = addListOfRoutesNode(route);
 
     if (node != NULL) {
@@ -308,16 +669,54 @@ bool addRouteToRoad(Road *road, Route *route) {
             road->lastRoute = road->firstRoute;
         }
         else {
+            node->previous = road->lastRoute;
             road->lastRoute->next = node;
             road->lastRoute = node;
         }
-        return true;
+    }
+
+    return node;
+}
+
+void unlinkRouteNode(ListOfRoutes **first, ListOfRoutes **last,
+                     ListOfRoutes *node) {
+    if (node->previous == NULL) {
+        *first = node->next;
     }
     else {
-        return false;
+        node->previous->next = node->next;
+    }
+
+    if (node->next == NULL) {
+        *last = node->previous;
+    }
+    else {
+        node->next->previous = node->previous;
     }
 }
 
+void relinkRouteNode(ListOfRoutes **first, ListOfRoutes **last,
+                     ListOfRoutes *node) {
+    if (node->previous == NULL) {
+        *first = node;
+    }
+    else {
+        node->previous->next = node;
+    }
+
+    if (node->next == NULL) {
+        *last = node;
+    }
+    else {
+        node->next->previous = node;
+    }
+}
+
+void removeRouteFromRoad(Road *road, ListOfRoutes *node) {
+    unlinkRouteNode(&road->firstRoute, &road->lastRoute, node);
+    free(node);
+}
+
 Route* findRoute(Map *map, unsigned id) {
     Route *route = NULL;
     ListOfRoutes *node = map->firstRoute;
@@ -334,30 +733,97 @@ Route* findRoute(Map *map, unsigned id) {
     return route;
 }
 
-bool isCityInRoute(Route *route, City *city) {
-    ListOfRoads *node;
-    Road *road;
-    bool found = false;
+bool addRouteToCity(City *city, Route *route) {
+    ListOfRoutes *node = addListOfRoutesNode(route);
 
-    node = route->firstRoad;
-    while ((node != NULL) && !found) {
-        road = node->road;
-        if ((road->cityA == city) || (road->cityB == city)) {
-            found = true;
+    if (node != NULL) {
+        if (city->firstRoute == NULL) {
+            city->firstRoute = node;
+            city->lastRoute = city->firstRoute;
         }
+        else {
+            node->previous = city->lastRoute;
+            city->lastRoute->next = node;
+            city->lastRoute = node;
+        }
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Szuka drogi krajowej na liście dróg krajowych miasta.
+ * @param[in] city           – wskaźnik na strukturę miasta;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ * @return Wskaźnik na węzeł listy zawierający drogę krajową lub NULL, jeśli
+ * droga krajowa nie przechodzi przez miasto.
+ */
+static ListOfRoutes* findRouteInCity(City *city, Route *route) {
+    ListOfRoutes *node = city->firstRoute;
+
+    while ((node != NULL) && (node->route != route)) {
         node = node->next;
     }
 
-    return found;
+    return node;
 }
 
-void markVerticies(Route *route, bool value) {
-    ListOfRoads *node;
+ListOfRoutes* unlinkRouteFromCity(City *city, Route *route) {
+    ListOfRoutes *node = findRouteInCity(city, route);
 
-    node = route->firstRoad;
-    while (node != NULL) {
-        node->road->cityA->vertex->usedInRoute = value;
-        node->road->cityB->vertex->usedInRoute = value;
-        node = node->next;
+    if (node != NULL) {
+        unlinkRouteNode(&city->firstRoute, &city->lastRoute, node);
+    }
+
+    return node;
+}
+
+void removeRouteFromCity(City *city, Route *route) {
+    free(unlinkRouteFromCity(city, route));
+}
+
+bool isCityInRoute(Route *route, City *city) {
+    if (findRouteInCity(city, route) != NULL) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+unsigned newMark(Map *map) {
+    map->mark++;
+
+    if (map->mark == 0) {
+        for (int i = 0; i < map->numberOfCities; i++) {
+            map->vertices.mark[i] = 0;
+        }
+        map->mark = 1;
+    }
+
+    return map->mark;
+}
+
+void markVerticies(Map *map, Route *route) {
+    int last = route->first + route->numberOfRoads;
+    unsigned mark = newMark(map);
+
+    for (int i = route->first; i <= last; i++) {
+        map->vertices.mark[route->cities[i]->id] = mark;
+    }
+}
+
+void markVertex(Map *map, int id) {
+    map->vertices.mark[id] = map->mark;
+}
+
+bool isVertexMarked(Map *map, int id) {
+    if (map->vertices.mark[id] == map->mark) {
+        return true;
+    }
+    else {
+        return false;
     }
 }
@@ -23,6 +23,12 @@ void setMapValues(Map *map);
  */
 void freeCity(City *city);
 
+/**
+ * @brief Zwalnia pamięć zaalokowaną na listę odcinków dróg, bez odcinków dróg.
+ * @param[in] list           – lista odcinków dróg.
+ */
+void freeListOfRoads(ListOfRoads *list);
+
 /**
  * @brief Zwalnia pamięć zaalokowaną na daną listę dróg oraz drogi.
  * @param[in] list           – lista odcinków dróg.
@@ -48,6 +54,21 @@ void freeRoutes(ListOfRoutes *list);
  */
 void freeListOfRoutes(ListOfRoutes *list);
 
+/**
+ * @brief Zwalnia pamięć zaalokowaną na bloki z nazwami miast.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void freeNamesBlocks(Map *map);
+
+/**
+ * @brief Oblicza skrót i długość nazwy miasta w jednym przejściu po napisie.
+ * @param[in] name           – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[out] length        – wskaźnik na zmienną, do której zostanie
+ *                             zapisana długość nazwy.
+ * @return Skrót nazwy miasta.
+ */
+unsigned hashCityName(const char *name, size_t *length);
+
 /**
  * @brief Szuka w mapie miasta o podanej nazwie.
  * @param[in] map            – wskaźnik na strukturę mapy;
@@ -57,6 +78,13 @@ void freeListOfRoutes(ListOfRoutes *list);
  */
 City* findCity(Map *map, const char *name);
 
+/**
+ * @brief Powiększa podany rozmiar.
+ * @param[in] size           – liczba całkowita.
+ * @return Powiększony rozmiar.
+ */
+int enlargeSize(int size);
+
 /**
  * @brief Zwiększa rozmiar tablicy wskaźników na miasta w mapie.
  * @param[in,out] map        – wskaźnik na strukturę mapy.
@@ -65,22 +93,61 @@ City* findCity(Map *map, const char *name);
  */
 bool enlargeCitiesArray(Map *map);
 
+/**
+ * @brief Powiększa tablicę mieszającą miast, jeśli dodanie kolejnego miasta
+ * zapełniłoby ją w więcej niż połowie.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli w tablicy jest miejsce na kolejne miasto.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool enlargeCitiesIndex(Map *map);
+
+/**
+ * @brief Dodaje miasto do tablicy mieszającej miast.
+ * Zakłada, że w tablicy jest miejsce na kolejne miasto.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] city           – wskaźnik na strukturę miasta;
+ * @param[in] id             – identyfikator miasta.
+ */
+void addCityToIndex(Map *map, City *city, int id);
+
+/**
+ * @brief Usuwa z mapy ostatnio dodane miasto.
+ * Zakłada, że miasto nie ma odcinków dróg ani dróg krajowych, a wszystkie
+ * miasta dodane po nim zostały już usunięte. Wtedy żadne miasto obecne
+ * w tablicy mieszającej nie było w niej wstawiane po nim, więc wystarczy
+ * opróżnić jego komórkę, a jego nazwa jest ostatnią zapisaną w bloku pamięci
+ * na nazwy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void removeLastCity(Map *map);
+
 /**
  * @brief Ustawia podstawowe wartości miasta.
+ * Zapisuje nazwę miasta w bloku pamięci na nazwy wraz z jej długością
+ * i skrótem.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in,out] city       – wskaźnik na strukturę miasta;
  * @param[in] name           – wskaźnik na napis reprezentujący nazwę miasta.
  */
-void setCityValues(City *city, const char *name);
+void setCityValues(Map *map, City *city, const char *name);
 
 /**
  * @brief Ustawia podstawowe wartości wierzchołka.
- * @param[in,out] vertex     – wskaźnik na strukturę wierzchołka;
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
  * @param[in] id             – identyfikator wierzchołka/miasta.
  */
-void setVertexValues(Vertex *vertex, int id);
+void setVertexValues(Map *map, int id);
+
+/**
+ * @brief Zwalnia tablice danych wierzchołków.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void freeVertices(Map *map);
 
 /**
  * @brief Ustawia podstawowe wartości odcinka drogi.
+ * Zapisuje w odcinku drogi identyfikatory łączonych miast.
  * @param[in,out] road       – wskaźnik na strukturę odcinka drogi;
  * @param[in] cityA          – wskaźnik na strukturę miasta;
  * @param[in] cityB          – wskaźnik na strukturę miasta;
@@ -108,6 +175,58 @@ bool addRoadToMap(Map *map, Road *road);
  */
 bool addRoadToCity(City *city, Road *road);
 
+/**
+ * @brief Usuwa z końca listy odcinków dróg węzły dodane po podanym węźle.
+ * @param[in,out] first      – wskaźnik na wskaźnik na pierwszy węzeł listy;
+ * @param[in,out] last       – wskaźnik na wskaźnik na ostatni węzeł listy;
+ * @param[in] tail           – wskaźnik na węzeł, który ma zostać ostatnim
+ *                             węzłem listy, lub NULL, gdy lista ma zostać
+ *                             pusta.
+ */
+void truncateRoads(ListOfRoads **first, ListOfRoads **last,
+                   ListOfRoads *tail);
+
+/**
+ * @brief Odłącza od listy odcinków dróg węzeł z podanym odcinkiem drogi.
+ * Nie zwalnia węzła i nie zmienia zapisanego w nim wskaźnika na następny
+ * węzeł, więc węzeł można później przywrócić na to samo miejsce funkcją
+ * @ref relinkRoad.
+ * @param[in,out] first      – wskaźnik na wskaźnik na pierwszy węzeł listy;
+ * @param[in,out] last       – wskaźnik na wskaźnik na ostatni węzeł listy;
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi.
+ * @return Wskaźnik na odłączony węzeł lub NULL, gdy odcinka drogi nie ma na
+ * liście.
+ */
+ListOfRoads* unlinkRoad(ListOfRoads **first, ListOfRoads **last, Road *road);
+
+/**
+ * @brief Przywraca węzeł odłączony funkcją @ref unlinkRoad.
+ * Zakłada, że lista jest taka sama jak zaraz po odłączeniu węzła. Wstawia
+ * węzeł przed węzłem, który był jego następnikiem.
+ * @param[in,out] first      – wskaźnik na wskaźnik na pierwszy węzeł listy;
+ * @param[in,out] last       – wskaźnik na wskaźnik na ostatni węzeł listy;
+ * @param[in] node           – wskaźnik na przywracany węzeł.
+ */
+void relinkRoad(ListOfRoads **first, ListOfRoads **last, ListOfRoads *node);
+
+/**
+ * @brief Daje w wyniku identyfikator drugiego końca odcinka drogi.
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] id             – identyfikator jednego z miast, które łączy
+ *                             odcinek.
+ * @return Identyfikator miasta na drugim końcu odcinka drogi.
+ */
+int otherCityId(Road *road, int id);
+
+/**
+ * @brief Daje w wyniku drugi koniec odcinka drogi.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] city           – wskaźnik na jedno z miast, które łączy odcinek.
+ * @return Wskaźnik na miasto na drugim końcu odcinka drogi.
+ */
+City* otherCity(Map *map, Road *road, City *city);
+
 /**
  * @brief Szuka drogi pomiędzy dwoma podanymi miastami.
  * @param[in] cityA          – wskaźnik na strukturę miasta;
@@ -136,30 +255,84 @@ bool enlargeRoutesArray(Map *map);
 
 /**
  * @brief Ustawia podstawowe wartości drogi krajowej.
+ * Tworzy pustą drogę krajową, bez zaalokowanych tablic.
  * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
- * @param[in] id             – identyfikator drogi krajowej;
- * @param[in] firstCity      – wskaźnik na strukturę miasta;
- * @param[in] lastCity       – wskaźnik na strukturę miasta.
+ * @param[in] id             – identyfikator drogi krajowej.
  */
-void setRouteValues(Route *route, unsigned id, City *firstCity, City *lastCity);
+void setRouteValues(Route *route, unsigned id);
 
 /**
- * @brief Dodaje odcinek drogi do drogi krajowej.
+ * @brief Aktualizuje pozycje zapisane w węzłach list dróg krajowych odcinków
+ * dróg po przesunięciu elementów tablic drogi krajowej.
  * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
- * @param[in] road           – wskaźnik na strukturę odcinka drogi.
- * @return Wartość @p true, jeśli udało się dodać odcinek do drogi krajowej.
+ * @param[in] from           – pierwsza aktualizowana pozycja;
+ * @param[in] to             – pozycja za ostatnią aktualizowaną pozycją.
+ */
+void updateLinksPositions(Route *route, int from, int to);
+
+/**
+ * @brief Daje w wyniku pierwsze miasto drogi krajowej.
+ * @param[in] route          – wskaźnik na strukturę niepustej drogi krajowej.
+ * @return Wskaźnik na pierwsze miasto drogi krajowej.
+ */
+City* routeFirstCity(Route *route);
+
+/**
+ * @brief Daje w wyniku ostatnie miasto drogi krajowej.
+ * @param[in] route          – wskaźnik na strukturę niepustej drogi krajowej.
+ * @return Wskaźnik na ostatnie miasto drogi krajowej.
+ */
+City* routeLastCity(Route *route);
+
+/**
+ * @brief Zapewnia wolne miejsce w tablicach drogi krajowej.
+ * Jeśli przed pierwszym odcinkiem lub za ostatnim odcinkiem drogi brakuje
+ * wolnego miejsca, alokuje większe tablice i umieszcza przebieg drogi tak,
+ * aby wolne miejsce rozłożyło się po obu jego stronach.
+ * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
+ * @param[in] left           – liczba wolnych miejsc przed pierwszym odcinkiem;
+ * @param[in] right          – liczba wolnych miejsc za ostatnim odcinkiem.
+ * @return Wartość @p true, jeśli w tablicach jest potrzebne miejsce.
  * Wartość @p false, gdy nie udało się zaalokować pamięci.
  */
-bool addRoadToRoute(Route *route, Road *road);
+bool reserveRouteSpace(Route *route, int left, int right);
 
 /**
  * @brief Dodaje drogę krajową do odcinka drogi.
  * @param[in,out] road       – wskaźnik na strukturę odcinka drogi;
  * @param[in] route          – wskaźnik na strukturę drogi krajowej.
- * @return Wartość @p true, jeśli udało się dodać drogę krajową do odcinka.
- * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ * @return Wskaźnik na utworzony węzeł listy dróg krajowych odcinka drogi lub
+ * NULL, gdy nie udało się zaalokować pamięci.
  */
-bool addRouteToRoad(Road *road, Route *route);
+ListOfRoutes* addRouteToRoad(Road *road, Route *route);
+
+/**
+ * @brief Odłącza węzeł od listy dróg krajowych.
+ * Nie zwalnia węzła i nie zmienia zapisanych w nim wskaźników na sąsiednie
+ * węzły, więc węzeł można później przywrócić funkcją @ref relinkRouteNode.
+ * @param[in,out] first      – wskaźnik na wskaźnik na pierwszy węzeł listy;
+ * @param[in,out] last       – wskaźnik na wskaźnik na ostatni węzeł listy;
+ * @param[in] node           – wskaźnik na odłączany węzeł.
+ */
+void unlinkRouteNode(ListOfRoutes **first, ListOfRoutes **last,
+                     ListOfRoutes *node);
+
+/**
+ * @brief Przywraca węzeł odłączony funkcją @ref unlinkRouteNode.
+ * Zakłada, że lista jest taka sama jak zaraz po odłączeniu węzła.
+ * @param[in,out] first      – wskaźnik na wskaźnik na pierwszy węzeł listy;
+ * @param[in,out] last       – wskaźnik na wskaźnik na ostatni węzeł listy;
+ * @param[in] node           – wskaźnik na przywracany węzeł.
+ */
+void relinkRouteNode(ListOfRoutes **first, ListOfRoutes **last,
+                     ListOfRoutes *node);
+
+/**
+ * @brief Usuwa węzeł z listy dróg krajowych odcinka drogi.
+ * @param[in,out] road       – wskaźnik na strukturę odcinka drogi;
+ * @param[in] node           – wskaźnik na usuwany węzeł listy.
+ */
+void removeRouteFromRoad(Road *road, ListOfRoutes *node);
 
 /**
  * @brief Szuka w mapie drogi krajowej o podanym numerze.
@@ -170,8 +343,39 @@ bool addRouteToRoad(Road *road, Route *route);
  */
 Route* findRoute(Map *map, unsigned id);
 
+/**
+ * @brief Dodaje drogę krajową do listy dróg krajowych przechodzących przez
+ * miasto.
+ * @param[in,out] city       – wskaźnik na strukturę miasta;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ * @return Wartość @p true, jeśli udało się dodać drogę krajową do miasta.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool addRouteToCity(City *city, Route *route);
+
+/**
+ * @brief Odłącza drogę krajową od listy dróg krajowych przechodzących przez
+ * miasto, nie zwalniając węzła listy.
+ * @param[in,out] city       – wskaźnik na strukturę miasta;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ * @return Wskaźnik na odłączony węzeł lub NULL, jeśli droga krajowa nie
+ * przechodzi przez miasto.
+ */
+ListOfRoutes* unlinkRouteFromCity(City *city, Route *route);
+
+/**
+ * @brief Usuwa drogę krajową z listy dróg krajowych przechodzących przez
+ * miasto.
+ * Nic nie robi, jeśli droga krajowa nie przechodzi przez miasto.
+ * @param[in,out] city       – wskaźnik na strukturę miasta;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ */
+void removeRouteFromCity(City *city, Route *route);
+
 /**
  * @brief Sprawdza, czy podane miasto znajduje się w danej drodze krajowej.
+ * Przegląda listę dróg krajowych przechodzących przez miasto, więc czas
+ * działania nie zależy od długości drogi krajowej.
  * @param[in] route          – wskaźnik na strukturę drogi krajowej;
  * @param[in] city           – wskaźnik na strukturę miasta.
  * @return Wartość @p true, jeśli dana droga przechodzi przez dane miasto.
@@ -180,10 +384,37 @@ Route* findRoute(Map *map, unsigned id);
 bool isCityInRoute(Route *route, City *city);
 
 /**
- * @brief Przypisuje wszystkim wierzchołkom w danej drodze podaną wartość.
- * @param[in,out] route      – wskaźnik na strukturę drogi krajowej;
- * @param[in] value          – przypisywana wartość.
+ * @brief Zmienia znacznik mapy, przez co żaden wierzchołek nie jest oznaczony.
+ * Wierzchołki oznaczone wcześniejszym znacznikiem przestają być oznaczone bez
+ * przechodzenia po nich. Dopiero gdy licznik znaczników się przepełni, zeruje
+ * znaczniki wszystkich wierzchołków.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Nowy znacznik mapy.
+ */
+unsigned newMark(Map *map);
+
+/**
+ * @brief Oznacza wszystkie wierzchołki w danej drodze krajowej.
+ * Oznaczenia wcześniej oznaczonych wierzchołków przestają obowiązywać.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ */
+void markVerticies(Map *map, Route *route);
+
+/**
+ * @brief Oznacza wierzchołek bieżącym znacznikiem mapy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] id             – identyfikator wierzchołka/miasta.
+ */
+void markVertex(Map *map, int id);
+
+/**
+ * @brief Sprawdza, czy wierzchołek jest oznaczony.
+ * @param[in] map            – wskaźnik na strukturę mapy;
+ * @param[in] id             – identyfikator wierzchołka/miasta.
+ * @return Wartość @p true, jeśli wierzchołek jest oznaczony.
+ * Wartość @p false, w przeciwnym przypadku.
  */
-void markVerticies(Route *route, bool value);
+bool isVertexMarked(Map *map, int id);
 
 #endif /* __STRUCTURES_FUNCTIONS_H__ */
\ No newline at end of file
@@ -0,0 +1,519 @@
+/** @file
+ * Plik zawierający funkcje dziennika zmian mapy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#include "undo-log.h"
+#include "help-functions.h"
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Rodzaj zmiany mapy.
+ */
+typedef enum ChangeKind ChangeKind;
+
+/**
+ * @brief Rodzaj zmiany mapy.
+ */
+enum ChangeKind {
+    ADDED_CITIES,   ///< dodanie ostatnich miast mapy
+    ADDED_ROAD,     ///< dodanie odcinka drogi
+    REPAIRED_ROAD,  ///< zmiana roku odcinka drogi
+    REMOVED_ROAD,   ///< usunięcie odcinka drogi
+    ADDED_ROUTE,    ///< dodanie drogi krajowej
+    EXTENDED_ROUTE, ///< wydłużenie drogi krajowej
+    DETOURED_ROUTE, ///< zastąpienie odcinka drogi krajowej objazdem
+    REMOVED_ROUTE,  ///< usunięcie drogi krajowej
+    CHANGED_LIMITS  ///< zmiana ograniczeń objazdów
+};
+
+/**
+ * @brief Struktura przechowująca zmianę mapy zapisaną w dzienniku zmian.
+ * Znaczenie pól zależy od rodzaju zmiany:
+ * dla dodanych miast @p number to ich liczba;
+ * dla dodanego odcinka drogi @p roadNodes to ostatnie węzły list odcinków
+ * dróg sprzed jego dodania, a dla usuniętego – jego odłączone węzły;
+ * dla zmiany roku odcinka drogi @p number to poprzedni rok;
+ * dla wydłużenia drogi krajowej @p number i @p shift to liczby odcinków dróg
+ * dodanych przed pierwszym i za ostatnim miastem;
+ * dla objazdu @p number to pozycja zastąpionego odcinka drogi względem
+ * początku drogi krajowej, @p shift to liczba odcinków dróg objazdu
+ * pomniejszona o 1, a @p road i @p routeNode to zastąpiony odcinek drogi i jego
+ * węzeł listy dróg krajowych;
+ * dla usuniętej drogi krajowej @p routeNode to jej węzeł listy dróg krajowych
+ * mapy, a @p cityNodes to tablica jej węzłów list dróg krajowych miast;
+ * dla zmiany ograniczeń objazdów @p length i @p number to poprzednie
+ * ograniczenia.
+ */
+struct Change {
+    ChangeKind kind;                     ///< rodzaj zmiany
+    int number;                          ///< liczba opisująca zmianę
+    int shift;                           ///< liczba dodanych odcinków dróg
+    uint64_t length;                     ///< poprzednia długość objazdu
+    Road *road;                          ///< wskaźnik na odcinek drogi
+    Route *route;                        ///< wskaźnik na drogę krajową
+    ListOfRoutes *routeNode;             ///< wskaźnik na węzeł listy
+    ListOfRoutes **cityNodes;            ///< tablica węzłów list miast
+    ListOfRoads *roadNodes[ROAD_LISTS];  ///< węzły list odcinków dróg
+};
+
+bool reserveChange(Map *map) {
+    UndoLog *log = &map->undoLog;
+    Change *changes;
+    int newSize;
+    bool correct = true;
+
+    if (log->numberOfChanges == log->size) {
+        newSize = enlargeSize(log->size);
+        changes = (Change *)realloc(log->changes, newSize * sizeof(Change));
+        if (changes == NULL) {
+            correct = false;
+        }
+        else {
+            log->changes = changes;
+            log->size = newSize;
+        }
+    }
+
+    return correct;
+}
+
+int startChanges(Map *map) {
+    int savepoint = 0;
+
+    if (map != NULL) {
+        savepoint = map->undoLog.numberOfChanges;
+        map->undoLog.savepoint = savepoint;
+    }
+
+    return savepoint;
+}
+
+void finishChanges(Map *map, int savepoint, bool correct) {
+    if (map != NULL) {
+        if (!correct) {
+            undoChanges(map, savepoint);
+            failBatch(map);
+        }
+
+        if (!map->undoLog.batch) {
+            commitChanges(map);
+        }
+    }
+}
+
+/**
+ * @brief Cofa dodanie odcinka drogi.
+ * Odcinek drogi jest na końcu list, na które został dodany, więc wystarczy
+ * obciąć je do zapisanych ostatnich węzłów. Działa też wtedy, gdy odcinka
+ * drogi nie udało się dodać do wszystkich list.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoAddedRoad(Map *map, Change *change) {
+    Road *road = change->road;
+    City *cityA = map->cities[road->cityA];
+    City *cityB = map->cities[road->cityB];
+
+    truncateRoads(&cityB->firstRoad, &cityB->lastRoad,
+                  change->roadNodes[CITY_B_ROADS]);
+    truncateRoads(&cityA->firstRoad, &cityA->lastRoad,
+                  change->roadNodes[CITY_A_ROADS]);
+    truncateRoads(&map->firstRoad, &map->lastRoad,
+                  change->roadNodes[MAP_ROADS]);
+    free(road);
+}
+
+/**
+ * @brief Cofa usunięcie odcinka drogi.
+ * Przywraca odłączone węzły na ich miejsca na listach odcinków dróg.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoRemovedRoad(Map *map, Change *change) {
+    Road *road = change->road;
+    City *cityA = map->cities[road->cityA];
+    City *cityB = map->cities[road->cityB];
+
+    relinkRoad(&cityB->firstRoad, &cityB->lastRoad,
+               change->roadNodes[CITY_B_ROADS]);
+    relinkRoad(&cityA->firstRoad, &cityA->lastRoad,
+               change->roadNodes[CITY_A_ROADS]);
+    relinkRoad(&map->firstRoad, &map->lastRoad, change->roadNodes[MAP_ROADS]);
+    road->toRemove = false;
+}
+
+/**
+ * @brief Cofa dodanie drogi krajowej.
+ * Droga krajowa jest ostatnią drogą krajową na liście mapy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoAddedRoute(Map *map, Change *change) {
+    ListOfRoutes *node = map->lastRoute;
+
+    unlinkRouteNode(&map->firstRoute, &map->lastRoute, node);
+    free(node);
+    removeRouteFromRoads(change->route);
+    freeRoute(change->route);
+}
+
+/**
+ * @brief Cofa wydłużenie drogi krajowej.
+ * Usuwa drogę krajową z dodanych odcinków dróg i miast, a następnie skraca
+ * zajęty fragment jej tablic.
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoExtendedRoute(Change *change) {
+    Route *route = change->route;
+    int front = change->number, back = change->shift;
+    int end;
+
+    if (front > 0) {
+        detachRoutePart(route, route->first, route->first + front,
+                        route->first, route->first + front);
+        route->first += front;
+        route->numberOfRoads -= front;
+    }
+
+    if (back > 0) {
+        end = route->first + route->numberOfRoads;
+        detachRoutePart(route, end - back, end, end - back + 1, end + 1);
+        route->numberOfRoads -= back;
+    }
+}
+
+/**
+ * @brief Cofa zastąpienie odcinka drogi krajowej objazdem.
+ * Usuwa drogę krajową z odcinków dróg i miast objazdu, przesuwa z powrotem
+ * część drogi krajowej przesuniętą przy tworzeniu objazdu i przywraca
+ * zastąpiony odcinek drogi wraz z jego węzłem listy dróg krajowych.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoDetouredRoute(Map *map, Change *change) {
+    Route *route = change->route;
+    ListOfRoutes *link = change->routeNode;
+    int before = change->number, shift = change->shift;
+    int after = route->numberOfRoads - shift - before - 1;
+    int position = route->first + before;
+    City *start;
+
+    if (link->forward) {
+        start = map->cities[change->road->cityA];
+    }
+    else {
+        start = map->cities[change->road->cityB];
+    }
+
+    detachRoutePart(route, position, position + shift + 1, position + 1,
+                    position + shift + 1);
+
+    if (before < after) {
+        memmove(route->roads + route->first + shift,
+                route->roads + route->first, before * sizeof(Road *));
+        memmove(route->cities + route->first + shift,
+                route->cities + route->first, before * sizeof(City *));
+        memmove(route->links + route->first + shift,
+                route->links + route->first, before * sizeof(ListOfRoutes *));
+        route->first += shift;
+        position += shift;
+        updateLinksPositions(route, route->first, position);
+    }
+    else {
+        memmove(route->roads + position + 1,
+                route->roads + position + 1 + shift, after * sizeof(Road *));
+        memmove(route->cities + position + 1,
+                route->cities + position + 1 + shift,
+                (after + 1) * sizeof(City *));
+        memmove(route->links + position + 1,
+                route->links + position + 1 + shift,
+                after * sizeof(ListOfRoutes *));
+        updateLinksPositions(route, position + 1, position + 1 + after);
+    }
+
+    route->numberOfRoads -= shift;
+    route->roads[position] = change->road;
+    route->cities[position] = start;
+    route->links[position] = link;
+    link->position = position;
+}
+
+/**
+ * @brief Cofa usunięcie drogi krajowej.
+ * Przywraca odłączone węzły list dróg krajowych w kolejności odwrotnej do
+ * ich odłączania i zwalnia tablicę węzłów list miast.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoRemovedRoute(Map *map, Change *change) {
+    Route *route = change->route;
+    int last = route->first + route->numberOfRoads;
+    City *city;
+    Road *road;
+
+    relinkRouteNode(&map->firstRoute, &map->lastRoute, change->routeNode);
+
+    for (int i = last; i >= route->first; i--) {
+        city = route->cities[i];
+        relinkRouteNode(&city->firstRoute, &city->lastRoute,
+                        change->cityNodes[i - route->first]);
+        if (i < last) {
+            road = route->roads[i];
+            relinkRouteNode(&road->firstRoute, &road->lastRoute,
+                            route->links[i]);
+        }
+    }
+
+    free(change->cityNodes);
+}
+
+/**
+ * @brief Cofa zmianę mapy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void undoChange(Map *map, Change *change) {
+    if (change->kind == ADDED_CITIES) {
+        for (int i = 0; i < change->number; i++) {
+            removeLastCity(map);
+        }
+    }
+    else if (change->kind == ADDED_ROAD) {
+        undoAddedRoad(map, change);
+    }
+    else if (change->kind == REPAIRED_ROAD) {
+        change->road->year = change->number;
+    }
+    else if (change->kind == REMOVED_ROAD) {
+        undoRemovedRoad(map, change);
+    }
+    else if (change->kind == ADDED_ROUTE) {
+        undoAddedRoute(map, change);
+    }
+    else if (change->kind == EXTENDED_ROUTE) {
+        undoExtendedRoute(change);
+    }
+    else if (change->kind == DETOURED_ROUTE) {
+        undoDetouredRoute(map, change);
+    }
+    else if (change->kind == REMOVED_ROUTE) {
+        undoRemovedRoute(map, change);
+    }
+    else {
+        map->maxDetourLength = change->length;
+        map->maxDetourCities = change->number;
+    }
+}
+
+void undoChanges(Map *map, int savepoint) {
+    UndoLog *log = &map->undoLog;
+
+    while (log->numberOfChanges > savepoint) {
+        log->numberOfChanges--;
+        undoChange(map, &log->changes[log->numberOfChanges]);
+    }
+
+    if (log->savepoint > savepoint) {
+        log->savepoint = savepoint;
+    }
+}
+
+/**
+ * @brief Zwalnia pamięć usuniętej drogi krajowej i jej węzłów.
+ * @param[in] change         – wskaźnik na zmianę.
+ */
+static void freeRemovedRoute(Change *change) {
+    Route *route = change->route;
+    int last = route->first + route->numberOfRoads;
+
+    for (int i = route->first; i < last; i++) {
+        free(route->links[i]);
+    }
+    for (int i = 0; i <= route->numberOfRoads; i++) {
+        free(change->cityNodes[i]);
+    }
+
+    free(change->cityNodes);
+    free(change->routeNode);
+    freeRoute(route);
+}
+
+/**
+ * @brief Zaznacza drogi krajowe zmienione przez zmiany zapisane w dzienniku.
+ * Drogą krajową zmienioną przez zmianę roku odcinka drogi jest każda droga
+ * krajowa przechodząca przez ten odcinek. Zmiany są przeglądane w kolejności
+ * ich wprowadzenia, więc dla każdego numeru zapisana zostaje droga krajowa
+ * istniejąca po wszystkich zmianach.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+static void findChangedRoutes(Map *map) {
+    UndoLog *log = &map->undoLog;
+    Change *change;
+    ListOfRoutes *node;
+
+    for (int i = 0; i < log->numberOfChanges; i++) {
+        change = &log->changes[i];
+        if (change->kind == REPAIRED_ROAD) {
+            node = change->road->firstRoute;
+            while (node != NULL) {
+                markChangedRoute(map, node->route->id, node->route);
+                node = node->next;
+            }
+        }
+        else if (change->kind == REMOVED_ROUTE) {
+            markChangedRoute(map, change->route->id, NULL);
+        }
+        else if ((change->kind == ADDED_ROUTE)
+                 || (change->kind == EXTENDED_ROUTE)
+                 || (change->kind == DETOURED_ROUTE)) {
+            markChangedRoute(map, change->route->id, change->route);
+        }
+    }
+}
+
+void commitChanges(Map *map) {
+    UndoLog *log = &map->undoLog;
+    Change *change;
+
+    if (map->versions != NULL) {
+        findChangedRoutes(map);
+        publishVersion(map);
+    }
+
+    for (int i = 0; i < log->numberOfChanges; i++) {
+        change = &log->changes[i];
+        if (change->kind == REMOVED_ROAD) {
+            for (int j = 0; j < ROAD_LISTS; j++) {
+                free(change->roadNodes[j]);
+            }
+            freeListOfRoutes(change->road->firstRoute);
+            free(change->road);
+        }
+        else if (change->kind == REMOVED_ROUTE) {
+            freeRemovedRoute(change);
+        }
+    }
+
+    log->numberOfChanges = 0;
+    log->savepoint = 0;
+}
+
+void failBatch(Map *map) {
+    if ((map != NULL) && map->undoLog.batch) {
+        map->undoLog.failed = true;
+    }
+}
+
+void freeUndoLog(Map *map) {
+    undoChanges(map, 0);
+    free(map->undoLog.changes);
+    map->undoLog.changes = NULL;
+    map->undoLog.size = 0;
+}
+
+/**
+ * @brief Zapisuje w dzienniku nową zmianę podanego rodzaju.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] kind           – rodzaj zmiany.
+ * @return Wskaźnik na zapisaną zmianę.
+ */
+static Change* newChange(Map *map, ChangeKind kind) {
+    UndoLog *log = &map->undoLog;
+    Change *change = &log->changes[log->numberOfChanges];
+
+    log->numberOfChanges++;
+    change->kind = kind;
+
+    return change;
+}
+
+void logAddedCity(Map *map) {
+    UndoLog *log = &map->undoLog;
+    Change *change = NULL;
+
+    if (log->numberOfChanges > log->savepoint) {
+        change = &log->changes[log->numberOfChanges - 1];
+        if (change->kind != ADDED_CITIES) {
+            change = NULL;
+        }
+    }
+
+    if (change == NULL) {
+        change = newChange(map, ADDED_CITIES);
+        change->number = 0;
+    }
+    change->number++;
+}
+
+void logAddedRoad(Map *map, Road *road, ListOfRoads *tails[]) {
+    Change *change = newChange(map, ADDED_ROAD);
+
+    change->road = road;
+    for (int i = 0; i < ROAD_LISTS; i++) {
+        change->roadNodes[i] = tails[i];
+    }
+}
+
+void logRepairedRoad(Map *map, Road *road, int year) {
+    Change *change = newChange(map, REPAIRED_ROAD);
+
+    change->road = road;
+    change->number = year;
+}
+
+void logRemovedRoad(Map *map, Road *road, ListOfRoads *nodes[]) {
+    Change *change = newChange(map, REMOVED_ROAD);
+
+    change->road = road;
+    for (int i = 0; i < ROAD_LISTS; i++) {
+        change->roadNodes[i] = nodes[i];
+    }
+}
+
+void logAddedRoute(Map *map, Route *route) {
+    Change *change = newChange(map, ADDED_ROUTE);
+
+    change->route = route;
+}
+
+void logExtendedRoute(Map *map, Route *route, int front, int back) {
+    Change *change = newChange(map, EXTENDED_ROUTE);
+
+    change->route = route;
+    change->number = front;
+    change->shift = back;
+}
+
+void logDetouredRoute(Map *map, Route *route, int position, int shift,
+                      Road *road, ListOfRoutes *link) {
+    Change *change = newChange(map, DETOURED_ROUTE);
+
+    change->route = route;
+    change->number = position;
+    change->shift = shift;
+    change->road = road;
+    change->routeNode = link;
+}
+
+void logRemovedRoute(Map *map, Route *route, ListOfRoutes *node,
+                     ListOfRoutes **cityNodes) {
+    Change *change = newChange(map, REMOVED_ROUTE);
+
+    change->route = route;
+    change->routeNode = node;
+    change->cityNodes = cityNodes;
+}
+
+void logChangedLimits(Map *map) {
+    Change *change = newChange(map, CHANGED_LIMITS);
+
+    change->length = map->maxDetourLength;
+    change->number = map->maxDetourCities;
+}
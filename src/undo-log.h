@@ -0,0 +1,176 @@
+/** @file
+ * Interfejs pliku zawierającego funkcje dziennika zmian mapy.
+ *
+ * @author Karol Soczewica <ks394468@students.mimuw.edu.pl>
+ * @date 01.09.2019
+ */
+
+#ifndef __UNDO_LOG_H__
+#define __UNDO_LOG_H__
+
+#include "structures-functions.h"
+
+#define MAP_ROADS 0    ///< indeks listy odcinków dróg mapy
+#define CITY_A_ROADS 1 ///< indeks listy odcinków dróg miasta @p cityA
+#define CITY_B_ROADS 2 ///< indeks listy odcinków dróg miasta @p cityB
+#define ROAD_LISTS 3   ///< liczba list, na których jest odcinek drogi
+
+/**
+ * @brief Zapewnia w dzienniku miejsce na kolejną zmianę.
+ * Funkcje zmieniające mapę wywołują ją przed wprowadzeniem zmiany, dzięki
+ * czemu zapisanie wprowadzonej już zmiany w dzienniku nie może się nie
+ * powieść.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli w dzienniku jest miejsce na kolejną zmianę.
+ * Wartość @p false, gdy nie udało się zaalokować pamięci.
+ */
+bool reserveChange(Map *map);
+
+/**
+ * @brief Rozpoczyna polecenie zmieniające mapę.
+ * Nic nie robi, jeśli wskaźnik na mapę ma wartość NULL.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ * @return Liczba zmian zapisanych w dzienniku przed poleceniem, do której
+ * można wycofać jego zmiany.
+ */
+int startChanges(Map *map);
+
+/**
+ * @brief Kończy polecenie zmieniające mapę.
+ * Jeśli polecenie się nie powiodło, wycofuje wszystkie jego zmiany i oznacza
+ * otwartą grupę zmian jako nieudaną. Jeśli grupa zmian nie jest otwarta,
+ * zatwierdza zmiany zapisane w dzienniku. Nic nie robi, jeśli wskaźnik na
+ * mapę ma wartość NULL.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] savepoint      – wynik funkcji @ref startChanges;
+ * @param[in] correct        – informacja o tym, czy polecenie się powiodło.
+ */
+void finishChanges(Map *map, int savepoint, bool correct);
+
+/**
+ * @brief Wycofuje zmiany zapisane w dzienniku.
+ * Cofa zmiany w kolejności odwrotnej do ich wprowadzenia, aż w dzienniku
+ * zostanie podana liczba zmian. Nie alokuje pamięci.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] savepoint      – liczba zmian, które mają zostać w dzienniku.
+ */
+void undoChanges(Map *map, int savepoint);
+
+/**
+ * @brief Zatwierdza zmiany zapisane w dzienniku.
+ * Jeśli wersje mapy są publikowane, publikuje wersję z tymi zmianami.
+ * Zwalnia pamięć usuniętych elementów mapy i opróżnia dziennik.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void commitChanges(Map *map);
+
+/**
+ * @brief Oznacza otwartą grupę zmian jako nieudaną.
+ * Zmiany nieudanej grupy są wycofywane przy jej zatwierdzaniu. Nic nie robi,
+ * jeśli grupa zmian nie jest otwarta lub wskaźnik na mapę ma wartość NULL.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void failBatch(Map *map);
+
+/**
+ * @brief Wycofuje niezatwierdzone zmiany i zwalnia dziennik.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void freeUndoLog(Map *map);
+
+/**
+ * @brief Zapisuje w dzienniku dodanie do mapy ostatniego miasta.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void logAddedCity(Map *map);
+
+/**
+ * @brief Zapisuje w dzienniku dodanie odcinka drogi.
+ * Zakłada, że w dzienniku jest miejsce na zmianę, a odcinek drogi jest
+ * dodawany na koniec list odcinków dróg mapy i obu miast.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] tails          – ostatnie węzły list odcinków dróg mapy i obu
+ *                             miast przed dodaniem odcinka drogi.
+ */
+void logAddedRoad(Map *map, Road *road, ListOfRoads *tails[]);
+
+/**
+ * @brief Zapisuje w dzienniku zmianę roku budowy lub ostatniego remontu
+ * odcinka drogi.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] year           – poprzedni rok odcinka drogi.
+ */
+void logRepairedRoad(Map *map, Road *road, int year);
+
+/**
+ * @brief Zapisuje w dzienniku usunięcie odcinka drogi.
+ * Zakłada, że w dzienniku jest miejsce na zmianę. Odcinek drogi i jego węzły
+ * zostaną zwolnione przy zatwierdzeniu zmian.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] road           – wskaźnik na strukturę odcinka drogi;
+ * @param[in] nodes          – węzły odłączone od list odcinków dróg mapy
+ *                             i obu miast.
+ */
+void logRemovedRoad(Map *map, Road *road, ListOfRoads *nodes[]);
+
+/**
+ * @brief Zapisuje w dzienniku dodanie drogi krajowej.
+ * Zakłada, że w dzienniku jest miejsce na zmianę, a droga krajowa jest
+ * ostatnią drogą krajową na liście mapy.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej.
+ */
+void logAddedRoute(Map *map, Route *route);
+
+/**
+ * @brief Zapisuje w dzienniku wydłużenie drogi krajowej.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej;
+ * @param[in] front          – liczba odcinków dróg dodanych przed pierwszym
+ *                             miastem;
+ * @param[in] back           – liczba odcinków dróg dodanych za ostatnim
+ *                             miastem.
+ */
+void logExtendedRoute(Map *map, Route *route, int front, int back);
+
+/**
+ * @brief Zapisuje w dzienniku zastąpienie odcinka drogi krajowej objazdem.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej;
+ * @param[in] position       – pozycja zastąpionego odcinka drogi względem
+ *                             pierwszego odcinka drogi krajowej;
+ * @param[in] shift          – liczba odcinków dróg objazdu pomniejszona o 1;
+ * @param[in] road           – wskaźnik na zastąpiony odcinek drogi;
+ * @param[in] link           – wskaźnik na węzeł listy dróg krajowych
+ *                             zastąpionego odcinka drogi.
+ */
+void logDetouredRoute(Map *map, Route *route, int position, int shift,
+                      Road *road, ListOfRoutes *link);
+
+/**
+ * @brief Zapisuje w dzienniku usunięcie drogi krajowej.
+ * Zakłada, że w dzienniku jest miejsce na zmianę. Droga krajowa i jej węzły
+ * zostaną zwolnione przy zatwierdzeniu zmian.
+ * @param[in,out] map        – wskaźnik na strukturę mapy;
+ * @param[in] route          – wskaźnik na strukturę drogi krajowej;
+ * @param[in] node           – węzeł odłączony od listy dróg krajowych mapy;
+ * @param[in] cityNodes      – zaalokowana tablica węzłów odłączonych od list
+ *                             dróg krajowych kolejnych miast drogi krajowej.
+ */
+void logRemovedRoute(Map *map, Route *route, ListOfRoutes *node,
+                     ListOfRoutes **cityNodes);
+
+/**
+ * @brief Zapisuje w dzienniku zmianę ograniczeń objazdów.
+ * Zakłada, że w dzienniku jest miejsce na zmianę.
+ * @param[in,out] map        – wskaźnik na strukturę mapy.
+ */
+void logChangedLimits(Map *map);
+
+#endif /* __UNDO_LOG_H__ */
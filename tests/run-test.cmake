@@ -0,0 +1,34 @@
+# Uruchamia program map na pliku NAME.in i porównuje standardowe wyjście
+# z plikiem NAME.out, a standardowe wyjście diagnostyczne z plikiem NAME.err.
+# Parametry: PROGRAM – ścieżka do programu, NAME – ścieżka do testu bez
+# rozszerzenia, OPTIONS – opcjonalne parametry wywołania programu, MODE –
+# opcjonalna nazwa trybu. Jeśli istnieje plik NAME.MODE.out lub NAME.MODE.err,
+# wyjście jest porównywane z nim zamiast z plikiem wspólnym dla trybów.
+
+execute_process(COMMAND ${PROGRAM} ${OPTIONS}
+                INPUT_FILE ${NAME}.in
+                OUTPUT_VARIABLE results
+                ERROR_VARIABLE errors
+                RESULT_VARIABLE status)
+
+set(resultsFile ${NAME}.out)
+set(errorsFile ${NAME}.err)
+if (DEFINED MODE AND EXISTS ${NAME}.${MODE}.out)
+    set(resultsFile ${NAME}.${MODE}.out)
+endif ()
+if (DEFINED MODE AND EXISTS ${NAME}.${MODE}.err)
+    set(errorsFile ${NAME}.${MODE}.err)
+endif ()
+
+file(READ ${resultsFile} expectedResults)
+file(READ ${errorsFile} expectedErrors)
+
+if (NOT status EQUAL 0)
+    message(FATAL_ERROR "Program zakończył się kodem ${status}")
+endif ()
+if (NOT results STREQUAL expectedResults)
+    message(FATAL_ERROR "Niezgodne wyjście:\n${results}\nOczekiwane:\n${expectedResults}")
+endif ()
+if (NOT errors STREQUAL expectedErrors)
+    message(FATAL_ERROR "Niezgodne wyjście diagnostyczne:\n${errors}\nOczekiwane:\n${expectedErrors}")
+endif ()
@@ -0,0 +1,102 @@
+#!/bin/sh
+# Sprawdza tryb serwera z dwoma klientami. Klient A otwiera grupę zmian
+# i przestaje przysyłać polecenia, a klient B w tym czasie czyta opis drogi
+# krajowej i wprowadza zmiany. Serwer ma wycofać grupę bezczynnego klienta
+# po upływie limitu czasu, dzięki czemu zmiany klienta B się udają. Następnie
+# klient C wydłuża drogę krajową w grupie zmian, a klient D w trakcie grupy
+# i po jej zatwierdzeniu odczytuje opis drogi krajowej i drogi krajowe miast
+# z opublikowanych wersji mapy: w trakcie grupy bez czekania na nią i bez jej
+# zmian, a po zatwierdzeniu z nimi. Po otrzymaniu sygnału SIGTERM serwer ma
+# zakończyć pracę kodem 0 i usunąć gniazdo.
+# Parametry: ścieżka do programu map i ścieżka do programu map-client.
+
+MAP=$1
+CLIENT=$2
+DIRECTORY=$(mktemp -d)
+SOCKET=$DIRECTORY/socket
+STATUS=0
+
+fail() {
+    echo "$1" >&2
+    STATUS=1
+}
+
+"$MAP" --server "$SOCKET" 1 &
+SERVER=$!
+TRIES=0
+while [ ! -S "$SOCKET" ] && [ $TRIES -lt 50 ]; do
+    sleep 0.1
+    TRIES=$((TRIES + 1))
+done
+
+printf 'addRoad;A;B;1;2000\nnewRoute;1;A;B\n' | "$CLIENT" "$SOCKET"
+
+{
+    printf 'beginBatch\naddRoad;B;C;1;2000\nextendRoute;1;C\n'
+    sleep 3
+    printf 'commitBatch\n'
+} | "$CLIENT" "$SOCKET" > "$DIRECTORY/a.out" 2>&1 &
+IDLE=$!
+sleep 0.3
+
+printf 'getRouteDescription;1\naddRoad;B;C;2;2001\nextendRoute;1;C\ngetRouteDescription;1\n' \
+    | "$CLIENT" "$SOCKET" > "$DIRECTORY/b.out" 2>&1
+EXPECTED='1;A;1;2000;B
+1;A;1;2000;B;2;2001;C'
+if [ "$(cat "$DIRECTORY/b.out")" != "$EXPECTED" ]; then
+    fail "Niezgodne wyjście klienta B:
+$(cat "$DIRECTORY/b.out")"
+fi
+
+wait $IDLE
+if [ -s "$DIRECTORY/a.out" ]; then
+    fail "Niezgodne wyjście klienta A:
+$(cat "$DIRECTORY/a.out")"
+fi
+
+{
+    printf 'beginBatch\naddRoad;C;D;3;2002\nextendRoute;1;D\n'
+    printf 'getRouteDescription;1\ngetCityRoutes;D\n'
+    sleep 0.6
+    printf 'commitBatch\n'
+} | "$CLIENT" "$SOCKET" > "$DIRECTORY/c.out" 2>&1 &
+WRITER=$!
+sleep 0.3
+
+{
+    printf 'getRouteDescription;1\ngetCityRoutes;C\ngetCityRoutes;D\n'
+    sleep 0.6
+    printf 'getRouteDescription;1\ngetCityRoutes;D\n'
+} | "$CLIENT" "$SOCKET" > "$DIRECTORY/d.out" 2> "$DIRECTORY/d.err"
+wait $WRITER
+EXPECTED='1;A;1;2000;B;2;2001;C;3;2002;D
+1'
+if [ "$(cat "$DIRECTORY/c.out")" != "$EXPECTED" ]; then
+    fail "Niezgodne wyjście klienta C:
+$(cat "$DIRECTORY/c.out")"
+fi
+EXPECTED='1;A;1;2000;B;2;2001;C
+1
+1;A;1;2000;B;2;2001;C;3;2002;D
+1'
+if [ "$(cat "$DIRECTORY/d.out")" != "$EXPECTED" ]; then
+    fail "Niezgodne wyjście klienta D:
+$(cat "$DIRECTORY/d.out")"
+fi
+if [ "$(cat "$DIRECTORY/d.err")" != "ERROR 3" ]; then
+    fail "Niezgodne wyjście diagnostyczne klienta D:
+$(cat "$DIRECTORY/d.err")"
+fi
+
+kill -TERM $SERVER
+wait $SERVER
+SERVER_STATUS=$?
+if [ $SERVER_STATUS -ne 0 ]; then
+    fail "Serwer zakończył się kodem $SERVER_STATUS"
+fi
+if [ -e "$SOCKET" ]; then
+    fail "Serwer nie usunął gniazda"
+fi
+
+rm -rf "$DIRECTORY"
+exit $STATUS